@@ -0,0 +1,63 @@
+//
+//  FlxBenchmark.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSUInteger, FlxBenchmarkFormat) {
+    FlxBenchmarkFormatJSON,
+    FlxBenchmarkFormatCSV
+};
+
+/**
+ *  The block measured by a benchmark. It's called once per operation, inside it's own autorelease pool, so the cost of releasing what the operation created is measured too.
+ */
+typedef void (^FlxBenchmarkBlock) (void);
+
+/**
+ *  A minimal benchmark harness. Each benchmark is run for a number of warmup operations (which aren't measured) and then for it's measured operations, and the results are written to stdout as one line per benchmark:
+ *  - `ops_per_sec` & `ns_per_op`: Measured with a monotonic clock.
+ *  - `allocs_per_op` & `bytes_per_op`: Calls to malloc/calloc/realloc (and the bytes requested) on any thread while the benchmark runs. These are only counted on glibc (where the allocator can be interposed); elsewhere they're `null`.
+ *  - `peak_rss_kb`: The peak resident set size of the process so far. Since it never goes down, run a single benchmark (with `--filter`) if you want to compare the peak of one benchmark.
+ *
+ *  The first line written is a header with the sqlite version and the options used, so results from different versions can be compared.
+ */
+@interface FlxBenchmarkRunner : NSObject
+/**
+ *  Only benchmarks whose name contains this string are run. `nil` runs every benchmark.
+ */
+@property (copy) NSString *filter;
+/**
+ *  Multiplies every benchmark's operation count. Use a value below 1 for a quick run.
+ *  Default: 1
+ */
+@property double scale;
+/**
+ *  Default: FlxBenchmarkFormatJSON
+ */
+@property FlxBenchmarkFormat format;
+/**
+ *  Creates a runner configured from the command line arguments: `--filter <name>`, `--scale <factor>` and `--format json|csv`.
+ */
+- (id) initWithArguments:(NSArray *)arguments;
+/**
+ *  Returns YES if the benchmark would be run (it matches the filter). Use this to skip expensive set up for benchmarks that won't be run.
+ */
+- (BOOL) shouldRunBenchmark:(NSString *)name;
+/**
+ *  Runs the benchmark and writes it's results.
+ *
+ *  @param name       The benchmark's name. Use a dotted name (ex: "statement.insert.16") so related benchmarks can be filtered together.
+ *  @param operations The number of measured operations (before scaling). A tenth as many operations (at least one) are run to warm up.
+ *  @param block      The operation to measure.
+ */
+- (void) runBenchmark:(NSString *)name operations:(NSUInteger)operations block:(FlxBenchmarkBlock)block;
+/**
+ *  Writes the header line. This is done automatically before the first benchmark is written.
+ */
+- (void) writeHeader;
+@end
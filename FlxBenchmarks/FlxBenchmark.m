@@ -0,0 +1,166 @@
+//
+//  FlxBenchmark.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "FlxBenchmark.h"
+#import <sqlite3.h>
+#import <stdlib.h>
+#import <time.h>
+#import <sys/resource.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+
+#pragma mark - Allocation Counting
+#if defined(__GLIBC__)
+#define FlxCountsAllocations 1
+/* glibc lets an executable replace malloc & friends, and exports the real allocator as __libc_*, so the replacements can count and forward without dlsym (which itself allocates).
+ Counting is off unless a benchmark is being measured, and the counters are updated atomically since the manager allocates on it's own queues. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+
+static volatile int FlxAllocationCounting = 0;
+static unsigned long long FlxAllocationCount = 0;
+static unsigned long long FlxAllocationBytes = 0;
+
+static inline void FlxCountAllocation(size_t size){
+  if (!__atomic_load_n(&FlxAllocationCounting, __ATOMIC_RELAXED)) return;
+  __atomic_fetch_add(&FlxAllocationCount, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&FlxAllocationBytes, size, __ATOMIC_RELAXED);
+}
+void *malloc(size_t size){
+  FlxCountAllocation(size);
+  return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size){
+  FlxCountAllocation(count * size);
+  return __libc_calloc(count, size);
+}
+void *realloc(void *pointer, size_t size){
+  FlxCountAllocation(size);
+  return __libc_realloc(pointer, size);
+}
+static void FlxStartCountingAllocations(void){
+  __atomic_store_n(&FlxAllocationCount, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&FlxAllocationBytes, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&FlxAllocationCounting, 1, __ATOMIC_SEQ_CST);
+}
+static void FlxStopCountingAllocations(unsigned long long *count, unsigned long long *bytes){
+  __atomic_store_n(&FlxAllocationCounting, 0, __ATOMIC_SEQ_CST);
+  *count = __atomic_load_n(&FlxAllocationCount, __ATOMIC_RELAXED);
+  *bytes = __atomic_load_n(&FlxAllocationBytes, __ATOMIC_RELAXED);
+}
+#else
+#define FlxCountsAllocations 0
+static void FlxStartCountingAllocations(void){}
+static void FlxStopCountingAllocations(unsigned long long *count, unsigned long long *bytes){
+  *count = 0;
+  *bytes = 0;
+}
+#endif
+
+#pragma mark - Measurement
+static uint64_t FlxMonotonicNanoseconds(void){
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * NSEC_PER_SEC + (uint64_t)time.tv_nsec;
+}
+static long FlxPeakRSSKilobytes(void){
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+  //Darwin reports bytes, Linux reports kilobytes
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+@implementation FlxBenchmarkRunner {
+  BOOL _wroteHeader;
+}
+#pragma mark - Init Methods
+- (id) init{
+  if ((self = [super init])){
+    _scale = 1;
+    _format = FlxBenchmarkFormatJSON;
+    _wroteHeader = NO;
+  }
+  return self;
+}
+- (id) initWithArguments:(NSArray *)arguments{
+  if ((self = [self init])){
+    for (NSUInteger i = 1; i + 1 < arguments.count; i++){
+      NSString *option = arguments[i];
+      NSString *value = arguments[i + 1];
+      if ([option isEqualToString:@"--filter"]){
+        _filter = [value copy];
+        i++;
+      } else if ([option isEqualToString:@"--scale"]){
+        _scale = MAX(value.doubleValue, 0.001);
+        i++;
+      } else if ([option isEqualToString:@"--format"]){
+        _format = [value isEqualToString:@"csv"] ? FlxBenchmarkFormatCSV : FlxBenchmarkFormatJSON;
+        i++;
+      }
+    }
+  }
+  return self;
+}
+#pragma mark - Private Methods
+- (void) writeLine:(NSString *)line{
+  fprintf(stdout, "%s\n", line.UTF8String);
+  fflush(stdout);
+}
+#pragma mark - Standard Methods
+- (void) writeHeader{
+  if (_wroteHeader) return;
+  _wroteHeader = YES;
+  if (_format == FlxBenchmarkFormatCSV){
+    [self writeLine:$(@"# sqlite %s, scale %g, allocations %@", sqlite3_libversion(), _scale, FlxCountsAllocations ? @"counted" : @"not counted")];
+    [self writeLine:@"benchmark,operations,ops_per_sec,ns_per_op,allocs_per_op,bytes_per_op,peak_rss_kb"];
+  } else {
+    [self writeLine:$(@"{\"suite\":\"FlxBenchmarks\",\"sqlite\":\"%s\",\"scale\":%g,\"counts_allocations\":%@}", sqlite3_libversion(), _scale, FlxCountsAllocations ? @"true" : @"false")];
+  }
+}
+- (BOOL) shouldRunBenchmark:(NSString *)name{
+  return !_filter.length || [name rangeOfString:_filter].location != NSNotFound;
+}
+- (void) runBenchmark:(NSString *)name operations:(NSUInteger)operations block:(FlxBenchmarkBlock)block{
+  if (!block || ![self shouldRunBenchmark:name]) return;
+  [self writeHeader];
+  operations = MAX((NSUInteger)(operations * _scale), 1);
+  NSUInteger warmup = MAX(operations / 10, 1);
+  for (NSUInteger i = 0; i < warmup; i++){
+    @autoreleasepool {
+      block();
+    }
+  }
+
+  unsigned long long allocations, bytes;
+  FlxStartCountingAllocations();
+  uint64_t start = FlxMonotonicNanoseconds();
+  for (NSUInteger i = 0; i < operations; i++){
+    @autoreleasepool {
+      block();
+    }
+  }
+  uint64_t elapsed = FlxMonotonicNanoseconds() - start;
+  FlxStopCountingAllocations(&allocations, &bytes);
+
+  double nsPerOp = (double)elapsed / operations;
+  double opsPerSec = elapsed ? operations * (double)NSEC_PER_SEC / elapsed : 0;
+  NSString *allocsPerOp = FlxCountsAllocations ? $(@"%.2f", (double)allocations / operations) : nil;
+  NSString *bytesPerOp = FlxCountsAllocations ? $(@"%.1f", (double)bytes / operations) : nil;
+  long peakRSS = FlxPeakRSSKilobytes();
+  if (_format == FlxBenchmarkFormatCSV){
+    [self writeLine:$(@"%@,%lu,%.1f,%.1f,%@,%@,%ld", name, (unsigned long)operations, opsPerSec, nsPerOp, allocsPerOp ?: @"", bytesPerOp ?: @"", peakRSS)];
+  } else {
+    [self writeLine:$(@"{\"benchmark\":\"%@\",\"operations\":%lu,\"ops_per_sec\":%.1f,\"ns_per_op\":%.1f,\"allocs_per_op\":%@,\"bytes_per_op\":%@,\"peak_rss_kb\":%ld}", name, (unsigned long)operations, opsPerSec, nsPerOp, allocsPerOp ?: @"null", bytesPerOp ?: @"null", peakRSS)];
+  }
+}
+@end
@@ -0,0 +1,262 @@
+//
+//  main.m
+//  FlxBenchmarks
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "FlxBenchmark.h"
+#import "SQLDatabase.h"
+#import "SQLDatabaseManager.h"
+#import "SQLStatement.h"
+#import "SQLStatementConstructor.h"
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define BenchmarkTable @"Benchmark"
+#define BenchmarkRowCount 1000
+#define BenchmarkPredicateDepth 3
+
+@protocol BenchmarkRowProtocol <NSObject, SQLStatementObject>
+@property (nonatomic) NSString *name;
+@property (nonatomic) NSString *detail;
+@property (nonatomic) NSData *data;
+@property long long count;
+@property double value;
+@property BOOL flag;
+@end
+
+@interface BenchmarkRow : NSObject <BenchmarkRowProtocol>
+@end
+@implementation BenchmarkRow
+@synthesize GUID, SQLCreatedDateTime, SQLModifiedDateTime;
+@synthesize name, detail, data, count, value, flag;
+@end
+
+#pragma mark - Helpers
+static NSString *BenchmarkDatabasePath(NSString *name){
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:$(@"FlxBenchmark-%@-%d.sqlite", name, [[NSProcessInfo processInfo] processIdentifier])];
+  [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+  return path;
+}
+
+static void BenchmarkRemoveDatabase(NSString *path){
+  NSFileManager *fileManager = [NSFileManager defaultManager];
+  for (NSString *suffix in @[@"", @"-wal", @"-shm", @"-journal"]){
+    [fileManager removeItemAtPath:[path stringByAppendingString:suffix] error:nil];
+  }
+}
+
+static void BenchmarkWaitUntil(BOOL (^finished)(void)){
+  //Manager blocks are returned on the main queue, so the run loop has to run for them to be called
+  while (!finished()){
+    @autoreleasepool {
+      [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.001]];
+    }
+  }
+}
+
+static SQLStatement *BenchmarkStatement(SQLStatementType type, NSUInteger columnCount){
+  SQLStatement *statement = [SQLStatement statementType:type forTable:BenchmarkTable];
+  for (NSUInteger i = 0; i < columnCount; i++){
+    SQLColumn *column = [statement addColumn:$(@"column%lu", (unsigned long)i) ofColumnType:(i % 2 ? SQLColumnTypeInt : SQLColumnTypeText)];
+    if (type == SQLStatementInsert || type == SQLStatementUpdate){
+      column.value = (i % 2) ? @(i) : $(@"value %lu", (unsigned long)i);
+    }
+  }
+  return statement;
+}
+
+static SQLPredicateGroup *BenchmarkPredicateGroup(NSUInteger depth){
+  //Each group has a few predicates and (until it's deep enough) two child groups, connected with alternating ANDs & ORs
+  SQLPredicateGroup *group = [[SQLPredicateGroup alloc] initWithConnection:(depth % 2 ? SQLConnectOr : SQLConnectAnd) predicates:nil];
+  for (NSUInteger i = 0; i < 3; i++){
+    [group addPredicate:[[SQLPredicate alloc] initWithColumn:$(@"column%lu", (unsigned long)i) value:@(depth * 10 + i) operator:(i == 2 ? SQLLessThan : SQLEquals) connection:(i % 2 ? SQLConnectOr : SQLConnectAnd)]];
+  }
+  if (depth > 1){
+    [group addGroup:BenchmarkPredicateGroup(depth - 1)];
+    [group addGroup:BenchmarkPredicateGroup(depth - 1)];
+  }
+  return group;
+}
+
+static BenchmarkRow *BenchmarkRowObject(NSUInteger index){
+  BenchmarkRow *row = [BenchmarkRow new];
+  row.name = $(@"Row %lu", (unsigned long)index);
+  row.detail = @"A short description that's about as long as most text columns.";
+  row.data = [row.detail dataUsingEncoding:NSUTF8StringEncoding];
+  row.count = index;
+  row.value = index * 1.5;
+  row.flag = index % 2;
+  return row;
+}
+
+static SQLStatement *BenchmarkInsertStatement(NSUInteger index){
+  return [SQLStatementConstructor constructInsertStatementFromObject:BenchmarkRowObject(index) usingProtocol:@protocol(BenchmarkRowProtocol) tableName:BenchmarkTable];
+}
+
+static SQLStatement *BenchmarkCreateStatement(void){
+  return [SQLStatementConstructor constructStatement:SQLStatementCreate fromProtocol:@protocol(BenchmarkRowProtocol) usingTableName:BenchmarkTable];
+}
+
+#pragma mark - Benchmarks
+static void BenchmarkStatementGeneration(FlxBenchmarkRunner *runner){
+  for (NSNumber *columnCount in @[@4, @16, @64]){
+    NSUInteger columns = columnCount.unsignedIntegerValue;
+    SQLStatement *insert = BenchmarkStatement(SQLStatementInsert, columns);
+    [runner runBenchmark:$(@"statement.insert.%lu", (unsigned long)columns) operations:20000 block:^{
+      (void)insert.newStatement;
+      insert.GUID = nil;
+    }];
+
+    SQLStatement *update = BenchmarkStatement(SQLStatementUpdate, columns);
+    [update addPredicate:@"benchmark" forColumn:GUIDKey];
+    [runner runBenchmark:$(@"statement.update.%lu", (unsigned long)columns) operations:20000 block:^{
+      (void)update.newStatement;
+    }];
+
+    SQLStatement *query = BenchmarkStatement(SQLStatementQuery, columns);
+    [query addPredicateGroup:BenchmarkPredicateGroup(BenchmarkPredicateDepth)];
+    [query addOrderForColumn:@"column0" withDirection:SQLOrderAscending];
+    [runner runBenchmark:$(@"statement.query.%lu.groups%d", (unsigned long)columns, BenchmarkPredicateDepth) operations:20000 block:^{
+      (void)query.newStatement;
+    }];
+  }
+}
+
+static void BenchmarkConstructor(FlxBenchmarkRunner *runner){
+  [runner runBenchmark:@"constructor.query" operations:20000 block:^{
+    (void)[SQLStatementConstructor constructStatement:SQLStatementQuery fromProtocol:@protocol(BenchmarkRowProtocol) usingTableName:BenchmarkTable];
+  }];
+  BenchmarkRow *row = BenchmarkRowObject(1);
+  [runner runBenchmark:@"constructor.insert" operations:20000 block:^{
+    (void)[SQLStatementConstructor constructInsertStatementFromObject:row usingProtocol:@protocol(BenchmarkRowProtocol) tableName:BenchmarkTable];
+  }];
+}
+
+static BOOL BenchmarkShouldRunAny(FlxBenchmarkRunner *runner, NSArray *names){
+  for (NSString *name in names){
+    if ([runner shouldRunBenchmark:name]) return YES;
+  }
+  return NO;
+}
+
+static void BenchmarkHydration(FlxBenchmarkRunner *runner){
+  NSArray *rowCounts = @[@10, @(BenchmarkRowCount)];
+  NSMutableArray *names = [NSMutableArray new];
+  for (NSNumber *rowCount in rowCounts){
+    [names addObject:$(@"hydrate.dictionary.%@", rowCount)];
+    [names addObject:$(@"hydrate.rowclass.%@", rowCount)];
+  }
+  //Filling the table takes a while, so skip it if none of these would be run
+  if (!BenchmarkShouldRunAny(runner, names)) return;
+  NSString *path = BenchmarkDatabasePath(@"hydrate");
+  SQLDatabase *database = [[SQLDatabase alloc] initWithPath:path];
+  [database executeUpdate:BenchmarkCreateStatement().newStatement];
+  [database beginImmediateTransaction];
+  for (NSUInteger i = 0; i < BenchmarkRowCount; i++){
+    @autoreleasepool {
+      SQLStatement *insert = BenchmarkInsertStatement(i);
+      NSString *sql = insert.newStatement;
+      [database executeUpdate:sql withParameters:insert.parameters];
+    }
+  }
+  [database commit];
+
+  SQLStatement *query = [SQLStatementConstructor constructStatement:SQLStatementQuery fromProtocol:@protocol(BenchmarkRowProtocol) usingTableName:BenchmarkTable];
+  for (NSNumber *rowCount in rowCounts){
+    query.limit = rowCount.unsignedIntegerValue;
+    NSString *sql = query.newStatement;
+    NSArray *parameters = query.parameters;
+    NSUInteger operations = 200000 / rowCount.unsignedIntegerValue;
+    [runner runBenchmark:$(@"hydrate.dictionary.%@", rowCount) operations:operations block:^{
+      (void)[database executeQuery:sql withParameters:parameters];
+    }];
+    [runner runBenchmark:$(@"hydrate.rowclass.%@", rowCount) operations:operations block:^{
+      (void)[database executeQuery:sql withParameters:parameters withClassForRow:[BenchmarkRow class]];
+    }];
+  }
+  [database close];
+  BenchmarkRemoveDatabase(path);
+}
+
+static void BenchmarkManager(FlxBenchmarkRunner *runner){
+  NSString *bulkName = $(@"bulk.updatequeue.%d", BenchmarkRowCount);
+  if (!BenchmarkShouldRunAny(runner, @[bulkName, @"roundtrip.sync.query", @"roundtrip.async.query", @"roundtrip.sync.update", @"roundtrip.async.update"])) return;
+  NSString *path = BenchmarkDatabasePath(@"manager");
+  SQLDatabaseManager *manager = [[SQLDatabaseManager alloc] initWithFilePath:path];
+  [manager runSynchronousUpdate:BenchmarkCreateStatement()];
+
+  NSMutableArray *inserts = [NSMutableArray arrayWithCapacity:BenchmarkRowCount];
+  for (NSUInteger i = 0; i < BenchmarkRowCount; i++){
+    [inserts addObject:BenchmarkInsertStatement(i)];
+  }
+  //Statements without a block have their GUID reset once they're run, so the same statements insert new rows each time
+  [runner runBenchmark:bulkName operations:50 block:^{
+    SQLUpdateQueue *queue = [SQLUpdateQueue new];
+    for (SQLStatement *insert in inserts){
+      [queue addSQLUpdate:insert withBlock:nil];
+    }
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [manager runUpdateQueue:queue withCompletionBlock:^(BOOL success) {
+      dispatch_semaphore_signal(finished);
+    }];
+    dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+  }];
+
+  SQLStatement *insert = BenchmarkInsertStatement(0);
+  NSString *GUID = insert.GUID;
+  [manager runSynchronousUpdate:insert];
+  SQLStatement *query = [SQLStatementConstructor constructStatement:SQLStatementQuery fromProtocol:@protocol(BenchmarkRowProtocol) usingTableName:BenchmarkTable];
+  [query addPredicate:GUID forColumn:GUIDKey];
+  SQLStatement *update = [SQLStatement statementType:SQLStatementUpdate forTable:BenchmarkTable];
+  [update addColumn:@"count"].value = @1;
+  [update addPredicate:GUID forColumn:GUIDKey];
+
+  [runner runBenchmark:@"roundtrip.sync.query" operations:5000 block:^{
+    (void)[manager runSynchronousQuery:query];
+  }];
+  [runner runBenchmark:@"roundtrip.async.query" operations:5000 block:^{
+    __block BOOL finished = NO;
+    [manager runImmediateQuery:query withBlock:^(NSArray *results) {
+      finished = YES;
+    }];
+    BenchmarkWaitUntil(^{ return finished; });
+  }];
+  [runner runBenchmark:@"roundtrip.sync.update" operations:2000 block:^{
+    (void)[manager runSynchronousUpdate:update];
+  }];
+  [runner runBenchmark:@"roundtrip.async.update" operations:2000 block:^{
+    __block BOOL finished = NO;
+    [manager runImmediateUpdate:update withBlock:^(NSInteger result) {
+      finished = YES;
+    }];
+    BenchmarkWaitUntil(^{ return finished; });
+  }];
+  //Results delivered on a background queue don't go through the run loop (or the main thread) at all
+  dispatch_queue_t callbackQueue = dispatch_queue_create("FlxBenchmarkCallbackQueue", DISPATCH_QUEUE_SERIAL);
+  [runner runBenchmark:@"roundtrip.async.query.callbackQueue" operations:5000 block:^{
+    dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+    [manager runImmediateQuery:query usingRowClass:nil onQueue:callbackQueue withBlock:^(NSArray *results) {
+      dispatch_semaphore_signal(finished);
+    }];
+    dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+  }];
+  dispatch_release(callbackQueue);
+
+  [manager closeDatabase];
+  BenchmarkRemoveDatabase(path);
+}
+
+int main(int argc, const char * argv[]){
+  @autoreleasepool {
+    FlxBenchmarkRunner *runner = [[FlxBenchmarkRunner alloc] initWithArguments:[[NSProcessInfo processInfo] arguments]];
+    [runner writeHeader];
+    BenchmarkStatementGeneration(runner);
+    BenchmarkConstructor(runner);
+    BenchmarkHydration(runner);
+    BenchmarkManager(runner);
+  }
+  return 0;
+}
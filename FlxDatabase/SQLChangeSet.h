@@ -0,0 +1,51 @@
+//
+//  SQLChangeSet.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A SQLChangeSet describes the rows changed by one or more commits, by table. Rows are identified by their rowid (NSNumber), not their GUID, since that's all sqlite reports.
+ *
+ *  Some changes can't be tracked by row: sqlite doesn't report rows deleted by `DELETE FROM <table>` without a predicate (the truncate optimization) or rows replaced by an `ON CONFLICT REPLACE`, and a table whose schema changed may have changed completely. In those cases the table is marked with `allRowsChangedInTable:`. If even the tables aren't known (ex: raw sql run through SQLDatabaseManager), `allTablesChanged` is set.
+ *
+ *  @see SQLDatabase's `tracksChanges`
+ */
+@interface SQLChangeSet : NSObject <NSCopying>
+/**
+ *  The names of the tables that changed.
+ */
+@property (readonly) NSSet *tableNames;
+/**
+ *  YES if the tables that changed aren't known, in which case any table may have changed.
+ */
+@property (readonly) BOOL allTablesChanged;
+/**
+ *  YES if there are no changes.
+ */
+@property (readonly) BOOL isEmpty;
+/**
+ *  @return The rowids (NSNumber) of the rows inserted into the table. Never `nil`.
+ */
+- (NSSet *) insertedRowIDsForTable:(NSString *)tableName;
+/**
+ *  @return The rowids (NSNumber) of the rows updated in the table. Never `nil`.
+ */
+- (NSSet *) updatedRowIDsForTable:(NSString *)tableName;
+/**
+ *  @return The rowids (NSNumber) of the rows deleted from the table. Never `nil`.
+ */
+- (NSSet *) deletedRowIDsForTable:(NSString *)tableName;
+/**
+ *  Returns YES if the rows that changed in the table aren't known (or there were too many to track individually), in which case any row in the table may have changed. This is also YES for every table when `allTablesChanged` is set.
+ */
+- (BOOL) allRowsChangedInTable:(NSString *)tableName;
+/**
+ *  Returns the names of the columns that were updated in the table, or `nil` if they aren't known. Columns are only known when every update to the table was made with a SQLStatement through SQLDatabaseManager.
+ */
+- (NSSet *) updatedColumnsForTable:(NSString *)tableName;
+@end
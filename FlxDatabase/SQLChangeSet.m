@@ -0,0 +1,223 @@
+//
+//  SQLChangeSet.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLChangeSet.h"
+#import <sqlite3.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+//Past this, a table's rows aren't tracked individually (ex: a large bulk insert)
+#define SQLChangeSetMaxRowIDs 10000
+#define SQLChangeSetTableNameLength 256
+
+@interface SQLTableChanges : NSObject <NSCopying>
+@property (readonly) NSMutableSet *inserted;
+@property (readonly) NSMutableSet *updated;
+@property (readonly) NSMutableSet *deleted;
+@property BOOL allRowsChanged;
+@property NSMutableSet *updatedColumns;
+@property BOOL updatedColumnsKnown;
+- (void) addRowID:(sqlite3_int64)rowID toSet:(NSMutableSet *)rowIDs;
+- (void) addChanges:(SQLTableChanges *)changes;
+@end
+
+@implementation SQLTableChanges
+- (id) init{
+  if ((self = [super init])){
+    _inserted = [NSMutableSet new];
+    _updated = [NSMutableSet new];
+    _deleted = [NSMutableSet new];
+    _allRowsChanged = NO;
+    _updatedColumnsKnown = NO;
+  }
+  return self;
+}
+- (id) copyWithZone:(NSZone *)zone{
+  SQLTableChanges *copy = [SQLTableChanges new];
+  [copy.inserted unionSet:_inserted];
+  [copy.updated unionSet:_updated];
+  [copy.deleted unionSet:_deleted];
+  copy.allRowsChanged = _allRowsChanged;
+  copy.updatedColumns = [_updatedColumns mutableCopy];
+  copy.updatedColumnsKnown = _updatedColumnsKnown;
+  return copy;
+}
+- (void) setAllRowsChanged:(BOOL)allRowsChanged{
+  _allRowsChanged = allRowsChanged;
+  if (allRowsChanged){
+    [_inserted removeAllObjects];
+    [_updated removeAllObjects];
+    [_deleted removeAllObjects];
+  }
+}
+- (void) addRowID:(sqlite3_int64)rowID toSet:(NSMutableSet *)rowIDs{
+  if (_allRowsChanged) return;
+  [rowIDs addObject:@(rowID)];
+  if (_inserted.count + _updated.count + _deleted.count > SQLChangeSetMaxRowIDs) self.allRowsChanged = YES;
+}
+- (void) addChanges:(SQLTableChanges *)changes{
+  BOOL hadUpdates = (_updated.count > 0 || _updatedColumnsKnown);
+  if (changes.allRowsChanged || _allRowsChanged){
+    self.allRowsChanged = YES;
+  } else {
+    [_inserted unionSet:changes.inserted];
+    [_updated unionSet:changes.updated];
+    [_deleted unionSet:changes.deleted];
+    if (_inserted.count + _updated.count + _deleted.count > SQLChangeSetMaxRowIDs) self.allRowsChanged = YES;
+  }
+  //Columns are only known if they're known on both sides (a side with no updates doesn't count)
+  if (!changes.updated.count && !changes.updatedColumnsKnown) return;
+  if (!hadUpdates){
+    _updatedColumnsKnown = changes.updatedColumnsKnown;
+    _updatedColumns = [changes.updatedColumns mutableCopy];
+  } else if (_updatedColumnsKnown && changes.updatedColumnsKnown){
+    [_updatedColumns unionSet:changes.updatedColumns];
+  } else {
+    _updatedColumnsKnown = NO;
+    _updatedColumns = nil;
+  }
+}
+@end
+
+@interface SQLChangeSet ()
+- (void) recordOperation:(int)operation table:(const char *)tableName rowID:(sqlite3_int64)rowID;
+- (void) addChangesFromChangeSet:(SQLChangeSet *)changeSet;
+- (void) addTable:(NSString *)tableName;
+- (void) markAllRowsChangedInTable:(NSString *)tableName;
+- (void) markAllTablesChanged;
+- (void) setUpdatedColumns:(NSSet *)columnNames forTable:(NSString *)tableName;
+- (void) removeAllChanges;
+@end
+
+@implementation SQLChangeSet {
+  NSMutableDictionary *_tables;
+  //The table changes were last recorded for, so the name isn't converted for every row
+  char _lastTableName[SQLChangeSetTableNameLength];
+  SQLTableChanges *_lastTableChanges;
+}
+#pragma mark - Init Methods
+- (id) init{
+  if ((self = [super init])){
+    _tables = [NSMutableDictionary new];
+    _allTablesChanged = NO;
+    _lastTableName[0] = '\0';
+  }
+  return self;
+}
+#pragma mark - Private Methods
+- (SQLTableChanges *) changesForTable:(NSString *)tableName{
+  SQLTableChanges *changes = _tables[tableName];
+  if (!changes){
+    changes = [SQLTableChanges new];
+    _tables[tableName] = changes;
+  }
+  return changes;
+}
+- (void) recordOperation:(int)operation table:(const char *)tableName rowID:(sqlite3_int64)rowID{
+  //Called from sqlite's update hook, once per row
+  SQLTableChanges *changes = _lastTableChanges;
+  if (!changes || strncmp(tableName, _lastTableName, SQLChangeSetTableNameLength) != 0){
+    changes = [self changesForTable:[NSString stringWithUTF8String:tableName]];
+    _lastTableChanges = nil;
+    if (strlen(tableName) < SQLChangeSetTableNameLength){
+      strncpy(_lastTableName, tableName, SQLChangeSetTableNameLength);
+      _lastTableChanges = changes;
+    }
+  }
+  switch (operation) {
+    case SQLITE_INSERT:
+      [changes addRowID:rowID toSet:changes.inserted];
+      break;
+    case SQLITE_UPDATE:
+      [changes addRowID:rowID toSet:changes.updated];
+      break;
+    case SQLITE_DELETE:
+      [changes addRowID:rowID toSet:changes.deleted];
+      break;
+    default:
+      break;
+  }
+}
+- (void) addChangesFromChangeSet:(SQLChangeSet *)changeSet{
+  if (changeSet.allTablesChanged) _allTablesChanged = YES;
+  [changeSet->_tables enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, SQLTableChanges *changes, BOOL *stop) {
+    SQLTableChanges *existing = _tables[tableName];
+    if (existing){
+      [existing addChanges:changes];
+    } else {
+      _tables[tableName] = [changes copy];
+    }
+  }];
+}
+- (void) addTable:(NSString *)tableName{
+  if (tableName.length) [self changesForTable:tableName];
+}
+- (void) markAllRowsChangedInTable:(NSString *)tableName{
+  if (tableName.length) [self changesForTable:tableName].allRowsChanged = YES;
+}
+- (void) markAllTablesChanged{
+  _allTablesChanged = YES;
+}
+- (void) setUpdatedColumns:(NSSet *)columnNames forTable:(NSString *)tableName{
+  if (!tableName.length) return;
+  SQLTableChanges *changes = [self changesForTable:tableName];
+  changes.updatedColumns = [columnNames mutableCopy];
+  changes.updatedColumnsKnown = (columnNames != nil);
+}
+- (void) removeAllChanges{
+  [_tables removeAllObjects];
+  _allTablesChanged = NO;
+  _lastTableChanges = nil;
+  _lastTableName[0] = '\0';
+}
+#pragma mark - Protocol Methods
+- (id) copyWithZone:(NSZone *)zone{
+  SQLChangeSet *copy = [SQLChangeSet new];
+  [copy addChangesFromChangeSet:self];
+  return copy;
+}
+- (NSString *) description{
+  NSMutableString *description = [NSMutableString stringWithString:$(@"<%@: %p>%@", NSStringFromClass([self class]), self, _allTablesChanged ? @" all tables changed" : @"")];
+  [_tables enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, SQLTableChanges *changes, BOOL *stop) {
+    if (changes.allRowsChanged){
+      [description appendFormat:@"\n %@: all rows changed", tableName];
+    } else {
+      [description appendFormat:@"\n %@: %lu inserted, %lu updated, %lu deleted", tableName, (unsigned long)changes.inserted.count, (unsigned long)changes.updated.count, (unsigned long)changes.deleted.count];
+    }
+  }];
+  return description;
+}
+#pragma mark - Property Methods
+- (NSSet *) tableNames{
+  return [NSSet setWithArray:_tables.allKeys];
+}
+- (BOOL) isEmpty{
+  if (_allTablesChanged) return NO;
+  for (SQLTableChanges *changes in _tables.allValues){
+    if (changes.allRowsChanged || changes.inserted.count || changes.updated.count || changes.deleted.count) return NO;
+  }
+  return YES;
+}
+#pragma mark - Standard Methods
+- (NSSet *) insertedRowIDsForTable:(NSString *)tableName{
+  return [[_tables[tableName] inserted] copy] ?: [NSSet set];
+}
+- (NSSet *) updatedRowIDsForTable:(NSString *)tableName{
+  return [[_tables[tableName] updated] copy] ?: [NSSet set];
+}
+- (NSSet *) deletedRowIDsForTable:(NSString *)tableName{
+  return [[_tables[tableName] deleted] copy] ?: [NSSet set];
+}
+- (BOOL) allRowsChangedInTable:(NSString *)tableName{
+  return _allTablesChanged || [_tables[tableName] allRowsChanged];
+}
+- (NSSet *) updatedColumnsForTable:(NSString *)tableName{
+  SQLTableChanges *changes = _tables[tableName];
+  if (_allTablesChanged || !changes.updatedColumnsKnown || changes.allRowsChanged) return nil;
+  return [changes.updatedColumns copy] ?: [NSSet set];
+}
+@end
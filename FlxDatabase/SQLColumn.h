@@ -41,7 +41,12 @@ typedef NS_ENUM(NSUInteger, SQLAggregate){
  */
 @property (readonly) NSString *alias;
 /**
- The name string is used for hashing and to determine column uniqueness.  It will either be the column's alias, if you're using one, the name or else the name and aggregate if you're using an aggregate. */
+ *  Only used for queries. The table (or table alias) the column belongs to, used to qualify the column in a query with joins (see `SQLJoin`). If this is `nil`, the column belongs to the statement's table (or, for a join's columns, the joined table).
+ *  Default: nil
+ */
+@property (copy) NSString *table;
+/**
+ The name string is used for hashing and to determine column uniqueness.  It will either be the column's alias, if you're using one, the name or else the name and aggregate if you're using an aggregate. A column with a `table` is prefixed by the table (ex: `List.name`), so columns with the same name from different tables are unique. */
 @property (readonly) NSString *nameString;
 /**
  *  The aggregate is only used for Queries and it will aggregate the data in this column according to the type you set here. How this work may depend on how the rest of the statement is setup (other columns, whether you've added groups, etc...).  If you're unsure, you probably need to brush up your SQL.
@@ -69,6 +74,10 @@ typedef NS_ENUM(NSUInteger, SQLAggregate){
  *  This is used only for creating new columns and tables. SQLite will require all entries into this column to be unique.
  */
 @property bool unique;
+/**
+ *  This is used only for creating new columns and tables. The column will be indexed: a SQLStatement includes an index for each indexed column in it's `indexStatements`, which SQLDatabaseManager creates when it creates or updates the table (see `updateOrCreateTableToColumnsInStatement:`). Use a `SQLStatementCreateIndex` statement for composite, partial or covering indexes.
+ */
+@property bool indexed;
 /**
  *  This returns the string SQL equivalent of the column type.
  */
@@ -13,11 +13,13 @@
 @implementation SQLColumn{
     NSString *_name;
     NSString *_alias;
+    NSString *_table;
     SQLColumnType _type;
     SQLAggregate _aggregate;
     bool _primaryKey;
     bool _notNull;
     bool _unique;
+    bool _indexed;
     id _value;
 }
 #pragma mark -
@@ -40,6 +42,7 @@
         _primaryKey = NO;
         _notNull = NO;
         _unique = NO;
+        _indexed = NO;
         _value = nil;
     }
     return self;
@@ -53,6 +56,8 @@
     copy.primaryKey = _primaryKey;
     copy.notNull = _notNull;
     copy.unique = _unique;
+    copy.indexed = _indexed;
+    copy.table = _table;
     return copy;
 }
 #pragma mark - Properties
@@ -60,10 +65,11 @@
     if (_alias){
         return _alias;
     } else {
+        NSString *name = _table ? $(@"%@.%@", _table, _name) : _name;
         if (_aggregate != SQLAggregateNone){
-            return $(@"%@(%@)", self.columnAggregateString, _name);
+            return $(@"%@(%@)", self.columnAggregateString, name);
         } else {
-            return _name;
+            return name;
         }
     }
 }
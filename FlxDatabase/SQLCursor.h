@@ -0,0 +1,53 @@
+//
+//  SQLCursor.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  A SQLCursor steps through the results of a query one row at a time instead of loading every row into memory at once. Rows are only created as you ask for them, so memory stays constant no matter how large the result is.
+ *
+ *  Get a cursor from `-[SQLDatabase cursorForQuery:withParameters:rowClass:]`. You can use `nextRow`, `nextBatch:` or fast enumeration (`for (id row in cursor)`).
+ *
+ *  @warning A cursor holds an open statement on it's database, so it must be used on the same thread/queue as the database and should be closed (or released) as soon as you're done with it. Closing the database closes the cursor.
+ */
+@interface SQLCursor : NSObject <NSFastEnumeration>
+/**
+ *  The column names returned by the query.
+ */
+@property (readonly) NSArray *columnNames;
+/**
+ *  The class used for each row. NSMutableDictionary is used unless a row class was provided.
+ */
+@property (readonly) Class rowClass;
+/**
+ *  Returns YES once the last row has been returned or the cursor has been closed.
+ */
+@property (readonly) BOOL finished;
+/**
+ *  The number of rows returned from the cursor so far.
+ */
+@property (readonly) NSUInteger rowsRead;
+/**
+ *  Steps to the next row.
+ *
+ *  @return The next row, or nil if there are no more rows. The cursor is closed automatically after the last row.
+ */
+- (id) nextRow;
+/**
+ *  Steps through the next `count` rows.
+ *
+ *  @param count The maximum number of rows to return.
+ *
+ *  @return An array of up to `count` rows. The array will be empty once there are no more rows.
+ */
+- (NSArray *) nextBatch:(NSUInteger)count;
+/**
+ *  Stops the cursor and releases it's statement. Any remaining rows are skipped. It's safe to call this more than once.
+ */
+- (void) close;
+@end
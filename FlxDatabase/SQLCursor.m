@@ -0,0 +1,100 @@
+//
+//  SQLCursor.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLCursor.h"
+#import "SQLDatabase.h"
+#import "SQLRowMapper.h"
+#import <sqlite3.h>
+
+@interface SQLDatabase (SQLCursor)
+- (NSArray *) columnNamesForStatement:(sqlite3_stmt *)statement;
+- (id) rowFromStatement:(sqlite3_stmt *)statement rowClass:(Class)rowClass columnNames:(NSArray *)columnNames;
+- (void) releaseStatement:(sqlite3_stmt *)statement cachedStatement:(id)cachedStatement;
+- (void) sqlError:(NSString *)errorMessage errorCode:(int)errorCode critical:(BOOL)critical;
+@end
+
+@interface SQLRowMapper (SQLCursor)
+- (id) rowFromStatement:(sqlite3_stmt *)statement;
+@end
+
+@interface SQLCursor ()
+- (id) initWithDatabase:(SQLDatabase *)database statement:(sqlite3_stmt *)statement cachedStatement:(id)cachedStatement rowClass:(Class)rowClass;
+@end
+
+@implementation SQLCursor {
+    SQLDatabase *_database;
+    sqlite3_stmt *_statement;
+    id _cachedStatement;
+    SQLRowMapper *_mapper;
+    //Keeps the rows handed out by fast enumeration alive until the next batch is requested
+    NSArray *_enumerationBatch;
+    unsigned long _mutations;
+}
+#pragma mark - Init Methods
+- (id) initWithDatabase:(SQLDatabase *)database statement:(sqlite3_stmt *)statement cachedStatement:(id)cachedStatement rowClass:(Class)rowClass{
+    if ((self = [super init])){
+        _database = database;
+        _statement = statement;
+        _cachedStatement = cachedStatement;
+        _rowClass = rowClass ?: [NSMutableDictionary class];
+        _columnNames = [database columnNamesForStatement:statement];
+        if (![_rowClass isSubclassOfClass:[NSMutableDictionary class]]){
+            _mapper = [SQLRowMapper mapperForClass:_rowClass columnNames:_columnNames];
+        }
+        _finished = NO;
+        _rowsRead = 0;
+    }
+    return self;
+}
+- (void) dealloc{
+    [self close];
+}
+#pragma mark - Standard Methods
+- (id) nextRow{
+    if (_finished) return nil;
+    int rc = sqlite3_step(_statement);
+    if (rc == SQLITE_ROW){
+        _rowsRead++;
+        if (_mapper) return [_mapper rowFromStatement:_statement];
+        return [_database rowFromStatement:_statement rowClass:_rowClass columnNames:_columnNames];
+    }
+    if (rc != SQLITE_DONE){
+        [_database sqlError:@"Failed to step cursor with message: %S" errorCode:rc critical:NO];
+    }
+    [self close];
+    return nil;
+}
+- (NSArray *) nextBatch:(NSUInteger)count{
+    NSMutableArray *batch = [NSMutableArray arrayWithCapacity:count];
+    id row = nil;
+    while (batch.count < count && (row = [self nextRow])){
+        [batch addObject:row];
+    }
+    return batch;
+}
+- (void) close{
+    if (_statement){
+        [_database releaseStatement:_statement cachedStatement:_cachedStatement];
+        _statement = NULL;
+        _cachedStatement = nil;
+    }
+    _finished = YES;
+}
+#pragma mark - Protocol Methods
+- (NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(__unsafe_unretained id [])buffer count:(NSUInteger)len{
+    state->state = 1;
+    state->mutationsPtr = &_mutations;
+    _enumerationBatch = [self nextBatch:len];
+    NSUInteger count = _enumerationBatch.count;
+    for (NSUInteger i = 0; i < count; i++){
+        buffer[i] = _enumerationBatch[i];
+    }
+    state->itemsPtr = buffer;
+    return count;
+}
+@end
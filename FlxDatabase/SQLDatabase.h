@@ -7,6 +7,12 @@
     //
 
 #import <Foundation/Foundation.h>
+#import "SQLDatabaseOptions.h"
+#import "SQLResultSet.h"
+#import "SQLCursor.h"
+#import "SQLGUID.h"
+#import "SQLChangeSet.h"
+#import "SQLProfiler.h"
 
 @interface SQLDatabase : NSObject 
 
@@ -14,16 +20,53 @@
  *  This is the path to the database. This will need to be set before you open the database.  However, normally this should be necessary as you'd normally use either `initWithPath:` or `initWithFileName:` which will set this property on initialization.
  */
 @property (nonatomic, retain) NSString *pathToDatabase;
+/**
+ *  The maximum number of prepared statements kept in the statement cache. Statements are cached by their SQL text, so running the same SQL repeatedly will reuse the prepared statement (it's reset and its bindings are cleared instead of being finalized). When the cache is full, the least recently used statement is finalized. Set to `0` to disable caching.
+ *  Default: 50
+ */
+@property (nonatomic) NSUInteger statementCacheSize;
+/**
+ *  The number of prepared statements currently held in the cache.
+ */
+@property (readonly) NSUInteger statementCacheCount;
+/**
+ *  The number of times a SQL statement was found in the statement cache.
+ */
+@property (readonly) NSUInteger statementCacheHits;
+/**
+ *  The number of times a SQL statement had to be prepared because it wasn't in the statement cache.
+ */
+@property (readonly) NSUInteger statementCacheMisses;
 /**
  Returns a SQLDatabse at the specified path. If no file exists at that path, a new database will be created. This will automatically 'open' the database for use.
  */
 - (id) initWithPath:(NSString *) filePath;
+/**
+ Returns a SQLDatabase at the specified path, opened either read-only or read/write. A read-only database will not be created if it doesn't exist. This will automatically 'open' the database for use.
+ */
+- (id) initWithPath:(NSString *)filePath readOnly:(BOOL)readOnly;
+/**
+ Returns a SQLDatabase at the specified path, opened with the provided options (cache size, journal mode, etc). If `nil` is passed, `[SQLDatabaseOptions defaultOptions]` is used. This will automatically 'open' the database for use.
+ */
+- (id) initWithPath:(NSString *)filePath options:(SQLDatabaseOptions *)options;
+/**
+ Returns a SQLDatabase at the specified path, opened either read-only or read/write with the provided options. Read-only connections won't apply options that write to the database (page size & journal mode). This will automatically 'open' the database for use.
+ */
+- (id) initWithPath:(NSString *)filePath readOnly:(BOOL)readOnly options:(SQLDatabaseOptions *)options;
+/**
+ *  Returns YES if the database connection was opened read-only.
+ */
+@property (readonly) BOOL readOnly;
+/**
+ *  The options applied to the connection whenever it's opened. This is a copy of the options passed in on initialization, so changing the options afterward won't affect the database.
+ */
+@property (readonly) SQLDatabaseOptions *options;
 /**
  Returns a SQLDatabase at the specified fileName in the standard Documents directory path. If no file exists at that path, a new database will be created. This will automatically 'open' the database for use.
  **/
 - (id) initWithFileName:(NSString *)fileName;
 /**
- This will close the database.  Required if you intend on moving the database file.
+ This will close the database.  Required if you intend on moving the database file. Any open cursors are closed first.
  */
 - (void) close;
 /**
@@ -49,12 +92,32 @@
  *
  *  @param sql        The query statement.
  *  @param parameters The parameter values (should match '?' in the statement).
- *  @param rowClass   The class type you want created for each row returned. For each column returned in the query, the resulting value will be set on the class type using the column name as the keyPath. If `nil` is passed, NSMutableDictionary class will be used as the row class.
+ *  @param rowClass   The class type you want created for each row returned. For each column returned in the query, the resulting value will be set on the class type using the column name as the keyPath. If `nil` is passed, NSMutableDictionary class will be used as the row class. Row classes other than NSMutableDictionary are populated with a SQLRowMapper, which calls the setters directly with native values.
  *  @warning If the rowClass doesn't respond to a keyPath (column name), an exception will be thrown.
  *
  *  @return An array of class items that represent the items returned in the query.
  */
 - (NSArray *) executeQuery:(NSString *)sql withParameters:(NSArray *)parameters withClassForRow:(Class)rowClass;
+/**
+ *  Executes a query with the parameters provided, returning the results in a columnar SQLResultSet instead of an array of row objects. Values aren't boxed into objects until you ask for them, so this is a lot lighter on memory and allocations for large queries.
+ *
+ *  @param sql        The query statement.
+ *  @param parameters The parameter values (should match '?' in the statement).
+ *
+ *  @return A SQLResultSet containing the rows returned from the query, or nil if the statement failed.
+ */
+- (SQLResultSet *) executeResultSetQuery:(NSString *)sql withParameters:(NSArray *)parameters;
+/**
+ *  Prepares a query and returns a cursor that steps through the results lazily instead of loading them all into memory. Use this for queries that may return more rows than you'd want to hold at once (exports, full table scans, etc).
+ *  @warning The cursor must be used on the same thread/queue as the database and closed when you're done. Closing the database closes any open cursors.
+ *
+ *  @param sql        The query statement.
+ *  @param parameters The parameter values (should match '?' in the statement).
+ *  @param rowClass   The class type you want created for each row. If `nil` is passed, NSMutableDictionary will be used.
+ *
+ *  @return A SQLCursor positioned before the first row, or nil if the statement failed.
+ */
+- (SQLCursor *) cursorForQuery:(NSString *)sql withParameters:(NSArray *)parameters rowClass:(Class)rowClass;
 /**
  *  This will execute the query.  It's not recommended you use this method for if there are any unkown parameters. Instead, parameratize the statement and use `executeUpdate:withParameters` instead.
  *
@@ -72,6 +135,27 @@
  *  @return An integer representing success. -1 if the update failed.
  */
 - (NSInteger) executeUpdate:(NSString *)sql withParameters:(NSArray *)parameters;
+/**
+ *  Executes an update like `executeUpdate:withParameters:`, except a failure doesn't raise an exception. Use this when a failure is expected and handled (ex: retrying rows that violate a constraint).
+ *
+ *  @param sql        The SQL update statement.
+ *  @param parameters The parameter values (should match '?' in the statement).
+ *
+ *  @return The sqlite result code. `SQLITE_DONE` (101) means the update succeeded.
+ */
+- (int) executeUpdateForResultCode:(NSString *)sql withParameters:(NSArray *)parameters;
+/**
+ *  @return The number of rows inserted, updated or deleted by the most recent update.
+ */
+- (NSUInteger) changes;
+/**
+ *  @return The maximum number of parameters ('?') sqlite allows in a single statement.
+ */
+- (NSUInteger) maximumParameterCount;
+/**
+ *  @return YES if a transaction is currently open on the connection.
+ */
+- (BOOL) inTransaction;
 /**
  *  Grab an array of columns for the provided table name.
  *
@@ -80,6 +164,10 @@
  *  @return An array of NSString column names.
  */
 - (NSArray *) columnsForTableName:(NSString *)tableName;
+/**
+ *  This will finalize and remove all prepared statements from the statement cache. This is automatically done when the database is opened or closed. You should also call this after changing the schema (adding columns, dropping or altering tables) so stale statements aren't reused. It also clears the cached GUID modes (see `GUIDModeForTable:`).
+ */
+- (void) clearStatementCache;
 /**
  *  Grab all table information for the database.
  *
@@ -112,6 +200,88 @@
  *  This will rollback a set of updates in a transaction.
  */
 - (void) rollback;
+/**
+ *  If set to YES, the rows inserted, updated and deleted through this connection are recorded (using sqlite's update, commit and rollback hooks) and can be retrieved with `takeCommittedChanges`. Changes are only kept once they're committed; changes from a rolled back transaction are discarded (though changes rolled back to a savepoint are still reported, since sqlite doesn't report those). Changes made by other connections aren't seen.
+ *  @warning Changes accumulate until they're taken, so if you turn this on, call `takeCommittedChanges` regularly (ex: after every commit).
+ *  Default: NO
+ */
+@property (nonatomic) BOOL tracksChanges;
+/**
+ *  Returns the changes committed since this was last called and starts collecting a new set.
+ *
+ *  @return The committed changes, or `nil` if nothing was changed (or changes aren't being tracked).
+ */
+- (SQLChangeSet *) takeCommittedChanges;
+/**
+ *  If set, every query & update executed on this connection is profiled (timings, rows, sqlite's statement counters) and recorded in the profiler. A profiler can be shared by several connections. Set this on the thread (or queue) the database is used on.
+ *
+ *  When this is `nil`, nothing is measured.
+ *  Default: nil
+ *  @see SQLProfiler
+ */
+@property (nonatomic, strong) SQLProfiler *profiler;
+/**
+ *  If set, this is called periodically while a statement is executing (every few thousand sqlite instructions, using `sqlite3_progress_handler`). Return YES to interrupt the statement: it stops with SQLITE_INTERRUPT and `interrupted` is set. Use this to enforce deadlines; it's called on the thread executing the statement, so keep it quick.
+ *  @warning sqlite rolls back the whole transaction when an update (insert, update or delete) is interrupted inside it. Queries only stop.
+ *  Default: nil
+ */
+@property (nonatomic, copy) BOOL (^interruptBlock)(void);
+/**
+ *  Interrupts the statement currently executing on the connection (`sqlite3_interrupt`). Unlike the other methods, this can be called from any thread. If nothing is executing, this does nothing.
+ *  @see interruptBlock
+ */
+- (void) interrupt;
+/**
+ *  YES if the last query or update was interrupted (by `interrupt` or the `interruptBlock`). An interrupted query returns the rows read before it stopped, so they're incomplete. An interrupted update returns -1 instead of raising an exception.
+ */
+@property (readonly) BOOL interrupted;
+/**
+ *  This will switch the database to write-ahead logging (`PRAGMA journal_mode=WAL`). WAL mode is persistent, so once it's set on the database file, all connections to that file will use it. In WAL mode, readers don't block the writer and the writer doesn't block readers.
+ *
+ *  @return YES if the database is now in WAL mode.
+ */
+- (BOOL) enableWriteAheadLogging;
+/**
+ *  @return The database's current journal mode (ex: "delete", "wal").
+ */
+- (NSString *) journalMode;
+/**
+ *  Queries the connection for the settings actually in effect. This is useful to verify your options were applied (ex: sqlite may refuse WAL mode or a page size change on an existing database).
+ *
+ *  @return A dictionary keyed by pragma name ("cache_size", "mmap_size", "page_size", "synchronous", "temp_store", "journal_mode", "locking_mode", "busy_timeout") with the values sqlite reports.
+ */
+- (NSDictionary *) effectiveSettings;
+/**
+ *  The database's user version (`PRAGMA user_version`). sqlite doesn't use it, so it's free to track the version of your schema (see SQLDatabaseManager's `runMigrations:`). Setting it inside a transaction is rolled back with the transaction.
+ *  Default: 0
+ */
+@property (nonatomic) NSUInteger userVersion;
+/**
+ *  The database's schema version (`PRAGMA schema_version`). sqlite changes this every time the schema is changed (tables, columns or indexes are created, altered or dropped).
+ */
+@property (readonly) NSUInteger schemaVersion;
+/**
+ *  Rebuilds a table so it's GUID column uses the GUID mode provided, converting every existing GUID (ex: from `VARCHAR(36)` strings to 16 byte BLOBs). The table's columns, indexes and triggers are kept. It's all done in a savepoint, so if anything fails the table is left as it was.
+ *
+ *  GUIDs that aren't valid UUIDs are copied unchanged. The table's mode is stored in the schema (as the GUID column's type), so `GUIDModeForTable:` returns the new mode once this succeeds.
+ *  @warning This rewrites the entire table, so it can take a while for large tables. The table must have been created with a `"GUID" ... PRIMARY KEY` column (as SQLStatement creates it).
+ *
+ *  @param tableName The table to migrate.
+ *  @param mode      The GUID mode to migrate to.
+ *
+ *  @return YES if the table was migrated.
+ */
+- (BOOL) migrateTable:(NSString *)tableName toGUIDMode:(SQLGUIDMode)mode;
+/**
+ *  Returns how a table stores it's GUID, read from the declared type of it's GUID column (`BLOB` is binary) and cached for this connection until the statement cache is cleared. A table that doesn't exist yet uses the mode from `[SQLGUID modeForTable:]`.
+ *
+ *  SQLDatabaseManager sets each SQLStatement's mode from this before running it. If you run a statement's sql yourself, set it's `GUIDMode` from this first.
+ *
+ *  @param tableName The name of the table.
+ *
+ *  @return SQLGUIDMode
+ */
+- (SQLGUIDMode) GUIDModeForTable:(NSString *)tableName;
 /**
  *  @return This will return the last row ID inserted.
  */
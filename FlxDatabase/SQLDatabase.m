@@ -7,27 +7,122 @@
     // pg 159
 
 #import "SQLDatabase.h"
+#import "SQLResultSet.h"
+#import "SQLCursor.h"
+#import "SQLRowMapper.h"
+#import "SQLChangeSet.h"
 #import <sqlite3.h>
 
 #define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
 
 #define DocumentDirectory (NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject)
+#define DefaultStatementCacheSize 50
+#define InterruptCheckInstructions 1000
+
+/**
+ *  Wraps a prepared sqlite3_stmt held in the statement cache. A cached statement is reset (not finalized) when it's released so it can be reused.
+ */
+@interface SQLCachedStatement : NSObject
+@property (readonly) NSString *sql;
+@property (readonly) sqlite3_stmt *statement;
+@property BOOL inUse;
+- (id) initWithSQL:(NSString *)sql statement:(sqlite3_stmt *)statement;
+@end
+
+@implementation SQLCachedStatement
+- (id) initWithSQL:(NSString *)sql statement:(sqlite3_stmt *)statement{
+    if ((self = [super init])){
+        _sql = sql;
+        _statement = statement;
+        _inUse = NO;
+    }
+    return self;
+}
+- (void) dealloc{
+    if (_statement){
+        sqlite3_finalize(_statement);
+        _statement = NULL;
+    }
+}
+@end
+
+@interface SQLResultSet (SQLDatabase)
+- (id) initWithColumnNames:(NSArray *)columnNames;
+- (void) appendRowFromStatement:(sqlite3_stmt *)statement;
+- (void) finishLoading;
+@end
+
+@interface SQLRowMapper (SQLDatabase)
+- (id) rowFromStatement:(sqlite3_stmt *)statement;
+@end
+
+@interface SQLGUID (SQLDatabase)
++ (int) registerFunctionsWithConnection:(sqlite3 *)connection;
+@end
+
+@interface SQLChangeSet (SQLDatabase)
+- (void) recordOperation:(int)operation table:(const char *)tableName rowID:(sqlite3_int64)rowID;
+- (void) addChangesFromChangeSet:(SQLChangeSet *)changeSet;
+- (void) removeAllChanges;
+@end
+
+@interface SQLCursor (SQLDatabase)
+- (id) initWithDatabase:(SQLDatabase *)database statement:(sqlite3_stmt *)statement cachedStatement:(id)cachedStatement rowClass:(Class)rowClass;
+@end
+
+@interface SQLProfiler (SQLDatabase)
+- (void) recordSQL:(NSString *)sql statement:(sqlite3_stmt *)statement parameterCount:(NSUInteger)parameterCount rowCount:(NSUInteger)rowCount prepared:(BOOL)prepared prepareDuration:(NSTimeInterval)prepareDuration stepDuration:(NSTimeInterval)stepDuration hydrationDuration:(NSTimeInterval)hydrationDuration queueWait:(NSTimeInterval)queueWait;
+@end
+
+@interface SQLDatabase ()
+//Set by SQLDatabaseManager before it executes a queued statement; it's added to the next execution profiled
+@property (nonatomic) NSTimeInterval profileQueueWait;
+@end
 
 @implementation SQLDatabase {
     NSString *pathToDatabase;
 	sqlite3 *database;
+    //Statement Cache: keyed by sql, ordered from least to most recently used
+    NSMutableDictionary *_statementCache;
+    NSMutableOrderedSet *_statementCacheOrder;
+    //GUID Modes: keyed by table name, read from the GUID column's declared type & cleared with the statement cache
+    NSMutableDictionary *_GUIDModes;
+    //Change Tracking: changes are pending until the transaction commits
+    SQLChangeSet *_pendingChanges;
+    SQLChangeSet *_committedChanges;
+    //Interruption: the connection is read from other threads by interrupt
+    NSLock *_interruptLock;
+    //Cursors: held weakly, so open cursors can be closed with the database
+    NSHashTable *_openCursors;
 }
 
 @synthesize pathToDatabase;
 
 #pragma mark - Initialization
 - (id) initWithPath:(NSString *)filePath{
+    return [self initWithPath:filePath readOnly:NO options:nil];
+}
+- (id) initWithPath:(NSString *)filePath readOnly:(BOOL)readOnly{
+    return [self initWithPath:filePath readOnly:readOnly options:nil];
+}
+- (id) initWithPath:(NSString *)filePath options:(SQLDatabaseOptions *)options{
+    return [self initWithPath:filePath readOnly:NO options:options];
+}
+- (id) initWithPath:(NSString *)filePath readOnly:(BOOL)readOnly options:(SQLDatabaseOptions *)options{
     /* Initialization with full path
      - set the pathToDatabase varialbe
      - call open to open the database 
      */
     if ((self = [super init])){
         self.pathToDatabase = filePath;
+        _readOnly = readOnly;
+        _options = options ? [options copy] : [SQLDatabaseOptions defaultOptions];
+        _statementCache = [NSMutableDictionary new];
+        _statementCacheOrder = [NSMutableOrderedSet new];
+        _statementCacheSize = DefaultStatementCacheSize;
+        _GUIDModes = [NSMutableDictionary new];
+        _interruptLock = [NSLock new];
+        _openCursors = [NSHashTable weakObjectsHashTable];
         [self open];
     }
     return self;
@@ -41,10 +136,20 @@
 }
 - (void) close{
     /* Close database or raise exception */
+    //All prepared statements must be finalized before sqlite will close the database, including those held by open cursors
+    for (SQLCursor *cursor in _openCursors.allObjects){
+        [cursor close];
+    }
+    [_openCursors removeAllObjects];
+    [self clearStatementCache];
     int rc = 0;
+    [_interruptLock lock];
     if((rc = sqlite3_close(database)) != SQLITE_OK){
         [self sqlError:@"Failed to close database with message '%S'." errorCode:rc critical:NO];
+    } else {
+        database = NULL;
     }
+    [_interruptLock unlock];
 }
 - (void) open{
     /* Opens the database
@@ -52,19 +157,129 @@
      (note: apparently sqlite3_open will create a new database if the file doesn't exist)
      */
     sqlite3_config(SQLITE_CONFIG_SERIALIZED);
+    [self clearStatementCache];
     int rc = 0;
-    if((rc = sqlite3_open([self.pathToDatabase UTF8String], &database)) != SQLITE_OK){
+    int flags = _readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    if((rc = sqlite3_open_v2([self.pathToDatabase UTF8String], &database, flags, NULL)) != SQLITE_OK){
         sqlite3_close(database);
         [self sqlError:@"Failed to open database with message '%S'." errorCode:rc critical:YES];
     } else {
-        //Limiting the cache to zero to reduce memory footprint.  Might reenable if performance ever becomes a problem.
-        const char *pragmaSql = "PRAGMA cache_size = 0";
-        if (sqlite3_exec(database, pragmaSql, NULL, NULL, NULL) != SQLITE_OK) {
-            NSAssert(NO, @"Error: failed to execute pragma statement with message '%s'.", sqlite3_errmsg(database));
+        [self applyOptions];
+        if ((rc = [SQLGUID registerFunctionsWithConnection:database]) != SQLITE_OK){
+            [self sqlError:@"Failed to register GUID functions with message '%S'." errorCode:rc critical:NO];
         }
+        if (_tracksChanges) [self installChangeHooks];
+        if (_interruptBlock) [self installProgressHandler];
     }
     
 }
+- (void) applyOptions{
+    /* Applies the connection options
+     - the busy timeout is set directly on the connection (it isn't a pragma)
+     - the options provide the pragmas in the order they need to be run
+     */
+    sqlite3_busy_timeout(database, (int)(_options.busyTimeout * 1000));
+    for (NSString *pragma in [_options pragmaStatementsForReadOnlyConnection:_readOnly]){
+        if (sqlite3_exec(database, [pragma UTF8String], NULL, NULL, NULL) != SQLITE_OK) {
+            NSAssert(NO, @"Error: failed to execute pragma statement '%@' with message '%s'.", pragma, sqlite3_errmsg(database));
+        }
+    }
+}
+#pragma mark - Change Tracking
+static void SQLDatabaseUpdateHook(void *context, int operation, const char *databaseName, const char *tableName, sqlite3_int64 rowID){
+    //Temp tables aren't tracked
+    if (strcmp(databaseName, "main") != 0) return;
+    SQLDatabase *sqlDatabase = (__bridge SQLDatabase *)context;
+    [sqlDatabase->_pendingChanges recordOperation:operation table:tableName rowID:rowID];
+}
+static int SQLDatabaseCommitHook(void *context){
+    SQLDatabase *sqlDatabase = (__bridge SQLDatabase *)context;
+    [sqlDatabase->_committedChanges addChangesFromChangeSet:sqlDatabase->_pendingChanges];
+    [sqlDatabase->_pendingChanges removeAllChanges];
+    return 0;
+}
+static void SQLDatabaseRollbackHook(void *context){
+    SQLDatabase *sqlDatabase = (__bridge SQLDatabase *)context;
+    [sqlDatabase->_pendingChanges removeAllChanges];
+}
+- (void) installChangeHooks{
+    /* The hooks only record changes; sqlite doesn't allow the connection to be used from inside them.
+     - update: records each row inserted, updated or deleted as pending
+     - commit: moves the pending changes to the committed changes (statements outside a transaction commit on their own)
+     - rollback: discards the pending changes
+     The connection doesn't retain the database, but it's closed before the database is deallocated.
+     */
+    void *context = (__bridge void *)self;
+    sqlite3_update_hook(database, SQLDatabaseUpdateHook, context);
+    sqlite3_commit_hook(database, SQLDatabaseCommitHook, context);
+    sqlite3_rollback_hook(database, SQLDatabaseRollbackHook, context);
+}
+- (void) removeChangeHooks{
+    sqlite3_update_hook(database, NULL, NULL);
+    sqlite3_commit_hook(database, NULL, NULL);
+    sqlite3_rollback_hook(database, NULL, NULL);
+}
+- (void) setTracksChanges:(BOOL)tracksChanges{
+    if (_tracksChanges == tracksChanges) return;
+    _tracksChanges = tracksChanges;
+    if (tracksChanges){
+        _pendingChanges = [SQLChangeSet new];
+        _committedChanges = [SQLChangeSet new];
+        if (database) [self installChangeHooks];
+    } else {
+        if (database) [self removeChangeHooks];
+        _pendingChanges = nil;
+        _committedChanges = nil;
+    }
+}
+- (SQLChangeSet *) takeCommittedChanges{
+    if (!_tracksChanges || _committedChanges.isEmpty) return nil;
+    SQLChangeSet *changes = _committedChanges;
+    _committedChanges = [SQLChangeSet new];
+    return changes;
+}
+#pragma mark - Interruption
+static int SQLDatabaseProgressHandler(void *context){
+    //A non-zero return interrupts the statement
+    SQLDatabase *sqlDatabase = (__bridge SQLDatabase *)context;
+    BOOL (^interruptBlock)(void) = sqlDatabase->_interruptBlock;
+    return (interruptBlock && interruptBlock()) ? 1 : 0;
+}
+- (void) installProgressHandler{
+    sqlite3_progress_handler(database, InterruptCheckInstructions, SQLDatabaseProgressHandler, (__bridge void *)self);
+}
+- (void) setInterruptBlock:(BOOL (^)(void))interruptBlock{
+    /* The progress handler is only installed while there's a block, so statements aren't slowed down otherwise */
+    BOOL installed = (_interruptBlock != nil);
+    _interruptBlock = [interruptBlock copy];
+    if (!database || installed == (interruptBlock != nil)) return;
+    if (interruptBlock){
+        [self installProgressHandler];
+    } else {
+        sqlite3_progress_handler(database, 0, NULL, NULL);
+    }
+}
+- (void) interrupt{
+    //Guarded so the connection can't be closed out from under us
+    [_interruptLock lock];
+    if (database) sqlite3_interrupt(database);
+    [_interruptLock unlock];
+}
+#pragma mark - Profiling
+static CFAbsoluteTime SQLBeginProfiling(sqlite3_stmt *statement){
+    /* Called once the statement is prepared & bound. A cached statement keeps it's counters from executions that weren't profiled, so they're cleared. Returns the time stepping started. */
+    sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+    sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    return CFAbsoluteTimeGetCurrent();
+}
+- (void) profileSQL:(NSString *)sql statement:(sqlite3_stmt *)statement parameterCount:(NSUInteger)parameterCount rowCount:(NSUInteger)rowCount prepared:(BOOL)prepared start:(CFAbsoluteTime)start stepStart:(CFAbsoluteTime)stepStart hydrationDuration:(CFAbsoluteTime)hydrationDuration{
+    /* Must be called before the statement is released. Hydration happens between steps, so it's taken out of the step time. */
+    CFAbsoluteTime end = CFAbsoluteTimeGetCurrent();
+    NSTimeInterval queueWait = _profileQueueWait;
+    _profileQueueWait = 0;
+    [_profiler recordSQL:sql statement:statement parameterCount:parameterCount rowCount:rowCount prepared:prepared prepareDuration:stepStart - start stepDuration:MAX(end - stepStart - hydrationDuration, 0) hydrationDuration:hydrationDuration queueWait:queueWait];
+}
 #pragma mark - mark Execution
 - (NSArray *) executeQuery:(NSString *)sql{
     /* this is a simplified executeSQL method that used when there are no parameters */
@@ -93,70 +308,266 @@
     if (parameters) [queryInfo setObject:parameters forKey:@"parameters"];
         //rows will be returned by the method
     NSMutableArray *rows = [NSMutableArray array];
+    _interrupted = NO;
 //    if (logging) FlxLog(@"SQL: %@ \n Parameters: %@", sql, parameters);
+        //Nothing is timed unless there's a profiler
+    SQLProfiler *profiler = _profiler;
+    CFAbsoluteTime start = profiler ? CFAbsoluteTimeGetCurrent() : 0;
+    NSUInteger cacheMisses = _statementCacheMisses;
     
         //Begin iteration through the sql results
-    sqlite3_stmt *statement = nil;
+    SQLCachedStatement *cachedStatement = nil;
     int rc = 0;
-    if ((rc = sqlite3_prepare_v2(database, [sql UTF8String], -1, &statement, NULL)) == SQLITE_OK){
+    sqlite3_stmt *statement = [self prepareStatement:sql cachedStatement:&cachedStatement errorCode:&rc];
+    if (statement){
             //This will only bind parameters if parameters exist
-        if (parameters) [self bindArguments: parameters toStatement:statement queryInfo:queryInfo];
+        if (parameters) [self bindArguments: parameters toStatement:statement cachedStatement:cachedStatement queryInfo:queryInfo];
+        CFAbsoluteTime stepStart = profiler ? SQLBeginProfiling(statement) : 0;
+        CFAbsoluteTime hydrationDuration = 0;
             //Arrays to store column names and types.  BOOL is used to get column information only once.  WARNING: sqlite3 can store variable data types in a single column.  This implementation ASSUMES that all data types within a column are the same.  This speeds the code by not fetching data types for each individual row, but may throw an exception or simply crash if the information stored isn't the correct type.
         BOOL needsToFetchColumnTapesAndName = YES;
         NSArray *columnTypes = nil;
         NSArray *columnNames = nil;
+            //Any row class other than a dictionary is mapped using a cached plan of setters instead of KVC
+        BOOL dictionaryRows = [rowClass isSubclassOfClass:[NSMutableDictionary class]];
+        SQLRowMapper *mapper = nil;
             //Iteration call several class methods, see those methods for details
-        while (sqlite3_step(statement) == SQLITE_ROW){
+        while ((rc = sqlite3_step(statement)) == SQLITE_ROW){
+            CFAbsoluteTime rowStart = profiler ? CFAbsoluteTimeGetCurrent() : 0;
             if(needsToFetchColumnTapesAndName){
                 columnTypes = [self columnTypesForStatement: statement];
                 columnNames = [self columnNamesForStatement: statement];
+                if (!dictionaryRows) mapper = [SQLRowMapper mapperForClass:rowClass columnNames:columnNames];
                 needsToFetchColumnTapesAndName = NO;
             }
-                //rowClass is generally of class type NSMutableDictionary
-            id row = [rowClass new];
-            [self copyValuesFromStatement:statement toRow:row queryInfo:queryInfo columnTypes:columnTypes columnNames:columnNames];
-            [rows addObject:row];
+            if (mapper){
+                [rows addObject:[mapper rowFromStatement:statement]];
+            } else {
+                    //rowClass is generally of class type NSMutableDictionary
+                id row = [rowClass new];
+                [self copyValuesFromStatement:statement toRow:row queryInfo:queryInfo columnTypes:columnTypes columnNames:columnNames];
+                [rows addObject:row];
+            }
+            if (profiler) hydrationDuration += CFAbsoluteTimeGetCurrent() - rowStart;
         }
+        _interrupted = (rc == SQLITE_INTERRUPT);
+        if (profiler) [self profileSQL:sql statement:statement parameterCount:parameters.count rowCount:rows.count prepared:(_statementCacheMisses != cacheMisses) start:start stepStart:stepStart hydrationDuration:hydrationDuration];
     } else {
-        sqlite3_finalize(statement);
+        _interrupted = (rc == SQLITE_INTERRUPT);
         [self sqlError:[$(@"Failed to execute statement: '%@' with message: ", sql) stringByAppendingString:@"%S"] errorCode:rc critical:NO];
     }
-    sqlite3_finalize(statement);
+    [self releaseStatement:statement cachedStatement:cachedStatement];
     return rows;
 }
+- (SQLResultSet *) executeResultSetQuery:(NSString *)sql withParameters:(NSArray *)parameters{
+    /* Same as executeQuery, except rows are copied straight into a columnar result set instead of being boxed into row objects */
+    if (!sql.length) return nil;
+    NSMutableDictionary *queryInfo = [NSMutableDictionary dictionary];
+    [queryInfo setObject:sql forKey:@"sql"];
+    if (parameters) [queryInfo setObject:parameters forKey:@"parameters"];
+    SQLResultSet *resultSet = nil;
+    _interrupted = NO;
+    SQLProfiler *profiler = _profiler;
+    CFAbsoluteTime start = profiler ? CFAbsoluteTimeGetCurrent() : 0;
+    NSUInteger cacheMisses = _statementCacheMisses;
+    SQLCachedStatement *cachedStatement = nil;
+    int rc = 0;
+    sqlite3_stmt *statement = [self prepareStatement:sql cachedStatement:&cachedStatement errorCode:&rc];
+    if (statement){
+        if (parameters) [self bindArguments: parameters toStatement:statement cachedStatement:cachedStatement queryInfo:queryInfo];
+        CFAbsoluteTime stepStart = profiler ? SQLBeginProfiling(statement) : 0;
+        CFAbsoluteTime hydrationDuration = 0;
+        //Column names are available before the first step, so even an empty result will have them
+        resultSet = [[SQLResultSet alloc] initWithColumnNames:[self columnNamesForStatement:statement]];
+        while ((rc = sqlite3_step(statement)) == SQLITE_ROW){
+            CFAbsoluteTime rowStart = profiler ? CFAbsoluteTimeGetCurrent() : 0;
+            [resultSet appendRowFromStatement:statement];
+            if (profiler) hydrationDuration += CFAbsoluteTimeGetCurrent() - rowStart;
+        }
+        _interrupted = (rc == SQLITE_INTERRUPT);
+        [resultSet finishLoading];
+        if (profiler) [self profileSQL:sql statement:statement parameterCount:parameters.count rowCount:resultSet.rowCount prepared:(_statementCacheMisses != cacheMisses) start:start stepStart:stepStart hydrationDuration:hydrationDuration];
+    } else {
+        _interrupted = (rc == SQLITE_INTERRUPT);
+        [self sqlError:[$(@"Failed to execute statement: '%@' with message: ", sql) stringByAppendingString:@"%S"] errorCode:rc critical:NO];
+    }
+    [self releaseStatement:statement cachedStatement:cachedStatement];
+    return resultSet;
+}
+- (SQLCursor *) cursorForQuery:(NSString *)sql withParameters:(NSArray *)parameters rowClass:(Class)rowClass{
+    /* Prepares and binds the statement, then hands it off to a cursor. The cursor is responsible for releasing the statement when it's closed. */
+    if (!sql.length) return nil;
+    NSMutableDictionary *queryInfo = [NSMutableDictionary dictionary];
+    [queryInfo setObject:sql forKey:@"sql"];
+    if (parameters) [queryInfo setObject:parameters forKey:@"parameters"];
+    SQLCachedStatement *cachedStatement = nil;
+    int rc = 0;
+    sqlite3_stmt *statement = [self prepareStatement:sql cachedStatement:&cachedStatement errorCode:&rc];
+    if (!statement){
+        [self sqlError:[$(@"Failed to execute statement: '%@' with message: ", sql) stringByAppendingString:@"%S"] errorCode:rc critical:NO];
+        return nil;
+    }
+    if (parameters) [self bindArguments: parameters toStatement:statement cachedStatement:cachedStatement queryInfo:queryInfo];
+    SQLCursor *cursor = [[SQLCursor alloc] initWithDatabase:self statement:statement cachedStatement:cachedStatement rowClass:rowClass];
+    [_openCursors addObject:cursor];
+    return cursor;
+}
 - (NSInteger) executeUpdate:(NSString *)sql{
     return [self executeUpdate:sql withParameters:nil];
 }
 - (NSInteger) executeUpdate:(NSString *)sql withParameters:(NSArray *)parameters{
     if (!sql.length) return -1;
+    _interrupted = NO;
     NSMutableDictionary *queryInfo = [NSMutableDictionary dictionary];
     [queryInfo setObject:sql forKey:@"sql"];
     if (parameters) [queryInfo setObject:parameters forKey:@"parameters"];
-    sqlite3_stmt *statement = nil;
-    int rc = sqlite3_prepare_v2(database, [sql UTF8String], -1, &statement, NULL);
-    if (rc == SQLITE_OK){
-        if (parameters) [self bindArguments:parameters toStatement:statement queryInfo:queryInfo];
+    SQLProfiler *profiler = _profiler;
+    CFAbsoluteTime start = profiler ? CFAbsoluteTimeGetCurrent() : 0;
+    NSUInteger cacheMisses = _statementCacheMisses;
+    SQLCachedStatement *cachedStatement = nil;
+    int rc = 0;
+    sqlite3_stmt *statement = [self prepareStatement:sql cachedStatement:&cachedStatement errorCode:&rc];
+    if (statement){
+        if (parameters) [self bindArguments:parameters toStatement:statement cachedStatement:cachedStatement queryInfo:queryInfo];
+        CFAbsoluteTime stepStart = profiler ? SQLBeginProfiling(statement) : 0;
         rc = sqlite3_step(statement);
         if (rc != SQLITE_DONE && rc != SQLITE_ROW){
-            sqlite3_finalize(statement);
+            [self releaseStatement:statement cachedStatement:cachedStatement];
+            //An interrupt was asked for, so it isn't an error
+            if ((_interrupted = (rc == SQLITE_INTERRUPT))) return -1;
             [self sqlError:$(@"SQL Update Error: %@", sql) errorCode:rc critical:YES];
             return -1;
         }
-        sqlite3_finalize(statement);
+        if (profiler) [self profileSQL:sql statement:statement parameterCount:parameters.count rowCount:(NSUInteger)sqlite3_changes(database) prepared:(_statementCacheMisses != cacheMisses) start:start stepStart:stepStart hydrationDuration:0];
+        [self releaseStatement:statement cachedStatement:cachedStatement];
         NSInteger rowid = (NSInteger)sqlite3_last_insert_rowid(database);
         return rowid;
     } else {
-        sqlite3_finalize(statement);
+        if ((_interrupted = (rc == SQLITE_INTERRUPT))) return -1;
         [self sqlError:$(@"SQL Update: %@", sql) errorCode:rc critical:YES];
         return -1;
     }
 }
+- (int) executeUpdateForResultCode:(NSString *)sql withParameters:(NSArray *)parameters{
+    /* Same as executeUpdate, except failures are returned instead of raised */
+    if (!sql.length) return SQLITE_MISUSE;
+    _interrupted = NO;
+    NSMutableDictionary *queryInfo = [NSMutableDictionary dictionary];
+    [queryInfo setObject:sql forKey:@"sql"];
+    if (parameters) [queryInfo setObject:parameters forKey:@"parameters"];
+    SQLProfiler *profiler = _profiler;
+    CFAbsoluteTime start = profiler ? CFAbsoluteTimeGetCurrent() : 0;
+    NSUInteger cacheMisses = _statementCacheMisses;
+    SQLCachedStatement *cachedStatement = nil;
+    int rc = 0;
+    sqlite3_stmt *statement = [self prepareStatement:sql cachedStatement:&cachedStatement errorCode:&rc];
+    _interrupted = (rc == SQLITE_INTERRUPT);
+    if (!statement) return rc;
+    if (parameters) [self bindArguments:parameters toStatement:statement cachedStatement:cachedStatement queryInfo:queryInfo];
+    CFAbsoluteTime stepStart = profiler ? SQLBeginProfiling(statement) : 0;
+    rc = sqlite3_step(statement);
+    _interrupted = (rc == SQLITE_INTERRUPT);
+    if (profiler && rc == SQLITE_DONE) [self profileSQL:sql statement:statement parameterCount:parameters.count rowCount:(NSUInteger)sqlite3_changes(database) prepared:(_statementCacheMisses != cacheMisses) start:start stepStart:stepStart hydrationDuration:0];
+    [self releaseStatement:statement cachedStatement:cachedStatement];
+    return rc;
+}
+- (NSUInteger) changes{
+    return (NSUInteger)sqlite3_changes(database);
+}
+- (NSUInteger) maximumParameterCount{
+    return (NSUInteger)sqlite3_limit(database, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+}
+- (BOOL) inTransaction{
+    return sqlite3_get_autocommit(database) == 0;
+}
+#pragma mark - Statement Cache
+- (sqlite3_stmt *) prepareStatement:(NSString *)sql cachedStatement:(SQLCachedStatement **)cachedStatement errorCode:(int *)errorCode{
+    /* Returns a prepared statement for the sql, reusing a cached statement if one is available.
+     - If the statement is cached (and not currently in use), it's moved to the end of the LRU order and returned
+     - Otherwise the statement is prepared and, if caching is enabled, added to the cache (evicting the least recently used statement if we're over the limit)
+     - Returns NULL on failure, with the sqlite error code set in errorCode
+     */
+    *cachedStatement = nil;
+    *errorCode = SQLITE_OK;
+    SQLCachedStatement *cached = _statementCache[sql];
+    if (cached && !cached.inUse){
+        _statementCacheHits++;
+        cached.inUse = YES;
+        [_statementCacheOrder removeObject:cached.sql];
+        [_statementCacheOrder addObject:cached.sql];
+        *cachedStatement = cached;
+        return cached.statement;
+    }
+    _statementCacheMisses++;
+    sqlite3_stmt *statement = NULL;
+    int rc = sqlite3_prepare_v2(database, [sql UTF8String], -1, &statement, NULL);
+    if (rc != SQLITE_OK){
+        sqlite3_finalize(statement);
+        *errorCode = rc;
+        return NULL;
+    }
+    //A statement already in use (ex: a nested query) is run uncached
+    if (_statementCacheSize > 0 && !cached){
+        NSString *key = [sql copy];
+        cached = [[SQLCachedStatement alloc] initWithSQL:key statement:statement];
+        cached.inUse = YES;
+        _statementCache[key] = cached;
+        [_statementCacheOrder addObject:key];
+        [self trimStatementCacheToSize:_statementCacheSize];
+        *cachedStatement = cached;
+    }
+    return statement;
+}
+- (void) releaseStatement:(sqlite3_stmt *)statement cachedStatement:(SQLCachedStatement *)cachedStatement{
+    /* Cached statements are reset and their bindings cleared so they can be reused. Anything else (uncached or evicted while in use) is finalized. */
+    if (!statement) return;
+    if (cachedStatement && _statementCache[cachedStatement.sql] == cachedStatement){
+        sqlite3_reset(statement);
+        sqlite3_clear_bindings(statement);
+        cachedStatement.inUse = NO;
+    } else if (cachedStatement){
+        //Evicted while in use: the cached object owns the statement and will finalize it when released.
+        cachedStatement.inUse = NO;
+    } else {
+        sqlite3_finalize(statement);
+    }
+}
+- (void) trimStatementCacheToSize:(NSUInteger)size{
+    /* Evicts least recently used statements (skipping any in use) until the cache fits the size */
+    NSUInteger index = 0;
+    while (_statementCacheOrder.count > size && index < _statementCacheOrder.count){
+        NSString *key = _statementCacheOrder[index];
+        SQLCachedStatement *cached = _statementCache[key];
+        if (cached.inUse){
+            index++;
+            continue;
+        }
+        [_statementCacheOrder removeObjectAtIndex:index];
+        [_statementCache removeObjectForKey:key];
+    }
+}
+- (void) setStatementCacheSize:(NSUInteger)statementCacheSize{
+    _statementCacheSize = statementCacheSize;
+    [self trimStatementCacheToSize:statementCacheSize];
+}
+- (void) clearStatementCache{
+    [_statementCacheOrder removeAllObjects];
+    [_statementCache removeAllObjects];
+        //The schema may have changed, so the GUID modes are read again
+    [_GUIDModes removeAllObjects];
+}
+- (NSUInteger) statementCacheCount{
+    return _statementCache.count;
+}
 #pragma mark - Argument Binding
-- (void) bindArguments:(NSArray *)arguments toStatement:(sqlite3_stmt *)statement queryInfo:(NSDictionary *)queryInfo{
+- (void) bindArguments:(NSArray *)arguments toStatement:(sqlite3_stmt *)statement cachedStatement:(SQLCachedStatement *)cachedStatement queryInfo:(NSDictionary *)queryInfo{
     /* This method binds arguments to the sql statement.  Takes an array of objects. And a pointer to the statement */
     int expectedArguments = sqlite3_bind_parameter_count(statement);
-        //The number of arguments must match the parameter count in the statement.
-    NSAssert(expectedArguments == [arguments count], @"Number of bound parameters does not match for sql: %@ \n Parameters: %@'", [queryInfo objectForKey:@"sql"], [queryInfo objectForKey:@"parameters"]);
+        //The number of arguments must match the parameter count in the statement. The statement is released first, so a cached statement isn't left in use.
+    if (expectedArguments != [arguments count]){
+        [self releaseStatement:statement cachedStatement:cachedStatement];
+        [NSException raise:NSInternalInconsistencyException format:@"Number of bound parameters does not match for sql: %@ \n Parameters: %@'", [queryInfo objectForKey:@"sql"], [queryInfo objectForKey:@"parameters"]];
+    }
     id argument;
         //Bind each argument to the statement depending on class type
     for (int i=1; i <= expectedArguments; i++){
@@ -198,7 +609,7 @@
         else if ([argument isKindOfClass:[NSNull class]])
             sqlite3_bind_null(statement, i);
         else {
-            sqlite3_finalize(statement);
+            [self releaseStatement:statement cachedStatement:cachedStatement];
             [NSException raise:@"Unrecognized object type" format:@"Active Record doesn't know how to handle object: '%@' bound to sql: %@ position: %i", argument, [queryInfo objectForKey:@"sql"], i];
         }
     }
@@ -242,11 +653,23 @@
 }
 #pragma mark -
 #pragma mark Value Copying
+- (id) rowFromStatement:(sqlite3_stmt *)statement rowClass:(Class)rowClass columnNames:(NSArray *)columnNames{
+    if (rowClass && ![rowClass isSubclassOfClass:[NSMutableDictionary class]]){
+        return [[SQLRowMapper mapperForClass:rowClass columnNames:columnNames] rowFromStatement:statement];
+    }
+    id row = [(rowClass ?: [NSMutableDictionary class]) new];
+    [self copyValuesFromStatement:statement toRow:row queryInfo:nil columnTypes:nil columnNames:columnNames];
+    return row;
+}
 - (void) copyValuesFromStatement:(sqlite3_stmt *)statement toRow:(id)row queryInfo:(NSDictionary *)queryInfo columnTypes:(NSArray *)columnTypes columnNames:(NSArray *)columnNames{
         // Copys values from a prepared statement that is being iterated through to a class type (row) by iterating through each column.  Depends on self method valueFromStatement to provide correct return data types given data column data types.
     int columnCount = sqlite3_column_count(statement);
     for (int i=0; i < columnCount; i++){
         id value = [self valueFromStatement:statement column:i queryInfo:queryInfo columnTypes:columnTypes];
+        //Binary GUIDs are always returned in their string form
+        if ([value isKindOfClass:[NSData class]] && [columnNames[i] isEqualToString:GUIDKey]){
+            value = [SQLGUID GUIDFromData:value] ?: value;
+        }
         if (value){
             if ([row isKindOfClass:[NSMutableDictionary class]]){
                 [row setValue:value forKey:columnNames[i]];
@@ -308,6 +731,118 @@
 - (void) rollback{
     [self executeQuery:@"ROLLBACK TRANSACTION;"];
 }
+- (BOOL) enableWriteAheadLogging{
+    return [[[self journalModeFromPragma:@"PRAGMA journal_mode = WAL;"] lowercaseString] isEqualToString:@"wal"];
+}
+- (NSString *) journalMode{
+    return [self journalModeFromPragma:@"PRAGMA journal_mode;"];
+}
+- (NSString *) journalModeFromPragma:(NSString *)pragma{
+    NSDictionary *result = [[self executeQuery:pragma] firstObject];
+    return [result[@"journal_mode"] description];
+}
+- (NSDictionary *) effectiveSettings{
+    NSMutableDictionary *settings = [NSMutableDictionary new];
+    for (NSString *pragma in @[@"cache_size", @"mmap_size", @"page_size", @"synchronous", @"temp_store", @"journal_mode", @"locking_mode", @"busy_timeout"]){
+        NSDictionary *result = [[self executeQuery:$(@"PRAGMA %@;", pragma)] firstObject];
+        //Pragmas that return a value return a single row with a single column. Some (like busy_timeout) name the column differently.
+        id value = result[pragma] ?: [result.allValues firstObject];
+        if (value) settings[pragma] = value;
+    }
+    return settings;
+}
+- (NSUInteger) userVersion{
+    return [[[[self executeQuery:@"PRAGMA user_version;"] firstObject] objectForKey:@"user_version"] unsignedIntegerValue];
+}
+- (void) setUserVersion:(NSUInteger)userVersion{
+    [self executeUpdate:$(@"PRAGMA user_version = %lu;", (unsigned long)userVersion)];
+}
+- (NSUInteger) schemaVersion{
+    return [[[[self executeQuery:@"PRAGMA schema_version;"] firstObject] objectForKey:@"schema_version"] unsignedIntegerValue];
+}
+- (SQLGUIDMode) GUIDModeForTable:(NSString *)tableName{
+    /* A table's mode is stored in the schema, as the declared type of it's GUID column: BLOB is binary, anything else is text.
+     - it's cached per table until the statement cache is cleared (which is done whenever the schema is changed through the database)
+     - a table that doesn't exist (or has no GUID column) isn't cached, and uses the mode set in SQLGUID
+     */
+    if (!tableName.length) return SQLGUIDModeText;
+    NSNumber *cached = _GUIDModes[tableName];
+    if (cached) return cached.unsignedIntegerValue;
+    for (NSDictionary *info in [self executeQuery:$(@"PRAGMA table_info(\"%@\");", tableName)]){
+        if (![info[@"name"] isEqualToString:GUIDKey]) continue;
+        SQLGUIDMode mode = [[info[@"type"] uppercaseString] isEqualToString:@"BLOB"] ? SQLGUIDModeBinary : SQLGUIDModeText;
+        _GUIDModes[tableName] = @(mode);
+        return mode;
+    }
+    return [SQLGUID modeForTable:tableName];
+}
+- (BOOL) migrateTable:(NSString *)tableName toGUIDMode:(SQLGUIDMode)mode{
+    /* Rebuilds the table with it's GUID column converted
+     - the table's create sql (from sqlite_master) is rewritten with the new GUID column type and a temporary name
+     - the rows are copied into the new table, converting each GUID with guid_blob() or guid_text()
+     - the old table is dropped, the new one renamed and the table's indexes & triggers are recreated
+     Everything is run in a savepoint so nothing is changed if a step fails.
+     */
+    if (_readOnly || !tableName.length) return NO;
+    NSString *createSQL = nil;
+    NSMutableArray *dependents = [NSMutableArray new];
+    for (NSDictionary *item in [self executeQuery:@"SELECT type, name, sql FROM sqlite_master WHERE tbl_name = ? AND sql IS NOT NULL;" withParameters:@[tableName]]){
+        if ([item[@"type"] isEqualToString:@"table"] && [item[@"name"] isEqualToString:tableName]){
+            createSQL = item[@"sql"];
+        } else if ([item[@"type"] isEqualToString:@"index"] || [item[@"type"] isEqualToString:@"trigger"]){
+            [dependents addObject:item[@"sql"]];
+        }
+    }
+    if (!createSQL) return NO;
+    
+    NSRegularExpression *GUIDColumn = [NSRegularExpression regularExpressionWithPattern:@"\"GUID\"\\s+\\w+(\\s*\\(\\s*\\d+\\s*\\))?\\s+PRIMARY KEY" options:NSRegularExpressionCaseInsensitive error:nil];
+    NSRange GUIDRange = [GUIDColumn rangeOfFirstMatchInString:createSQL options:0 range:NSMakeRange(0, createSQL.length)];
+    NSRange columnsRange = [createSQL rangeOfString:@"("];
+    if (GUIDRange.location == NSNotFound || columnsRange.location == NSNotFound) return NO;
+    NSString *temporaryName = $(@"%@_FlxGUIDMigration", tableName);
+    createSQL = [createSQL stringByReplacingCharactersInRange:GUIDRange withString:$(@"\"%@\" %@ PRIMARY KEY", GUIDKey, mode == SQLGUIDModeBinary ? @"BLOB" : @"VARCHAR(36)")];
+    createSQL = $(@"CREATE TABLE \"%@\" %@", temporaryName, [createSQL substringFromIndex:columnsRange.location]);
+    
+    NSMutableArray *columnNames = [NSMutableArray new];
+    NSMutableArray *selectColumns = [NSMutableArray new];
+    for (NSDictionary *info in [self executeQuery:$(@"PRAGMA table_info(\"%@\");", tableName)]){
+        NSString *column = $(@"\"%@\"", info[@"name"]);
+        [columnNames addObject:column];
+        if ([info[@"name"] isEqualToString:GUIDKey]){
+            [selectColumns addObject:$(@"%@(%@)", mode == SQLGUIDModeBinary ? @"guid_blob" : @"guid_text", column)];
+        } else {
+            [selectColumns addObject:column];
+        }
+    }
+    
+    NSMutableArray *statements = [NSMutableArray arrayWithObjects:
+                                  createSQL,
+                                  $(@"INSERT INTO \"%@\" (%@) SELECT %@ FROM \"%@\";", temporaryName, [columnNames componentsJoinedByString:@", "], [selectColumns componentsJoinedByString:@", "], tableName),
+                                  $(@"DROP TABLE \"%@\";", tableName),
+                                  $(@"ALTER TABLE \"%@\" RENAME TO \"%@\";", temporaryName, tableName),
+                                  nil];
+    [statements addObjectsFromArray:dependents];
+    
+    //Cached statements can reference the old table, and views referencing the table shouldn't be touched by the rename
+    [self clearStatementCache];
+    id legacyAlterTable = [[[self executeQuery:@"PRAGMA legacy_alter_table;"] firstObject] allValues].firstObject;
+    sqlite3_exec(database, "PRAGMA legacy_alter_table = ON;", NULL, NULL, NULL);
+    sqlite3_exec(database, "SAVEPOINT FlxGUIDMigration;", NULL, NULL, NULL);
+    BOOL success = YES;
+    for (NSString *sql in statements){
+        int rc = [self executeUpdateForResultCode:sql withParameters:nil];
+        if (rc != SQLITE_DONE){
+            [self sqlError:[$(@"Failed to migrate GUIDs with statement: '%@' with message: ", sql) stringByAppendingString:@"%S"] errorCode:rc critical:NO];
+            success = NO;
+            break;
+        }
+    }
+    if (!success) sqlite3_exec(database, "ROLLBACK TO SAVEPOINT FlxGUIDMigration;", NULL, NULL, NULL);
+    sqlite3_exec(database, "RELEASE SAVEPOINT FlxGUIDMigration;", NULL, NULL, NULL);
+    if (![legacyAlterTable boolValue]) sqlite3_exec(database, "PRAGMA legacy_alter_table = OFF;", NULL, NULL, NULL);
+    [self clearStatementCache];
+    return success;
+}
 - (NSString *) dbVersion{
     return [NSString stringWithUTF8String:sqlite3_libversion()];
 }
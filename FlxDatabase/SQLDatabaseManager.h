@@ -9,16 +9,101 @@
 #import <Foundation/Foundation.h>
 #import "SQLStatementProtocol.h"
 #import "SQLDatabase.h"
+#import "SQLQueryCache.h"
+#import "SQLIndexAdvisor.h"
+#import "SQLSchema.h"
 
 #define DatabaseName @"database.db"
 
 @class SQLStatement;
 @class SQLUpdateQueue;
 @class SQLQueryQueue;
+@class SQLBulkResult;
+@class SQLWriteMetrics;
+@class SQLSubscription;
+@class SQLOperation;
 
 typedef void (^QueueBlock) (NSArray *results);
+typedef void (^ResultSetBlock) (SQLResultSet *results);
 typedef void (^ExecBlock) (NSInteger result);
 typedef void (^CompletionBlock) (void);
+typedef BOOL (^StreamBlock) (NSArray *rows);
+typedef void (^BulkBlock) (SQLBulkResult *result);
+typedef void (^SyncBlock) (BOOL success);
+typedef BOOL (^MigrationBlock) (SQLDatabase *database);
+
+/**
+ *  The error domain of a SQLOperation's `error`.
+ */
+extern NSString *const SQLDatabaseErrorDomain;
+
+/**
+ *  The codes of errors in the SQLDatabaseErrorDomain.
+ */
+typedef NS_ENUM(NSInteger, SQLDatabaseError) {
+    /**
+     *  The operation was cancelled.
+     */
+    SQLDatabaseErrorCancelled = 1,
+    /**
+     *  The operation ran past one of it's deadlines (see SQLQueryQueue's & SQLUpdateQueue's `timeout` and `statementTimeout`).
+     */
+    SQLDatabaseErrorTimedOut = 2
+};
+
+/**
+ *  Besides the row id of the last insert, an update block (ExecBlock) can receive one of these.
+ */
+typedef NS_ENUM(NSInteger, SQLUpdateResult) {
+    /**
+     *  The update failed.
+     */
+    SQLUpdateResultFailed = -1,
+    /**
+     *  The update's operation was cancelled, so it wasn't run (or was rolled back).
+     */
+    SQLUpdateResultCancelled = -2,
+    /**
+     *  The update's operation ran past a deadline, so it wasn't run (or was rolled back).
+     */
+    SQLUpdateResultTimedOut = -3
+};
+
+/**
+ *  How the queries in a SQLQueryQueue are run.
+ */
+typedef NS_ENUM(NSUInteger, SQLQueryExecution) {
+    /**
+     *  The queries are run one after another, in order, in a single read transaction. This is the default.
+     */
+    SQLQueryExecutionSerial,
+    /**
+     *  The queries are spread across the reader pool and run concurrently, each reader in it's own read transaction. Queries can see different commits if updates are committed while they run.
+     */
+    SQLQueryExecutionParallel,
+    /**
+     *  Same as SQLQueryExecutionParallel, except every reader starts reading from the same commit, so all the queries see the same snapshot of the database (as if they'd been run in a single transaction).
+     */
+    SQLQueryExecutionSnapshot
+};
+
+/**
+ *  The lane work is scheduled in on the database queue (and the reader pool). Waiting work in a higher lane always runs first, unless lower work has waited long enough to be aged past it (see `priorityAgingInterval`).
+ */
+typedef NS_ENUM(NSUInteger, SQLPriority) {
+    /**
+     *  Work that can wait: syncing, prefetching, maintenance. Large update queues in this lane are committed in chunks so they yield to other work (see `backgroundChunkSize`).
+     */
+    SQLPriorityBackground = 0,
+    /**
+     *  Everything that doesn't choose a priority. This is the default.
+     */
+    SQLPriorityDefault = 1,
+    /**
+     *  Work a user is waiting on.
+     */
+    SQLPriorityInteractive = 2
+};
 
 @interface SQLDatabaseManager : NSObject <NSCopying>
 /**
@@ -46,6 +131,16 @@ typedef void (^CompletionBlock) (void);
  *  @return SQLDatabaseManager
  */
 - (id) initWithFilePath:(NSString *)path;
+/**
+ *  Initializes a SQLDatabaseManager and opens the database at the file provided by the path using the provided connection options. The same options are used for the read-only connections created by `enableConcurrentReadsWithReaderCount:`.
+ *  @warning Only one SQLDatabaseManager can be initialized per file. If a manager already exists for the file, it's returned and the options are ignored.
+ *
+ *  @param path    Full file path to the database file.
+ *  @param options The connection options (cache size, journal mode, etc). If `nil`, `[SQLDatabaseOptions defaultOptions]` is used.
+ *
+ *  @return SQLDatabaseManager
+ */
+- (id) initWithFilePath:(NSString *)path options:(SQLDatabaseOptions *)options;
 /**
  *  Opens the database is if is not already open. The database is automatically opened on class initialization.
  */
@@ -55,82 +150,365 @@ typedef void (^CompletionBlock) (void);
  */
 - (void) closeDatabase;
 /**
- *  This will queue an update to be processed at the end of the current run loop.
+ *  Returns YES if queries are being processed concurrently by a pool of read-only connections.
+ *  @see enableConcurrentReadsWithReaderCount:
+ */
+@property (readonly) BOOL concurrentReadsEnabled;
+/**
+ *  The number of read-only connections in the reader pool (0 if concurrent reads aren't enabled).
+ */
+@property (readonly) NSUInteger readerCount;
+/**
+ *  This will switch the database to write-ahead logging (WAL) and open a pool of read-only connections to process queries. Updates continue to be processed, in order, by a single writer connection on the database queue. Queries (`queueQuery:`, `runQueryQueue:`, `runImmediateQuery:`, `runSynchronousQuery:`, etc) are instead processed by the reader pool, so queries can run in parallel with each other and with updates.
+ *
+ *  *A note about ordering*
+ *  Query queues are started in the order they're submitted, but they can finish in any order and they no longer wait for pending updates. An asynchronous query submitted after an asynchronous update may run *before* that update is committed. If you need to read your own writes, submit the query from the update's completion block or use `runSynchronousUpdate:` first. Synchronous queries run immediately on the calling thread using a free reader (waiting for one if they're all busy), so they can run ahead of asynchronous queries that were submitted earlier. Updates are still processed strictly in order.
+ *
+ *  WAL mode is persistent: it stays with the database file, even after the manager is closed. This should be called once, right after the manager is initialized.
+ *
+ *  @param readerCount The number of read-only connections to open. Generally, this should be about the number of cores available.
+ *
+ *  @return YES if concurrent reads were enabled. NO if the database isn't open, concurrent reads are already enabled, the reader count is 0 or the database couldn't be switched to WAL mode.
+ */
+- (BOOL) enableConcurrentReadsWithReaderCount:(NSUInteger)readerCount;
+/**
+ *  ### Callbacks
+ *
+ *  The queue result, completion, subscription & stream blocks are run on, unless a submission chooses it's own (the `onQueue:` methods, or SQLQueryQueue's & SQLUpdateQueue's `callbackQueue`). Blocks are always dispatched asynchronously, so the manager never waits on this queue. With a concurrent queue, result blocks can run in any order, but a queue's completion block still runs after all of it's results.
+ *
+ *  Batching doesn't depend on this queue (or any run loop): queued queries & updates are collected on the manager's own schedule queue and sent to the database as soon as it's free, so a busy main thread doesn't hold up anything but the blocks dispatched to it.
+ *
+ *  This should be set once, right after the manager is initialized. Setting `NULL` restores the default.
+ *  Default: the main queue
+ */
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+/**
+ *  ### Priorities
+ *
+ *  Work isn't run strictly in the order it's submitted. Queries & updates are put in a lane by priority (see SQLPriority) and the database queue always runs the next piece of work from the highest lane that's waiting, so an interactive query doesn't wait behind a long background sync. The reader pool hands out readers the same way. Work in the same lane runs in the order it was submitted.
+ *
+ *  Statements submitted one at a time (`queueQuery:`, `runImmediateUpdate:`, `runSynchronousQuery:`, etc) use the priority of the enclosing `performWithPriority:block:` (`SQLPriorityDefault` outside of one). Query & update queues use their own `priority`. Bulk inserts & schema syncs also use the enclosing priority.
+ *  @warning Updates in different lanes can be committed out of order: an interactive update submitted after a background one can be committed first. Keep updates that depend on each other in the same lane (or the same update queue).
+ *
+ *  Submits the statements from the block with the priority provided. Calls made inside the block (on the same thread) use the priority; nested calls override it until they return.
+ *
+ *  @param priority The priority to submit the work with.
+ *  @param block    The block that submits the work. It's run immediately, on the calling thread.
+ */
+- (void) performWithPriority:(SQLPriority)priority block:(CompletionBlock)block;
+/**
+ *  Waiting work is aged: every time it's waited this long (in seconds), it's treated as being one lane higher. This keeps a steady stream of higher priority work from starving background work. Set to 0 to disable aging.
+ *  Default: 0.5
+ */
+@property NSTimeInterval priorityAgingInterval;
+/**
+ *  Background update queues (without `rollbackOnFail`) with more statements than this are committed in chunks of this many statements, each in it's own transaction, and higher priority work can run between the chunks. Background batches of queued updates are capped at this size too. The queue's completion block is run after the last chunk. Update queues with `rollbackOnFail` are never split. Set to 0 to never split them.
+ *  Default: 256
+ */
+@property NSUInteger backgroundChunkSize;
+/**
+ *  ### Cancellation & Deadlines
+ *
+ *  The asynchronous methods return a SQLOperation for the statements submitted, which can be cancelled. Cancelled work that's still waiting isn't run, and work that's running is interrupted (`sqlite3_interrupt`). Deadlines are checked before each statement and, while it runs, with sqlite's progress handler.
+ *
+ *  Every block of a stopped operation is still called, so it can tell: query blocks receive `nil` (check the operation's `error`), update blocks receive `SQLUpdateResultCancelled` or `SQLUpdateResultTimedOut` and an update queue's completion receives NO.
+ *  @warning sqlite rolls back the whole transaction when an update is interrupted, so the rest of it's batch is run again without it (and committed as usual).
+ *
+ *  The maximum time (in seconds) a single statement can run before it's interrupted, for statements submitted without a queue and queues without their own `statementTimeout`. Set to 0 for no limit.
+ *  Default: 0
+ */
+@property NSTimeInterval statementTimeout;
+/**
+ *  ### Write Scheduling
+ *
+ *  Updates aren't committed one at a time. Pending updates from `queueUpdate:`, `queueUpdates:`, `runImmediateUpdate:` and `runUpdateQueue:withCompletionBlock:` are grouped into batches, and each batch is committed in a single transaction. Update queues are never split between batches and a queue with `rollbackOnFail` is run inside a savepoint, so if one of it's updates fails only that queue is rolled back; the rest of the batch is still committed.
+ *
+ *  The maximum time (in seconds) a queued update will wait to be batched with other updates. If 0 (the default), queued updates are flushed as soon as the manager's schedule queue is free, along with any other updates queued in the meantime. Larger values trade latency for fewer, larger transactions. Immediate updates never wait.
+ */
+@property NSTimeInterval writeLatency;
+/**
+ *  The maximum number of updates committed in a single transaction. When this many updates are pending, they're processed right away instead of waiting for the write latency. A single update queue larger than this is still committed as one batch. Default: 0 (no limit).
+ */
+@property NSUInteger maxWriteBatchSize;
+/**
+ *  Returns a snapshot of the write batching metrics (batch sizes & commit durations) since the manager was created or the metrics were last reset.
+ */
+@property (readonly) SQLWriteMetrics *writeMetrics;
+/**
+ *  Resets the write metrics.
+ */
+- (void) resetWriteMetrics;
+/**
+ *  ### Query Cache
+ *
+ *  Returns YES if query results are being cached.
+ *  @see enableQueryCacheWithByteLimit:
+ */
+@property (readonly) BOOL queryCacheEnabled;
+/**
+ *  This will cache the results of queries (keyed by the query's sql, parameters and row class) so repeated queries are returned without going to the database. Results are only cached for statements that have a `tableName` (ex: SQLStatement); raw sql strings aren't cached.
+ *
+ *  Cached results are invalidated whenever an update, insert, delete, drop or alter is committed against the statement's table (including bulk inserts & migrations). Updates made with a raw sql string clear the whole cache, since the tables they changed aren't known. Changes made to the database outside of this manager aren't seen, so don't enable the cache if something else writes to the database.
+ *
+ *  Dictionary rows are copied for each caller, so they can still be modified. Custom row objects (`usingRowClass:`) are copied if they conform to NSCopying; otherwise the same objects are returned to every caller.
+ *
+ *  This should be called once, right after the manager is initialized.
+ *
+ *  @param byteLimit The maximum (estimated) number of bytes of results to keep in memory. The least recently used results are evicted first.
+ */
+- (void) enableQueryCacheWithByteLimit:(NSUInteger)byteLimit;
+/**
+ *  Returns a snapshot of the query cache metrics (hit rate, evictions, byte size, etc) or `nil` if the cache isn't enabled.
+ */
+@property (readonly) SQLQueryCacheMetrics *queryCacheMetrics;
+/**
+ *  Resets the query cache metrics.
+ */
+- (void) resetQueryCacheMetrics;
+/**
+ *  Removes all results from the query cache.
+ */
+- (void) clearQueryCache;
+/**
+ *  ### Profiling
+ *
+ *  Setting a profiler profiles every statement executed by the manager, on the writer and all of the readers (see SQLProfiler). Executions also record how long the statement waited between being queued (`queueUpdate:`, `queueQuery:`, etc) and being executed.
+ *
+ *  Set to `nil` to stop profiling. Default: `nil`
+ */
+@property (nonatomic, strong) SQLProfiler *profiler;
+/**
+ *  ### Index Advice
+ *
+ *  Setting an index advisor records the shape of every SQLStatement query the manager runs (see SQLIndexAdvisor). Use `adviseIndexesWithBlock:` to find out which of them scan their table or sort, and the indexes that would help.
+ *
+ *  Set to `nil` to stop observing queries. Default: `nil`
+ */
+@property (nonatomic, strong) SQLIndexAdvisor *indexAdvisor;
+/**
+ *  Runs `EXPLAIN QUERY PLAN` on the queries observed by the `indexAdvisor` and passes the advice (NSArray of SQLIndexAdvice) to the block on the callback queue. If the advisor `createsIndexes`, the proposed indexes are created first. Pending writes are flushed before the queries are explained.
+ *
+ *  @param block The block to receive the advice. If there isn't an index advisor, the block receives an empty array.
+ */
+- (void) adviseIndexesWithBlock:(void (^)(NSArray *advice))block;
+/**
+ *  ### Subscriptions
+ *
+ *  Subscribes to a query: the block is called with the query's results right away and again whenever a commit may have changed them, until the subscription is cancelled. Blocks are called on the callback queue.
+ *
+ *  Changes are detected with sqlite's update & commit hooks on the writer connection, so they're only seen if they're made through this manager. A commit only refreshes the subscriptions for the tables it changed. If the columns updated are known (the updates were made with SQLStatements) and the query doesn't reference any of them, the subscription isn't refreshed. Changes are coalesced per commit, and if more commits come in while a subscription is refreshing, they're all picked up by the next refresh.
+ *
+ *  Subscriptions with dictionary rows that select the GUID (or `*`) and don't use an order, grouping, aggregate, distinct or limit are refreshed incrementally: only the inserted & updated rows are queried and merged into the previous results (and the block isn't called if the results didn't actually change). Anything else, or any commit that deletes rows or changes the schema, runs the whole query again.
+ *  @warning sqlite doesn't report rows replaced by an `ON CONFLICT REPLACE` on a column other than the GUID, so an incremental subscription can miss those.
+ *
+ *  @param statement The query to subscribe to. The statement is copied, so changing it afterward doesn't affect the subscription.
+ *  @param block     The block to call with the results.
+ *
+ *  @return The subscription (keep it to cancel it) or `nil` if the database is closed or the statement isn't a query.
+ */
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement withBlock:(QueueBlock)block;
+/**
+ *  Subscribes to a query, returning rows of the class provided.
+ *  @see subscribeToQuery:withBlock:
+ *
+ *  @param statement The query to subscribe to.
+ *  @param rowClass  The class to use for each row (see SQLDatabase's `executeQuery:withParameters:withClassForRow:`). Subscriptions with a custom row class are always refreshed by running the whole query.
+ *  @param block     The block to call with the results.
+ *
+ *  @return The subscription or `nil` if the database is closed or the statement isn't a query.
+ */
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)block;
+/**
+ *  Subscribes to a query, calling the block on the queue provided.
+ *  @see subscribeToQuery:usingRowClass:withBlock:
+ *
+ *  @param statement     The query to subscribe to.
+ *  @param rowClass      The class to use for each row, or nil for dictionaries.
+ *  @param callbackQueue The queue the block is called on. If NULL, the manager's callback queue is used.
+ *  @param block         The block to call with the results.
+ *
+ *  @return The subscription or `nil` if the database is closed or the statement isn't a query.
+ */
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement usingRowClass:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)block;
+/**
+ *  This will queue an update to be processed with the next batch (or after the `writeLatency`), batched with any other pending updates.
+ *
+ *  @param statement      On object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param blockToProcess **optional** block to process on completion.
+ *
+ *  @return An operation that can cancel the update, or nil if nothing was submitted.
+ */
+- (SQLOperation *) queueUpdate:(id <SQLStatementProtocol>)statement withBlock:(ExecBlock)blockToProcess;
+/**
+ *  This will queue an update, running the block on the queue provided instead of the manager's `callbackQueue`.
+ *  @see queueUpdate:withBlock:
  *
  *  @param statement      On object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param callbackQueue  The queue to run the block on. If `NULL`, the manager's `callbackQueue` is used.
  *  @param blockToProcess **optional** block to process on completion.
+ *
+ *  @return An operation that can cancel the update, or nil if nothing was submitted.
  */
-- (void) queueUpdate:(id <SQLStatementProtocol>)statement withBlock:(ExecBlock)blockToProcess;
+- (SQLOperation *) queueUpdate:(id <SQLStatementProtocol>)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(ExecBlock)blockToProcess;
 /**
- *  This will queue a query to be processed at the end of the current run loop and process the results on the main thread using the supplied block.
+ *  This will queue a query to be processed with the next batch and process the results on the callback queue using the supplied block.
  *
  *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
- *  @param blockToProcess The block to process the query. The block will be run on the main thread. If this block is not present, the query will not be run since the results can't be returned.
+ *  @param blockToProcess The block to process the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
  */
-- (void) queueQuery:(id <SQLStatementProtocol>)statement withBlock:(QueueBlock)blockToProcess;
+- (SQLOperation *) queueQuery:(id <SQLStatementProtocol>)statement withBlock:(QueueBlock)blockToProcess;
 /**
- *  This will queue a query to be processed at the end of the current run loop
+ *  This will queue a query to be processed with the next batch
  *
  *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
  *  @param rowClass       Normally, a query will return an array of NSMutableDictionary items. If you specify a row class, the query will return an array of that class type.  Make sure the row class responds to keypaths that are the columns in the query, or else an exception will be thrown.
- *  @param blockToProcess The block to process the query. The block will be run on the main thread. If this block is not present, the query will not be run since the results can't be returned.
+ *  @param blockToProcess The block to process the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
+ */
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass withBlock:(QueueBlock)blockToProcess;
+/**
+ *  This will queue a query, running the block on the queue provided instead of the manager's `callbackQueue`.
+ *  @see queueQuery:usingClassForRow:withBlock:
+ *
+ *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param rowClass       The class to use for rows. If nil, NSMutableDictionary will be used.
+ *  @param callbackQueue  The queue to run the block on. If `NULL`, the manager's `callbackQueue` is used.
+ *  @param blockToProcess The block to process the query. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
  */
-- (void) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass withBlock:(QueueBlock)blockToProcess;
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)blockToProcess;
 /**
- *  This will queue the queries in the provided queue to run at the end of the current run loop.  The queue you submit will be emptied of it's statements.
+ *  This will queue a query to be processed with the next batch, returning the results as a SQLResultSet instead of an array of rows. This is much lighter on memory for large queries.
+ *
+ *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param blockToProcess The block to process the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
+ */
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)blockToProcess;
+/**
+ *  This will queue the queries in the provided queue to run with the next batch.  The queue you submit will be emptied of it's statements. If the queue uses parallel execution (or delivers it's results together), it's run on it's own instead of with the other queued queries.
  *
  *  @param queue The queue of queries you wish to add.
+ *
+ *  @return An operation that can cancel the queries, or nil if nothing was submitted.
  */
-- (void) queueQueries:(SQLQueryQueue *)queue;
+- (SQLOperation *) queueQueries:(SQLQueryQueue *)queue;
 /**
- *  This will queue the updates in the provided queue to run at the end of the current run loop.  The queue you submit will be emptied of it's statements.
+ *  This will queue the updates in the provided queue to run with the next batch (or after the `writeLatency`).  The queue you submit will be emptied of it's statements. The updates are kept together, so the queue's `rollbackOnFail` still applies to them even though they're batched with other updates.
  *
  *  @param queue The queue of updates you wish to add.
+ *
+ *  @return An operation that can cancel the updates, or nil if nothing was submitted.
  */
-- (void) queueUpdates:(SQLUpdateQueue *)queue;
+- (SQLOperation *) queueUpdates:(SQLUpdateQueue *)queue;
 /**
- *  This will run the update 'immediately' (as possible) but not synchronously.  Note: any pending updates currently being processed will finished before this is run.
+ *  This will run the update 'immediately' (as possible) but not synchronously.  Note: any pending updates currently being processed will finished before this is run, and any updates still waiting to be processed will be committed with this one.
  *
  *  @param statement      On object that conforms to the SQLStatementProtocol (usually SQLStatement)
  *  @param blockToProcess **optional** block to process on completion.
+ *
+ *  @return An operation that can cancel the update, or nil if nothing was submitted.
+ */
+- (SQLOperation *) runImmediateUpdate:(id <SQLStatementProtocol>)statement withBlock:(ExecBlock)blockToProcess;
+/**
+ *  This will run the update 'immediately' (as possible), running the block on the queue provided instead of the manager's `callbackQueue`.
+ *  @see runImmediateUpdate:withBlock:
+ *
+ *  @param statement      On object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param callbackQueue  The queue to run the block on. If `NULL`, the manager's `callbackQueue` is used.
+ *  @param blockToProcess **optional** block to process on completion.
+ *
+ *  @return An operation that can cancel the update, or nil if nothing was submitted.
  */
-- (void) runImmediateUpdate:(id <SQLStatementProtocol>)statement withBlock:(ExecBlock)blockToProcess;
+- (SQLOperation *) runImmediateUpdate:(id <SQLStatementProtocol>)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(ExecBlock)blockToProcess;
 /**
  *  This will run the update 'immediately' (as possible) but not synchronously.  Note: any pending updates currently being processed will finished before this is run.
  *
  *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
- *  @param blockToProcess The block to process the query.  The block will be passed an array of NSMutableDictionary items that correspond to the rows returned from the query. The block will be run on the main thread. If this block is not present, the query will not be run since the results can't be returned.
+ *  @param blockToProcess The block to process the query.  The block will be passed an array of NSMutableDictionary items that correspond to the rows returned from the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
  */
-- (void) runImmediateQuery:(id <SQLStatementProtocol>)statement withBlock:(QueueBlock)blockToProcess;
+- (SQLOperation *) runImmediateQuery:(id <SQLStatementProtocol>)statement withBlock:(QueueBlock)blockToProcess;
 /**
  *  This will run the update 'immediately' (as possible) but not synchronously.  Note: any pending updates currently being processed will finished before this is run.
  *
  *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
  *  @param rowClass       The Class you wish to use for rows.  If nil, NSMutableDictionary will be used. The class must have keypaths that correspond to the columns in the statement or else an exception will be thrown.
- *  @param blockToProcess The block to process the query.  The block will be passed an array of rowClass items that correspond to the rows returned from the query. The block will be run on the main thread. If this block is not present, the query will not be run since the results can't be returned.
+ *  @param blockToProcess The block to process the query.  The block will be passed an array of rowClass items that correspond to the rows returned from the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
+ */
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)blockToProcess;
+/**
+ *  This will run the query 'immediately' (as possible), running the block on the queue provided instead of the manager's `callbackQueue`.
+ *  @see runImmediateQuery:usingRowClass:withBlock:
+ *
+ *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param rowClass       The Class you wish to use for rows.  If nil, NSMutableDictionary will be used.
+ *  @param callbackQueue  The queue to run the block on. If `NULL`, the manager's `callbackQueue` is used.
+ *  @param blockToProcess The block to process the query. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
+ */
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)blockToProcess;
+/**
+ *  This will run the query 'immediately' (as possible) but not synchronously, returning the results as a SQLResultSet.
+ *
+ *  @param statement      An object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param blockToProcess The block to process the query. The block will be run on the callback queue. If this block is not present, the query will not be run since the results can't be returned.
+ *
+ *  @return An operation that can cancel the query, or nil if nothing was submitted.
  */
-- (void) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)blockToProcess;
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)blockToProcess;
+/**
+ *  Streams the results of a query in batches instead of loading them all at once, so memory stays constant no matter how many rows the query returns. Rows are read lazily with a SQLCursor and each batch is passed to the block on the callback queue.
+ *
+ *  Backpressure: at most two batches are waiting on the callback queue at any time. If the block is slow, the query stops reading rows until it catches up. The stream never blocks a queue waiting on the block: it's read one batch at a time and the next batch is only scheduled once there's room.
+ *
+ *  With concurrent reads enabled, the stream is read on a reader (which it keeps until it finishes), in one read transaction. Otherwise each batch is read on the database queue in turn with other queries & updates, so it doesn't hold them up, but rows written while the stream is running may or may not be included.
+ *
+ *  @param statement  An object that conforms to the SQLStatementProtocol (usually SQLStatement)
+ *  @param rowClass   The Class you wish to use for rows.  If nil, NSMutableDictionary will be used.
+ *  @param batchSize  The maximum number of rows passed to each call of the batch block.
+ *  @param batchBlock The block to process each batch. Return NO to stop the stream early (the statement is released immediately and no more batches will be sent). Required.
+ *  @param completion **optional** Run on the callback queue after the last batch. `finished` is NO if the stream was stopped early.
+ */
+- (void) streamQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass batchSize:(NSUInteger)batchSize withBatchBlock:(StreamBlock)batchBlock completion:(void (^)(BOOL finished))completion;
 /**
  *  This will process the query queue immediately (as possible) after any currently processing queues are finished.  The queue will be emptied of it's statements.
  *  @see runQueryQueue:withCompletionBlock:
  *
  *  @param queue The queue of queries you with to process.
+ *
+ *  @return An operation that can cancel the queries, or nil if nothing was submitted.
  */
-- (void) runQueryQueue:(SQLQueryQueue *)queue;
+- (SQLOperation *) runQueryQueue:(SQLQueryQueue *)queue;
 /**
  *  This will process the query queue immediately (as possible) after any currently processing queues are finished.  The queue will be emptied of it's statements.
  *
+ *  With a parallel `execution` (and a reader pool), the queries are run concurrently so the queue takes about as long as it's slowest query rather than the total of all of them. Each query's block is still run on the callback queue as it finishes.
+ *
  *  @param queue The queue of queries you with to process.
- *  @param block **optional** Completion block to be run when finished processing.
+ *  @param block **optional** Completion block to be run (on the callback queue) when all the queries have finished and their blocks have been run.
+ *
+ *  @return An operation that can cancel the queries, or nil if nothing was submitted.
  */
-- (void) runQueryQueue:(SQLQueryQueue *)queue withCompletionBlock:(CompletionBlock)block;
+- (SQLOperation *) runQueryQueue:(SQLQueryQueue *)queue withCompletionBlock:(CompletionBlock)block;
 /**
- *  This will process the update queue immediately (as possbile) after any currently processing queues are finished.  The queue will be emptied of it's statements.
+ *  This will process the update queue immediately (as possbile) after any currently processing queues are finished.  The queue will be emptied of it's statements. Any updates waiting to be processed are committed in the same transaction, but a `rollbackOnFail` queue will only roll back it's own updates.
  *
  *  @param queue          The update queue you wish to process.
- *  @param blockToProcess **optional** A completion block to be processed after all the updates have been run. If the block returns YES, then all updates were processed.  If the block returns no, then no updates were processed (or the updates were rolled back).  Just because this returns YES doesn't mean all updates were successfull.
+ *  @param blockToProcess **optional** A completion block to be processed after all the updates have been run. If the block returns YES, then all updates were processed.  If the block returns no, then no updates were processed (or the updates were rolled back, or the queue was cancelled or timed out).  Just because this returns YES doesn't mean all updates were successfull. It's run on the queue's callback queue (or the manager's) after all the update blocks.
+ *
+ *  @return An operation that can cancel the updates, or nil if nothing was submitted.
  */
-- (void) runUpdateQueue:(SQLUpdateQueue *)queue withCompletionBlock:(void (^)(BOOL success))blockToProcess;
+- (SQLOperation *) runUpdateQueue:(SQLUpdateQueue *)queue withCompletionBlock:(void (^)(BOOL success))blockToProcess;
 /**
  *  This will synchronously run an update.  However, the update is still processed on a dedicated background queue, so whatever thread you call this from will be locked until the processing is complete.  Any current queues processing will be completed *before* this statement is processed.  This means you may be waiting not only for this statment to process, but also for other pending statement to process if there are any.
  *
@@ -165,6 +543,14 @@ typedef void (^CompletionBlock) (void);
  *  @return An array of rowClass items representing the query row data.
  */
 - (NSArray *) runSynchronousQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass;
+/**
+ *  This will synchronously run a query, returning the results as a SQLResultSet. The same caveats as `runSynchronousQuery:` apply.
+ *
+ *  @param statement The statement you wish to process synchronously.
+ *
+ *  @return A SQLResultSet with the query row data.
+ */
+- (SQLResultSet *) runSynchronousResultSetQuery:(id<SQLStatementProtocol>)statement;
 /**
  *  This will synchronously run the upates in the queue. However, the updates are still processed on a dedicated background queue, so whatever thread you call this from will be locked until the processing is complete.  Any current queues processing will be completed *before* these statement are processed.  This means you may be waiting not only for this statment to process, but also for other pending statement to process if there are any.
  *
@@ -177,22 +563,123 @@ typedef void (^CompletionBlock) (void);
  */
 - (NSArray *) runSynchronousUpdateQueue:(SQLUpdateQueue *)updates;
 /**
- *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table. If the table doesn't exist, this will create a new table with the column in the statement.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion.
-   This is a synchronous version of the call.
+ *  ### Bulk Inserts
+ *
+ *  Inserts a large number of rows using a statement as a template, without creating a statement per row. Rows are inserted in a single transaction using multi-row inserts (`INSERT ... VALUES (...), (...)`) sized to fit sqlite's parameter limit. The statement text is the same for every full chunk, so it's prepared once and reused.
+ *
+ *  The template's `conflict` is honored. With `SQLConflictReplace`, `SQLConflictIgnore` or `SQLConflictAbort`, a chunk that fails is retried a row at a time so only the rows that actually failed are reported. With `SQLConflictFail` and `SQLConflictRollback` rows are always inserted one at a time (a multi-row insert could be partially applied); a `SQLConflictRollback` failure rolls back the entire bulk insert. Since that would also roll back a transaction the database was already in, a `SQLConflictRollback` insert is refused (every row fails) if the database is in a transaction when it's run.
+ *
+ *  Each row can be:
+ *  - An NSArray of values in the same order as the template's `bulkInsertColumnNames`. Use NSNull for NULL.
+ *  - An NSDictionary keyed by column name. A GUID can be provided using the `GUIDKey`.
+ *  - Any object that responds to the column names as keys. If the object has a GUID property that's nil, it will be set to the GUID used for the row.
+ *
+ *  A GUID is generated for any row that doesn't provide one and every row gets the same created/modified date.
+ *  @warning Rows are read on the database queue, so don't modify them until the block is called.
+ *
+ *  @param rows      The rows to insert.
+ *  @param statement An insert (or upsert) statement to use as the template. Only it's table name, columns, conflict & upsert properties are used.
+ *  @param block     **optional** Run on the callback queue with the results.
+ */
+- (void) bulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement withBlock:(BulkBlock)block;
+/**
+ *  Bulk inserts rows, calling the block on the queue provided.
+ *  @see bulkInsertRows:usingStatement:withBlock:
+ *
+ *  @param rows          The rows to insert.
+ *  @param statement     An insert (or upsert) statement to use as the template.
+ *  @param callbackQueue The queue the block is run on. If NULL, the manager's callback queue is used.
+ *  @param block         **optional** Run with the results.
+ */
+- (void) bulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(BulkBlock)block;
+/**
+ *  Bulk inserts objects using a protocol to define the table & columns (the same as `SQLStatementConstructor`). The protocol name is used as the table name.
+ *  @see bulkInsertRows:usingStatement:withBlock:
+ *
+ *  @param objects The objects to insert.
+ *  @param proto   The protocol that defines the table's columns.
+ *  @param block   **optional** Run on the callback queue with the results.
+ */
+- (void) bulkInsertObjects:(NSArray *)objects usingProtocol:(Protocol *)proto withBlock:(BulkBlock)block;
+/**
+ *  Synchronous version of `bulkInsertRows:usingStatement:withBlock:`. The same caveats as the other synchronous methods apply.
+ *
+ *  @return The results of the insert.
+ */
+- (SQLBulkResult *) runSynchronousBulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement;
+/**
+ *  Synchronously migrates a table to a new GUID mode (see SQLDatabase's `migrateTable:toGUIDMode:`). Any pending updates are committed first. The mode is stored in the table's schema, so once the migration succeeds every connection reads the new mode and statements for the table (including ones created before the migration) use it the next time they're run.
+ *  @warning A statement whose `GUIDMode` was set explicitly keeps it.
+ *
+ *  @param tableName The table to migrate.
+ *  @param mode      The GUID mode to migrate to.
+ *
+ *  @return YES if the table was migrated.
+ */
+- (BOOL) migrateTable:(NSString *)tableName toGUIDMode:(SQLGUIDMode)mode;
+/**
+ *  ### Schema Sync
+ *
+ *  Brings the database's tables up to the columns & indexes in a set of statements: missing tables are created, missing columns are added and missing indexes are created. Columns are never removed (sqlite doesn't allow it).
+ *
+ *  The schema of every table is read in a single query and diffed in memory (see `SQLSchema`), then all the changes are applied in one transaction. Once the database is synced, a fingerprint of the statements is recorded in the database. As long as neither the statements nor the database's schema change, the next sync is skipped after a single query. Use this instead of updating tables one at a time: syncing all your tables at launch is usually a single query.
+ *
+ *  This is synchronous: pending updates are committed first and the same caveats as the other synchronous methods apply.
+ *
+ *  @param statements An NSArray of SQLStatements (ex: from `SQLStatementConstructor`), one per table.
+ *
+ *  @return YES if the database is synced to the statements.
+ */
+- (BOOL) syncSchemaToStatements:(NSArray *)statements;
+/**
+ *  The same as `syncSchemaToStatements:`, except the sync is run after any pending updates.
+ *
+ *  @param statements An NSArray of SQLStatements, one per table.
+ *  @param block      **optional** Run on the callback queue when the sync is done.
+ */
+- (void) syncSchemaToStatements:(NSArray *)statements onCompletion:(SyncBlock)block;
+/**
+ *  The same as `syncSchemaToStatements:onCompletion:`, except the block is run on the queue provided.
+ *
+ *  @param statements    An NSArray of SQLStatements, one per table.
+ *  @param callbackQueue The queue the block is run on. If NULL, the manager's callback queue is used.
+ *  @param block         **optional** Run when the sync is done.
+ */
+- (void) syncSchemaToStatements:(NSArray *)statements onQueue:(dispatch_queue_t)callbackQueue onCompletion:(SyncBlock)block;
+/**
+ *  The database's user version (`PRAGMA user_version`), which is the last migration run by `runMigrations:`.
+ */
+@property (readonly) NSUInteger userVersion;
+/**
+ *  Runs versioned migrations. Migrations are keyed by version (an NSNumber). Every migration with a version greater than the database's `userVersion` is run in ascending order, each in it's own transaction. When a migration returns YES, the database's `userVersion` is set to it's version in the same transaction, so a migration is only ever run once.
+ *
+ *  If a migration returns NO, it's rolled back and the migrations after it aren't run. The next call will start from that migration again.
+ *
+ *  Migrations can make any change (ex: copying data into a new column), so query caches & subscriptions are refreshed afterward. Run your migrations before syncing your schema if they depend on the old schema.
+ *  This is synchronous: pending updates are committed first.
+ *
+ *  @param migrations An NSDictionary of MigrationBlocks keyed by version.
+ *
+ *  @return YES if every migration succeeded (or there weren't any to run).
+ */
+- (BOOL) runMigrations:(NSDictionary *)migrations;
+/**
+ *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table. If the table doesn't exist, this will create a new table with the column in the statement.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion. Indexes in the statement's `indexStatements` (ex: `indexed` columns) are created if they don't already exist.
+   This is a synchronous version of the call. It's the same as calling `syncSchemaToStatements:` with the one statement; if you're updating several tables, sync them all at once.
  *
  *  @param statement       The statement you want to use to update the table to.
  *  @param completionBlock **optional** completion block to be run when done.
  */
 - (void) updateOrCreateTableToColumnsInStatement:(SQLStatement *)statement;
 /**
- *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table. If the table doesn't exist, this will create a new table with the column in the statement.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion.
+ *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table. If the table doesn't exist, this will create a new table with the column in the statement.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion. Indexes in the statement's `indexStatements` (ex: `indexed` columns) are created if they don't already exist.
  *
  *  @param statement       The statement you want to use to update the table to.
  *  @param completionBlock **optional** completion block to be run when done.
  */
 - (void) updateOrCreateTableToColumnsInStatement:(SQLStatement *)statement onCompletion:(CompletionBlock)completionBlock;
 /**
- *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion.
+ *  This will take a statement, compare the columns in that statement to the columns in the database table (also listed in the statement) and add any missing columns listed in the statement to the table.  This *will not* delete columns in the table not present in the statement because, quite frankly, SQLite doesn't allow column deletion. Indexes in the statement's `indexStatements` (ex: `indexed` columns) are created if they don't already exist.
  *
  *  @param statement       The statement you want to use to update the table to.
  *  @param completionBlock **optional** completion block to be run when done.
@@ -200,7 +687,7 @@ typedef void (^CompletionBlock) (void);
 - (void) updateTableToColumnsInStatement:(SQLStatement *)statement onCompletion:(CompletionBlock)completionBlock;
 /**
  *  Similar to `updateTableToColumnsInStatement:onCompletion` this will update a database table to the columns listed in the statement.  
- *  However, initially, nothing will be done.  Instead, a query will be added to the query queue you provide. When that query is processed, the appropriate updates will be added to the update queue you provide.  You must then process the update queue to effect the approriate updates in the table.
+ *  However, initially, nothing will be done.  Instead, a query will be added to the query queue you provide. When that query is processed, the appropriate updates will be added to the update queue you provide.  You must then process the update queue to effect the approriate updates in the table. Indexes in the statement's `indexStatements` are added to the update queue as well.
  *  This will allow you to update a large number of tables in an effecient manner by processing all the queries first and then processing all the updates at the same time (in a single transaction).  To be clear: this can be a huge effeciency gain. Use this if you're updating a lot of tables.
  *
  *  @param statement   The statement you want to update the table to.
@@ -236,6 +723,26 @@ typedef void (^CompletionBlock) (void);
  *  Default: NO.
  */
 @property BOOL rollbackOnFail;
+/**
+ *  The priority the updates are run with. Queued updates are only batched with updates of the same priority.
+ *  Default: SQLPriorityDefault
+ */
+@property SQLPriority priority;
+/**
+ *  The queue the update blocks are run on. If `NULL`, the manager's `callbackQueue` is used.
+ *  Default: `NULL`
+ */
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+/**
+ *  The deadline (in seconds) for all the updates in the queue, counted from when the queue is submitted (so it includes the time spent waiting). Updates that haven't finished by then are stopped; with `rollbackOnFail`, the ones already run are rolled back. Set to 0 for no deadline.
+ *  Default: 0
+ */
+@property NSTimeInterval timeout;
+/**
+ *  The maximum time (in seconds) each update can run. If 0, the manager's `statementTimeout` is used.
+ *  Default: 0
+ */
+@property NSTimeInterval statementTimeout;
 /**
  *  Adds the statement with corresponding block to the Queue.
  *
@@ -262,6 +769,45 @@ typedef void (^CompletionBlock) (void);
  *  The query Queue is a place to store SQL Statements you can then pass on to the SQLDatabaManager for processing.
  */
 @interface SQLQueryQueue : NSObject
+/**
+ *  How the queries in the queue are run. Parallel execution needs a reader pool (see `enableConcurrentReadsWithReaderCount:`); without one the queries are run serially. Results are still returned (on the callback queue) as each query finishes and the completion block is run after all of them, so with parallel execution the results can be returned in any order.
+ *
+ *  This only applies to queues run with `runQueryQueue:` (or queued with `queueQueries:`). Queries queued individually are run serially.
+ *  Default: SQLQueryExecutionSerial
+ */
+@property SQLQueryExecution execution;
+/**
+ *  The maximum number of queries run at the same time with parallel execution. A value of 0 uses every reader in the pool.
+ *  Default: 0
+ */
+@property NSUInteger maxConcurrentQueries;
+/**
+ *  The priority the queries are run with. Queued queries are only batched with queries of the same priority.
+ *  Default: SQLPriorityDefault
+ */
+@property SQLPriority priority;
+/**
+ *  The queue the query & completion blocks are run on. If `NULL`, the manager's `callbackQueue` is used.
+ *  Default: `NULL`
+ */
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+/**
+ *  If YES, the results of every query in the queue are delivered together, in a single hop to the callback queue once all the queries have finished, followed by the completion block. Otherwise each query's block is dispatched as soon as it finishes.
+ *
+ *  Use this when the callback queue is busy (or the queue has a lot of small queries): it's one dispatch instead of one per query. Queues that deliver their results together are run on their own instead of being batched with other queued queries.
+ *  Default: NO
+ */
+@property BOOL deliversResultsTogether;
+/**
+ *  The deadline (in seconds) for all the queries in the queue, counted from when the queue is submitted (so it includes the time spent waiting). Queries that haven't finished by then are stopped and their blocks receive `nil`. Set to 0 for no deadline.
+ *  Default: 0
+ */
+@property NSTimeInterval timeout;
+/**
+ *  The maximum time (in seconds) each query can run. If 0, the manager's `statementTimeout` is used.
+ *  Default: 0
+ */
+@property NSTimeInterval statementTimeout;
 /**
  *  Add a new query with corresponding block to the Queue.
  *
@@ -281,6 +827,15 @@ typedef void (^CompletionBlock) (void);
  *  @return YES if the statement was added, NO if it was not added. The statement won't be added if the statement is not a query or if you do not supply a block.
  */
 - (bool) addSQLQuery:(id <SQLStatementProtocol>)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)block;
+/**
+ *  Add a new query to the Queue whose results will be returned as a SQLResultSet.
+ *
+ *  @param statement The SQL statement to be processed.
+ *  @param block     The block to process the results of the query.  This is not optional. If you don't supply a block, the query will not be run.
+ *
+ *  @return YES if the statement was added, NO if it was not added. The statement won't be added if the statement is not a query or if you do not supply a block.
+ */
+- (bool) addSQLQuery:(id <SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)block;
 /**
  *  This will append the queries from the provided Queue to this one.
  *
@@ -292,3 +847,124 @@ typedef void (^CompletionBlock) (void);
  */
 - (void) removeAllStatements;
 @end
+
+/**
+ *  The results of a bulk insert.
+ */
+@interface SQLBulkResult : NSObject
+/**
+ *  The number of rows submitted.
+ */
+@property (readonly) NSUInteger rowCount;
+/**
+ *  The number of rows actually inserted. This can be less than the row count without any failures when using `SQLConflictIgnore`.
+ */
+@property (readonly) NSUInteger insertedCount;
+/**
+ *  The indexes of the rows that failed to insert.
+ */
+@property (readonly) NSIndexSet *failedIndexes;
+/**
+ *  The number of statements executed to insert the rows.
+ */
+@property (readonly) NSUInteger statementCount;
+/**
+ *  YES if a `SQLConflictRollback` conflict rolled back the entire insert.
+ */
+@property (readonly) BOOL rolledBack;
+/**
+ *  YES if every row was processed without failure.
+ */
+@property (readonly) BOOL success;
+@end
+
+/**
+ *  Metrics for batched writes. 
+ *  @see writeMetrics
+ */
+@interface SQLWriteMetrics : NSObject
+/**
+ *  The number of batches (transactions) committed.
+ */
+@property (readonly) NSUInteger batchCount;
+/**
+ *  The number of update requests (single updates or update queues) committed.
+ */
+@property (readonly) NSUInteger requestCount;
+/**
+ *  The number of update statements executed.
+ */
+@property (readonly) NSUInteger statementCount;
+/**
+ *  The most statements executed in a single batch.
+ */
+@property (readonly) NSUInteger largestBatchSize;
+/**
+ *  The average number of statements per batch.
+ */
+@property (readonly) double averageBatchSize;
+/**
+ *  How long (in seconds) the last batch took to execute and commit.
+ */
+@property (readonly) NSTimeInterval lastCommitDuration;
+/**
+ *  The average time (in seconds) a batch took to execute and commit.
+ */
+@property (readonly) NSTimeInterval averageCommitDuration;
+/**
+ *  The longest time (in seconds) a batch took to execute and commit.
+ */
+@property (readonly) NSTimeInterval maxCommitDuration;
+@end
+
+/**
+ *  A live query, returned from SQLDatabaseManager's `subscribeToQuery:withBlock:`.
+ */
+@interface SQLSubscription : NSObject
+/**
+ *  A copy of the statement subscribed to.
+ */
+@property (readonly) SQLStatement *statement;
+/**
+ *  NO once the subscription is cancelled.
+ */
+@property (readonly) BOOL active;
+/**
+ *  YES if the query can be refreshed incrementally (by querying only the changed rows).
+ */
+@property (readonly) BOOL incremental;
+/**
+ *  The number of times the whole query was run (including the initial results).
+ */
+@property (readonly) NSUInteger refreshCount;
+/**
+ *  The number of times only the changed rows were queried.
+ */
+@property (readonly) NSUInteger incrementalRefreshCount;
+/**
+ *  Stops the subscription. The block won't be called again (even for a refresh that's already running) and it's released right away.
+ */
+- (void) cancel;
+@end
+
+/**
+ *  A handle to asynchronous queries or updates, returned when they're submitted to a SQLDatabaseManager.
+ */
+@interface SQLOperation : NSObject
+/**
+ *  YES once the operation is cancelled.
+ */
+@property (readonly) BOOL cancelled;
+/**
+ *  YES once the operation has run past one of it's deadlines.
+ */
+@property (readonly) BOOL timedOut;
+/**
+ *  Why the operation was stopped (a SQLDatabaseErrorDomain error), or nil if it wasn't.
+ */
+@property (readonly) NSError *error;
+/**
+ *  Cancels the operation. Queries & updates that haven't run yet are skipped and any that are running are interrupted; their blocks are still called, with `nil` or a SQLUpdateResult (see the manager's `statementTimeout`). Queries & updates whose blocks have already been called aren't affected.
+ */
+- (void) cancel;
+@end
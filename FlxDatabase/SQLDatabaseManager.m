@@ -8,11 +8,30 @@
 
 #import "SQLDatabaseManager.h"
 #import "SQLStatement.h"
+#import "SQLStatementConstructor.h"
+#import "SQLPriorityScheduler.h"
+#import <sqlite3.h>
 
 #define DBQueue "SQLExecutionQueue"
 #define DBOperation "SQLOperationQueue"
+#define DBReadQueue "SQLReadQueue"
+#define DBReadDispatchQueue "SQLReadDispatchQueue"
+#define DBScheduleQueue "SQLWriteScheduleQueue"
+#define DBStreamQueue "SQLStreamQueue"
+#define WriteBatchSavepoint @"SAVEPOINT FlxWriteBatch;"
+#define WriteBatchRollbackSavepoint @"ROLLBACK TO SAVEPOINT FlxWriteBatch;"
+#define WriteBatchReleaseSavepoint @"RELEASE SAVEPOINT FlxWriteBatch;"
+#define StreamBatchesInFlight 2
+#define BulkInsertMaxRowsPerStatement 500
+#define SchemaTableName @"sqlite_master"
+#define SubscriptionMaxIncrementalRows 256
+#define PriorityKey @"SQLDatabaseManagerPriority"
+#define DefaultPriorityAgingInterval 0.5
+#define DefaultBackgroundChunkSize 256
 #define DocumentDirectory (NSSearchPathForDirectoriesInDomains(NSDocumentDirectory, NSUserDomainMask, YES).firstObject)
 
+NSString *const SQLDatabaseErrorDomain = @"SQLDatabaseErrorDomain";
+
 @interface WeakContainer : NSObject
 @property (weak) id object;
 + (instancetype) contain:(__weak id)object;
@@ -25,10 +44,26 @@
 }
 @end
 
+static void SQLRetainQueue(dispatch_queue_t *queueRef, dispatch_queue_t queue){
+  //Callback queues are kept (retained) by whatever they're set on
+  if (*queueRef == queue) return;
+  if (queue) dispatch_retain(queue);
+  if (*queueRef) dispatch_release(*queueRef);
+  *queueRef = queue;
+}
+
 @interface SQLUpdateBlock : NSObject
 @property  (readonly) id <SQLStatementProtocol> statement;
 @property (readonly) ExecBlock block;
 @property NSUInteger result;
+//The submission the update belongs to
+@property (strong) SQLOperation *operation;
+//The queue the block is run on, if it was chosen when the update was submitted
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+//When the statement was queued by the manager (only set while profiling)
+@property CFAbsoluteTime queuedTime;
+//YES if the update rolled back the whole transaction it was batched in, so it isn't run again when the batch is started over
+@property BOOL endedTransaction;
 - (id) initWithConstructor:(id <SQLStatementProtocol> )statement block:(ExecBlock)block;
 @end
 
@@ -40,13 +75,27 @@
   }
   return self;
 }
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue);
+}
+- (void) dealloc{
+  SQLRetainQueue(&_callbackQueue, NULL);
+}
 @end
 
 @interface SQLQueryBlock : NSObject
 @property (readonly) id <SQLStatementProtocol> statement;
 @property (readonly) QueueBlock block;
+@property (readonly) ResultSetBlock resultSetBlock;
 @property (readonly) Class rowClass;
+//When the query was queued by the manager (only set while profiling)
+@property CFAbsoluteTime queuedTime;
+//The queue the block is run on, if it was chosen when the query was queued
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+//The submission the query belongs to
+@property (strong) SQLOperation *operation;
 - (id) initWithConstructor:(id <SQLStatementProtocol> )statement block:(QueueBlock)block rowClass:(Class)rowClass;
+- (id) initWithConstructor:(id <SQLStatementProtocol> )statement resultSetBlock:(ResultSetBlock)block;
 @end
 
 @implementation SQLQueryBlock
@@ -58,6 +107,139 @@
   }
   return self;
 }
+- (id) initWithConstructor:(id <SQLStatementProtocol> )statement resultSetBlock:(ResultSetBlock)block{
+  if (self = [super init]){
+    _resultSetBlock = [block copy];
+    _statement = statement;
+  }
+  return self;
+}
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue);
+}
+- (void) dealloc{
+  SQLRetainQueue(&_callbackQueue, NULL);
+}
+@end
+
+@interface SQLWriteRequest : NSObject
+@property (readonly) SQLUpdateQueue *queue;
+@property (readonly) void (^completion)(BOOL success);
+@property (readonly) BOOL mergeable;
+@property SQLPriority priority;
+@property BOOL succeeded;
+//YES if one of it's updates was stopped by it's operation
+@property BOOL stopped;
+- (id) initWithQueue:(SQLUpdateQueue *)queue completion:(void (^)(BOOL success))completion mergeable:(BOOL)mergeable;
+@end
+
+@implementation SQLWriteRequest
+- (id) initWithQueue:(SQLUpdateQueue *)queue completion:(void (^)(BOOL))completion mergeable:(BOOL)mergeable{
+  if (self = [super init]){
+    _queue = queue;
+    _completion = [completion copy];
+    _mergeable = mergeable;
+    _priority = queue.priority;
+  }
+  return self;
+}
+@end
+
+@interface SQLStream : NSObject
+//The statement's sql is generated when the stream starts, on the connection it's read on
+@property (readonly) id <SQLStatementProtocol> statement;
+@property (readonly) Class rowClass;
+@property (readonly) NSUInteger batchSize;
+@property (readonly) SQLPriority priority;
+@property (readonly) StreamBlock batchBlock;
+@property (readonly) void (^completion)(BOOL finished);
+//Batches go through a serial queue that targets the callback queue, so they're delivered in order (and the completion after them) even if the callback queue is concurrent
+@property (readonly) dispatch_queue_t streamQueue;
+//The connection the stream is read on (the database or a checked out reader) & it's cursor, only touched by the stream's passes
+@property (strong) SQLDatabase *database;
+@property (strong) SQLCursor *cursor;
+//Set on the stream queue, checked before each batch is read
+@property BOOL cancelled;
+//Guarded by the stream: the batches waiting on the stream queue, and whether the next pass is waiting for one of them to be consumed
+@property NSUInteger batchesInFlight;
+@property BOOL paused;
+- (id) initWithStatement:(id <SQLStatementProtocol>)statement rowClass:(Class)rowClass batchSize:(NSUInteger)batchSize priority:(SQLPriority)priority callbackQueue:(dispatch_queue_t)callbackQueue batchBlock:(StreamBlock)batchBlock completion:(void (^)(BOOL finished))completion;
+@end
+
+@implementation SQLStream
+- (id) initWithStatement:(id <SQLStatementProtocol>)statement rowClass:(__unsafe_unretained Class)rowClass batchSize:(NSUInteger)batchSize priority:(SQLPriority)priority callbackQueue:(dispatch_queue_t)callbackQueue batchBlock:(StreamBlock)batchBlock completion:(void (^)(BOOL))completion{
+  if (self = [super init]){
+    _statement = statement;
+    _rowClass = rowClass;
+    _batchSize = MAX(batchSize, 1);
+    _priority = priority;
+    _batchBlock = [batchBlock copy];
+    _completion = [completion copy];
+    _streamQueue = dispatch_queue_create(DBStreamQueue, DISPATCH_QUEUE_SERIAL);
+    dispatch_set_target_queue(_streamQueue, callbackQueue);
+  }
+  return self;
+}
+- (void) dealloc{
+  dispatch_release(_streamQueue);
+}
+@end
+
+@interface SQLWriteMetrics () <NSCopying>
+- (void) reset;
+- (void) recordBatchWithRequests:(NSUInteger)requestCount statements:(NSUInteger)statementCount commitDuration:(NSTimeInterval)duration;
+@end
+
+@interface SQLBulkResult ()
+@property NSUInteger insertedCount;
+@property NSUInteger statementCount;
+@property BOOL rolledBack;
+@property (readonly) NSMutableIndexSet *failures;
+- (id) initWithRowCount:(NSUInteger)rowCount;
+@end
+
+@interface SQLSubscription ()
+@property (readonly) Class rowClass;
+//The priority refreshes are run with (the priority the subscription was made with)
+@property SQLPriority priority;
+@property (readonly) QueueBlock block;
+//The queue the block is called on, if it was chosen when the subscription was made
+@property (nonatomic, assign) dispatch_queue_t callbackQueue;
+//The columns the statement references (nil if it references every column)
+@property (readonly) NSSet *referencedColumns;
+//The current results, kept (as copies) for incremental subscriptions
+@property NSMutableArray *rows;
+- (id) initWithStatement:(SQLStatement *)statement rowClass:(Class)rowClass block:(QueueBlock)block;
+- (BOOL) addChanges:(SQLChangeSet *)changes;
+- (BOOL) beginRefresh;
+- (BOOL) takePendingRowIDs:(NSSet **)rowIDs;
+- (BOOL) endRefresh;
+- (void) recordRefresh:(BOOL)incremental;
+@end
+
+@interface SQLOperation ()
+//YES once the operation is cancelled or past a deadline
+@property (readonly) BOOL stopped;
+//The result passed to the update blocks of a stopped operation
+@property (readonly) NSInteger updateResult;
+- (id) initWithTimeout:(NSTimeInterval)timeout statementTimeout:(NSTimeInterval)statementTimeout;
+- (void) beginStatementOnDatabase:(SQLDatabase *)database;
+- (void) endStatementOnDatabase:(SQLDatabase *)database;
+@end
+
+@interface SQLDatabase (SQLDatabaseManager)
+@property (nonatomic) NSTimeInterval profileQueueWait;
+@end
+
+@interface SQLStatement (SQLDatabaseManager)
+- (void) setTableGUIDMode:(SQLGUIDMode)mode;
+@end
+
+@interface SQLChangeSet (SQLDatabaseManager)
+- (void) addTable:(NSString *)tableName;
+- (void) markAllRowsChangedInTable:(NSString *)tableName;
+- (void) markAllTablesChanged;
+- (void) setUpdatedColumns:(NSSet *)columnNames forTable:(NSString *)tableName;
 @end
 
 @interface SQLQueryQueue () <NSFastEnumeration>
@@ -65,6 +247,7 @@
 @property (readonly) NSUInteger count;
 + (SQLQueryQueue *) queueWithQueue:(SQLQueryQueue *)queue;
 - (SQLQueryBlock *) queryBlockAtIndex:(NSUInteger)index;
+- (void) addQueryBlock:(SQLQueryBlock *)block;
 @end
 
 @interface SQLUpdateQueue () <NSFastEnumeration>
@@ -72,6 +255,7 @@
 @property (readonly) NSUInteger count;
 + (SQLUpdateQueue *) queueWithQueue:(SQLUpdateQueue *)queue;
 - (SQLUpdateBlock *) updateBlockAtIndex:(NSUInteger)index;
+- (void) addUpdateBlock:(SQLUpdateBlock *)block;
 @end
 
 @interface SQLDatabaseManager (private)
@@ -88,14 +272,46 @@ static NSMutableDictionary *DBManagers(){
 }
 
 @implementation SQLDatabaseManager{
-  SQLUpdateQueue *_updateQueue;
-  SQLQueryQueue *_queryQueue;
+  //Queued queries, one queue per priority (guarded by self)
+  NSArray *_queryQueues;
   SQLDatabase *_database;
   BOOL _dbOpen;
-  BOOL _queriesNeedProcessing;
-  BOOL _updatesNeedProcessing;
   dispatch_queue_t _databaseQueue;
-  dispatch_queue_t _operationsQueue;
+  //Priorities: work for the database queue & the reader pool is run by lane
+  SQLPriorityScheduler *_databaseScheduler;
+  SQLPriorityScheduler *_readScheduler;
+  NSTimeInterval _priorityAgingInterval;
+  dispatch_queue_t _callbackQueue;
+  //Batching: the triggers fire on the schedule queue, coalescing every request made before they run
+  dispatch_source_t _queryTrigger;
+  dispatch_source_t _writeTrigger;
+  //Write Scheduling: everything here is only touched on the schedule queue
+  dispatch_queue_t _scheduleQueue;
+  NSMutableArray *_pendingWrites;
+  NSUInteger _pendingWriteCount;
+  BOOL _writeFlushScheduled;
+  NSUInteger _writeFlushGeneration;
+  SQLWriteMetrics *_writeMetrics;
+  //Concurrent Reads
+  NSMutableArray *_readers;
+  NSUInteger _readerCount;
+  dispatch_semaphore_t _readerSemaphore;
+  dispatch_queue_t _readQueue;
+  dispatch_queue_t _readDispatchQueue;
+  //Bumped when the schema changes. Each reader clears it's statement cache when it's checked out behind the generation (guarded by _readers).
+  NSUInteger _readerSchemaGeneration;
+  NSMapTable *_readerGenerations;
+  //Change Tracking: the written tables & columns are only touched on the database queue
+  SQLQueryCache *_queryCache;
+  NSMutableSet *_writtenTables;
+  NSMutableSet *_rewrittenTables;
+  NSMutableDictionary *_writtenColumns;
+  BOOL _writtenUnknownTable;
+  //Subscriptions
+  NSMutableArray *_subscriptions;
+  //Profiling
+  SQLProfiler *_profiler;
+  SQLIndexAdvisor *_indexAdvisor;
   
   NSMutableDictionary *_managers;
 }
@@ -105,21 +321,38 @@ static NSMutableDictionary *DBManagers(){
   return [self initWithFilePath:[DocumentDirectory stringByAppendingPathComponent:fileName]];
 }
 - (id) initWithFilePath:(NSString *)path{
+  return [self initWithFilePath:path options:nil];
+}
+- (id) initWithFilePath:(NSString *)path options:(SQLDatabaseOptions *)options{
   if (!path.length) return nil;
   //Only one manager can be instantiated for an individual path
   NSMutableDictionary *managers = DBManagers();
   SQLDatabaseManager *manager = [managers[path] object];
   if (!manager){
     if (self = [super init]){
-      _updateQueue = [[SQLUpdateQueue alloc] init];
-      _queryQueue = [[SQLQueryQueue alloc] init];
+      _queryQueues = [self newPendingQueryQueues];
       
-      _database = [[SQLDatabase alloc] initWithPath:path];
+      _database = [[SQLDatabase alloc] initWithPath:path options:options];
       _dbOpen = YES;
-      _queriesNeedProcessing = NO;
-      _updatesNeedProcessing = NO;
       _databaseQueue = dispatch_queue_create(DBQueue, DISPATCH_QUEUE_SERIAL);
-      _operationsQueue = dispatch_get_main_queue();
+      _databaseScheduler = [[SQLPriorityScheduler alloc] initWithQueue:_databaseQueue];
+      _priorityAgingInterval = DefaultPriorityAgingInterval;
+      _backgroundChunkSize = DefaultBackgroundChunkSize;
+      SQLRetainQueue(&_callbackQueue, dispatch_get_main_queue());
+      _scheduleQueue = dispatch_queue_create(DBScheduleQueue, DISPATCH_QUEUE_SERIAL);
+      [self createBatchTriggers];
+      _pendingWrites = [NSMutableArray new];
+      _pendingWriteCount = 0;
+      _writeFlushScheduled = NO;
+      _writeFlushGeneration = 0;
+      _writeMetrics = [SQLWriteMetrics new];
+      _writeLatency = 0;
+      _maxWriteBatchSize = 0;
+      _writtenTables = [NSMutableSet new];
+      _rewrittenTables = [NSMutableSet new];
+      _writtenColumns = [NSMutableDictionary new];
+      _subscriptions = [NSMutableArray new];
+      _writtenUnknownTable = NO;
       
       _managers = [NSMutableDictionary new];
     }
@@ -130,31 +363,884 @@ static NSMutableDictionary *DBManagers(){
   }
 }
 #pragma mark -  Private Methods
+- (void) createBatchTriggers{
+  /* Queued queries & zero latency writes are batched with dispatch sources instead of the main run loop. Merging data into a source that's already waiting to fire is coalesced, so everything requested before the handler runs is picked up in one batch.
+   The handlers hold the manager weakly, since the manager holds the sources.
+   */
+  __weak SQLDatabaseManager *weakSelf = self;
+  _queryTrigger = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, _scheduleQueue);
+  dispatch_source_set_event_handler(_queryTrigger, ^{
+    [weakSelf processPendingQueries];
+  });
+  dispatch_resume(_queryTrigger);
+  _writeTrigger = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, _scheduleQueue);
+  dispatch_source_set_event_handler(_writeTrigger, ^{
+    [weakSelf processScheduledWrites];
+  });
+  dispatch_resume(_writeTrigger);
+}
 - (void) setQueryNeedsProcessing{
-  if (!_queriesNeedProcessing){
-    _queriesNeedProcessing = YES;
-    dispatch_async(dispatch_get_main_queue(), ^{
-      [self performSelector:@selector(processPendingQueries) withObject:nil afterDelay:0 inModes:@[NSRunLoopCommonModes]];
+  dispatch_source_merge_data(_queryTrigger, 1);
+}
+- (SQLPriority) currentPriority{
+  //The priority of the enclosing performWithPriority:block: on this thread
+  NSNumber *priority = [[NSThread currentThread] threadDictionary][PriorityKey];
+  return priority ? priority.unsignedIntegerValue : SQLPriorityDefault;
+}
+#pragma mark Write Scheduling
+- (void) scheduleWriteRequest:(SQLWriteRequest *)request orUpdateBlock:(SQLUpdateBlock *)updateBlock immediate:(BOOL)immediate{
+  /* All writes are funneled through here and grouped into batches that are committed in a single transaction.
+   - A single statement is merged into the last pending request if that request is also made of single statements with the same priority
+   - Large background requests are split into chunks (see chunksOfWriteRequest:)
+   - Immediate writes flush right away, taking anything pending with them
+   - Otherwise a flush is scheduled after the write latency (or by the write trigger if there's no latency), or right away if the batch is full
+   */
+  CFAbsoluteTime queuedTime = _profiler ? CFAbsoluteTimeGetCurrent() : 0;
+  SQLPriority priority = [self currentPriority];
+  dispatch_async(_scheduleQueue, ^{
+    SQLWriteRequest *pending = request;
+    if (!pending){
+      SQLWriteRequest *last = _pendingWrites.lastObject;
+      BOOL merge = last.mergeable && last.priority == priority;
+      SQLUpdateQueue *queue = merge ? last.queue : [SQLUpdateQueue new];
+      queue.priority = priority;
+      [queue addUpdateBlock:updateBlock];
+      if (queuedTime) [self markBlocks:@[updateBlock] queuedAtTime:queuedTime];
+      if (!merge) [_pendingWrites addObject:[[SQLWriteRequest alloc] initWithQueue:queue completion:nil mergeable:YES]];
+      _pendingWriteCount++;
+    } else {
+      if (queuedTime) [self markBlocks:pending.queue.blocks queuedAtTime:queuedTime];
+      [_pendingWrites addObjectsFromArray:[self chunksOfWriteRequest:pending]];
+      _pendingWriteCount += pending.queue.count;
+    }
+    NSUInteger maxBatchSize = self.maxWriteBatchSize;
+    if (immediate || (maxBatchSize > 0 && _pendingWriteCount >= maxBatchSize)){
+      [self flushPendingWrites];
+    } else {
+      [self scheduleWriteFlush];
+    }
+  });
+}
+- (void) scheduleWriteFlush{
+  //Must be called on the schedule queue
+  if (_writeFlushScheduled) return;
+  _writeFlushScheduled = YES;
+  NSUInteger generation = _writeFlushGeneration;
+  void (^flush)(void) = ^{
+    //A flush may have already happened (ex: the batch filled up), in which case this one is stale
+    if (generation == _writeFlushGeneration) [self flushPendingWrites];
+  };
+  NSTimeInterval latency = self.writeLatency;
+  if (latency > 0){
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(latency * NSEC_PER_SEC)), _scheduleQueue, flush);
+  } else {
+    dispatch_source_merge_data(_writeTrigger, 1);
+  }
+}
+- (void) processScheduledWrites{
+  //Called by the write trigger on the schedule queue. The writes may have already been flushed (ex: by an immediate update).
+  if (_writeFlushScheduled) [self flushPendingWrites];
+}
+- (NSArray *) chunksOfWriteRequest:(SQLWriteRequest *)request{
+  /* Must be called on the schedule queue
+   A background request without rollbackOnFail that's larger than the chunk size is split into requests of at most that many statements, so each is committed in it's own batch and other work can run between them. The request's completion is run (and it's queue emptied) after the last chunk.
+   */
+  SQLUpdateQueue *queue = request.queue;
+  NSUInteger chunkSize = self.backgroundChunkSize;
+  if (request.priority != SQLPriorityBackground || queue.rollbackOnFail || chunkSize < 1 || queue.count <= chunkSize) return @[request];
+  void (^completion)(BOOL success) = request.completion;
+  NSMutableArray *chunks = [NSMutableArray arrayWithCapacity:queue.count / chunkSize + 1];
+  for (NSUInteger index = 0; index < queue.count; index += chunkSize){
+    SQLUpdateQueue *chunkQueue = [SQLUpdateQueue new];
+    chunkQueue.priority = queue.priority;
+    chunkQueue.callbackQueue = queue.callbackQueue;
+    for (NSUInteger i = index; i < MIN(index + chunkSize, queue.count); i++){
+      [chunkQueue addUpdateBlock:[queue updateBlockAtIndex:i]];
+    }
+    BOOL last = (index + chunkSize >= queue.count);
+    [chunks addObject:[[SQLWriteRequest alloc] initWithQueue:chunkQueue completion:last ? ^(BOOL success){
+      [queue removeAllStatements];
+      if (completion) completion(success);
+    } : nil mergeable:NO]];
+  }
+  return chunks;
+}
+- (void) flushPendingWrites{
+  /* Must be called on the schedule queue
+   Pending requests are split into batches of up to maxWriteBatchSize statements (background batches are also capped at the background chunk size). A request is never split here, so it's rollbackOnFail is preserved (a single request can be larger than the batch size).
+   A batch only holds requests with the same priority, and is run in that priority's lane.
+   */
+  _writeFlushScheduled = NO;
+  _writeFlushGeneration++;
+  while (_pendingWrites.count){
+    NSMutableArray *batch = [NSMutableArray new];
+    NSUInteger statementCount = 0;
+    SQLPriority priority = [_pendingWrites.firstObject priority];
+    NSUInteger maxBatchSize = self.maxWriteBatchSize;
+    NSUInteger chunkSize = self.backgroundChunkSize;
+    if (priority == SQLPriorityBackground && chunkSize > 0) maxBatchSize = maxBatchSize > 0 ? MIN(maxBatchSize, chunkSize) : chunkSize;
+    while (_pendingWrites.count){
+      SQLWriteRequest *request = _pendingWrites.firstObject;
+      if (request.priority != priority) break;
+      if (batch.count && maxBatchSize > 0 && statementCount + request.queue.count > maxBatchSize) break;
+      [batch addObject:request];
+      statementCount += request.queue.count;
+      [_pendingWrites removeObjectAtIndex:0];
+    }
+    _pendingWriteCount -= statementCount;
+    [_databaseScheduler performWork:^{
+      [self executeWriteBatch:batch];
+    } priority:priority];
+  }
+}
+- (void) flushPendingWritesSynchronously{
+  //Pending writes are sent to the database queue now, so a synchronous update can't run ahead of writes waiting on the write latency
+  dispatch_sync(_scheduleQueue, ^{
+    if (_pendingWrites.count) [self flushPendingWrites];
+  });
+}
+- (void) executeWriteBatch:(NSArray *)batch{
+  /* Must be called on the database queue
+   Every request in the batch is committed in one transaction. A request with rollbackOnFail is wrapped in a savepoint, so if one of it's updates fails only that request is rolled back.
+   Updates whose operation was stopped (cancelled or past a deadline) aren't run, which is a failure for a request with rollbackOnFail. A failed update never raises (see executeUpdateStatement:), so it can't leave the transaction or a savepoint open.
+   Interrupting an update (or an update whose conflict clause is ROLLBACK failing) rolls back the whole transaction, so the batch is started over. The interrupted update's operation is stopped and the failed update is marked, so this time they're skipped.
+   Blocks are only called for requests that weren't rolled back (or were stopped, so they can report it).
+   */
+  if (!_dbOpen) return;
+  CFAbsoluteTime start = CFAbsoluteTimeGetCurrent();
+  NSUInteger statementCount = 0;
+  [_database beginImmediateTransaction];
+  for (SQLWriteRequest *request in batch){
+    SQLUpdateQueue *queue = request.queue;
+    BOOL rollback = NO;
+    request.stopped = NO;
+    if (queue.rollbackOnFail) [_database executeUpdate:WriteBatchSavepoint];
+    for (SQLUpdateBlock *block in queue){
+      id <SQLStatementProtocol> statement = block.statement;
+      if (statement.SQLType == SQLStatementQuery) continue;
+      SQLOperation *operation = block.operation;
+      NSInteger sqlResult = SQLUpdateResultFailed;
+      if (!operation.stopped && !block.endedTransaction){
+        [self beginProfilingBlock:block onDatabase:_database];
+        [operation beginStatementOnDatabase:_database];
+        sqlResult = [self executeUpdateStatement:statement];
+        [operation endStatementOnDatabase:_database];
+        _database.profileQueueWait = 0;
+        statementCount++;
+        if (![_database inTransaction]){
+          if (!_database.interrupted) block.endedTransaction = YES;
+          [self executeWriteBatch:batch];
+          return;
+        }
+      }
+      if (operation.stopped){
+        sqlResult = operation.updateResult;
+        request.stopped = YES;
+      }
+      block.result = sqlResult;
+      if ((sqlResult == SQLUpdateResultFailed || operation.stopped) && queue.rollbackOnFail){
+        rollback = YES;
+        break;
+      }
+    }
+    if (queue.rollbackOnFail){
+      if (rollback) [_database executeUpdate:WriteBatchRollbackSavepoint];
+      [_database executeUpdate:WriteBatchReleaseSavepoint];
+    }
+    request.succeeded = !rollback;
+  }
+  [_database commit];
+  [self processCommittedWrites];
+  [_writeMetrics recordBatchWithRequests:batch.count statements:statementCount commitDuration:CFAbsoluteTimeGetCurrent() - start];
+  
+  for (SQLWriteRequest *request in batch){
+    SQLUpdateQueue *queue = request.queue;
+    //The blocks may be on different queues, so the completion waits on the group for all of them
+    dispatch_group_t group = dispatch_group_create();
+    if (request.succeeded || request.stopped){
+      BOOL succeeded = request.succeeded;
+      for (SQLUpdateBlock *block in queue){
+        ExecBlock currentBlock = block.block;
+        //Every update of a stopped request that was rolled back reports why
+        NSInteger result = succeeded ? block.result : block.operation.updateResult;
+        if (currentBlock){
+          dispatch_group_async(group, [self callbackQueueForUpdate:block inQueue:queue], ^{
+            currentBlock(result);
+            block.statement.GUID = nil;
+          });
+        } else {
+          block.statement.GUID = nil;
+        }
+      }
+      [queue removeAllStatements];
+    }
+    void (^completion)(BOOL success) = request.completion;
+    if (completion){
+      BOOL success = request.succeeded && !request.stopped;
+      dispatch_group_notify(group, queue.callbackQueue ?: _callbackQueue, ^{
+        completion(success);
+      });
+    }
+    dispatch_release(group);
+  }
+}
+- (NSArray *) newPendingQueryQueues{
+  //Indexed by priority
+  NSMutableArray *queues = [NSMutableArray arrayWithCapacity:SQLPriorityInteractive + 1];
+  for (NSUInteger priority = SQLPriorityBackground; priority <= SQLPriorityInteractive; priority++){
+    SQLQueryQueue *queue = [SQLQueryQueue new];
+    queue.priority = priority;
+    [queues addObject:queue];
+  }
+  return queues;
+}
+- (void) processPendingQueries{
+  //Called by the query trigger on the schedule queue. Queries can be queued from any thread, so the pending queues are swapped out under the lock.
+  NSArray *queues = nil;
+  @synchronized(self){
+    queues = _queryQueues;
+    _queryQueues = [self newPendingQueryQueues];
+  }
+  for (SQLQueryQueue *queue in queues.reverseObjectEnumerator){
+    if ([queue count] > 0)
+      [self runQueriesOfQueue:queue completion:nil];
+  }
+}
+#pragma mark Callbacks
+- (dispatch_queue_t) callbackQueueForUpdate:(SQLUpdateBlock *)block inQueue:(SQLUpdateQueue *)queue{
+  //The queue chosen for the statement, then the one chosen for it's queue, then the manager's
+  return block.callbackQueue ?: queue.callbackQueue ?: _callbackQueue;
+}
+- (dispatch_queue_t) callbackQueueForQuery:(SQLQueryBlock *)block inQueue:(SQLQueryQueue *)queue{
+  return block.callbackQueue ?: queue.callbackQueue ?: _callbackQueue;
+}
+- (void) deliverResults:(NSArray *)deliveries ofQueue:(SQLQueryQueue *)queue group:(dispatch_group_t)group completion:(CompletionBlock)completion{
+  /* Results were either dispatched as each query finished (in the group, so the completion runs after all of them even on a concurrent queue) or collected to be delivered together with the completion in one hop.
+   */
+  dispatch_queue_t callbackQueue = queue.callbackQueue ?: _callbackQueue;
+  if (deliveries){
+    dispatch_async(callbackQueue, ^{
+      for (dispatch_block_t delivery in deliveries){
+        delivery();
+      }
+      if (completion) completion();
     });
+  } else if (completion){
+    dispatch_group_notify(group, callbackQueue, completion);
+  }
+}
+#pragma mark Operations
+- (SQLOperation *) operationForBlocks:(NSArray *)blocks timeout:(NSTimeInterval)timeout statementTimeout:(NSTimeInterval)statementTimeout{
+  //Every statement of a submission shares it's operation, so it follows them wherever they're batched. The manager's statement timeout is used if the submission doesn't have one.
+  SQLOperation *operation = [[SQLOperation alloc] initWithTimeout:timeout statementTimeout:statementTimeout > 0 ? statementTimeout : self.statementTimeout];
+  for (id block in blocks){
+    [block setOperation:operation];
+  }
+  return operation;
+}
+#pragma mark Reader Pool
+- (SQLDatabase *) checkoutReader{
+  //Blocks until a reader is available
+  dispatch_semaphore_wait(_readerSemaphore, DISPATCH_TIME_FOREVER);
+  SQLDatabase *reader = nil;
+  BOOL stale = NO;
+  @synchronized(_readers){
+    reader = _readers.lastObject;
+    [_readers removeLastObject];
+    stale = [[_readerGenerations objectForKey:reader] unsignedIntegerValue] != _readerSchemaGeneration;
+    if (stale) [_readerGenerations setObject:@(_readerSchemaGeneration) forKey:reader];
+  }
+  //The reader is checked out, so nothing else is using it
+  if (stale) [reader clearStatementCache];
+  return reader;
+}
+- (void) returnReader:(SQLDatabase *)reader{
+  @synchronized(_readers){
+    [_readers addObject:reader];
   }
+  dispatch_semaphore_signal(_readerSemaphore);
 }
-- (void) setUpdateNeedsProcessing{
-  if (!_updatesNeedProcessing){
-    _updatesNeedProcessing = YES;
-    dispatch_async(dispatch_get_main_queue(), ^{
-      [self performSelector:@selector(processPendingUpdates) withObject:nil afterDelay:0 inModes:@[NSRunLoopCommonModes]];
+- (void) dispatchRead:(void (^)(SQLDatabase *database))readBlock priority:(SQLPriority)priority{
+  /* Without a reader pool, reads are processed on the database queue with everything else.
+   With a pool, reads are handed out by priority (the dispatch queue is serial and waits for a free reader) and run concurrently on the read queue.
+   */
+  if (!_readers){
+    [_databaseScheduler performWork:^{
+      readBlock(_database);
+    } priority:priority];
+    return;
+  }
+  [_readScheduler performWork:^{
+    SQLDatabase *reader = [self checkoutReader];
+    dispatch_async(_readQueue, ^{
+      readBlock(reader);
+      [self returnReader:reader];
     });
+  } priority:priority];
+}
+- (void) performSynchronousRead:(void (^)(SQLDatabase *database))readBlock{
+  if (!_readers){
+    [_databaseScheduler performWorkAndWait:^{
+      readBlock(_database);
+    } priority:[self currentPriority]];
+    return;
   }
+  SQLDatabase *reader = [self checkoutReader];
+  readBlock(reader);
+  [self returnReader:reader];
 }
-- (void) processPendingUpdates{
-  _updatesNeedProcessing = NO;
-  if ([_updateQueue count] > 0)
-    [self runUpdateQueue:_updateQueue withCompletionBlock:nil];
+- (void) invalidateReaderStatementCaches{
+  /* Readers may have statements prepared against an old schema. This doesn't wait on the read side (so it's safe on the database queue): each reader clears it's cache the next time it's checked out.
+   */
+  if (!_readers) return;
+  @synchronized(_readers){
+    _readerSchemaGeneration++;
+  }
 }
-- (void) processPendingQueries{
-  _queriesNeedProcessing = NO;
-  if ([_queryQueue count] > 0)
-    [self runQueryQueue:_queryQueue];
+- (void) performOnAllReaders:(void (^)(SQLDatabase *reader))block{
+  /* Waits for all pending reads to finish, then runs the block on each reader
+   Must not be called on the database queue: the read side can be waiting on it (ex: a snapshot).
+   */
+  if (!_readers) return;
+  dispatch_sync(_readDispatchQueue, ^{
+    for (NSUInteger i = 0; i < _readerCount; i++){
+      dispatch_semaphore_wait(_readerSemaphore, DISPATCH_TIME_FOREVER);
+    }
+    for (SQLDatabase *reader in _readers){
+      block(reader);
+    }
+    for (NSUInteger i = 0; i < _readerCount; i++){
+      dispatch_semaphore_signal(_readerSemaphore);
+    }
+  });
+}
+#pragma mark Change Tracking
+- (NSString *) tableNameForStatement:(id <SQLStatementProtocol>)statement{
+  //Raw sql has no table name, so it can't be cached (or invalidated by table). Neither can a join or subquery that reads other tables.
+  if (![statement respondsToSelector:@selector(tableName)]) return nil;
+  if ([statement isKindOfClass:[SQLStatement class]] && [(SQLStatement *)statement referencedTableNames].count > 1) return nil;
+  NSString *tableName = [(SQLStatement *)statement tableName];
+  return tableName.length ? tableName : nil;
+}
+- (void) recordWriteForStatement:(id <SQLStatementProtocol>)statement{
+  /* Must be called on the database queue
+   sqlite's hooks report the rows changed, but not everything: the columns updated, rows deleted by a truncate (a delete without a predicate) and schema changes come from the statement.
+   */
+  if (!_database.tracksChanges) return;
+  if (statement.SQLType == SQLStatementCreateIndex || statement.SQLType == SQLStatementDropIndex){
+    //Indexes don't change any rows, only the schema
+    [_rewrittenTables addObject:SchemaTableName];
+    return;
+  }
+  NSString *tableName = [self tableNameForStatement:statement];
+  if (!tableName){
+    _writtenUnknownTable = YES;
+    return;
+  }
+  [_writtenTables addObject:tableName];
+  switch (statement.SQLType) {
+    case SQLStatementUpdate:
+    case SQLStatementUpsert:
+      if ([statement isKindOfClass:[SQLStatement class]] && _writtenColumns[tableName] != [NSNull null]){
+        NSMutableSet *columnNames = _writtenColumns[tableName] ?: [NSMutableSet setWithObject:SQLModifiedDate];
+        for (SQLColumn *column in [(SQLStatement *)statement orderedColumns]){
+          if (![column.name isEqualToString:@"*"]) [columnNames addObject:column.name];
+        }
+        _writtenColumns[tableName] = columnNames;
+      } else {
+        _writtenColumns[tableName] = [NSNull null];
+      }
+      break;
+    case SQLStatementDelete:
+      [_rewrittenTables addObject:tableName];
+      break;
+    case SQLStatementAlterTable:
+      if ([statement respondsToSelector:@selector(alterTableName)] && [(SQLStatement *)statement alterTableName]) [_rewrittenTables addObject:[(SQLStatement *)statement alterTableName]];
+      //Falls through: renaming is also a schema change
+    case SQLStatementCreate:
+    case SQLStatementDropTable:
+    case SQLStatementAddColumn:
+      //Schema changes also change the table list
+      [_rewrittenTables addObjectsFromArray:@[tableName, SchemaTableName]];
+      break;
+    default:
+      break;
+  }
+}
+- (void) processCommittedWrites{
+  /* Must be called on the database queue, after the recorded writes are committed (or rolled back)
+   The rows changed (from sqlite's hooks) are combined with what was recorded from the statements, then used to invalidate the query cache and refresh subscriptions.
+   */
+  if (!_database.tracksChanges) return;
+  SQLChangeSet *changes = [_database takeCommittedChanges] ?: [SQLChangeSet new];
+  if (_writtenUnknownTable) [changes markAllTablesChanged];
+  for (NSString *tableName in _writtenTables){
+    [changes addTable:tableName];
+  }
+  for (NSString *tableName in _rewrittenTables){
+    [changes markAllRowsChangedInTable:tableName];
+  }
+  [_writtenColumns enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, id columnNames, BOOL *stop) {
+    if (columnNames != [NSNull null]) [changes setUpdatedColumns:columnNames forTable:tableName];
+  }];
+  [_writtenTables removeAllObjects];
+  [_rewrittenTables removeAllObjects];
+  [_writtenColumns removeAllObjects];
+  _writtenUnknownTable = NO;
+  if (changes.isEmpty) return;
+  
+  if (changes.allTablesChanged){
+    [_queryCache removeAllResults];
+  } else {
+    [_queryCache invalidateTables:changes.tableNames];
+  }
+  [self publishChanges:changes];
+}
+- (NSUInteger) queryCacheGeneration{
+  //Must be read before the query's read transaction begins
+  return _queryCache.generation;
+}
+- (void) readGUIDModeOfStatement:(id <SQLStatementProtocol>)statement database:(SQLDatabase *)database{
+  //Must be called on the database's queue, before the statement's sql is generated. The table's mode comes from the connection's schema, so a statement never runs with a stale mode.
+  if (![statement isKindOfClass:[SQLStatement class]]) return;
+  [(SQLStatement *)statement setTableGUIDMode:[database GUIDModeForTable:[(SQLStatement *)statement tableName]]];
+}
+- (NSArray *) rowsForStatement:(id <SQLStatementProtocol>)statement rowClass:(Class)rowClass database:(SQLDatabase *)database generation:(NSUInteger)generation{
+  [self readGUIDModeOfStatement:statement database:database];
+  NSString *sql = statement.newStatement;
+  NSArray *parameters = statement.parameters;
+  if (_indexAdvisor && [statement isKindOfClass:[SQLStatement class]]) [_indexAdvisor observeStatement:(SQLStatement *)statement sql:sql];
+  NSString *tableName = _queryCache ? [self tableNameForStatement:statement] : nil;
+  if (tableName){
+    NSArray *rows = [_queryCache resultsForSQL:sql parameters:parameters rowClass:rowClass];
+    if (rows) return rows;
+  }
+  NSArray *rows = [database executeQuery:sql withParameters:parameters withClassForRow:rowClass];
+  //An interrupted query's rows are incomplete
+  if (database.interrupted) return nil;
+  if (tableName) [_queryCache cacheResults:rows forSQL:sql parameters:parameters rowClass:rowClass tableName:tableName generation:generation];
+  return rows;
+}
+- (SQLResultSet *) resultSetForStatement:(id <SQLStatementProtocol>)statement database:(SQLDatabase *)database generation:(NSUInteger)generation{
+  [self readGUIDModeOfStatement:statement database:database];
+  NSString *sql = statement.newStatement;
+  NSArray *parameters = statement.parameters;
+  if (_indexAdvisor && [statement isKindOfClass:[SQLStatement class]]) [_indexAdvisor observeStatement:(SQLStatement *)statement sql:sql];
+  NSString *tableName = _queryCache ? [self tableNameForStatement:statement] : nil;
+  if (tableName){
+    SQLResultSet *resultSet = [_queryCache resultsForSQL:sql parameters:parameters rowClass:[SQLResultSet class]];
+    if (resultSet) return resultSet;
+  }
+  SQLResultSet *resultSet = [database executeResultSetQuery:sql withParameters:parameters];
+  if (database.interrupted) return nil;
+  if (tableName) [_queryCache cacheResults:resultSet forSQL:sql parameters:parameters rowClass:[SQLResultSet class] tableName:tableName generation:generation];
+  return resultSet;
+}
+#pragma mark Subscriptions
+static NSMutableArray *SQLCopyRows(NSArray *rows){
+  //Subscriptions keep their own rows, so callers can't modify them
+  NSMutableArray *copies = [NSMutableArray arrayWithCapacity:rows.count];
+  for (NSDictionary *row in rows){
+    [copies addObject:[row mutableCopy]];
+  }
+  return copies;
+}
+- (void) publishChanges:(SQLChangeSet *)changes{
+  //Must be called on the database queue, after the changes are committed
+  NSArray *subscriptions = nil;
+  @synchronized(_subscriptions){
+    [_subscriptions filterUsingPredicate:[NSPredicate predicateWithFormat:@"active == YES"]];
+    subscriptions = [_subscriptions copy];
+  }
+  for (SQLSubscription *subscription in subscriptions){
+    if ([subscription addChanges:changes]) [self refreshSubscription:subscription];
+  }
+}
+- (void) refreshSubscription:(SQLSubscription *)subscription{
+  /* Only one refresh runs at a time for a subscription, so results are delivered in order. Changes committed while a refresh is running are coalesced into a single refresh after it finishes.
+   Refreshes are reads, so they run after the commit that triggered them (on the database queue or a reader started after the commit).
+   */
+  if (![subscription beginRefresh]) return;
+  [self dispatchRead:^(SQLDatabase *database) {
+    NSSet *rowIDs = nil;
+    BOOL full = [subscription takePendingRowIDs:&rowIDs];
+    NSArray *results = nil;
+    NSUInteger generation = [self queryCacheGeneration];
+    [database beginReadTransaction];
+    if (full){
+      results = [self rowsForStatement:subscription.statement rowClass:subscription.rowClass database:database generation:generation];
+      if (subscription.incremental) subscription.rows = results ? SQLCopyRows(results) : nil;
+    } else {
+      results = [self refreshRowIDs:rowIDs ofSubscription:subscription database:database];
+    }
+    [database commit];
+    [subscription recordRefresh:!full];
+    
+    QueueBlock block = subscription.block;
+    if (results && block){
+      dispatch_async(subscription.callbackQueue ?: _callbackQueue, ^{
+        if (subscription.active) block(results);
+      });
+    }
+    if ([subscription endRefresh]) [self refreshSubscription:subscription];
+  } priority:subscription.priority];
+}
+- (NSArray *) refreshRowIDs:(NSSet *)rowIDs ofSubscription:(SQLSubscription *)subscription database:(SQLDatabase *)database{
+  /* Re-queries only the changed rows and merges them into the subscription's rows. Returns the new results or nil if they didn't change.
+   - The GUIDs of the changed rows are looked up first, since changed rows that no longer match the predicates have to be removed
+   - The statement is run with it's predicates grouped together and the changed rowids added, so it only returns the changed rows that match
+   */
+  SQLStatement *statement = subscription.statement;
+  NSMutableArray *rows = subscription.rows;
+  NSArray *rowIDList = rowIDs.allObjects;
+  NSMutableArray *placeholders = [NSMutableArray arrayWithCapacity:rowIDList.count];
+  for (NSUInteger i = 0; i < rowIDList.count; i++){
+    [placeholders addObject:@"?"];
+  }
+  NSString *sql = [NSString stringWithFormat:@"SELECT \"%@\" FROM \"%@\" WHERE rowid IN (%@);", GUIDKey, statement.tableName, [placeholders componentsJoinedByString:@", "]];
+  NSMutableSet *changedGUIDs = [NSMutableSet new];
+  for (NSDictionary *row in [database executeQuery:sql withParameters:rowIDList]){
+    if (row[GUIDKey]) [changedGUIDs addObject:row[GUIDKey]];
+  }
+  
+  SQLStatement *changedStatement = [statement copy];
+  NSArray *predicates = [changedStatement.predicates copy];
+  [changedStatement removeAllPredicates];
+  if (predicates.count) [changedStatement addPredicateGroup:[[SQLPredicateGroup alloc] initWithConnection:SQLConnectAnd predicates:predicates]];
+  SQLPredicateGroup *rowIDGroup = [[SQLPredicateGroup alloc] initWithConnection:SQLConnectAnd predicates:nil];
+  for (NSNumber *rowID in rowIDList){
+    [rowIDGroup addPredicate:[[SQLPredicate alloc] initWithColumn:@"rowid" value:rowID operator:SQLEquals connection:SQLConnectOr]];
+  }
+  [changedStatement addPredicateGroup:rowIDGroup];
+  [self readGUIDModeOfStatement:changedStatement database:database];
+  NSMutableDictionary *matches = [NSMutableDictionary new];
+  NSMutableArray *matchOrder = [NSMutableArray new];
+  for (NSMutableDictionary *row in [database executeQuery:changedStatement.newStatement withParameters:changedStatement.parameters]){
+    id GUID = row[GUIDKey];
+    if (!GUID) continue;
+    matches[GUID] = row;
+    [matchOrder addObject:GUID];
+  }
+  
+  BOOL changed = NO;
+  for (NSInteger i = (NSInteger)rows.count - 1; i >= 0; i--){
+    id GUID = rows[i][GUIDKey];
+    if (!GUID || ![changedGUIDs containsObject:GUID]) continue;
+    NSMutableDictionary *match = matches[GUID];
+    if (match){
+      if (![match isEqualToDictionary:rows[i]]){
+        rows[i] = match;
+        changed = YES;
+      }
+      [matches removeObjectForKey:GUID];
+    } else {
+      [rows removeObjectAtIndex:i];
+      changed = YES;
+    }
+  }
+  for (id GUID in matchOrder){
+    if (!matches[GUID]) continue;
+    [rows addObject:matches[GUID]];
+    changed = YES;
+  }
+  return changed ? SQLCopyRows(rows) : nil;
+}
+#pragma mark Profiling
+- (void) markBlocks:(NSArray *)blocks queuedAtTime:(CFAbsoluteTime)queuedTime{
+  //Update & query blocks both have a queued time. Blocks that were already queued keep their original time.
+  for (id block in blocks){
+    if (![block queuedTime]) [block setQueuedTime:queuedTime];
+  }
+}
+- (void) beginProfilingBlock:(id)block onDatabase:(SQLDatabase *)database{
+  //The time a block waited in the queues is added to the profile of the statement it executes next
+  CFAbsoluteTime queuedTime = [block queuedTime];
+  if (!queuedTime) return;
+  [block setQueuedTime:0];
+  if (database.profiler) database.profileQueueWait = CFAbsoluteTimeGetCurrent() - queuedTime;
+}
+#pragma mark Schema Sync
+- (BOOL) applySchemaOfStatements:(NSArray *)statements createTables:(BOOL)createTables{
+  /* Must be called on the database queue
+   - if the database was already synced to these statements (and it's schema hasn't changed), nothing else is read
+   - otherwise the schema of every table is read in one query, diffed, and all the updates are applied in one transaction along with the new fingerprint
+   */
+  if (!_dbOpen) return NO;
+  NSString *fingerprint = [SQLSchema fingerprintForStatements:statements];
+  //Updating without creating can leave tables out, so it's a different sync
+  if (!createTables) fingerprint = [fingerprint stringByAppendingString:@"-update"];
+  if ([SQLSchema database:_database matchesFingerprint:fingerprint]) return YES;
+  
+  NSMutableArray *tableNames = [NSMutableArray arrayWithCapacity:statements.count];
+  for (SQLStatement *statement in statements){
+    if (statement.tableName) [tableNames addObject:statement.tableName];
+  }
+  SQLSchema *schema = [SQLSchema schemaFromDatabase:_database forTables:tableNames];
+  NSMutableArray *updates = [NSMutableArray new];
+  for (SQLStatement *statement in statements){
+    if (!createTables && ![schema hasTable:statement.tableName]) continue;
+    [updates addObjectsFromArray:[schema updatesForStatement:statement]];
+  }
+  
+  BOOL success = YES;
+  [_database beginImmediateTransaction];
+  for (SQLStatement *update in updates){
+    if ([self executeUpdateStatement:update] == -1){
+      success = NO;
+      break;
+    }
+  }
+  if (success){
+    [SQLSchema recordFingerprint:fingerprint inDatabase:_database];
+    [_database commit];
+  } else {
+    [_database rollback];
+  }
+  [self processCommittedWrites];
+  if (updates.count){
+    [_database clearStatementCache];
+    [self invalidateReaderStatementCaches];
+  }
+  return success;
+}
+- (void) applySchemaOfStatements:(NSArray *)statements createTables:(BOOL)createTables onQueue:(dispatch_queue_t)callbackQueue onCompletion:(SyncBlock)block{
+  //The statements are copied & the queue is kept, since they're used after this returns
+  statements = [[NSArray alloc] initWithArray:statements copyItems:YES];
+  SQLPriority priority = [self currentPriority];
+  if (callbackQueue) dispatch_retain(callbackQueue);
+  dispatch_async(_scheduleQueue, ^{
+    //Pending writes are ahead of the sync (unless they're in a lower lane)
+    if (_pendingWrites.count) [self flushPendingWrites];
+    [_databaseScheduler performWork:^{
+      BOOL success = [self applySchemaOfStatements:statements createTables:createTables];
+      if (block) dispatch_async(callbackQueue ?: _callbackQueue, ^{
+        block(success);
+      });
+      if (callbackQueue) dispatch_release(callbackQueue);
+    } priority:priority];
+  });
+}
+#pragma mark Execution
+- (dispatch_block_t) executeQueryBlock:(SQLQueryBlock *)block onDatabase:(SQLDatabase *)database generation:(NSUInteger)generation{
+  /* Runs the query and returns a block that passes the results to the query's block (or nil if nothing was run)
+   If the query's operation is stopped (cancelled or past a deadline) before it runs, it isn't run. If it's stopped while it runs, the results are dropped. Either way the block is passed nil.
+   */
+  id <SQLStatementProtocol> statement = block.statement;
+  if (statement.SQLType != SQLStatementQuery) return nil;
+  ResultSetBlock resultSetBlock = block.resultSetBlock;
+  QueueBlock currentBlock = block.block;
+  if (!resultSetBlock && !currentBlock) return nil;
+  SQLOperation *operation = block.operation;
+  id sqlResult = nil;
+  if (!operation.stopped){
+    [self beginProfilingBlock:block onDatabase:database];
+    [operation beginStatementOnDatabase:database];
+    if (resultSetBlock){
+      sqlResult = [self resultSetForStatement:statement database:database generation:generation];
+    } else {
+      sqlResult = [self rowsForStatement:statement rowClass:block.rowClass database:database generation:generation];
+    }
+    [operation endStatementOnDatabase:database];
+    //A cached result doesn't execute anything, so the wait mustn't carry over to the next statement
+    database.profileQueueWait = 0;
+    if (operation.stopped) sqlResult = nil;
+  }
+  if (resultSetBlock){
+    return ^{
+      resultSetBlock(sqlResult);
+    };
+  }
+  return ^{
+    currentBlock(sqlResult);
+  };
+}
+- (void) executeQueryBlock:(SQLQueryBlock *)block inQueue:(SQLQueryQueue *)queue onDatabase:(SQLDatabase *)database generation:(NSUInteger)generation group:(dispatch_group_t)group deliveries:(NSMutableArray *)deliveries{
+  //Runs the query, then dispatches the results right away or adds them to the deliveries (if the queue delivers it's results together)
+  dispatch_block_t delivery = [self executeQueryBlock:block onDatabase:database generation:generation];
+  if (!delivery) return;
+  if (deliveries){
+    @synchronized(deliveries){
+      [deliveries addObject:delivery];
+    }
+  } else {
+    dispatch_group_async(group, [self callbackQueueForQuery:block inQueue:queue], delivery);
+  }
+}
+- (void) runQueriesInParallel:(SQLQueryQueue *)queue completion:(CompletionBlock)completion{
+  /* Fans the queries out across the reader pool
+   - All the readers needed are checked out together on the read dispatch queue, so parallel queues can't deadlock each other waiting on readers.
+   - Each reader pulls the next query until there are none left, so the whole thing takes about as long as the slowest query.
+   - For a snapshot, every reader starts it's read transaction in one pass of the database queue, so no updates can be committed between them and they all read the same commit. The read side never waits on the database queue: the queries are fanned out from that pass.
+   - The completion is run after all the results have been delivered.
+   */
+  NSArray *blocks = [queue.blocks copy];
+  BOOL snapshot = (queue.execution == SQLQueryExecutionSnapshot);
+  NSUInteger width = queue.maxConcurrentQueries;
+  NSUInteger readerCount = MIN(MIN(width ?: _readerCount, _readerCount), blocks.count);
+  __block NSUInteger nextBlock = 0;
+  dispatch_group_t resultGroup = dispatch_group_create();
+  NSMutableArray *deliveries = queue.deliversResultsTogether ? [NSMutableArray arrayWithCapacity:blocks.count] : nil;
+  void (^runOnReaders)(NSArray *readers, NSUInteger snapshotGeneration) = ^(NSArray *readers, NSUInteger snapshotGeneration){
+    dispatch_group_t group = dispatch_group_create();
+    for (SQLDatabase *reader in readers){
+      dispatch_group_async(group, _readQueue, ^{
+        NSUInteger generation = snapshotGeneration;
+        if (!snapshot){
+          generation = [self queryCacheGeneration];
+          [reader beginReadTransaction];
+        }
+        while (YES){
+          SQLQueryBlock *block = nil;
+          @synchronized(blocks){
+            if (nextBlock < blocks.count) block = blocks[nextBlock++];
+          }
+          if (!block) break;
+          [self executeQueryBlock:block inQueue:queue onDatabase:reader generation:generation group:resultGroup deliveries:deliveries];
+        }
+        [reader commit];
+        [self returnReader:reader];
+      });
+    }
+    dispatch_group_notify(group, _readQueue, ^{
+      [self deliverResults:deliveries ofQueue:queue group:resultGroup completion:completion];
+      dispatch_release(resultGroup);
+    });
+    dispatch_release(group);
+  };
+  [_readScheduler performWork:^{
+    NSMutableArray *readers = [NSMutableArray arrayWithCapacity:readerCount];
+    for (NSUInteger i = 0; i < readerCount; i++){
+      [readers addObject:[self checkoutReader]];
+    }
+    if (!snapshot){
+      runOnReaders(readers, 0);
+      return;
+    }
+    [_databaseScheduler performWork:^{
+      for (SQLDatabase *reader in readers){
+        [reader beginReadTransaction];
+        [reader executeQuery:@"SELECT 1 FROM sqlite_master LIMIT 1;"];
+      }
+      runOnReaders(readers, [self queryCacheGeneration]);
+    } priority:queue.priority];
+  } priority:queue.priority];
+}
+- (NSInteger) executeUpdateStatement:(id <SQLStatementProtocol>)statement{
+  /* Must be called on the database queue
+   Returns the row id of the last insert, or SQLUpdateResultFailed. Failures are returned instead of raised: updates are run inside transactions (and savepoints) that have to be finished either way.
+   */
+  [self readGUIDModeOfStatement:statement database:_database];
+  int rc = [_database executeUpdateForResultCode:statement.newStatement withParameters:statement.parameters];
+  NSInteger result = (rc == SQLITE_DONE || rc == SQLITE_ROW) ? (NSInteger)[_database lastInsertRowId] : SQLUpdateResultFailed;
+  [self recordWriteForStatement:statement];
+  switch (statement.SQLType) {
+    case SQLStatementAddColumn:
+    case SQLStatementDropTable:
+    case SQLStatementAlterTable:
+    case SQLStatementCreateIndex:
+    case SQLStatementDropIndex:
+      //Schema changes can invalidate cached prepared statements
+      [_database clearStatementCache];
+      break;
+    default:
+      break;
+  }
+  return result;
+}
+- (void) appendBulkParametersForRow:(id)row columnNames:(NSArray *)columnNames GUIDMode:(SQLGUIDMode)GUIDMode date:(NSDate *)date toParameters:(NSMutableArray *)parameters{
+  //Parameter order: GUID, columns, created, modified (see newBulkInsertStatementForRowCount:)
+  BOOL binary = (GUIDMode == SQLGUIDModeBinary);
+  NSString *GUID = nil;
+  if ([row isKindOfClass:[NSDictionary class]]){
+    GUID = row[GUIDKey];
+  } else if (![row isKindOfClass:[NSArray class]] && [row respondsToSelector:@selector(GUID)]){
+    if (!(GUID = [row GUID]) && [row respondsToSelector:@selector(setGUID:)]){
+      GUID = binary ? [SQLGUID newTimeOrderedGUID] : [SQLStatement newGUID];
+      [row setGUID:GUID];
+    }
+  }
+  if (!GUID) GUID = binary ? [SQLGUID newTimeOrderedGUID] : [SQLStatement newGUID];
+  [parameters addObject:binary ? ([SQLGUID dataFromGUID:GUID] ?: GUID) : GUID];
+  
+  if ([row isKindOfClass:[NSArray class]]){
+    NSArray *values = row;
+    for (NSUInteger i = 0; i < columnNames.count; i++){
+      [parameters addObject:(i < values.count) ? values[i] : [NSNull null]];
+    }
+  } else {
+    for (NSString *columnName in columnNames){
+      [parameters addObject:[row valueForKey:columnName] ?: [NSNull null]];
+    }
+  }
+  [parameters addObject:date];
+  [parameters addObject:date];
+}
+- (SQLBulkResult *) executeBulkInsert:(SQLStatement *)template rows:(NSArray *)rows{
+  /* Must be called on the database queue
+   - Rows are inserted in chunks sized to sqlite's parameter limit. A full chunk always has the same sql, so the statement cache reuses the prepared statement.
+   - A failed chunk is retried a row at a time to find the failed rows. FAIL & ROLLBACK conflicts can partially apply a chunk, so those are always inserted a row at a time.
+   - A ROLLBACK conflict ends the transaction, in which case nothing was inserted. So it's refused if the database is already in a transaction (that isn't ours to roll back): every row is reported as failed and nothing is run.
+   */
+  SQLBulkResult *result = [[SQLBulkResult alloc] initWithRowCount:rows.count];
+  if (!rows.count) return result;
+  BOOL ownsTransaction = ![_database inTransaction];
+  if (!ownsTransaction && template.conflict == SQLConflictRollback){
+    [result.failures addIndexesInRange:NSMakeRange(0, rows.count)];
+    return result;
+  }
+  [self readGUIDModeOfStatement:template database:_database];
+  NSArray *columnNames = template.bulkInsertColumnNames;
+  NSUInteger parametersPerRow = columnNames.count + 3;
+  NSUInteger rowsPerStatement = 1;
+  if (template.conflict != SQLConflictFail && template.conflict != SQLConflictRollback){
+    rowsPerStatement = MAX(MIN(BulkInsertMaxRowsPerStatement, [_database maximumParameterCount] / parametersPerRow), 1);
+  }
+  NSString *rowSQL = [template newBulkInsertStatementForRowCount:1];
+  NSString *chunkSQL = (rowsPerStatement > 1) ? [template newBulkInsertStatementForRowCount:rowsPerStatement] : rowSQL;
+  NSDate *now = [NSDate date];
+  
+  if (ownsTransaction) [_database beginImmediateTransaction];
+  NSUInteger index = 0;
+  while (index < rows.count && !result.rolledBack){
+    @autoreleasepool {
+      NSUInteger count = MIN(rowsPerStatement, rows.count - index);
+      NSMutableArray *parameters = [NSMutableArray arrayWithCapacity:count * parametersPerRow];
+      for (NSUInteger i = index; i < index + count; i++){
+        [self appendBulkParametersForRow:rows[i] columnNames:columnNames GUIDMode:template.GUIDMode date:now toParameters:parameters];
+      }
+      NSString *sql = (count == rowsPerStatement) ? chunkSQL : [template newBulkInsertStatementForRowCount:count];
+      result.statementCount++;
+      if ([_database executeUpdateForResultCode:sql withParameters:parameters] == SQLITE_DONE){
+        result.insertedCount += [_database changes];
+      } else {
+        for (NSUInteger i = 0; i < count; i++){
+          if (count > 1){
+            result.statementCount++;
+            NSArray *rowParameters = [parameters subarrayWithRange:NSMakeRange(i * parametersPerRow, parametersPerRow)];
+            if ([_database executeUpdateForResultCode:rowSQL withParameters:rowParameters] == SQLITE_DONE){
+              result.insertedCount += [_database changes];
+              continue;
+            }
+          }
+          [result.failures addIndex:index + i];
+          if (![_database inTransaction]){
+            result.rolledBack = YES;
+            break;
+          }
+        }
+      }
+      index += count;
+    }
+  }
+  if (result.rolledBack){
+    result.insertedCount = 0;
+    [result.failures addIndexesInRange:NSMakeRange(0, rows.count)];
+  } else if (ownsTransaction){
+    [_database commit];
+  }
+  if (_database.tracksChanges) [_writtenTables addObject:template.tableName];
+  if (ownsTransaction) [self processCommittedWrites];
+  return result;
 }
 #pragma mark - Protocol Methods
 - (id) copyWithZone:(NSZone *)zone{
@@ -167,196 +1253,483 @@ static NSMutableDictionary *DBManagers(){
 - (NSString *) databasePath{
   return _database.pathToDatabase;
 }
+- (BOOL) concurrentReadsEnabled{
+  return _readers != nil;
+}
+- (NSUInteger) readerCount{
+  return _readerCount;
+}
+- (BOOL) queryCacheEnabled{
+  return _queryCache != nil;
+}
+- (dispatch_queue_t) callbackQueue{
+  return _callbackQueue;
+}
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue ?: dispatch_get_main_queue());
+}
+- (NSTimeInterval) priorityAgingInterval{
+  return _priorityAgingInterval;
+}
+- (void) setPriorityAgingInterval:(NSTimeInterval)priorityAgingInterval{
+  _priorityAgingInterval = MAX(priorityAgingInterval, 0);
+  _databaseScheduler.agingInterval = _priorityAgingInterval;
+  _readScheduler.agingInterval = _priorityAgingInterval;
+}
 #pragma mark - Standard Methods
 - (void) openDatabase{
   if (!_dbOpen){
     [_managers removeAllObjects];
     [_database open];
+    [self performOnAllReaders:^(SQLDatabase *reader) {
+      [reader open];
+    }];
     _dbOpen = YES;
   }
 }
 - (void) closeDatabase{
   if (_dbOpen){
+    [self performOnAllReaders:^(SQLDatabase *reader) {
+      [reader close];
+    }];
     [_database close];
     _dbOpen = NO;
   }
 }
-- (void) queueUpdate:(id <SQLStatementProtocol> )statement withBlock:(ExecBlock)blockToProcess{
-  [_updateQueue addSQLUpdate:statement withBlock:blockToProcess];
-  [self setUpdateNeedsProcessing];
+- (void) performWithPriority:(SQLPriority)priority block:(CompletionBlock)block{
+  if (!block) return;
+  NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+  NSNumber *enclosingPriority = threadDictionary[PriorityKey];
+  threadDictionary[PriorityKey] = @(MIN(priority, SQLPriorityInteractive));
+  block();
+  if (enclosingPriority){
+    threadDictionary[PriorityKey] = enclosingPriority;
+  } else {
+    [threadDictionary removeObjectForKey:PriorityKey];
+  }
+}
+- (BOOL) enableConcurrentReadsWithReaderCount:(NSUInteger)readerCount{
+  if (!_dbOpen || _readers || readerCount < 1) return NO;
+  __block BOOL walEnabled = NO;
+  dispatch_sync(_databaseQueue, ^{
+    walEnabled = [_database enableWriteAheadLogging];
+  });
+  if (!walEnabled) return NO;
+  
+  NSMutableArray *readers = [NSMutableArray arrayWithCapacity:readerCount];
+  for (NSUInteger i = 0; i < readerCount; i++){
+    SQLDatabase *reader = [[SQLDatabase alloc] initWithPath:_database.pathToDatabase readOnly:YES options:_database.options];
+    reader.profiler = _profiler;
+    [readers addObject:reader];
+  }
+  _readerCount = readerCount;
+  _readerSemaphore = dispatch_semaphore_create(readerCount);
+  _readQueue = dispatch_queue_create(DBReadQueue, DISPATCH_QUEUE_CONCURRENT);
+  _readDispatchQueue = dispatch_queue_create(DBReadDispatchQueue, DISPATCH_QUEUE_SERIAL);
+  _readScheduler = [[SQLPriorityScheduler alloc] initWithQueue:_readDispatchQueue];
+  _readScheduler.agingInterval = self.priorityAgingInterval;
+  _readerSchemaGeneration = 0;
+  _readerGenerations = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+  _readers = readers;
+  return YES;
+}
+- (SQLOperation *) queueUpdate:(id <SQLStatementProtocol> )statement withBlock:(ExecBlock)blockToProcess{
+  return [self queueUpdate:statement onQueue:NULL withBlock:blockToProcess];
+}
+- (SQLOperation *) queueUpdate:(id<SQLStatementProtocol>)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(ExecBlock)blockToProcess{
+  if (!statement || statement.SQLType == SQLStatementQuery) return nil;
+  SQLUpdateBlock *updateBlock = [[SQLUpdateBlock alloc] initWithConstructor:statement block:blockToProcess];
+  updateBlock.callbackQueue = callbackQueue;
+  SQLOperation *operation = [self operationForBlocks:@[updateBlock] timeout:0 statementTimeout:0];
+  [self scheduleWriteRequest:nil orUpdateBlock:updateBlock immediate:NO];
+  return operation;
+}
+- (SQLOperation *) queueQuery:(id <SQLStatementProtocol> )statement withBlock:(QueueBlock)blockToProcess{
+  return [self queueQuery:statement usingClassForRow:nil onQueue:NULL withBlock:blockToProcess];
+}
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass withBlock:(QueueBlock)blockToProcess{
+  return [self queueQuery:statement usingClassForRow:rowClass onQueue:NULL withBlock:blockToProcess];
+}
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)blockToProcess{
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.callbackQueue = callbackQueue;
+  queue.priority = [self currentPriority];
+  [queue addSQLQuery:statement usingRowClass:rowClass withBlock:blockToProcess];
+  return [self queueQueries:queue];
+}
+- (SQLOperation *) queueQuery:(id<SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)blockToProcess{
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.priority = [self currentPriority];
+  [queue addSQLQuery:statement withResultSetBlock:blockToProcess];
+  return [self queueQueries:queue];
+}
+- (SQLOperation *) queueQueries:(SQLQueryQueue *)queue{
+  if ([queue count] < 1) return nil;
+  SQLOperation *operation = [self operationForBlocks:queue.blocks timeout:queue.timeout statementTimeout:queue.statementTimeout];
+  if (queue.execution != SQLQueryExecutionSerial || queue.deliversResultsTogether){
+    //These queues keep their own policy, so they aren't merged with the other queued queries
+    SQLQueryQueue *ownQueue = [SQLQueryQueue queueWithQueue:queue];
+    [queue removeAllStatements];
+    if (_profiler) [self markBlocks:ownQueue.blocks queuedAtTime:CFAbsoluteTimeGetCurrent()];
+    dispatch_async(_scheduleQueue, ^{
+      [self runQueriesOfQueue:ownQueue completion:nil];
+    });
+    return operation;
+  }
+  //The blocks are merged with queries from other queues, so each one keeps it's queue's callback queue
+  for (SQLQueryBlock *block in queue){
+    if (!block.callbackQueue) block.callbackQueue = queue.callbackQueue;
+  }
+  if (_profiler) [self markBlocks:queue.blocks queuedAtTime:CFAbsoluteTimeGetCurrent()];
+  @synchronized(self){
+    [_queryQueues[MIN(queue.priority, SQLPriorityInteractive)] appendQueriesFromQueue:queue];
+  }
+  [queue removeAllStatements];
+  [self setQueryNeedsProcessing];
+  return operation;
+}
+- (SQLOperation *) queueUpdates:(SQLUpdateQueue *)queue{
+  if ([queue count] < 1) return nil;
+  SQLOperation *operation = [self operationForBlocks:queue.blocks timeout:queue.timeout statementTimeout:queue.statementTimeout];
+  //The queue is kept together (not merged) so it's rollbackOnFail still applies to it
+  SQLUpdateQueue *pendingQueue = [SQLUpdateQueue queueWithQueue:queue];
+  [queue removeAllStatements];
+  [self scheduleWriteRequest:[[SQLWriteRequest alloc] initWithQueue:pendingQueue completion:nil mergeable:NO] orUpdateBlock:nil immediate:NO];
+  return operation;
+}
+- (SQLOperation *) runImmediateUpdate:(id <SQLStatementProtocol> )statement withBlock:(ExecBlock)blockToProcess{
+  return [self runImmediateUpdate:statement onQueue:NULL withBlock:blockToProcess];
+}
+- (SQLOperation *) runImmediateUpdate:(id<SQLStatementProtocol>)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(ExecBlock)blockToProcess{
+  if (!_dbOpen || !statement || statement.SQLType == SQLStatementQuery) return nil;
+  SQLUpdateBlock *updateBlock = [[SQLUpdateBlock alloc] initWithConstructor:statement block:blockToProcess];
+  updateBlock.callbackQueue = callbackQueue;
+  SQLOperation *operation = [self operationForBlocks:@[updateBlock] timeout:0 statementTimeout:0];
+  [self scheduleWriteRequest:nil orUpdateBlock:updateBlock immediate:YES];
+  return operation;
+}
+- (SQLWriteMetrics *) writeMetrics{
+  return [_writeMetrics copy];
+}
+- (void) resetWriteMetrics{
+  [_writeMetrics reset];
+}
+- (void) enableQueryCacheWithByteLimit:(NSUInteger)byteLimit{
+  if (_queryCache || byteLimit < 1) return;
+  SQLQueryCache *queryCache = [[SQLQueryCache alloc] initWithByteLimit:byteLimit];
+  dispatch_sync(_databaseQueue, ^{
+    _queryCache = queryCache;
+    _database.tracksChanges = YES;
+  });
+}
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement withBlock:(QueueBlock)block{
+  return [self subscribeToQuery:statement usingRowClass:nil withBlock:block];
+}
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)block{
+  return [self subscribeToQuery:statement usingRowClass:rowClass onQueue:NULL withBlock:block];
+}
+- (SQLSubscription *) subscribeToQuery:(SQLStatement *)statement usingRowClass:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)block{
+  if (!_dbOpen || !block || statement.SQLType != SQLStatementQuery) return nil;
+  SQLSubscription *subscription = [[SQLSubscription alloc] initWithStatement:statement rowClass:rowClass block:block];
+  subscription.priority = [self currentPriority];
+  subscription.callbackQueue = callbackQueue;
+  dispatch_sync(_databaseQueue, ^{
+    _database.tracksChanges = YES;
+  });
+  @synchronized(_subscriptions){
+    [_subscriptions addObject:subscription];
+  }
+  //The initial results
+  [self refreshSubscription:subscription];
+  return subscription;
+}
+- (void) setProfiler:(SQLProfiler *)profiler{
+  _profiler = profiler;
+  dispatch_sync(_databaseQueue, ^{
+    _database.profiler = profiler;
+  });
+  [self performOnAllReaders:^(SQLDatabase *reader) {
+    reader.profiler = profiler;
+  }];
 }
-- (void) queueQuery:(id <SQLStatementProtocol> )statement withBlock:(QueueBlock)blockToProcess{
-  [_queryQueue addSQLQuery:statement withBlock:blockToProcess];
-  [self setQueryNeedsProcessing];
+- (void) adviseIndexesWithBlock:(void (^)(NSArray *))block{
+  if (!_dbOpen) return;
+  SQLIndexAdvisor *indexAdvisor = _indexAdvisor;
+  //Pending writes go first, so the queries are explained against the current schema
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWork:^{
+    NSArray *advice = [indexAdvisor adviceUsingDatabase:_database] ?: @[];
+    BOOL created = NO;
+    for (SQLIndexAdvice *indexAdvice in advice){
+      if (!indexAdvice.created) continue;
+      [self recordWriteForStatement:indexAdvice.proposedIndex];
+      created = YES;
+    }
+    if (created){
+      [_database clearStatementCache];
+      [self processCommittedWrites];
+      [self invalidateReaderStatementCaches];
+    }
+    if (block) dispatch_async(_callbackQueue, ^{
+      block(advice);
+    });
+  } priority:[self currentPriority]];
 }
-- (void) queueQuery:(id<SQLStatementProtocol>)statement usingClassForRow:(Class)rowClass withBlock:(QueueBlock)blockToProcess{
-  [_queryQueue addSQLQuery:statement usingRowClass:rowClass withBlock:blockToProcess];
-  [self setQueryNeedsProcessing];
+- (SQLQueryCacheMetrics *) queryCacheMetrics{
+  return _queryCache.metrics;
 }
-- (void) queueQueries:(SQLQueryQueue *)queue{
-  [_queryQueue appendQueriesFromQueue:queue];
-  [queue removeAllStatements];
-  [self setQueryNeedsProcessing];
+- (void) resetQueryCacheMetrics{
+  [_queryCache resetMetrics];
 }
-- (void) queueUpdates:(SQLUpdateQueue *)queue{
-  [_updateQueue appendUpdatesFromQueue:queue];
-  [queue removeAllStatements];
-  [self setUpdateNeedsProcessing];
+- (void) clearQueryCache{
+  [_queryCache removeAllResults];
 }
-- (void) runImmediateUpdate:(id <SQLStatementProtocol> )statement withBlock:(ExecBlock)blockToProcess{
-  SQLUpdateQueue *queue = [[SQLUpdateQueue alloc] init];
-  [queue addSQLUpdate:statement withBlock:blockToProcess];
-  [self runUpdateQueue:queue withCompletionBlock:nil];
+- (SQLOperation *) runImmediateQuery:(id <SQLStatementProtocol> )statement withBlock:(QueueBlock)blockToProcess{
+  return [self runImmediateQuery:statement usingRowClass:nil onQueue:NULL withBlock:blockToProcess];
 }
-- (void) runImmediateQuery:(id <SQLStatementProtocol> )statement withBlock:(QueueBlock)blockToProcess{
-  SQLQueryQueue *queue = [[SQLQueryQueue alloc] init];
-  [queue addSQLQuery:statement withBlock:blockToProcess];
-  [self runQueryQueue:queue];
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)blockToProcess{
+  return [self runImmediateQuery:statement usingRowClass:rowClass onQueue:NULL withBlock:blockToProcess];
 }
-- (void) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass withBlock:(QueueBlock)blockToProcess{
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass onQueue:(dispatch_queue_t)callbackQueue withBlock:(QueueBlock)blockToProcess{
   SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.callbackQueue = callbackQueue;
+  queue.priority = [self currentPriority];
   [queue addSQLQuery:statement usingRowClass:rowClass withBlock:blockToProcess];
-  [self runQueryQueue:queue];
+  return [self runQueryQueue:queue];
+}
+- (SQLOperation *) runImmediateQuery:(id<SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)blockToProcess{
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.priority = [self currentPriority];
+  [queue addSQLQuery:statement withResultSetBlock:blockToProcess];
+  return [self runQueryQueue:queue];
 }
-- (void) runUpdateQueue:(SQLUpdateQueue *)queue withCompletionBlock:(void (^)(BOOL success))blockToProcess{
+- (SQLOperation *) runUpdateQueue:(SQLUpdateQueue *)queue withCompletionBlock:(void (^)(BOOL success))blockToProcess{
+  if (!_dbOpen || [queue count] < 1) return nil;
+  SQLOperation *operation = [self operationForBlocks:queue.blocks timeout:queue.timeout statementTimeout:queue.statementTimeout];
+  [self scheduleWriteRequest:[[SQLWriteRequest alloc] initWithQueue:queue completion:blockToProcess mergeable:NO] orUpdateBlock:nil immediate:YES];
+  return operation;
+}
+- (SQLOperation *) runQueryQueue:(SQLQueryQueue *)queue{
+  return [self runQueryQueue:queue withCompletionBlock:nil];
+}
+- (SQLOperation *) runQueryQueue:(SQLQueryQueue *)queue withCompletionBlock:(CompletionBlock)block{
+  if (!_dbOpen || [queue count] < 1) return nil;
+  SQLOperation *operation = [self operationForBlocks:queue.blocks timeout:queue.timeout statementTimeout:queue.statementTimeout];
+  [self runQueriesOfQueue:queue completion:block];
+  return operation;
+}
+- (void) runQueriesOfQueue:(SQLQueryQueue *)queue completion:(CompletionBlock)block{
+  //Runs a queue that's already been submitted (it's blocks have their operations)
   if (!_dbOpen) return;
-  if (queue == _updateQueue) {
-    _updateQueue = [SQLUpdateQueue new];
-  }
+  if (_profiler) [self markBlocks:queue.blocks queuedAtTime:CFAbsoluteTimeGetCurrent()];
   
   if ([queue count] > 0){
-    dispatch_async(_databaseQueue, ^{
-      if (queue.rollbackOnFail){
-        BOOL rollback = NO;
-        [_database beginImmediateTransaction];
-        for (SQLUpdateBlock *block in queue) {
-          id <SQLStatementProtocol> statement = block.statement;
-          if (statement.SQLType == SQLStatementQuery) continue;
-          NSInteger sqlResult = [_database executeUpdate:statement.newStatement withParameters:statement.parameters];
-          block.result = sqlResult;
-          if (sqlResult == -1 && queue.rollbackOnFail){
-            rollback = YES;
-            break;
-          }
-        }
-        if (rollback){
-          [_database rollback];
-          if (blockToProcess) {
-            blockToProcess(NO);
-          }
-        } else {
-          [_database commit];
-          for (SQLUpdateBlock *block in queue){
-            ExecBlock currentBlock = block.block;
-            if (currentBlock){
-              dispatch_async(_operationsQueue, ^{
-                currentBlock(block.result);
-                block.statement.GUID = nil;
-              });
-            } else {
-              block.statement.GUID = nil;
-            }
-          }
-          if (blockToProcess) {
-            blockToProcess(YES);
-          }
-          [queue removeAllStatements];
-        }
-      } else {
-        [_database beginImmediateTransaction];
-        for (SQLUpdateBlock *block in queue) {
-          id <SQLStatementProtocol> statement = block.statement;
-          if (statement.SQLType == SQLStatementQuery) continue;
-          NSInteger sqlResult = [_database executeUpdate:statement.newStatement withParameters:statement.parameters];
-          ExecBlock currentBlock = block.block;
-          if (currentBlock){
-            dispatch_async(_operationsQueue, ^{
-              currentBlock(sqlResult);
-              statement.GUID = nil;
-            });
-          } else {
-            statement.GUID = nil;
-          }
-        }
-        [_database commit];
-        if (blockToProcess) {
-          blockToProcess(YES);
-        }
-        [queue removeAllStatements];
+    if (_readers && queue.execution != SQLQueryExecutionSerial){
+      [self runQueriesInParallel:queue completion:block];
+      [queue removeAllStatements];
+      return;
+    }
+    [self dispatchRead:^(SQLDatabase *database) {
+      dispatch_group_t resultGroup = dispatch_group_create();
+      NSMutableArray *deliveries = queue.deliversResultsTogether ? [NSMutableArray arrayWithCapacity:queue.count] : nil;
+      NSUInteger generation = [self queryCacheGeneration];
+      [database beginReadTransaction];
+      for (SQLQueryBlock *queryBlock in queue){
+        [self executeQueryBlock:queryBlock inQueue:queue onDatabase:database generation:generation group:resultGroup deliveries:deliveries];
       }
+      [database commit];
+      [self deliverResults:deliveries ofQueue:queue group:resultGroup completion:block];
+      dispatch_release(resultGroup);
+      [queue removeAllStatements];
+    } priority:queue.priority];
+  }
+}
+- (void) streamQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass batchSize:(NSUInteger)batchSize withBatchBlock:(StreamBlock)batchBlock completion:(void (^)(BOOL))completion{
+  if (!_dbOpen || !batchBlock || statement.SQLType != SQLStatementQuery) return;
+  SQLStream *stream = [[SQLStream alloc] initWithStatement:statement rowClass:rowClass batchSize:batchSize priority:[self currentPriority] callbackQueue:_callbackQueue batchBlock:batchBlock completion:completion];
+  if (!_readers){
+    [_databaseScheduler performWork:^{
+      [self startStream:stream onDatabase:_database];
+    } priority:stream.priority];
+    return;
+  }
+  //The reader is kept until the stream finishes, so it isn't returned like dispatchRead:priority: would
+  [_readScheduler performWork:^{
+    SQLDatabase *reader = [self checkoutReader];
+    dispatch_async(_readQueue, ^{
+      [self startStream:stream onDatabase:reader];
+    });
+  } priority:stream.priority];
+}
+- (void) startStream:(SQLStream *)stream onDatabase:(SQLDatabase *)database{
+  /* A reader keeps one read transaction (so one snapshot) for the whole stream. The database can't, since other work is run on it between passes and starts it's own transactions, so rows written while the stream is running may or may not be included.
+   */
+  stream.database = database;
+  if (database != _database) [database beginReadTransaction];
+  [self readGUIDModeOfStatement:stream.statement database:database];
+  id <SQLStatementProtocol> statement = stream.statement;
+  stream.cursor = [database cursorForQuery:statement.newStatement withParameters:statement.parameters rowClass:stream.rowClass];
+  [self stepStream:stream];
+}
+- (void) scheduleStreamPass:(SQLStream *)stream{
+  //Without a reader, each pass is scheduled on the database queue like any other work, so queries & updates run between batches
+  if (stream.database == _database){
+    [_databaseScheduler performWork:^{
+      [self stepStream:stream];
+    } priority:stream.priority];
+  } else {
+    dispatch_async(_readQueue, ^{
+      [self stepStream:stream];
     });
   }
 }
-- (void) runQueryQueue:(SQLQueryQueue *)queue{
-  [self runQueryQueue:queue withCompletionBlock:nil];
+- (void) stepStream:(SQLStream *)stream{
+  /* Reads one batch per pass and never waits on the consumer.
+   Backpressure: once the limit of batches are waiting on the callback queue, no pass is scheduled. The consumer schedules the next pass when it finishes a batch.
+   */
+  NSArray *batch = nil;
+  if (_dbOpen && !stream.cancelled){
+    @autoreleasepool {
+      batch = [stream.cursor nextBatch:stream.batchSize];
+    }
+  }
+  if (!batch.count){
+    [self finishStream:stream];
+    return;
+  }
+  BOOL full = NO;
+  @synchronized(stream){
+    stream.batchesInFlight++;
+    full = (stream.batchesInFlight >= StreamBatchesInFlight);
+    stream.paused = full;
+  }
+  dispatch_async(stream.streamQueue, ^{
+    if (!stream.cancelled && !stream.batchBlock(batch)) stream.cancelled = YES;
+    BOOL resume = NO;
+    @synchronized(stream){
+      stream.batchesInFlight--;
+      resume = stream.paused;
+      stream.paused = NO;
+    }
+    if (resume) [self scheduleStreamPass:stream];
+  });
+  if (!full) [self scheduleStreamPass:stream];
 }
-- (void) runQueryQueue:(SQLQueryQueue *)queue withCompletionBlock:(CompletionBlock)block{
-  if (!_dbOpen) return;
-  if (queue == _queryQueue){
-    _queryQueue = [SQLQueryQueue new];
+- (void) finishStream:(SQLStream *)stream{
+  [stream.cursor close];
+  stream.cursor = nil;
+  SQLDatabase *database = stream.database;
+  if (database != _database){
+    [database commit];
+    [self returnReader:database];
   }
-  
-  if ([queue count] > 0){
-    dispatch_async(_databaseQueue, ^{
-      [_database beginReadTransaction];
-      for (SQLQueryBlock *block in queue){
-        id <SQLStatementProtocol> statement = block.statement;
-        if (statement.SQLType != SQLStatementQuery) continue;
-        QueueBlock currentBlock = block.block;
-        if (!currentBlock) continue;
-        NSArray *sqlResult = [_database executeQuery:statement.newStatement withParameters:statement.parameters withClassForRow:block.rowClass];
-        dispatch_async(_operationsQueue, ^{
-          currentBlock(sqlResult); 
-        });
-      }
-      [_database commit];
-      if (block) {
-        dispatch_async(_operationsQueue, block);
-      }
-      [queue removeAllStatements];
+  stream.database = nil;
+  if (stream.completion){
+    //The stream queue is serial, so this runs after any outstanding batches
+    dispatch_async(stream.streamQueue, ^{
+      stream.completion(!stream.cancelled);
     });
   }
 }
+- (void) bulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement withBlock:(BulkBlock)block{
+  [self bulkInsertRows:rows usingStatement:statement onQueue:NULL withBlock:block];
+}
+- (void) bulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement onQueue:(dispatch_queue_t)callbackQueue withBlock:(BulkBlock)block{
+  if (!_dbOpen || !statement) return;
+  SQLStatement *template = [statement copy];
+  rows = [rows copy];
+  if (callbackQueue) dispatch_retain(callbackQueue);
+  [_databaseScheduler performWork:^{
+    SQLBulkResult *result = [self executeBulkInsert:template rows:rows];
+    if (block){
+      dispatch_async(callbackQueue ?: _callbackQueue, ^{
+        block(result);
+      });
+    }
+    if (callbackQueue) dispatch_release(callbackQueue);
+  } priority:[self currentPriority]];
+}
+- (void) bulkInsertObjects:(NSArray *)objects usingProtocol:(Protocol *)proto withBlock:(BulkBlock)block{
+  [self bulkInsertRows:objects usingStatement:[SQLStatementConstructor constructStatement:SQLStatementInsert fromProtocol:proto] withBlock:block];
+}
+- (SQLBulkResult *) runSynchronousBulkInsertRows:(NSArray *)rows usingStatement:(SQLStatement *)statement{
+  if (!_dbOpen || !statement) return nil;
+  SQLStatement *template = [statement copy];
+  __block SQLBulkResult *result = nil;
+  [_databaseScheduler performWorkAndWait:^{
+    result = [self executeBulkInsert:template rows:rows];
+  } priority:[self currentPriority]];
+  return result;
+}
+- (BOOL) migrateTable:(NSString *)tableName toGUIDMode:(SQLGUIDMode)mode{
+  if (!_dbOpen || !tableName.length) return NO;
+  __block BOOL success = NO;
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWorkAndWait:^{
+    success = [_database migrateTable:tableName toGUIDMode:mode];
+    if (_database.tracksChanges) [_rewrittenTables addObjectsFromArray:@[tableName, SchemaTableName]];
+    [self processCommittedWrites];
+  } priority:[self currentPriority]];
+  //Readers may have statements prepared against (and GUID modes read from) the old table
+  [self invalidateReaderStatementCaches];
+  return success;
+}
 - (NSArray *) runSynchronousQuery:(id <SQLStatementProtocol> )statement{
   if (!_dbOpen) return nil;
   __block NSArray *sqlResult = nil;
-  dispatch_sync(_databaseQueue, ^{
-    [_database beginReadTransaction];
-    sqlResult = [_database executeQuery:statement.newStatement withParameters:statement.parameters];
-    [_database commit];
-  });
+  [self performSynchronousRead:^(SQLDatabase *database) {
+    NSUInteger generation = [self queryCacheGeneration];
+    [database beginReadTransaction];
+    sqlResult = [self rowsForStatement:statement rowClass:nil database:database generation:generation];
+    [database commit];
+  }];
   
   return sqlResult;
 }
 - (NSArray *) runSynchronousQuery:(id<SQLStatementProtocol>)statement usingRowClass:(Class)rowClass{
   if (!_dbOpen) return nil;
   __block NSArray *sqlResult = nil;
-  dispatch_sync(_databaseQueue, ^{
-    [_database beginReadTransaction];
-    sqlResult = [_database executeQuery:statement.newStatement withParameters:statement.parameters withClassForRow:rowClass];
-    [_database commit];
-  });
+  [self performSynchronousRead:^(SQLDatabase *database) {
+    NSUInteger generation = [self queryCacheGeneration];
+    [database beginReadTransaction];
+    sqlResult = [self rowsForStatement:statement rowClass:rowClass database:database generation:generation];
+    [database commit];
+  }];
   return sqlResult;
 }
+- (SQLResultSet *) runSynchronousResultSetQuery:(id<SQLStatementProtocol>)statement{
+  if (!_dbOpen) return nil;
+  __block SQLResultSet *resultSet = nil;
+  [self performSynchronousRead:^(SQLDatabase *database) {
+    NSUInteger generation = [self queryCacheGeneration];
+    [database beginReadTransaction];
+    resultSet = [self resultSetForStatement:statement database:database generation:generation];
+    [database commit];
+  }];
+  return resultSet;
+}
 - (NSUInteger) runSynchronousUpdate:(id <SQLStatementProtocol> )statement{
   if (!_dbOpen) return -1;
   __block NSUInteger result = 0;
-  dispatch_sync(_databaseQueue, ^{
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWorkAndWait:^{
     [_database beginImmediateTransaction];
-    result = [_database executeUpdate:statement.newStatement withParameters:statement.parameters];
+    result = [self executeUpdateStatement:statement];
     [_database commit];
+    [self processCommittedWrites];
     statement.GUID = nil;
-  });
+  } priority:[self currentPriority]];
   return result;
 }
 - (NSArray *) runSynchronousUpdateQueue:(SQLUpdateQueue *)updates{
   __block NSMutableArray *results = [NSMutableArray new];
-  dispatch_sync(_databaseQueue, ^{
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWorkAndWait:^{
     if (updates.rollbackOnFail){
       BOOL rollback = NO;
       [_database beginImmediateTransaction];
       for (SQLUpdateBlock *update in updates){
-        NSInteger result = [_database executeUpdate:update.statement.newStatement withParameters:update.statement.parameters];
+        NSInteger result = [self executeUpdateStatement:update.statement];
         if (result == -1 && updates.rollbackOnFail){
           rollback = YES;
           break;
@@ -366,168 +1739,111 @@ static NSMutableDictionary *DBManagers(){
       }
       if (rollback){
         [_database rollback];
+        [self processCommittedWrites];
         results = nil;
       } else {
         for (SQLUpdateBlock *update in updates){
           [results addObject:@(update.result)];
           if (update.block){
-            dispatch_async(_operationsQueue, ^{
+            dispatch_async([self callbackQueueForUpdate:update inQueue:updates], ^{
               update.block(update.result);
             });
           }
         }
         [_database commit];
+        [self processCommittedWrites];
         [updates removeAllStatements];
       }
     } else {
       [_database beginImmediateTransaction];
       for (SQLUpdateBlock *update in updates){
-        NSInteger result = [_database executeUpdate:update.statement.newStatement withParameters:update.statement.parameters];
+        NSInteger result = [self executeUpdateStatement:update.statement];
         [results addObject:@(result)];
         update.statement.GUID = nil;
         if (update.block){
-          dispatch_async(_operationsQueue, ^{
+          dispatch_async([self callbackQueueForUpdate:update inQueue:updates], ^{
             update.block(result);
           });
         }
       }
       [_database commit];
+      [self processCommittedWrites];
       [updates removeAllStatements];
     }
-  });
+  } priority:updates.priority];
   return results;
 }
 
-- (void) updateOrCreateTableToColumnsInStatement:(SQLStatement *)statement{
-  NSString *tableName = statement.tableName;
-  if (!tableName) return;
-  
-  NSArray *results = [self runSynchronousQuery:[SQLStatement getAllTables]];
-  
-  BOOL tableExists = ({
-    BOOL tableFound = NO;
-    for (id table in results){
-      NSString *tName = [table isKindOfClass:[NSString class]] ? table :
-      [table isKindOfClass:[NSDictionary class]] ? table[@"name"] : nil;
-      if ([tName isEqualToString:tableName]){
-        tableFound = YES;
-        break;
-      }
-    }
-    tableFound;
+- (BOOL) syncSchemaToStatements:(NSArray *)statements{
+  if (!_dbOpen || !statements.count) return NO;
+  __block BOOL success = NO;
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWorkAndWait:^{
+    success = [self applySchemaOfStatements:statements createTables:YES];
+  } priority:[self currentPriority]];
+  return success;
+}
+- (void) syncSchemaToStatements:(NSArray *)statements onCompletion:(SyncBlock)block{
+  [self syncSchemaToStatements:statements onQueue:NULL onCompletion:block];
+}
+- (void) syncSchemaToStatements:(NSArray *)statements onQueue:(dispatch_queue_t)callbackQueue onCompletion:(SyncBlock)block{
+  if (!_dbOpen || !statements.count){
+    if (block) block(NO);
+    return;
+  }
+  [self applySchemaOfStatements:statements createTables:YES onQueue:callbackQueue onCompletion:block];
+}
+- (NSUInteger) userVersion{
+  if (!_dbOpen) return 0;
+  __block NSUInteger userVersion = 0;
+  dispatch_sync(_databaseQueue, ^{
+    userVersion = _database.userVersion;
   });
-  
-  if (tableExists){
-    statement.tableInfo = YES;
-    NSArray *tableResults = [self runSynchronousQuery:statement];
-    BOOL found = NO;
-    NSMutableArray *results = [NSMutableArray arrayWithArray:tableResults];
-    SQLUpdateQueue *updates = [SQLUpdateQueue new];
-    for (SQLColumn *column in statement.columns.allValues) if (![column.name isEqualToString:@"*"]){
-      for (NSDictionary *dict in results) if ([column.name isEqualToString:[dict objectForKey:@"name"]]){
-        [results removeObject:dict];
-        found = YES;
+  return userVersion;
+}
+- (BOOL) runMigrations:(NSDictionary *)migrations{
+  if (!_dbOpen) return NO;
+  __block BOOL success = YES;
+  [self flushPendingWritesSynchronously];
+  [_databaseScheduler performWorkAndWait:^{
+    NSUInteger userVersion = _database.userVersion;
+    BOOL migrated = NO;
+    for (NSNumber *version in [migrations.allKeys sortedArrayUsingSelector:@selector(compare:)]){
+      if (version.unsignedIntegerValue <= userVersion) continue;
+      MigrationBlock migration = migrations[version];
+      [_database beginImmediateTransaction];
+      if (!migration(_database)){
+        [_database rollback];
+        success = NO;
         break;
       }
-      if (found == NO){
-        SQLStatement *addColumn = [[SQLStatement alloc] initWithType:SQLStatementAddColumn forTable:statement.tableName];
-        [addColumn addSQLColumn:column];
-        [updates addSQLUpdate:addColumn withBlock:nil];
-      }
-      found = NO;
-    }
-    if (updates.count){
-      [self runSynchronousUpdateQueue:updates];
+      _database.userVersion = version.unsignedIntegerValue;
+      [_database commit];
+      migrated = YES;
     }
-    statement.tableInfo = NO;
-  } else {
-    SQLStatement *createStatement = [statement copy];
-    createStatement.SQLType = SQLStatementCreate;
-    [self runSynchronousUpdate:createStatement];
-  }
+    if (!migrated) return;
+    //Migrations are raw sql, so what they changed isn't known
+    if (_database.tracksChanges) _writtenUnknownTable = YES;
+    [self processCommittedWrites];
+    [_database clearStatementCache];
+    [self invalidateReaderStatementCaches];
+  } priority:[self currentPriority]];
+  return success;
+}
+- (void) updateOrCreateTableToColumnsInStatement:(SQLStatement *)statement{
+  if (!statement.tableName) return;
+  [self syncSchemaToStatements:@[statement]];
 }
 - (void) updateOrCreateTableToColumnsInStatement:(SQLStatement *)statement onCompletion:(CompletionBlock)completionBlock{
-  NSString *tableName = statement.tableName;
-  if (!tableName) return;
-  
-  [self runImmediateQuery:[SQLStatement getAllTables] withBlock:^(NSArray *results) {
-    BOOL tableExists = ({
-      BOOL tableFound = NO;
-      for (id table in results){
-        NSString *tName = [table isKindOfClass:[NSString class]] ? table :
-        [table isKindOfClass:[NSDictionary class]] ? table[@"name"] : nil;
-        if ([tName isEqualToString:tableName]){
-          tableFound = YES;
-          break;
-        }
-      }
-      tableFound;
-    });
-    
-    if (tableExists){
-      statement.tableInfo = YES;
-      [self runImmediateQuery:statement withBlock:^(NSArray *tableResults){
-        BOOL found = NO;
-        NSMutableArray *results = [NSMutableArray arrayWithArray:tableResults];
-        SQLUpdateQueue *updates = [SQLUpdateQueue new];
-        for (SQLColumn *column in statement.columns.allValues) if (![column.name isEqualToString:@"*"]){
-          for (NSDictionary *dict in results) if ([column.name isEqualToString:[dict objectForKey:@"name"]]){
-            [results removeObject:dict];
-            found = YES;
-            break;
-          }
-          if (found == NO){
-            SQLStatement *addColumn = [[SQLStatement alloc] initWithType:SQLStatementAddColumn forTable:statement.tableName];
-            [addColumn addSQLColumn:column];
-            [updates addSQLUpdate:addColumn withBlock:nil];
-          }
-          found = NO;
-        }
-        if (updates.count){
-          [self runUpdateQueue:updates withCompletionBlock:^(BOOL success) {
-            if (completionBlock) completionBlock();
-          }];
-        } else {
-          if (completionBlock) completionBlock();
-        }
-        statement.tableInfo = NO;
-      }];
-    } else {
-      SQLStatement *createStatement = [statement copy];
-      createStatement.SQLType = SQLStatementCreate;
-      [self runImmediateUpdate:createStatement withBlock:^(NSInteger result) {
-        if (completionBlock) completionBlock();
-      }];
-    }
+  if (!statement.tableName || !_dbOpen) return;
+  [self applySchemaOfStatements:@[statement] createTables:YES onQueue:NULL onCompletion:^(BOOL success) {
+    if (completionBlock) completionBlock();
   }];
 }
 - (void) updateTableToColumnsInStatement:(SQLStatement *)statement onCompletion:(CompletionBlock)completionBlock{
-  statement.tableInfo = YES;
-  [self runImmediateQuery:statement withBlock:^(NSArray *tableResults){
-    BOOL found = NO;
-    NSMutableArray *results = [NSMutableArray arrayWithArray:tableResults];
-    SQLUpdateQueue *updates = [SQLUpdateQueue new];
-    for (SQLColumn *column in statement.columns.allValues) if (![column.name isEqualToString:@"*"]){
-      for (NSDictionary *dict in results) if ([column.name isEqualToString:[dict objectForKey:@"name"]]){
-        [results removeObject:dict];
-        found = YES;
-        break;
-      }
-      if (found == NO){
-        SQLStatement *addColumn = [[SQLStatement alloc] initWithType:SQLStatementAddColumn forTable:statement.tableName];
-        [addColumn addSQLColumn:column];
-        [updates addSQLUpdate:addColumn withBlock:nil];
-      }
-      found = NO;
-    }
-    if (updates.count){
-      [self runUpdateQueue:updates withCompletionBlock:^(BOOL success) {
-        if (completionBlock) completionBlock();
-      }];
-    } else {
-      if (completionBlock) completionBlock();
-    }
-    statement.tableInfo = NO;
+  if (!statement.tableName || !_dbOpen) return;
+  [self applySchemaOfStatements:@[statement] createTables:NO onQueue:NULL onCompletion:^(BOOL success) {
+    if (completionBlock) completionBlock();
   }];
 }
 - (void) updateTableToColumnsInStatement:(SQLStatement *)statement usingQueryQueue:(SQLQueryQueue *)queryQueue andUpdateQueue:(SQLUpdateQueue *)updateQueue{
@@ -536,21 +1852,12 @@ static NSMutableDictionary *DBManagers(){
   statement.tableInfo = YES;
   
   [queryQueue addSQLQuery:statement withBlock:^(NSArray *tableResults) {
-    BOOL found = NO;
-    NSMutableArray *results = [NSMutableArray arrayWithArray:tableResults];
-    SQLStatement *addColumn;
-    for (SQLColumn *column in statement.columns.allValues) if (![column.name isEqualToString:@"*"]){
-      for (NSDictionary *dict in results) if ([column.name isEqualToString:[dict objectForKey:@"name"]]){
-        [results removeObject:dict];
-        found = YES;
-        break;
-      }
-      if (found == NO){
-        addColumn = [[SQLStatement alloc] initWithType:SQLStatementAddColumn forTable:statement.tableName];
-        [addColumn addSQLColumn:column];
-        [updateQueue addSQLUpdate:addColumn withBlock:nil];
-      }
-      found = NO;
+    NSMutableSet *columnNames = [NSMutableSet setWithCapacity:tableResults.count];
+    for (NSDictionary *column in tableResults){
+      if (column[@"name"]) [columnNames addObject:column[@"name"]];
+    }
+    for (SQLStatement *update in [SQLSchema updatesForStatement:statement existingColumnNames:columnNames existingIndexNames:nil]){
+      [updateQueue addSQLUpdate:update withBlock:nil];
     }
   }];
 }
@@ -568,10 +1875,34 @@ static NSMutableDictionary *DBManagers(){
   if (self.databaseOpen){
     [self closeDatabase];
   }
+  if (_readers){
+    //Closing waited for every reader to be returned, so the semaphore is back at it's initial count
+    dispatch_release(_readerSemaphore);
+    _readerSemaphore = nil;
+    dispatch_release(_readQueue);
+    _readQueue = nil;
+    dispatch_release(_readDispatchQueue);
+    _readDispatchQueue = nil;
+  }
   if (_databaseQueue){
     dispatch_release(_databaseQueue);
     _databaseQueue = nil;
   }
+  if (_queryTrigger){
+    dispatch_source_cancel(_queryTrigger);
+    dispatch_release(_queryTrigger);
+    _queryTrigger = nil;
+  }
+  if (_writeTrigger){
+    dispatch_source_cancel(_writeTrigger);
+    dispatch_release(_writeTrigger);
+    _writeTrigger = nil;
+  }
+  if (_scheduleQueue){
+    dispatch_release(_scheduleQueue);
+    _scheduleQueue = nil;
+  }
+  SQLRetainQueue(&_callbackQueue, NULL);
 }
 @end
 
@@ -594,6 +1925,10 @@ static NSMutableDictionary *DBManagers(){
     [returnedQueue addUpdateBlock:[queue updateBlockAtIndex:i]];
   }
   returnedQueue.rollbackOnFail = queue.rollbackOnFail;
+  returnedQueue.callbackQueue = queue.callbackQueue;
+  returnedQueue.priority = queue.priority;
+  returnedQueue.timeout = queue.timeout;
+  returnedQueue.statementTimeout = queue.statementTimeout;
   return returnedQueue;
 }
 - (id) init{
@@ -601,6 +1936,7 @@ static NSMutableDictionary *DBManagers(){
     _blocks = [[NSMutableArray alloc] init];
     _sqlConflict = SQLConflictIgnore;
     _conformConflict = NO;
+    _priority = SQLPriorityDefault;
   }
   return self;
 }
@@ -631,10 +1967,17 @@ static NSMutableDictionary *DBManagers(){
 - (void) removeAllStatements{
   [_blocks removeAllObjects];
 }
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue);
+}
 #pragma mark - Protocol Methods
 - (NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(__unsafe_unretained id [])buffer count:(NSUInteger)len{
   return [_blocks countByEnumeratingWithState:state objects:buffer count:len];
 }
+#pragma mark - Overridden Methods
+- (void) dealloc{
+  SQLRetainQueue(&_callbackQueue, NULL);
+}
 @end
 
 @implementation SQLQueryQueue{
@@ -652,11 +1995,21 @@ static NSMutableDictionary *DBManagers(){
   for (int i = 0; i < [queue count]; i++) {
     [returnedQueue addQueryBlock:[queue queryBlockAtIndex:i]];
   }
+  returnedQueue.execution = queue.execution;
+  returnedQueue.maxConcurrentQueries = queue.maxConcurrentQueries;
+  returnedQueue.callbackQueue = queue.callbackQueue;
+  returnedQueue.deliversResultsTogether = queue.deliversResultsTogether;
+  returnedQueue.priority = queue.priority;
+  returnedQueue.timeout = queue.timeout;
+  returnedQueue.statementTimeout = queue.statementTimeout;
   return returnedQueue;
 }
 - (id) init{
   if ((self = [super init])){
     _blocks = [[NSMutableArray alloc] init];
+    _execution = SQLQueryExecutionSerial;
+    _maxConcurrentQueries = 0;
+    _priority = SQLPriorityDefault;
   }
   return self;
 }
@@ -671,6 +2024,13 @@ static NSMutableDictionary *DBManagers(){
   }
   return NO;
 }
+- (bool) addSQLQuery:(id <SQLStatementProtocol>)statement withResultSetBlock:(ResultSetBlock)block{
+  if (block && statement && statement.SQLType == SQLStatementQuery){
+    [_blocks addObject:[[SQLQueryBlock alloc] initWithConstructor:statement resultSetBlock:block]];
+    return YES;
+  }
+  return NO;
+}
 - (NSUInteger) count{
   return [_blocks count];
 }
@@ -684,8 +2044,353 @@ static NSMutableDictionary *DBManagers(){
 - (void) removeAllStatements{
   [_blocks removeAllObjects];
 }
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue);
+}
 #pragma mark - Protocol Methods
 - (NSUInteger) countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(__unsafe_unretained id [])buffer count:(NSUInteger)len{
   return [_blocks countByEnumeratingWithState:state objects:buffer count:len];
 }
+#pragma mark - Overridden Methods
+- (void) dealloc{
+  SQLRetainQueue(&_callbackQueue, NULL);
+}
+@end
+
+@implementation SQLBulkResult
+#pragma mark - Init Methods
+- (id) initWithRowCount:(NSUInteger)rowCount{
+  if (self = [super init]){
+    _rowCount = rowCount;
+    _failures = [NSMutableIndexSet new];
+  }
+  return self;
+}
+#pragma mark - Property Methods
+- (NSIndexSet *) failedIndexes{
+  return [_failures copy];
+}
+- (BOOL) success{
+  return !_rolledBack && _failures.count == 0;
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+  return [NSString stringWithFormat:@"<%@: %p> %lu of %lu rows inserted using %lu statements, %lu failed%@", NSStringFromClass([self class]), self, (unsigned long)_insertedCount, (unsigned long)_rowCount, (unsigned long)_statementCount, (unsigned long)_failures.count, _rolledBack ? @" (rolled back)" : @""];
+}
+@end
+
+static BOOL SQLPredicatesHaveSubquery(NSArray *predicates){
+  for (id predicateItem in predicates){
+    if ([predicateItem isKindOfClass:[SQLPredicate class]]){
+      if ([[predicateItem value] isKindOfClass:[SQLStatement class]]) return YES;
+    } else if ([predicateItem isKindOfClass:[SQLPredicateGroup class]]){
+      if (SQLPredicatesHaveSubquery([predicateItem predicates])) return YES;
+    }
+  }
+  return NO;
+}
+@implementation SQLSubscription{
+  //Every table the statement reads, if it reads more than it's own rows (joins & subqueries)
+  NSSet *_referencedTableNames;
+  //Refresh state, guarded by self
+  BOOL _refreshing;
+  BOOL _pendingFullRefresh;
+  NSMutableSet *_pendingRowIDs;
+}
+#pragma mark - Init Methods
+- (id) initWithStatement:(SQLStatement *)statement rowClass:(Class)rowClass block:(QueueBlock)block{
+  if (self = [super init]){
+    _statement = [statement copy];
+    _rowClass = rowClass;
+    _block = [block copy];
+    _active = YES;
+    if (_statement.joins.count || SQLPredicatesHaveSubquery(_statement.predicates)){
+      _referencedTableNames = [NSSet setWithArray:_statement.referencedTableNames];
+    }
+    _referencedColumns = [self columnsReferencedByStatement:_statement];
+    _incremental = [self statementAllowsIncrementalRefresh:_statement rowClass:rowClass];
+    _refreshing = NO;
+    //The first refresh returns the initial results
+    _pendingFullRefresh = YES;
+    _pendingRowIDs = [NSMutableSet new];
+  }
+  return self;
+}
+- (void) setCallbackQueue:(dispatch_queue_t)callbackQueue{
+  SQLRetainQueue(&_callbackQueue, callbackQueue);
+}
+- (void) dealloc{
+  SQLRetainQueue(&_callbackQueue, NULL);
+}
+#pragma mark - Private Methods
+static void SQLAddPredicateColumns(NSArray *predicates, NSMutableSet *columnNames){
+  for (id predicateItem in predicates){
+    if ([predicateItem isKindOfClass:[SQLPredicate class]]){
+      if ([predicateItem column]) [columnNames addObject:[predicateItem column]];
+    } else if ([predicateItem isKindOfClass:[SQLPredicateGroup class]]){
+      SQLAddPredicateColumns([predicateItem predicates], columnNames);
+    }
+  }
+}
+- (NSSet *) columnsReferencedByStatement:(SQLStatement *)statement{
+  //nil means every column is referenced. A join or subquery can reference columns in any of it's tables.
+  if (statement.tableInfo || _referencedTableNames) return nil;
+  NSMutableSet *columnNames = [NSMutableSet new];
+  for (SQLColumn *column in statement.orderedColumns){
+    if ([column.name isEqualToString:@"*"]) return nil;
+    [columnNames addObject:column.name];
+  }
+  SQLAddPredicateColumns(statement.predicates, columnNames);
+  for (SQLOrder *order in statement.orderings){
+    if (order.column) [columnNames addObject:order.column];
+  }
+  for (SQLColumn *column in statement.groups){
+    [columnNames addObject:column.name];
+  }
+  return columnNames;
+}
+- (BOOL) statementAllowsIncrementalRefresh:(SQLStatement *)statement rowClass:(Class)rowClass{
+  /* Changed rows can be merged into the results when:
+   - rows are dictionaries that include the GUID (to match them up)
+   - every row stands on it's own: no aggregates, grouping, distinct, limit, offset, joins or subqueries
+   - there's no order, since merged rows couldn't be put in the right place
+   */
+  if (rowClass && rowClass != [NSMutableDictionary class]) return NO;
+  if (_referencedTableNames) return NO;
+  if (statement.tableInfo || statement.selectDistinct || statement.limit > 0 || statement.offset > -1) return NO;
+  if (statement.orderings.count || statement.groups.count) return NO;
+  BOOL selectsGUID = NO;
+  for (SQLColumn *column in statement.orderedColumns){
+    if (column.aggregate != SQLAggregateNone) return NO;
+    if ([column.name isEqualToString:@"*"] || ([column.name isEqualToString:GUIDKey] && !column.alias)) selectsGUID = YES;
+  }
+  return selectsGUID;
+}
+- (BOOL) addChanges:(SQLChangeSet *)changes{
+  /* Returns YES if the changes may have changed the results
+   - Updates are ignored if the columns updated are known and the statement doesn't reference any of them
+   - Inserted & updated rows can be refreshed individually (for incremental subscriptions); anything else runs the whole query again
+   - A change to any table a join or subquery reads runs the whole query again (a change to one row can change which other rows match)
+   */
+  if (_referencedTableNames){
+    if (!changes.allTablesChanged && ![changes.tableNames intersectsSet:_referencedTableNames]) return NO;
+    @synchronized(self){
+      if (!_active) return NO;
+      _pendingFullRefresh = YES;
+    }
+    return YES;
+  }
+  NSString *tableName = _statement.tableName;
+  if (!changes.allTablesChanged && ![changes.tableNames containsObject:tableName]) return NO;
+  BOOL full = [changes allRowsChangedInTable:tableName] || [changes deletedRowIDsForTable:tableName].count > 0;
+  NSSet *inserted = [changes insertedRowIDsForTable:tableName];
+  NSSet *updated = [changes updatedRowIDsForTable:tableName];
+  NSSet *updatedColumns = [changes updatedColumnsForTable:tableName];
+  if (updated.count && updatedColumns && _referencedColumns && ![updatedColumns intersectsSet:_referencedColumns]){
+    updated = nil;
+  }
+  if (!full && !inserted.count && !updated.count) return NO;
+  @synchronized(self){
+    if (!_active) return NO;
+    if (full || !_incremental){
+      _pendingFullRefresh = YES;
+    } else {
+      [_pendingRowIDs unionSet:inserted];
+      if (updated) [_pendingRowIDs unionSet:updated];
+    }
+  }
+  return YES;
+}
+- (BOOL) beginRefresh{
+  @synchronized(self){
+    if (_refreshing || !_active) return NO;
+    _refreshing = YES;
+    return YES;
+  }
+}
+- (BOOL) takePendingRowIDs:(NSSet **)rowIDs{
+  //Returns YES if the whole query needs to be run
+  @synchronized(self){
+    BOOL full = _pendingFullRefresh || !self.rows || _pendingRowIDs.count > SubscriptionMaxIncrementalRows;
+    *rowIDs = full ? nil : [_pendingRowIDs copy];
+    [_pendingRowIDs removeAllObjects];
+    _pendingFullRefresh = NO;
+    return full;
+  }
+}
+- (BOOL) endRefresh{
+  //Returns YES if more changes came in during the refresh
+  @synchronized(self){
+    _refreshing = NO;
+    return _active && (_pendingFullRefresh || _pendingRowIDs.count);
+  }
+}
+- (void) recordRefresh:(BOOL)incremental{
+  @synchronized(self){
+    if (incremental){
+      _incrementalRefreshCount++;
+    } else {
+      _refreshCount++;
+    }
+  }
+}
+#pragma mark - Property Methods
+- (QueueBlock) block{
+  @synchronized(self){
+    return _block;
+  }
+}
+#pragma mark - Standard Methods
+- (void) cancel{
+  @synchronized(self){
+    _active = NO;
+    //Release the block (and anything it captured) right away
+    _block = nil;
+    [_pendingRowIDs removeAllObjects];
+    self.rows = nil;
+  }
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+  return [NSString stringWithFormat:@"<%@: %p> %@ (%@%@), %lu full & %lu incremental refreshes", NSStringFromClass([self class]), self, _statement.tableName, _active ? @"active" : @"cancelled", _incremental ? @", incremental" : @"", (unsigned long)_refreshCount, (unsigned long)_incrementalRefreshCount];
+}
+@end
+
+@implementation SQLWriteMetrics{
+  NSTimeInterval _totalCommitDuration;
+}
+- (id) copyWithZone:(NSZone *)zone{
+  SQLWriteMetrics *metrics = [[SQLWriteMetrics allocWithZone:zone] init];
+  @synchronized(self){
+    metrics->_batchCount = _batchCount;
+    metrics->_requestCount = _requestCount;
+    metrics->_statementCount = _statementCount;
+    metrics->_largestBatchSize = _largestBatchSize;
+    metrics->_lastCommitDuration = _lastCommitDuration;
+    metrics->_maxCommitDuration = _maxCommitDuration;
+    metrics->_totalCommitDuration = _totalCommitDuration;
+  }
+  return metrics;
+}
+- (void) reset{
+  @synchronized(self){
+    _batchCount = 0;
+    _requestCount = 0;
+    _statementCount = 0;
+    _largestBatchSize = 0;
+    _lastCommitDuration = 0;
+    _maxCommitDuration = 0;
+    _totalCommitDuration = 0;
+  }
+}
+- (void) recordBatchWithRequests:(NSUInteger)requestCount statements:(NSUInteger)statementCount commitDuration:(NSTimeInterval)duration{
+  @synchronized(self){
+    _batchCount++;
+    _requestCount += requestCount;
+    _statementCount += statementCount;
+    _largestBatchSize = MAX(_largestBatchSize, statementCount);
+    _lastCommitDuration = duration;
+    _maxCommitDuration = MAX(_maxCommitDuration, duration);
+    _totalCommitDuration += duration;
+  }
+}
+- (double) averageBatchSize{
+  @synchronized(self){
+    return _batchCount ? (double)_statementCount / _batchCount : 0;
+  }
+}
+- (NSTimeInterval) averageCommitDuration{
+  @synchronized(self){
+    return _batchCount ? _totalCommitDuration / _batchCount : 0;
+  }
+}
+@end
+
+@implementation SQLOperation{
+  //Everything is guarded by self: operations are cancelled from any thread
+  BOOL _cancelled;
+  BOOL _timedOut;
+  CFAbsoluteTime _deadline;
+  NSTimeInterval _statementTimeout;
+  CFAbsoluteTime _statementDeadline;
+  //The connection running one of the operation's statements, so it can be interrupted
+  SQLDatabase *_database;
+}
+#pragma mark - Init Methods
+- (id) initWithTimeout:(NSTimeInterval)timeout statementTimeout:(NSTimeInterval)statementTimeout{
+  if (self = [super init]){
+    _deadline = timeout > 0 ? CFAbsoluteTimeGetCurrent() + timeout : 0;
+    _statementTimeout = statementTimeout;
+  }
+  return self;
+}
+#pragma mark - Private Methods
+- (BOOL) checkDeadlines{
+  //Must be called while synchronized. Once a deadline passes, the operation stays timed out.
+  if (_cancelled || _timedOut) return YES;
+  if (!_deadline && !_statementDeadline) return NO;
+  CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+  if ((_deadline && now >= _deadline) || (_statementDeadline && now >= _statementDeadline)) _timedOut = YES;
+  return _timedOut;
+}
+- (void) beginStatementOnDatabase:(SQLDatabase *)database{
+  /* Deadlines are checked by the database's progress handler while the statement runs (it's only installed if there's a deadline). Cancelling interrupts the database directly. */
+  BOOL hasDeadline = NO;
+  @synchronized(self){
+    _database = database;
+    _statementDeadline = _statementTimeout > 0 ? CFAbsoluteTimeGetCurrent() + _statementTimeout : 0;
+    hasDeadline = (_deadline || _statementDeadline);
+  }
+  if (hasDeadline){
+    database.interruptBlock = ^BOOL{
+      return self.stopped;
+    };
+  }
+}
+- (void) endStatementOnDatabase:(SQLDatabase *)database{
+  database.interruptBlock = nil;
+  @synchronized(self){
+    _database = nil;
+    _statementDeadline = 0;
+  }
+}
+#pragma mark - Property Methods
+- (BOOL) stopped{
+  @synchronized(self){
+    return [self checkDeadlines];
+  }
+}
+- (BOOL) cancelled{
+  @synchronized(self){
+    return _cancelled;
+  }
+}
+- (BOOL) timedOut{
+  @synchronized(self){
+    [self checkDeadlines];
+    return _timedOut;
+  }
+}
+- (NSInteger) updateResult{
+  return self.cancelled ? SQLUpdateResultCancelled : SQLUpdateResultTimedOut;
+}
+- (NSError *) error{
+  @synchronized(self){
+    if (![self checkDeadlines]) return nil;
+    if (_cancelled) return [NSError errorWithDomain:SQLDatabaseErrorDomain code:SQLDatabaseErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"The operation was cancelled."}];
+    return [NSError errorWithDomain:SQLDatabaseErrorDomain code:SQLDatabaseErrorTimedOut userInfo:@{NSLocalizedDescriptionKey : @"The operation timed out."}];
+  }
+}
+#pragma mark - Standard Methods
+- (void) cancel{
+  @synchronized(self){
+    if ([self checkDeadlines]) return;
+    _cancelled = YES;
+    [_database interrupt];
+  }
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+  return [NSString stringWithFormat:@"<%@: %p> %@", NSStringFromClass([self class]), self, self.cancelled ? @"cancelled" : self.timedOut ? @"timed out" : @"active"];
+}
 @end
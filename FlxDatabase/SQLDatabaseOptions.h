@@ -0,0 +1,125 @@
+//
+//  SQLDatabaseOptions.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  Corresponds to `PRAGMA journal_mode`. See: [http://www.sqlite.org/pragma.html#pragma_journal_mode](http://www.sqlite.org/pragma.html#pragma_journal_mode)
+ */
+typedef NS_ENUM(NSUInteger, SQLJournalMode){
+    SQLJournalModeDefault,
+    SQLJournalModeDelete,
+    SQLJournalModeTruncate,
+    SQLJournalModePersist,
+    SQLJournalModeMemory,
+    SQLJournalModeWAL,
+    SQLJournalModeOff
+};
+
+/**
+ *  Corresponds to `PRAGMA synchronous`. See: [http://www.sqlite.org/pragma.html#pragma_synchronous](http://www.sqlite.org/pragma.html#pragma_synchronous)
+ */
+typedef NS_ENUM(NSUInteger, SQLSynchronous){
+    SQLSynchronousDefault,
+    SQLSynchronousOff,
+    SQLSynchronousNormal,
+    SQLSynchronousFull,
+    SQLSynchronousExtra
+};
+
+/**
+ *  Corresponds to `PRAGMA temp_store`. See: [http://www.sqlite.org/pragma.html#pragma_temp_store](http://www.sqlite.org/pragma.html#pragma_temp_store)
+ */
+typedef NS_ENUM(NSUInteger, SQLTempStore){
+    SQLTempStoreDefault,
+    SQLTempStoreFile,
+    SQLTempStoreMemory
+};
+
+/**
+ *  Corresponds to `PRAGMA locking_mode`. See: [http://www.sqlite.org/pragma.html#pragma_locking_mode](http://www.sqlite.org/pragma.html#pragma_locking_mode)
+ */
+typedef NS_ENUM(NSUInteger, SQLLockingMode){
+    SQLLockingModeDefault,
+    SQLLockingModeNormal,
+    SQLLockingModeExclusive
+};
+
+/**
+ *  SQLDatabaseOptions holds the connection settings applied when a SQLDatabase is opened. Any option left at it's default (`nil` or the `...Default` enum value) isn't set, so SQLite's own default is used.
+ *
+ *  Options are applied in an order that works for a new database: page size first (it can only be changed before the database is created or when it's not in WAL mode), then the journal mode, and then everything else. Read-only connections skip the options that would write to the database (page size & journal mode).
+ *
+ *  There are a few preset profiles (`lowMemoryOptions`, `throughputOptions` and `bulkLoadOptions`) you can use as is or copy and tweak.
+ */
+@interface SQLDatabaseOptions : NSObject <NSCopying>
+/**
+ *  `PRAGMA cache_size`. A positive number is the number of pages; a negative number is the size in KiB (ex: -2000 => ~2MB).
+ *  Default: nil
+ */
+@property (strong) NSNumber *cacheSize;
+/**
+ *  `PRAGMA mmap_size`, in bytes. `0` disables memory mapped I/O.
+ *  Default: nil
+ */
+@property (strong) NSNumber *mmapSize;
+/**
+ *  `PRAGMA page_size`, in bytes. This must be a power of 2 between 512 and 65536 and only takes effect when the database is created (or vacuumed).
+ *  Default: nil
+ */
+@property (strong) NSNumber *pageSize;
+/**
+ *  `PRAGMA synchronous`.
+ *  Default: SQLSynchronousDefault
+ */
+@property SQLSynchronous synchronous;
+/**
+ *  `PRAGMA temp_store`.
+ *  Default: SQLTempStoreDefault
+ */
+@property SQLTempStore tempStore;
+/**
+ *  `PRAGMA journal_mode`. Note: WAL is persistent, so once a database is in WAL mode it stays that way until a different journal mode is set.
+ *  Default: SQLJournalModeDefault
+ */
+@property SQLJournalMode journalMode;
+/**
+ *  `PRAGMA locking_mode`. Be careful with `SQLLockingModeExclusive`: no other connection (including a SQLDatabaseManager reader pool) will be able to read the database.
+ *  Default: SQLLockingModeDefault
+ */
+@property SQLLockingMode lockingMode;
+/**
+ *  How long (in seconds) a connection will wait on a locked database before giving up with SQLITE_BUSY. `0` means don't wait.
+ *  Default: 0
+ */
+@property NSTimeInterval busyTimeout;
+/**
+ *  These are the options used if you don't provide any. For compatibility with earlier versions of this library, these are the same as `lowMemoryOptions`.
+ */
++ (instancetype) defaultOptions;
+/**
+ *  Keeps the memory footprint as small as possible: no page cache, no memory mapping and temp storage on disk. Every page read goes to the OS, so this is slow for anything but small databases.
+ */
++ (instancetype) lowMemoryOptions;
+/**
+ *  A general purpose profile for read/write throughput: WAL journal, `synchronous = NORMAL` (safe in WAL mode), a 16MB page cache, 256MB of memory mapped I/O, temp storage in memory and a 5 second busy timeout.
+ */
++ (instancetype) throughputOptions;
+/**
+ *  For loading large amounts of data: like `throughputOptions`, but with a 64MB page cache and `synchronous = OFF`. A power loss during a bulk load can corrupt the database, so only use this when the data can be reloaded.
+ */
++ (instancetype) bulkLoadOptions;
+/**
+ *  The PRAGMA statements (in order) needed to apply these options.
+ *
+ *  @param readOnly If YES, options that write to the database (page size & journal mode) are left out.
+ *
+ *  @return An array of NSString sql statements.
+ */
+- (NSArray *) pragmaStatementsForReadOnlyConnection:(BOOL)readOnly;
+@end
@@ -0,0 +1,120 @@
+//
+//  SQLDatabaseOptions.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLDatabaseOptions.h"
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+
+@implementation SQLDatabaseOptions
+#pragma mark - Init Methods
+- (id) init{
+    if ((self = [super init])){
+        _cacheSize = nil;
+        _mmapSize = nil;
+        _pageSize = nil;
+        _synchronous = SQLSynchronousDefault;
+        _tempStore = SQLTempStoreDefault;
+        _journalMode = SQLJournalModeDefault;
+        _lockingMode = SQLLockingModeDefault;
+        _busyTimeout = 0;
+    }
+    return self;
+}
++ (instancetype) defaultOptions{
+    return [self lowMemoryOptions];
+}
++ (instancetype) lowMemoryOptions{
+    SQLDatabaseOptions *options = [self new];
+    options.cacheSize = @0;
+    options.mmapSize = @0;
+    options.tempStore = SQLTempStoreFile;
+    return options;
+}
++ (instancetype) throughputOptions{
+    SQLDatabaseOptions *options = [self new];
+    options.cacheSize = @(-16384);
+    options.mmapSize = @(256 * 1024 * 1024);
+    options.journalMode = SQLJournalModeWAL;
+    options.synchronous = SQLSynchronousNormal;
+    options.tempStore = SQLTempStoreMemory;
+    options.busyTimeout = 5;
+    return options;
+}
++ (instancetype) bulkLoadOptions{
+    SQLDatabaseOptions *options = [self throughputOptions];
+    options.cacheSize = @(-65536);
+    options.synchronous = SQLSynchronousOff;
+    return options;
+}
+#pragma mark - Private Methods
+- (NSString *) journalModeString{
+    switch (_journalMode) {
+        case SQLJournalModeDelete: return @"DELETE";
+        case SQLJournalModeTruncate: return @"TRUNCATE";
+        case SQLJournalModePersist: return @"PERSIST";
+        case SQLJournalModeMemory: return @"MEMORY";
+        case SQLJournalModeWAL: return @"WAL";
+        case SQLJournalModeOff: return @"OFF";
+        default: return nil;
+    }
+}
+- (NSString *) synchronousString{
+    switch (_synchronous) {
+        case SQLSynchronousOff: return @"OFF";
+        case SQLSynchronousNormal: return @"NORMAL";
+        case SQLSynchronousFull: return @"FULL";
+        case SQLSynchronousExtra: return @"EXTRA";
+        default: return nil;
+    }
+}
+- (NSString *) tempStoreString{
+    switch (_tempStore) {
+        case SQLTempStoreFile: return @"FILE";
+        case SQLTempStoreMemory: return @"MEMORY";
+        default: return nil;
+    }
+}
+- (NSString *) lockingModeString{
+    switch (_lockingMode) {
+        case SQLLockingModeNormal: return @"NORMAL";
+        case SQLLockingModeExclusive: return @"EXCLUSIVE";
+        default: return nil;
+    }
+}
+#pragma mark - Protocol Methods
+- (id) copyWithZone:(NSZone *)zone{
+    SQLDatabaseOptions *copy = [[[self class] alloc] init];
+    copy.cacheSize = _cacheSize;
+    copy.mmapSize = _mmapSize;
+    copy.pageSize = _pageSize;
+    copy.synchronous = _synchronous;
+    copy.tempStore = _tempStore;
+    copy.journalMode = _journalMode;
+    copy.lockingMode = _lockingMode;
+    copy.busyTimeout = _busyTimeout;
+    return copy;
+}
+#pragma mark - Standard Methods
+- (NSArray *) pragmaStatementsForReadOnlyConnection:(BOOL)readOnly{
+    NSMutableArray *pragmas = [NSMutableArray new];
+    NSString *value = nil;
+    //Page size must be set before the journal mode (it can't be changed in WAL mode)
+    if (!readOnly && _pageSize) [pragmas addObject:$(@"PRAGMA page_size = %lld;", _pageSize.longLongValue)];
+    if (!readOnly && (value = [self journalModeString])) [pragmas addObject:$(@"PRAGMA journal_mode = %@;", value)];
+    if ((value = [self synchronousString])) [pragmas addObject:$(@"PRAGMA synchronous = %@;", value)];
+    if ((value = [self lockingModeString])) [pragmas addObject:$(@"PRAGMA locking_mode = %@;", value)];
+    if (_cacheSize) [pragmas addObject:$(@"PRAGMA cache_size = %lld;", _cacheSize.longLongValue)];
+    if (_mmapSize) [pragmas addObject:$(@"PRAGMA mmap_size = %lld;", _mmapSize.longLongValue)];
+    if ((value = [self tempStoreString])) [pragmas addObject:$(@"PRAGMA temp_store = %@;", value)];
+    return pragmas;
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+    return [[self pragmaStatementsForReadOnlyConnection:NO] componentsJoinedByString:@" "];
+}
+@end
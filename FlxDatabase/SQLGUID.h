@@ -0,0 +1,92 @@
+//
+//  SQLGUID.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#define GUIDKey @"GUID"
+
+/**
+ *  How a table stores it's GUID primary key.
+ */
+typedef NS_ENUM(NSUInteger, SQLGUIDMode) {
+    /**
+     *  GUIDs are random UUID strings stored as `VARCHAR(36)`. This is the default.
+     */
+    SQLGUIDModeText,
+    /**
+     *  GUIDs are time-ordered UUIDs (version 7) stored as 16 byte BLOBs. Keys are less than half the size and new rows are always inserted at the end of the primary key index instead of being scattered across it.
+     */
+    SQLGUIDModeBinary
+};
+
+/**
+ *  SQLGUID generates GUIDs and converts them between their string and 16 byte forms.
+ *
+ *  ### Binary GUIDs
+ *
+ *  Binary GUIDs are opt-in, per table. A table's mode is stored in it's schema, as the type of it's GUID column, so it only has to be chosen when the table is created: use `setMode:forTable:` before creating it (or set the create statement's `GUIDMode`). After that, each connection reads the mode from the schema (see SQLDatabase's `GUIDModeForTable:`) and SQLDatabaseManager sets it on every statement it runs. For a binary table:
+ *  - `SQLStatementCreate` creates the GUID column as `BLOB PRIMARY KEY`.
+ *  - A statement's auto-generated GUID is time-ordered.
+ *  - The GUID (for inserts) and any predicate on the GUID column are bound as 16 byte BLOBs.
+ *  - A GUID column returned by a query is converted back to it's string form: dictionary rows, mapped rows, cursors and SQLResultSet all return an NSString.
+ *
+ *  So GUIDs are always NSStrings in your code; only the storage changes. If you use raw SQL with a binary table, every connection has two functions to do the conversion: `guid_blob(text)` and `guid_text(blob)`. Values that can't be converted are returned unchanged.
+ *
+ *  Existing tables can be converted with SQLDatabase's `migrateTable:toGUIDMode:` (or the SQLDatabaseManager equivalent).
+ */
+@interface SQLGUID : NSObject
+/**
+ *  Returns a new time-ordered (version 7) UUID string, ex: `01890A5D-AC96-774B-BCCE-B302099A8057`.
+ *
+ *  The first 48 bits are the milliseconds since 1970, so GUIDs sort in the order they were created. GUIDs created in the same millisecond use a counter in place of random bits, so they still sort in order. The rest is random. No CFUUID is created.
+ *
+ *  @return A new GUID.
+ */
++ (NSString *) newTimeOrderedGUID;
+/**
+ *  Converts a GUID string (with or without hyphens) to it's 16 byte form.
+ *
+ *  @param GUID The GUID string.
+ *
+ *  @return 16 bytes of data or `nil` if the string isn't a valid GUID.
+ */
++ (NSData *) dataFromGUID:(NSString *)GUID;
+/**
+ *  Converts 16 bytes into a GUID string.
+ *
+ *  @param data The GUID data.
+ *
+ *  @return The GUID string or `nil` if the data isn't 16 bytes long.
+ */
++ (NSString *) GUIDFromData:(NSData *)data;
+/**
+ *  Converts 16 bytes into a GUID string.
+ *
+ *  @param bytes  The GUID bytes.
+ *  @param length The number of bytes.
+ *
+ *  @return The GUID string or `nil` if there aren't 16 bytes.
+ */
++ (NSString *) GUIDFromBytes:(const void *)bytes length:(NSUInteger)length;
+/**
+ *  Sets the GUID mode used for a table that doesn't exist yet (ex: by it's create statement). Once the table exists, it's mode is read from the schema instead. This is thread safe and isn't persisted.
+ *  @warning This doesn't change the table. Use `migrateTable:toGUIDMode:` to change an existing table.
+ *
+ *  @param mode      The GUID mode.
+ *  @param tableName The name of the table.
+ */
++ (void) setMode:(SQLGUIDMode)mode forTable:(NSString *)tableName;
+/**
+ *  Returns the GUID mode set for a table (SQLGUIDModeText unless it's been set). This is the mode for a new table; use SQLDatabase's `GUIDModeForTable:` for an existing one.
+ *
+ *  @param tableName The name of the table.
+ *
+ *  @return SQLGUIDMode
+ */
++ (SQLGUIDMode) modeForTable:(NSString *)tableName;
+@end
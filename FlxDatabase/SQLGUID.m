@@ -0,0 +1,169 @@
+//
+//  SQLGUID.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLGUID.h"
+#import <sqlite3.h>
+#import <sys/time.h>
+
+#define SQLGUIDLength 16
+#define SQLGUIDStringLength 36
+#define SQLGUIDCounterMax 0xFFF
+
+@interface SQLGUID ()
++ (int) registerFunctionsWithConnection:(sqlite3 *)connection;
+@end
+
+@implementation SQLGUID
+#pragma mark - Private Methods
+static const char SQLGUIDHexDigits[] = "0123456789ABCDEF";
+static void SQLGUIDFormat(const uint8_t *bytes, char *string){
+  //string must have room for 37 characters (including the terminator)
+  char *c = string;
+  for (int i = 0; i < SQLGUIDLength; i++){
+    if (i == 4 || i == 6 || i == 8 || i == 10) *c++ = '-';
+    *c++ = SQLGUIDHexDigits[bytes[i] >> 4];
+    *c++ = SQLGUIDHexDigits[bytes[i] & 0x0F];
+  }
+  *c = '\0';
+}
+static int SQLGUIDHexValue(char c){
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return -1;
+}
+static BOOL SQLGUIDParse(const char *string, size_t length, uint8_t *bytes){
+  //Accepts the hyphenated form (36 characters) or just the hex digits (32 characters)
+  BOOL hyphenated = (length == SQLGUIDStringLength);
+  if (!string || (!hyphenated && length != SQLGUIDLength * 2)) return NO;
+  size_t position = 0;
+  for (int i = 0; i < SQLGUIDLength; i++){
+    if (hyphenated && (i == 4 || i == 6 || i == 8 || i == 10)){
+      if (string[position] != '-') return NO;
+      position++;
+    }
+    int high = SQLGUIDHexValue(string[position]);
+    int low = SQLGUIDHexValue(string[position + 1]);
+    if (high < 0 || low < 0) return NO;
+    bytes[i] = (uint8_t)((high << 4) | low);
+    position += 2;
+  }
+  return YES;
+}
+static void SQLGUIDGenerate(uint8_t *bytes){
+  /* Version 7 layout (RFC 9562):
+   - 48 bits: unix time in milliseconds
+   - 4 bits: version (7), 12 bits: counter (seeded randomly each millisecond so GUIDs in the same millisecond still sort in order)
+   - 2 bits: variant, 62 bits: random
+   */
+  static uint64_t lastTime = 0;
+  static uint16_t counter = 0;
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  uint64_t time = (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_usec / 1000;
+  arc4random_buf(bytes, SQLGUIDLength);
+  @synchronized([SQLGUID class]){
+    if (time > lastTime){
+      lastTime = time;
+      //Leave plenty of room for the counter to increment
+      counter = (uint16_t)(arc4random_uniform(SQLGUIDCounterMax / 2));
+    } else {
+      //Same millisecond (or the clock moved backwards): keep the last time and increment the counter
+      time = lastTime;
+      if (++counter > SQLGUIDCounterMax){
+        time = ++lastTime;
+        counter = 0;
+      }
+    }
+  }
+  for (int i = 0; i < 6; i++){
+    bytes[i] = (uint8_t)(time >> (40 - i * 8));
+  }
+  bytes[6] = (uint8_t)(0x70 | ((counter >> 8) & 0x0F));
+  bytes[7] = (uint8_t)(counter & 0xFF);
+  bytes[8] = (uint8_t)(0x80 | (bytes[8] & 0x3F));
+}
+static NSMutableDictionary *SQLGUIDModes(){
+  static NSMutableDictionary *modes = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    modes = [NSMutableDictionary new];
+  });
+  return modes;
+}
+#pragma mark SQL Functions
+static void SQLGUIDBlobFunction(sqlite3_context *context, int argc, sqlite3_value **argv){
+  uint8_t bytes[SQLGUIDLength];
+  if (sqlite3_value_type(argv[0]) == SQLITE_TEXT){
+    const char *text = (const char *)sqlite3_value_text(argv[0]);
+    if (SQLGUIDParse(text, (size_t)sqlite3_value_bytes(argv[0]), bytes)){
+      sqlite3_result_blob(context, bytes, SQLGUIDLength, SQLITE_TRANSIENT);
+      return;
+    }
+  }
+  sqlite3_result_value(context, argv[0]);
+}
+static void SQLGUIDTextFunction(sqlite3_context *context, int argc, sqlite3_value **argv){
+  if (sqlite3_value_type(argv[0]) == SQLITE_BLOB && sqlite3_value_bytes(argv[0]) == SQLGUIDLength){
+    char string[SQLGUIDStringLength + 1];
+    SQLGUIDFormat(sqlite3_value_blob(argv[0]), string);
+    sqlite3_result_text(context, string, SQLGUIDStringLength, SQLITE_TRANSIENT);
+    return;
+  }
+  sqlite3_result_value(context, argv[0]);
+}
++ (int) registerFunctionsWithConnection:(sqlite3 *)connection{
+  int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+  int rc = sqlite3_create_function(connection, "guid_blob", 1, flags, NULL, SQLGUIDBlobFunction, NULL, NULL);
+  if (rc != SQLITE_OK) return rc;
+  return sqlite3_create_function(connection, "guid_text", 1, flags, NULL, SQLGUIDTextFunction, NULL, NULL);
+}
+#pragma mark - Standard Methods
++ (NSString *) newTimeOrderedGUID{
+  uint8_t bytes[SQLGUIDLength];
+  char string[SQLGUIDStringLength + 1];
+  SQLGUIDGenerate(bytes);
+  SQLGUIDFormat(bytes, string);
+  return [[NSString alloc] initWithBytes:string length:SQLGUIDStringLength encoding:NSASCIIStringEncoding];
+}
++ (NSData *) dataFromGUID:(NSString *)GUID{
+  if (![GUID isKindOfClass:[NSString class]]) return nil;
+  char string[SQLGUIDStringLength + 1];
+  if (![GUID getCString:string maxLength:sizeof(string) encoding:NSASCIIStringEncoding]) return nil;
+  uint8_t bytes[SQLGUIDLength];
+  if (!SQLGUIDParse(string, strlen(string), bytes)) return nil;
+  return [NSData dataWithBytes:bytes length:SQLGUIDLength];
+}
++ (NSString *) GUIDFromData:(NSData *)data{
+  return [self GUIDFromBytes:data.bytes length:data.length];
+}
++ (NSString *) GUIDFromBytes:(const void *)bytes length:(NSUInteger)length{
+  if (!bytes || length != SQLGUIDLength) return nil;
+  char string[SQLGUIDStringLength + 1];
+  SQLGUIDFormat(bytes, string);
+  return [[NSString alloc] initWithBytes:string length:SQLGUIDStringLength encoding:NSASCIIStringEncoding];
+}
++ (void) setMode:(SQLGUIDMode)mode forTable:(NSString *)tableName{
+  if (!tableName.length) return;
+  NSMutableDictionary *modes = SQLGUIDModes();
+  @synchronized(modes){
+    if (mode == SQLGUIDModeText){
+      [modes removeObjectForKey:tableName];
+    } else {
+      modes[tableName] = @(mode);
+    }
+  }
+}
++ (SQLGUIDMode) modeForTable:(NSString *)tableName{
+  if (!tableName.length) return SQLGUIDModeText;
+  NSMutableDictionary *modes = SQLGUIDModes();
+  @synchronized(modes){
+    return [modes[tableName] unsignedIntegerValue];
+  }
+}
+@end
@@ -0,0 +1,105 @@
+//
+//  SQLIndexAdvisor.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+@class SQLStatement;
+@class SQLDatabase;
+
+/**
+ *  The advice for a single query shape.
+ */
+@interface SQLIndexAdvice : NSObject
+/**
+ *  The sql of the query.
+ */
+@property (readonly) NSString *sql;
+/**
+ *  The table queried.
+ */
+@property (readonly) NSString *tableName;
+/**
+ *  The number of times the query was observed (`0` if it wasn't observed, ex: `adviceForStatement:database:`).
+ */
+@property (readonly) NSUInteger observationCount;
+/**
+ *  The query plan from `EXPLAIN QUERY PLAN`: an NSArray of the plan's detail strings, in order.
+ */
+@property (readonly) NSArray *queryPlan;
+/**
+ *  YES if the plan scans the table (every row is read).
+ */
+@property (readonly) BOOL fullScan;
+/**
+ *  YES if the plan sorts the results in a temporary b-tree (an ORDER BY, GROUP BY or DISTINCT that couldn't use an index).
+ */
+@property (readonly) BOOL temporarySort;
+/**
+ *  A `SQLStatementCreateIndex` statement for an index that should let the query avoid the scan or sort, or `nil` if there isn't anything to propose (ex: the query doesn't have any usable predicates or orders).
+ */
+@property (readonly) SQLStatement *proposedIndex;
+/**
+ *  YES if the advisor created the proposed index (see SQLIndexAdvisor's `createsIndexes`).
+ */
+@property (readonly) BOOL created;
+@end
+
+/**
+ *  SQLIndexAdvisor observes query shapes (SQLStatement queries, keyed by their sql) and, when asked, runs `EXPLAIN QUERY PLAN` on each of them. Queries that scan their table or sort in a temporary b-tree are flagged, and an index is proposed from the statement:
+ *  - Columns compared for equality (top level `AND` predicates) come first, followed by one column compared with a range (`<`, `<=`, `>`, `>=`).
+ *  - If there isn't a range column, the query's orders follow (with their collation & direction), so the index can also be used to sort.
+ *
+ *  Predicates in groups, `OR` predicates, `LIKE` and `!=` can't use an index this way, so they're ignored. Proposals are only a starting point: an index speeds up the queries that use it but slows down every write to the table.
+ *
+ *  The advisor is thread safe. To use it with SQLDatabaseManager, set the manager's `indexAdvisor`.
+ */
+@interface SQLIndexAdvisor : NSObject
+/**
+ *  When YES, `adviceUsingDatabase:` creates the indexes it proposes.
+ *  Default: NO
+ */
+@property BOOL createsIndexes;
+/**
+ *  The maximum number of query shapes observed. Past this, new shapes are ignored.
+ *  Default: 200
+ */
+@property NSUInteger observedStatementLimit;
+/**
+ *  The number of query shapes observed.
+ */
+@property (readonly) NSUInteger observedStatementCount;
+/**
+ *  Records a query. Only queries (`SQLStatementQuery`) on a table are observed; the first statement observed for a shape is kept to explain & propose indexes.
+ *
+ *  @param statement The query.
+ *  @param sql       The sql generated by the statement (`newStatement`), which identifies it's shape.
+ */
+- (void) observeStatement:(SQLStatement *)statement sql:(NSString *)sql;
+/**
+ *  Explains every observed query and returns the advice for those that scan or sort (most observed first). If `createsIndexes` is YES, the proposed indexes are created.
+ *
+ *  This must be called on the database's queue. Use SQLDatabaseManager's `adviseIndexesWithBlock:` if the database is managed.
+ *
+ *  @param database The database to explain the queries on.
+ *
+ *  @return NSArray of SQLIndexAdvice
+ */
+- (NSArray *) adviceUsingDatabase:(SQLDatabase *)database;
+/**
+ *  Explains a single query and returns it's advice, whether or not it scans or sorts. The index isn't created, even if `createsIndexes` is YES.
+ *
+ *  @param statement The query.
+ *  @param database  The database to explain the query on.
+ *
+ *  @return SQLIndexAdvice, or `nil` if the statement isn't a query.
+ */
+- (SQLIndexAdvice *) adviceForStatement:(SQLStatement *)statement database:(SQLDatabase *)database;
+/**
+ *  Removes all the observed queries.
+ */
+- (void) reset;
+@end
@@ -0,0 +1,202 @@
+//
+//  SQLIndexAdvisor.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLIndexAdvisor.h"
+#import "SQLStatement.h"
+#import "SQLDatabase.h"
+#import <sqlite3.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define DefaultObservedStatementLimit 200
+
+@interface SQLIndexAdvice ()
+@property (readwrite) NSString *sql;
+@property (readwrite) NSString *tableName;
+@property (readwrite) NSUInteger observationCount;
+@property (readwrite) NSArray *queryPlan;
+@property (readwrite) BOOL fullScan;
+@property (readwrite) BOOL temporarySort;
+@property (readwrite) SQLStatement *proposedIndex;
+@property (readwrite) BOOL created;
+@end
+
+/**
+ *  An observed query shape: the first statement seen with the sql and how many times it's been seen.
+ */
+@interface SQLObservedStatement : NSObject
+@property (readonly) SQLStatement *statement;
+@property NSUInteger count;
+- (id) initWithStatement:(SQLStatement *)statement;
+@end
+
+@implementation SQLObservedStatement
+- (id) initWithStatement:(SQLStatement *)statement{
+  if ((self = [super init])){
+    _statement = statement;
+    _count = 0;
+  }
+  return self;
+}
+@end
+
+@implementation SQLIndexAdvisor {
+  //Keyed by sql
+  NSMutableDictionary *_observed;
+}
+#pragma mark - Init Methods
+- (id) init{
+  if ((self = [super init])){
+    _createsIndexes = NO;
+    _observedStatementLimit = DefaultObservedStatementLimit;
+    _observed = [NSMutableDictionary new];
+  }
+  return self;
+}
+#pragma mark - Private Methods
+- (SQLStatement *) proposedIndexForStatement:(SQLStatement *)statement{
+  /* Equality columns first (in any order, they're all matched exactly), then a single range column.
+   Without a range column, the orders can follow the equality columns so the index also sorts the results.
+   */
+  NSMutableArray *columnNames = [NSMutableArray new];
+  NSString *rangeColumn = nil;
+  NSUInteger count = 0;
+  for (id predicateItem in statement.predicates){
+    //An OR at the top level means the predicates can't be matched with a single index
+    if (count++ > 0 && [predicateItem connect] == SQLConnectOr) return nil;
+    if (![predicateItem isKindOfClass:[SQLPredicate class]]) continue;
+    SQLPredicate *predicate = predicateItem;
+    switch (predicate.op) {
+      case SQLEquals:
+      case SQLIn:
+        //An IN list is looked up as a set of equalities
+        if (![columnNames containsObject:predicate.column]) [columnNames addObject:predicate.column];
+        break;
+      case SQLGreaterThan:
+      case SQLGreaterThanOrEqualTo:
+      case SQLLessThan:
+      case SQLLessThanOrEqualTo:
+        if (!rangeColumn) rangeColumn = predicate.column;
+        break;
+      default:
+        break;
+    }
+  }
+  //The GUID is the primary key, so it's already indexed
+  if ([columnNames containsObject:GUIDKey]) return nil;
+  if (rangeColumn && ![columnNames containsObject:rangeColumn]) [columnNames addObject:rangeColumn];
+
+  SQLStatement *index = [[SQLStatement alloc] initWithType:SQLStatementCreateIndex forTable:statement.tableName];
+  for (NSString *columnName in columnNames){
+    [index addColumn:columnName];
+  }
+  if (!rangeColumn){
+    for (SQLOrder *order in statement.orderings){
+      if (order.customOrdering.count) break;
+      if ([columnNames containsObject:order.column]) continue;
+      [index addColumn:order.column];
+      [index addOrderParameter:[order copy]];
+    }
+  }
+  return index.orderedColumns.count ? index : nil;
+}
+- (SQLIndexAdvice *) explainStatement:(SQLStatement *)statement sql:(NSString *)sql parameters:(NSArray *)parameters database:(SQLDatabase *)database{
+  NSArray *rows = [database executeQuery:$(@"EXPLAIN QUERY PLAN %@", sql) withParameters:parameters];
+  NSMutableArray *queryPlan = [NSMutableArray arrayWithCapacity:rows.count];
+  BOOL fullScan = NO;
+  BOOL temporarySort = NO;
+  for (NSDictionary *row in rows){
+    NSString *detail = [row[@"detail"] description];
+    if (!detail) continue;
+    [queryPlan addObject:detail];
+    //ex: "SCAN Test" or "SCAN TABLE Test" (older versions). Scanning an index is only a problem if it's not covering.
+    if ([detail hasPrefix:@"SCAN "] && [detail rangeOfString:@"CONSTANT ROW"].location == NSNotFound && [detail rangeOfString:@"COVERING INDEX"].location == NSNotFound) fullScan = YES;
+    if ([detail rangeOfString:@"USE TEMP B-TREE"].location != NSNotFound) temporarySort = YES;
+  }
+  SQLIndexAdvice *advice = [SQLIndexAdvice new];
+  advice.sql = sql;
+  advice.tableName = statement.tableName;
+  advice.queryPlan = queryPlan;
+  advice.fullScan = fullScan;
+  advice.temporarySort = temporarySort;
+  if (fullScan || temporarySort) advice.proposedIndex = [self proposedIndexForStatement:statement];
+  return advice;
+}
+#pragma mark - Property Methods
+- (NSUInteger) observedStatementCount{
+  @synchronized(self){
+    return _observed.count;
+  }
+}
+#pragma mark - Standard Methods
+- (void) observeStatement:(SQLStatement *)statement sql:(NSString *)sql{
+  //Joins aren't advised: the proposed index only covers the statement's own table
+  if (!sql.length || statement.SQLType != SQLStatementQuery || statement.tableInfo || ![statement isKindOfClass:[SQLStatement class]] || statement.joins.count) return;
+  @synchronized(self){
+    SQLObservedStatement *observed = _observed[sql];
+    if (!observed){
+      if (_observed.count >= _observedStatementLimit) return;
+      observed = [[SQLObservedStatement alloc] initWithStatement:[statement copy]];
+      _observed[sql] = observed;
+    }
+    observed.count++;
+  }
+}
+- (NSArray *) adviceUsingDatabase:(SQLDatabase *)database{
+  NSDictionary *observed = nil;
+  @synchronized(self){
+    observed = [_observed copy];
+  }
+  NSMutableArray *adviceList = [NSMutableArray new];
+  NSMutableSet *createdIndexes = [NSMutableSet new];
+  [observed enumerateKeysAndObjectsUsingBlock:^(NSString *sql, SQLObservedStatement *observedStatement, BOOL *stop) {
+    //The statement's sql is regenerated for it's parameters, but the observed sql (the shape) is what's explained
+    SQLStatement *statement = [observedStatement.statement copy];
+    [statement newStatement];
+    SQLIndexAdvice *advice = [self explainStatement:statement sql:sql parameters:statement.parameters database:database];
+    if (!advice.fullScan && !advice.temporarySort) return;
+    advice.observationCount = observedStatement.count;
+    [adviceList addObject:advice];
+  }];
+  [adviceList sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"observationCount" ascending:NO]]];
+
+  if (_createsIndexes){
+    for (SQLIndexAdvice *advice in adviceList){
+      //Several queries can propose the same index
+      NSString *indexSQL = advice.proposedIndex.newStatement;
+      if (!indexSQL.length) continue;
+      if ([createdIndexes containsObject:indexSQL]){
+        advice.created = YES;
+        continue;
+      }
+      if ([database executeUpdateForResultCode:indexSQL withParameters:nil] == SQLITE_DONE){
+        advice.created = YES;
+        [createdIndexes addObject:indexSQL];
+      }
+    }
+  }
+  return adviceList;
+}
+- (SQLIndexAdvice *) adviceForStatement:(SQLStatement *)statement database:(SQLDatabase *)database{
+  if (statement.SQLType != SQLStatementQuery || statement.tableInfo || statement.joins.count) return nil;
+  statement = [statement copy];
+  NSString *sql = statement.newStatement;
+  if (!sql.length) return nil;
+  return [self explainStatement:statement sql:sql parameters:statement.parameters database:database];
+}
+- (void) reset{
+  @synchronized(self){
+    [_observed removeAllObjects];
+  }
+}
+@end
+
+@implementation SQLIndexAdvice
+- (NSString *) description{
+  return $(@"<%@: %p> %@%@%@: %@ (proposed: %@)", NSStringFromClass([self class]), self, _fullScan ? @"full scan" : @"", _fullScan && _temporarySort ? @", " : @"", _temporarySort ? @"temporary sort" : @"", _sql, _proposedIndex ? _proposedIndex.newStatement : @"nothing");
+}
+@end
@@ -0,0 +1,145 @@
+//
+//  SQLJoin.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "SQLPredicate.h"
+
+typedef NS_ENUM(NSUInteger, SQLJoinType){
+    /**
+     *  Only rows with a match in the joined table are returned.
+     */
+    SQLJoinInner,
+    /**
+     *  Every row is returned. The joined table's columns are NULL for rows without a match.
+     */
+    SQLJoinLeft,
+    /**
+     *  Every row is combined with every row of the joined table (unless predicates limit it).
+     */
+    SQLJoinCross
+};
+
+/**
+ *  SQLJoin joins another table into a SQLStatement query, so related rows can be read in a single query instead of a query per row. A join has:
+ *  - The table being joined, with an optional alias (use an alias to join the same table more than once).
+ *  - The columns to read from the joined table. If the join has a `keyPathPrefix`, each of these columns is returned as `<keyPathPrefix>.<column>`, so a row class can map them onto a related object (ex: `list.name`) and they won't collide with the statement's columns.
+ *  - The predicates the tables are joined on (the `ON` clause). A predicate's column belongs to the joined table and it's `valueColumn` to the statement's table, unless their `table`s say otherwise.
+ *
+ *  In the statement's own columns, predicates, orders & groups, set the `table` to the join's `qualifier` to refer to the joined table.
+ *
+ *  If you add this to any type of SQLStatement other than `SQLStatementQuery`, it will do nothing.
+ *  @warning A join is part of the statement's shape. If you change a join after compiling the statement, compile it again.
+ */
+@interface SQLJoin : NSObject <NSCopying>
+/**
+ *  The table being joined.
+ */
+@property (readonly) NSString *tableName;
+/**
+ *  How the table is joined.
+ *  Default: SQLJoinInner
+ */
+@property SQLJoinType joinType;
+/**
+ *  *optional* An alias for the joined table.
+ */
+@property (copy) NSString *alias;
+/**
+ *  The name the joined table is referred to by in the statement: the `alias` if there is one, otherwise the `tableName`.
+ */
+@property (readonly) NSString *qualifier;
+/**
+ *  *optional* If set, the join's columns that don't have an alias are returned as `<keyPathPrefix>.<column name>`. A row class will have the values set using the key path, so the row class must create the object at the prefix (ex: in `init`). Dictionary rows will have the full key path as a key.
+ */
+@property (copy) NSString *keyPathPrefix;
+/**
+ *  The SQLColumns read from the joined table, in the order they were added.
+ */
+@property (readonly) NSArray *columns;
+/**
+ *  The SQLPredicate & SQLPredicateGroup items the table is joined on.
+ */
+@property (readonly) NSArray *predicates;
+/**
+ *  This returns the join string to be used in the SQLStatement for this join.
+ */
+@property (readonly) NSString *joinTypeString;
+/**
+ *  Init a join for the table with the join type provided.
+ *
+ *  @param tableName The table to join. If this is `nil` or empty, `nil` is returned.
+ *  @param joinType  How the table is joined.
+ *
+ *  @return SQLJoin
+ */
+- (id) initWithTable:(NSString *)tableName joinType:(SQLJoinType)joinType;
+/**
+ *  Reads a column from the joined table. If a column with the same nameString is already in the join, it's returned instead.
+ *
+ *  @param column Name of the column.
+ *
+ *  @return The SQLColumn that was added or found.
+ */
+- (SQLColumn *) addColumn:(NSString *)column;
+/**
+ *  Reads a column from the joined table using an alias. The alias is used as is (the `keyPathPrefix` isn't added).
+ *
+ *  @param column Name of the column.
+ *  @param alias  Alias for the column.
+ *
+ *  @return The SQLColumn that was added or found.
+ */
+- (SQLColumn *) addColumn:(NSString *)column usingAlias:(NSString *)alias;
+/**
+ *  Adds the column to the join. If a column with the same nameString is already in the join, it's replaced.
+ *
+ *  @param column The SQLColumn to add.
+ *
+ *  @return The SQLColumn that was added.
+ */
+- (SQLColumn *) addSQLColumn:(SQLColumn *)column;
+/**
+ *  Removes all columns from the join.
+ */
+- (void) removeAllColumns;
+/**
+ *  Joins the table where the joined table's column equals a column in the statement's table (ex: `"List"."GUID" = "Item"."listGUID"`).
+ *
+ *  @param column      The column in the joined table.
+ *  @param otherColumn The column in the statement's table.
+ *
+ *  @return The SQLPredicate added to the join.
+ */
+- (SQLPredicate *) addPredicateForColumn:(NSString *)column matchingColumn:(NSString *)otherColumn;
+/**
+ *  Adds a predicate comparing a column in the joined table with a value. For a left join, this limits the rows that are joined without limiting the rows returned.
+ *
+ *  @param value  The predicate value.
+ *  @param column The column in the joined table.
+ *  @param op     The comparison operator.
+ *
+ *  @return The SQLPredicate added to the join.
+ */
+- (SQLPredicate *) addPredicate:(id)value forColumn:(NSString *)column operator:(SQLOperator)op;
+/**
+ *  Adds the predicate to the join.
+ *
+ *  @param predicate The predicate to add.
+ */
+- (void) addPredicate:(SQLPredicate *)predicate;
+/**
+ *  Adds the predicate group to the join.
+ *
+ *  @param group The group to add.
+ */
+- (void) addPredicateGroup:(SQLPredicateGroup *)group;
+/**
+ *  Removes all predicates from the join.
+ */
+- (void) removeAllPredicates;
+@end
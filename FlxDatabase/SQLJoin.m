@@ -0,0 +1,117 @@
+//
+//  SQLJoin.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLJoin.h"
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+
+@implementation SQLJoin{
+    NSMutableArray *_columns;
+    NSMutableArray *_predicates;
+}
+#pragma mark -
+#pragma mark Init Methods
+- (id) init{
+    return nil;
+}
+- (id) initWithTable:(NSString *)tableName joinType:(SQLJoinType)joinType{
+    if (!tableName.length) return nil;
+    if ((self = [super init])){
+        _tableName = [tableName copy];
+        _joinType = joinType;
+        _columns = [NSMutableArray new];
+        _predicates = [NSMutableArray new];
+    }
+    return self;
+}
+#pragma mark -
+#pragma mark Protocol Methods
+- (id) copyWithZone:(NSZone *)zone{
+    SQLJoin *copy = [[SQLJoin alloc] initWithTable:_tableName joinType:_joinType];
+    copy.alias = _alias;
+    copy.keyPathPrefix = _keyPathPrefix;
+    for (SQLColumn *column in _columns){
+        [copy addSQLColumn:[column copy]];
+    }
+    for (id predicate in _predicates){
+        [copy->_predicates addObject:[predicate copy]];
+    }
+    return copy;
+}
+#pragma mark -
+#pragma mark Properties
+- (NSString *) qualifier{
+    return _alias.length ? _alias : _tableName;
+}
+- (NSArray *) columns{
+    return [_columns copy];
+}
+- (NSArray *) predicates{
+    return [_predicates copy];
+}
+- (NSString *) joinTypeString{
+    switch (_joinType) {
+        case SQLJoinInner: return @"INNER JOIN";
+        case SQLJoinLeft: return @"LEFT JOIN";
+        case SQLJoinCross: return @"CROSS JOIN";
+        default: return @"INNER JOIN";
+    }
+}
+#pragma mark - Standard Methods
+- (SQLColumn *) addColumn:(NSString *)column{
+    return [self addColumn:column usingAlias:nil];
+}
+- (SQLColumn *) addColumn:(NSString *)column usingAlias:(NSString *)alias{
+    if (!column.length) return nil;
+    SQLColumn *newColumn = [[SQLColumn alloc] initWithColumn:column usingAlias:alias];
+    for (SQLColumn *existing in _columns){
+        if ([existing isEqual:newColumn]) return existing;
+    }
+    [_columns addObject:newColumn];
+    return newColumn;
+}
+- (SQLColumn *) addSQLColumn:(SQLColumn *)column{
+    if (!column.name.length) return nil;
+    NSUInteger index = [_columns indexOfObject:column];
+    if (index == NSNotFound){
+        [_columns addObject:column];
+    } else {
+        [_columns replaceObjectAtIndex:index withObject:column];
+    }
+    return column;
+}
+- (void) removeAllColumns{
+    [_columns removeAllObjects];
+}
+- (SQLPredicate *) addPredicateForColumn:(NSString *)column matchingColumn:(NSString *)otherColumn{
+    if (!column.length || !otherColumn.length) return nil;
+    SQLPredicate *predicate = [[SQLPredicate alloc] initWithColumn:column value:nil operator:SQLEquals connection:SQLConnectAnd];
+    predicate.valueColumn = otherColumn;
+    [_predicates addObject:predicate];
+    return predicate;
+}
+- (SQLPredicate *) addPredicate:(id)value forColumn:(NSString *)column operator:(SQLOperator)op{
+    if (!column.length) return nil;
+    SQLPredicate *predicate = [[SQLPredicate alloc] initWithColumn:column value:value operator:op connection:SQLConnectAnd];
+    [_predicates addObject:predicate];
+    return predicate;
+}
+- (void) addPredicate:(SQLPredicate *)predicate{
+    if (predicate) [_predicates addObject:predicate];
+}
+- (void) addPredicateGroup:(SQLPredicateGroup *)group{
+    if (group) [_predicates addObject:group];
+}
+- (void) removeAllPredicates{
+    [_predicates removeAllObjects];
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+    return $(@"%@ \"%@\"%@ (%lu columns, %lu predicates)", self.joinTypeString, _tableName, _alias.length ? $(@" AS \"%@\"", _alias) : @"", (unsigned long)_columns.count, (unsigned long)_predicates.count);
+}
+@end
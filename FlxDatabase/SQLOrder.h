@@ -26,6 +26,10 @@ typedef NS_ENUM(NSUInteger, SQLOrderDirection){
  The column name to order the query by. If this value is not set, no ordering will be generated.
  **/
 @property (strong) NSString *column;
+/**
+ The table (or table alias) of the column, used to order by a joined table's column (see `SQLJoin`). If 'nil', the column belongs to the statement's table. Default: nil.
+ **/
+@property (copy) NSString *table;
 /**
  The direction to order the column by. Default: Ascending.
  **/
@@ -32,6 +32,8 @@
 - (id) copyWithZone:(NSZone *)zone{
     SQLOrder *copy = [[SQLOrder alloc] initWithColumn:_column orderDirection:_orderDirection];
     copy.customOrdering = _customOrdering;
+    copy.caseSensitive = _caseSensitive;
+    copy.table = _table;
     return copy;
 }
 #pragma mark -
@@ -55,12 +57,13 @@
 }
 #pragma mark - Overridden Methods
 - (NSString *) description{
+    if (_table) return $(@"%@.%@ %@", _table, _column, self.orderDirectionString);
     return $(@"%@ %@", _column, self.orderDirectionString);
 }
 - (BOOL) isEqual:(id)object{
     if (![object isKindOfClass:[SQLOrder class]]) return NO;
     else {
-        return [_column isEqualToString:[object column]];
+        return [_column isEqualToString:[object column]] && (_table == [object table] || [_table isEqualToString:[object table]]);
     }
 }
 - (NSUInteger) hash{
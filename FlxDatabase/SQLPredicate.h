@@ -17,7 +17,23 @@ typedef NS_ENUM(NSUInteger, SQLOperator){
     SQLLessThan,
     SQLGreaterThanOrEqualTo,
     SQLLessThanOrEqualTo,
-    SQLNotEqualTo
+    SQLNotEqualTo,
+    /**
+     *  The column matches a value in the predicate's value: a collection (NSArray, NSSet or NSOrderedSet) or a SQLStatement query (a subquery) that returns a single column.
+     */
+    SQLIn,
+    /**
+     *  The column doesn't match any value in the predicate's collection or subquery.
+     */
+    SQLNotIn,
+    /**
+     *  The predicate's value is a SQLStatement query (a subquery) that returns at least one row. The column isn't used.
+     */
+    SQLExists,
+    /**
+     *  The predicate's value is a SQLStatement query (a subquery) that returns no rows. The column isn't used.
+     */
+    SQLNotExists
 };
 
 typedef NS_ENUM(NSUInteger, SQLConnect){
@@ -35,8 +51,25 @@ typedef NS_ENUM(NSUInteger, SQLConnect){
  *  Name of the column.  Yes, it's required for the predicate to work.
  */
 @property (copy) NSString *column;
+/**
+ *  The table (or table alias) of the column, used in queries with joins (see `SQLJoin`). If this is `nil`, the column belongs to the statement's table or, for a join's predicates, the joined table.
+ *  Default: nil
+ */
+@property (copy) NSString *table;
+/**
+ *  If set, the column is compared to this column instead of the `value` (ex: to join tables: `"List"."GUID" = "Item"."listGUID"`). Nothing is parameterized and `SQLEquals` & `SQLNotEqualTo` compare with `=` & `!=`, so NULL never matches (the same as a join in SQL).
+ *  Default: nil
+ */
+@property (copy) NSString *valueColumn;
+/**
+ *  The table (or table alias) of the `valueColumn`. If this is `nil`, the value column belongs to the statement's table.
+ *  Default: nil
+ */
+@property (copy) NSString *valueTable;
 /**
  *  The value by which the predicate is analyzed. If this value is `nil`, the predicate will be analyzed as NULL.
+ *
+ *  `SQLIn` & `SQLNotIn` take a collection (NSArray, NSSet or NSOrderedSet) or a SQLStatement query. A single value is treated as a collection of one and `nil` as an empty collection. `SQLExists` & `SQLNotExists` take a SQLStatement query.
  */
 @property (copy) id value;
 /**
@@ -90,6 +123,10 @@ typedef NS_ENUM(NSUInteger, SQLConnect){
  *  This returns the connect string to be used in the SQLStatement for this predicate.
  */
 @property (readonly) NSString *connectString;
+/**
+ *  Changes every time the group is changed (it's predicates, groups or connect). Versions only increase and are unique across all groups, so a compiled SQLStatement can tell if any of it's groups changed since it was compiled (it's recompiled the next time it's run).
+ */
+@property (readonly) int64_t version;
 /**
  *  Convenience init with a connect and a set of predicates.
  *
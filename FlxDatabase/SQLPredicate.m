@@ -7,6 +7,7 @@
 //
 
 #import "SQLPredicate.h"
+#import <libkern/OSAtomic.h>
 
 @implementation SQLPredicate
 #pragma mark -
@@ -37,6 +38,9 @@
     copy.value = _value;
     copy.op = _op;
     copy.connect = _connect;
+    copy.table = _table;
+    copy.valueColumn = _valueColumn;
+    copy.valueTable = _valueTable;
     
     return copy;
 }
@@ -62,12 +66,23 @@
         case SQLLessThanOrEqualTo: return @"<=";
         case SQLGreaterThanOrEqualTo: return @">=";
         case SQLNotLike: return @"NOT LIKE";
+        case SQLIn: return @"IN";
+        case SQLNotIn: return @"NOT IN";
+        case SQLExists: return @"EXISTS";
+        case SQLNotExists: return @"NOT EXISTS";
     }
 }
 @end
 
+static int64_t SQLNextGroupVersion(){
+    static volatile int64_t version = 0;
+    return OSAtomicIncrement64Barrier(&version);
+}
+
 @implementation SQLPredicateGroup {
     NSMutableArray *_predicates;
+    SQLConnect _connect;
+    volatile int64_t _version;
 }
 #pragma mark - Init Methods
 - (id) init{
@@ -77,19 +92,34 @@
     if (self = [super init]){
         _connect = connect;
         _predicates = predicates.count ? [NSMutableArray arrayWithArray:predicates] : [NSMutableArray array];
+        _version = SQLNextGroupVersion();
     }
     return self;
 }
 #pragma mark - Private Methods
+- (void) didChange{
+    _version = SQLNextGroupVersion();
+}
 
 #pragma mark - Protocol Methods
 #pragma mark - Properties
 - (void) setPredicates:(NSArray *)predicates{
     _predicates = [NSMutableArray arrayWithArray:predicates];
+    [self didChange];
 }
 - (NSArray *) predicates{
     return _predicates;
 }
+- (void) setConnect:(SQLConnect)connect{
+    _connect = connect;
+    [self didChange];
+}
+- (SQLConnect) connect{
+    return _connect;
+}
+- (int64_t) version{
+    return _version;
+}
 - (id) copyWithZone:(NSZone *)zone{
     NSMutableArray *predicates = [NSMutableArray arrayWithCapacity:_predicates.count];
     for (id predicate in _predicates){
@@ -111,21 +141,26 @@
 - (void) addPredicate:(SQLPredicate *)predicate{
     if (predicate)
         [_predicates addObject:predicate];
+    [self didChange];
 }
 - (void) removePredicate:(SQLPredicate *)predicate{
     if (predicate)
         [_predicates removeObject:predicate];
+    [self didChange];
 }
 - (void) removeAllPredicates{
     [_predicates removeAllObjects];
+    [self didChange];
 }
 - (void) addGroup:(SQLPredicateGroup *)group{
     if (group)
         [_predicates addObject:group];
+    [self didChange];
 }
 - (void) removeGroup:(SQLPredicateGroup *)group{
     if (group)
         [_predicates removeObject:group];
+    [self didChange];
 }
 #pragma mark - Overridden Methods
 
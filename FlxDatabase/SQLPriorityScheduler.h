@@ -0,0 +1,48 @@
+//
+//  SQLPriorityScheduler.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "SQLDatabaseManager.h"
+
+/**
+ *  SQLPriorityScheduler runs work on a serial queue in priority order instead of submission order. SQLDatabaseManager uses one for the database queue and one for the reader pool.
+ *
+ *  Work is kept in a FIFO lane per `SQLPriority`. Each piece of work submitted adds one pass to the queue, and each pass runs the next piece of work: the oldest in the highest lane. So that lower lanes aren't starved, the work at the front of each lane is raised a lane for every `agingInterval` it's waited. Ties go to the higher lane.
+ *
+ *  The scheduler is thread safe.
+ */
+@interface SQLPriorityScheduler : NSObject
+/**
+ *  How long work waits before it's raised a lane. 0 disables aging.
+ *  Default: 0.5 seconds
+ */
+@property NSTimeInterval agingInterval;
+/**
+ *  Initializes a scheduler that runs it's work on the queue provided.
+ *
+ *  @param queue A serial queue. It's retained by the scheduler.
+ *
+ *  @return SQLPriorityScheduler
+ */
+- (id) initWithQueue:(dispatch_queue_t)queue;
+/**
+ *  Adds work to it's priority's lane. It's run asynchronously, on the scheduler's queue, when it's next.
+ *
+ *  @param work     The work to run.
+ *  @param priority The lane to add the work to.
+ */
+- (void) performWork:(dispatch_block_t)work priority:(SQLPriority)priority;
+/**
+ *  Adds work to it's priority's lane and waits for it to run.
+ *  @warning Must not be called from the scheduler's queue.
+ *
+ *  @param work     The work to run.
+ *  @param priority The lane to add the work to.
+ */
+- (void) performWorkAndWait:(dispatch_block_t)work priority:(SQLPriority)priority;
+@end
@@ -0,0 +1,91 @@
+//
+//  SQLPriorityScheduler.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLPriorityScheduler.h"
+
+#define DefaultAgingInterval 0.5
+
+@interface SQLScheduledWork : NSObject
+@property (readonly) dispatch_block_t block;
+@property (readonly) CFAbsoluteTime submittedTime;
+- (id) initWithBlock:(dispatch_block_t)block;
+@end
+
+@implementation SQLScheduledWork
+- (id) initWithBlock:(dispatch_block_t)block{
+  if (self = [super init]){
+    _block = [block copy];
+    _submittedTime = CFAbsoluteTimeGetCurrent();
+  }
+  return self;
+}
+@end
+
+@implementation SQLPriorityScheduler{
+  dispatch_queue_t _queue;
+  //One FIFO of SQLScheduledWork per priority, guarded by itself
+  NSArray *_lanes;
+}
+- (id) initWithQueue:(dispatch_queue_t)queue{
+  if (self = [super init]){
+    _queue = queue;
+    dispatch_retain(_queue);
+    _lanes = @[[NSMutableArray new], [NSMutableArray new], [NSMutableArray new]];
+    _agingInterval = DefaultAgingInterval;
+  }
+  return self;
+}
+- (void) dealloc{
+  dispatch_release(_queue);
+}
+- (void) performWork:(dispatch_block_t)work priority:(SQLPriority)priority{
+  /* Every piece of work submitted adds one pass to the (serial) queue, and each pass runs whichever piece of work is next by priority, not necessarily the one it was added for.
+   */
+  SQLScheduledWork *scheduledWork = [[SQLScheduledWork alloc] initWithBlock:work];
+  @synchronized(_lanes){
+    [_lanes[MIN(priority, SQLPriorityInteractive)] addObject:scheduledWork];
+  }
+  dispatch_async(_queue, ^{
+    [self runNextWork];
+  });
+}
+- (void) performWorkAndWait:(dispatch_block_t)work priority:(SQLPriority)priority{
+  //Must not be called from the scheduler's queue
+  dispatch_semaphore_t finished = dispatch_semaphore_create(0);
+  [self performWork:^{
+    work();
+    dispatch_semaphore_signal(finished);
+  } priority:priority];
+  dispatch_semaphore_wait(finished, DISPATCH_TIME_FOREVER);
+  dispatch_release(finished);
+}
+- (void) runNextWork{
+  /* The next piece of work is the oldest in the highest lane, after aging: the work at the front of each lane is raised a lane for every aging interval it's waited. Ties go to the higher lane.
+   */
+  SQLScheduledWork *next = nil;
+  @synchronized(_lanes){
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    NSTimeInterval agingInterval = self.agingInterval;
+    NSMutableArray *nextLane = nil;
+    double nextPriority = -1;
+    for (NSInteger priority = SQLPriorityInteractive; priority >= (NSInteger)SQLPriorityBackground; priority--){
+      NSMutableArray *lane = _lanes[priority];
+      SQLScheduledWork *work = lane.firstObject;
+      if (!work) continue;
+      double agedPriority = priority + ((agingInterval > 0) ? floor((now - work.submittedTime) / agingInterval) : 0);
+      if (agedPriority > nextPriority){
+        nextPriority = agedPriority;
+        nextLane = lane;
+      }
+    }
+    next = nextLane.firstObject;
+    if (next) [nextLane removeObjectAtIndex:0];
+  }
+  if (next) next.block();
+}
+@end
@@ -0,0 +1,233 @@
+//
+//  SQLProfiler.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class SQLProfiler;
+@class SQLExecutionProfile;
+@class SQLStatementProfile;
+
+/**
+ *  A sink receives every execution a profiler records, so they can be sent somewhere else (a log, an analytics service, etc).
+ *
+ *  Sinks are called on the queue the statement was executed on (right after it executes), so keep them fast or hand the work off to another queue.
+ */
+@protocol SQLProfilerSink <NSObject>
+/**
+ *  Called for every execution the profiler records.
+ */
+- (void) profiler:(SQLProfiler *)profiler didProfileExecution:(SQLExecutionProfile *)execution;
+@optional
+/**
+ *  Called (after `profiler:didProfileExecution:`) for executions that took at least the profiler's `slowExecutionThreshold`.
+ */
+- (void) profiler:(SQLProfiler *)profiler didLogSlowExecution:(SQLExecutionProfile *)execution;
+@end
+
+/**
+ *  SQLProfiler records how long each statement takes to execute and aggregates it by the statement's sql (it's "shape": SQLStatement parameterizes it's values, so the same statement with different values has the same sql).
+ *
+ *  For each execution it records the time spent preparing (including binding), stepping and hydrating rows, the time the statement waited in SQLDatabaseManager's queues, the rows returned, the parameters bound and sqlite's statement counters (full scan steps, sorts and automatic indexes). Executions that take at least `slowExecutionThreshold` are kept in the slow execution log.
+ *
+ *  To profile, set the profiler on a SQLDatabase (or on SQLDatabaseManager, which sets it on all of it's connections). When there isn't a profiler, nothing is measured. Cursors (`cursorForQuery:`) aren't profiled, since the rows are stepped by the caller.
+ *
+ *  The profiler is thread safe, so one profiler can be shared by several connections.
+ */
+@interface SQLProfiler : NSObject
+/**
+ *  Executions that take at least this long (in seconds) are added to the slow execution log and sent to the sinks' `profiler:didLogSlowExecution:`. Queue wait isn't included.
+ *  Default: 0.1
+ */
+@property NSTimeInterval slowExecutionThreshold;
+/**
+ *  The maximum number of executions kept in the slow execution log. When it's full, the oldest executions are removed.
+ *  Default: 100
+ */
+@property NSUInteger slowExecutionLogLimit;
+/**
+ *  The maximum number of statement shapes profiled individually. Past this, executions of new shapes are only included in the profiler's totals (and the slow execution log). This keeps raw sql with literal values from growing the profiles without limit.
+ *  Default: 500
+ */
+@property NSUInteger statementProfileLimit;
+/**
+ *  Returns the slow executions logged (oldest first).
+ */
+@property (readonly) NSArray *slowExecutions;
+/**
+ *  Returns a snapshot of the profile of each statement shape, ordered by total duration (longest first).
+ */
+@property (readonly) NSArray *statementProfiles;
+/**
+ *  The number of executions recorded.
+ */
+@property (readonly) NSUInteger executionCount;
+/**
+ *  The total duration (in seconds) of all the executions recorded.
+ */
+@property (readonly) NSTimeInterval totalDuration;
+/**
+ *  A histogram of the duration of all the executions recorded: an NSArray of counts (NSNumber), one per bucket in `histogramBucketBounds` plus a final bucket for everything longer.
+ */
+@property (readonly) NSArray *durationHistogram;
+/**
+ *  The upper bounds (in seconds, NSNumber) of the duration histogram buckets. A duration falls in the first bucket whose bound it's less than.
+ */
++ (NSArray *) histogramBucketBounds;
+/**
+ *  Returns a snapshot of the profile for the sql, or `nil` if it hasn't been profiled.
+ */
+- (SQLStatementProfile *) profileForSQL:(NSString *)sql;
+/**
+ *  Adds a sink. Sinks are retained until they're removed.
+ */
+- (void) addSink:(id <SQLProfilerSink>)sink;
+/**
+ *  Removes a sink.
+ */
+- (void) removeSink:(id <SQLProfilerSink>)sink;
+/**
+ *  Removes all the profiles, the slow execution log and the totals. Sinks are kept.
+ */
+- (void) reset;
+@end
+
+/**
+ *  A single execution of a statement.
+ */
+@interface SQLExecutionProfile : NSObject
+/**
+ *  The sql executed.
+ */
+@property (readonly) NSString *sql;
+/**
+ *  When the execution started.
+ */
+@property (readonly) NSDate *date;
+/**
+ *  The number of parameters bound.
+ */
+@property (readonly) NSUInteger parameterCount;
+/**
+ *  The number of rows returned by a query, or the number of rows changed by an update.
+ */
+@property (readonly) NSUInteger rowCount;
+/**
+ *  NO if the prepared statement was reused from the statement cache.
+ */
+@property (readonly) BOOL prepared;
+/**
+ *  The time (in seconds) spent preparing the statement and binding it's parameters.
+ */
+@property (readonly) NSTimeInterval prepareDuration;
+/**
+ *  The time (in seconds) spent in sqlite stepping through the statement.
+ */
+@property (readonly) NSTimeInterval stepDuration;
+/**
+ *  The time (in seconds) spent copying the rows into row objects (or a result set).
+ */
+@property (readonly) NSTimeInterval hydrationDuration;
+/**
+ *  The total time (in seconds) of the execution: prepare + step + hydration.
+ */
+@property (readonly) NSTimeInterval duration;
+/**
+ *  The time (in seconds) the statement waited in SQLDatabaseManager's queues before it was executed, or `0` if it wasn't queued.
+ */
+@property (readonly) NSTimeInterval queueWait;
+/**
+ *  The number of times sqlite stepped forward through a table as part of a full table scan (`SQLITE_STMTSTATUS_FULLSCAN_STEP`). A large number usually means an index is missing.
+ */
+@property (readonly) NSUInteger fullScanSteps;
+/**
+ *  The number of sorts sqlite had to perform (`SQLITE_STMTSTATUS_SORT`), ex: an ORDER BY without an index.
+ */
+@property (readonly) NSUInteger sorts;
+/**
+ *  The number of rows inserted into automatic (transient) indexes (`SQLITE_STMTSTATUS_AUTOINDEX`). This also usually means an index is missing.
+ */
+@property (readonly) NSUInteger autoIndexRows;
+/**
+ *  YES if the execution took at least the profiler's `slowExecutionThreshold`.
+ */
+@property (readonly) BOOL slow;
+@end
+
+/**
+ *  The aggregate of every execution of a statement shape (sql).
+ */
+@interface SQLStatementProfile : NSObject <NSCopying>
+/**
+ *  The sql profiled.
+ */
+@property (readonly) NSString *sql;
+/**
+ *  The number of executions.
+ */
+@property (readonly) NSUInteger executionCount;
+/**
+ *  The number of executions that had to prepare the statement (the rest reused it from the statement cache).
+ */
+@property (readonly) NSUInteger prepareCount;
+/**
+ *  The total number of parameters bound.
+ */
+@property (readonly) NSUInteger parameterCount;
+/**
+ *  The total number of rows returned (or changed).
+ */
+@property (readonly) NSUInteger rowCount;
+/**
+ *  The number of executions that were slow.
+ */
+@property (readonly) NSUInteger slowCount;
+/**
+ *  The total time (in seconds) spent preparing & binding.
+ */
+@property (readonly) NSTimeInterval prepareDuration;
+/**
+ *  The total time (in seconds) spent stepping.
+ */
+@property (readonly) NSTimeInterval stepDuration;
+/**
+ *  The total time (in seconds) spent hydrating rows.
+ */
+@property (readonly) NSTimeInterval hydrationDuration;
+/**
+ *  The total time (in seconds) spent waiting in queues.
+ */
+@property (readonly) NSTimeInterval queueWait;
+/**
+ *  The total time (in seconds) of all the executions.
+ */
+@property (readonly) NSTimeInterval totalDuration;
+/**
+ *  The average time (in seconds) of an execution.
+ */
+@property (readonly) NSTimeInterval averageDuration;
+/**
+ *  The longest time (in seconds) of an execution.
+ */
+@property (readonly) NSTimeInterval maxDuration;
+/**
+ *  The total full scan steps.
+ */
+@property (readonly) NSUInteger fullScanSteps;
+/**
+ *  The total sorts.
+ */
+@property (readonly) NSUInteger sorts;
+/**
+ *  The total rows inserted into automatic indexes.
+ */
+@property (readonly) NSUInteger autoIndexRows;
+/**
+ *  A histogram of the execution durations. See SQLProfiler's `histogramBucketBounds`.
+ */
+@property (readonly) NSArray *durationHistogram;
+@end
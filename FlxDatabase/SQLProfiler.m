@@ -0,0 +1,256 @@
+//
+//  SQLProfiler.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLProfiler.h"
+#import <sqlite3.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define DefaultSlowExecutionThreshold 0.1
+#define DefaultSlowExecutionLogLimit 100
+#define DefaultStatementProfileLimit 500
+#define SQLHistogramBucketCount 10
+
+//Upper bounds in seconds; the last bucket is everything from the last bound up
+static const NSTimeInterval SQLHistogramBounds[SQLHistogramBucketCount - 1] = { 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0 };
+
+static NSUInteger SQLHistogramBucket(NSTimeInterval duration){
+  NSUInteger bucket = 0;
+  while (bucket < SQLHistogramBucketCount - 1 && duration >= SQLHistogramBounds[bucket]) bucket++;
+  return bucket;
+}
+
+static NSArray *SQLHistogramArray(const NSUInteger *histogram){
+  NSMutableArray *counts = [NSMutableArray arrayWithCapacity:SQLHistogramBucketCount];
+  for (NSUInteger i = 0; i < SQLHistogramBucketCount; i++){
+    [counts addObject:@(histogram[i])];
+  }
+  return counts;
+}
+
+@interface SQLExecutionProfile ()
+@property (readwrite) NSString *sql;
+@property (readwrite) NSDate *date;
+@property (readwrite) NSUInteger parameterCount;
+@property (readwrite) NSUInteger rowCount;
+@property (readwrite) BOOL prepared;
+@property (readwrite) NSTimeInterval prepareDuration;
+@property (readwrite) NSTimeInterval stepDuration;
+@property (readwrite) NSTimeInterval hydrationDuration;
+@property (readwrite) NSTimeInterval queueWait;
+@property (readwrite) NSUInteger fullScanSteps;
+@property (readwrite) NSUInteger sorts;
+@property (readwrite) NSUInteger autoIndexRows;
+@property (readwrite) BOOL slow;
+@end
+
+@interface SQLStatementProfile ()
+- (id) initWithSQL:(NSString *)sql;
+- (void) addExecution:(SQLExecutionProfile *)execution;
+@end
+
+@implementation SQLProfiler {
+  //Keyed by sql
+  NSMutableDictionary *_profiles;
+  NSMutableArray *_slowExecutions;
+  NSMutableArray *_sinks;
+  NSUInteger _executionCount;
+  NSTimeInterval _totalDuration;
+  NSUInteger _histogram[SQLHistogramBucketCount];
+}
+#pragma mark - Init Methods
+- (id) init{
+  if ((self = [super init])){
+    _slowExecutionThreshold = DefaultSlowExecutionThreshold;
+    _slowExecutionLogLimit = DefaultSlowExecutionLogLimit;
+    _statementProfileLimit = DefaultStatementProfileLimit;
+    _profiles = [NSMutableDictionary new];
+    _slowExecutions = [NSMutableArray new];
+    _sinks = [NSMutableArray new];
+    _executionCount = 0;
+    _totalDuration = 0;
+    memset(_histogram, 0, sizeof(_histogram));
+  }
+  return self;
+}
+#pragma mark - Private Methods
+- (void) recordSQL:(NSString *)sql statement:(sqlite3_stmt *)statement parameterCount:(NSUInteger)parameterCount rowCount:(NSUInteger)rowCount prepared:(BOOL)prepared prepareDuration:(NSTimeInterval)prepareDuration stepDuration:(NSTimeInterval)stepDuration hydrationDuration:(NSTimeInterval)hydrationDuration queueWait:(NSTimeInterval)queueWait{
+  /* Called by SQLDatabase after a statement executes, before the statement is reset
+   - sqlite's counters are read and reset, so a cached statement starts from zero the next time it's run
+   - the execution is aggregated & logged under the lock, then sent to the sinks outside of it
+   */
+  SQLExecutionProfile *execution = [SQLExecutionProfile new];
+  execution.sql = sql;
+  execution.date = [NSDate dateWithTimeIntervalSinceNow:-(prepareDuration + stepDuration + hydrationDuration)];
+  execution.parameterCount = parameterCount;
+  execution.rowCount = rowCount;
+  execution.prepared = prepared;
+  execution.prepareDuration = prepareDuration;
+  execution.stepDuration = stepDuration;
+  execution.hydrationDuration = hydrationDuration;
+  execution.queueWait = queueWait;
+  execution.fullScanSteps = (NSUInteger)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+  execution.sorts = (NSUInteger)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_SORT, 1);
+  execution.autoIndexRows = (NSUInteger)sqlite3_stmt_status(statement, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+
+  NSArray *sinks = nil;
+  @synchronized(self){
+    execution.slow = (execution.duration >= _slowExecutionThreshold);
+    _executionCount++;
+    _totalDuration += execution.duration;
+    _histogram[SQLHistogramBucket(execution.duration)]++;
+    SQLStatementProfile *profile = _profiles[sql];
+    if (!profile && _profiles.count < _statementProfileLimit){
+      profile = [[SQLStatementProfile alloc] initWithSQL:sql];
+      _profiles[sql] = profile;
+    }
+    [profile addExecution:execution];
+    if (execution.slow && _slowExecutionLogLimit > 0){
+      [_slowExecutions addObject:execution];
+      if (_slowExecutions.count > _slowExecutionLogLimit) [_slowExecutions removeObjectsInRange:NSMakeRange(0, _slowExecutions.count - _slowExecutionLogLimit)];
+    }
+    if (_sinks.count) sinks = [_sinks copy];
+  }
+  for (id <SQLProfilerSink> sink in sinks){
+    [sink profiler:self didProfileExecution:execution];
+    if (execution.slow && [sink respondsToSelector:@selector(profiler:didLogSlowExecution:)]) [sink profiler:self didLogSlowExecution:execution];
+  }
+}
+#pragma mark - Property Methods
+- (NSArray *) slowExecutions{
+  @synchronized(self){
+    return [_slowExecutions copy];
+  }
+}
+- (NSArray *) statementProfiles{
+  NSMutableArray *profiles = [NSMutableArray new];
+  @synchronized(self){
+    for (SQLStatementProfile *profile in _profiles.allValues){
+      [profiles addObject:[profile copy]];
+    }
+  }
+  [profiles sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"totalDuration" ascending:NO]]];
+  return profiles;
+}
+- (NSUInteger) executionCount{
+  @synchronized(self){
+    return _executionCount;
+  }
+}
+- (NSTimeInterval) totalDuration{
+  @synchronized(self){
+    return _totalDuration;
+  }
+}
+- (NSArray *) durationHistogram{
+  @synchronized(self){
+    return SQLHistogramArray(_histogram);
+  }
+}
++ (NSArray *) histogramBucketBounds{
+  NSMutableArray *bounds = [NSMutableArray arrayWithCapacity:SQLHistogramBucketCount - 1];
+  for (NSUInteger i = 0; i < SQLHistogramBucketCount - 1; i++){
+    [bounds addObject:@(SQLHistogramBounds[i])];
+  }
+  return bounds;
+}
+#pragma mark - Standard Methods
+- (SQLStatementProfile *) profileForSQL:(NSString *)sql{
+  if (!sql) return nil;
+  @synchronized(self){
+    return [_profiles[sql] copy];
+  }
+}
+- (void) addSink:(id <SQLProfilerSink>)sink{
+  if (!sink) return;
+  @synchronized(self){
+    if (![_sinks containsObject:sink]) [_sinks addObject:sink];
+  }
+}
+- (void) removeSink:(id <SQLProfilerSink>)sink{
+  @synchronized(self){
+    [_sinks removeObject:sink];
+  }
+}
+- (void) reset{
+  @synchronized(self){
+    [_profiles removeAllObjects];
+    [_slowExecutions removeAllObjects];
+    _executionCount = 0;
+    _totalDuration = 0;
+    memset(_histogram, 0, sizeof(_histogram));
+  }
+}
+@end
+
+@implementation SQLExecutionProfile
+- (NSTimeInterval) duration{
+  return _prepareDuration + _stepDuration + _hydrationDuration;
+}
+- (NSString *) description{
+  return $(@"<%@: %p> %.3fms (prepare %.3fms, step %.3fms, hydrate %.3fms, queued %.3fms), %lu rows, %lu full scan steps, %lu sorts, %lu auto index rows%@: %@", NSStringFromClass([self class]), self, self.duration * 1000, _prepareDuration * 1000, _stepDuration * 1000, _hydrationDuration * 1000, _queueWait * 1000, (unsigned long)_rowCount, (unsigned long)_fullScanSteps, (unsigned long)_sorts, (unsigned long)_autoIndexRows, _slow ? @" (slow)" : @"", _sql);
+}
+@end
+
+@implementation SQLStatementProfile {
+  NSUInteger _histogram[SQLHistogramBucketCount];
+}
+- (id) initWithSQL:(NSString *)sql{
+  if ((self = [super init])){
+    _sql = [sql copy];
+    memset(_histogram, 0, sizeof(_histogram));
+  }
+  return self;
+}
+- (void) addExecution:(SQLExecutionProfile *)execution{
+  //Called under the profiler's lock
+  NSTimeInterval duration = execution.duration;
+  _executionCount++;
+  if (execution.prepared) _prepareCount++;
+  if (execution.slow) _slowCount++;
+  _parameterCount += execution.parameterCount;
+  _rowCount += execution.rowCount;
+  _prepareDuration += execution.prepareDuration;
+  _stepDuration += execution.stepDuration;
+  _hydrationDuration += execution.hydrationDuration;
+  _queueWait += execution.queueWait;
+  _totalDuration += duration;
+  _maxDuration = MAX(_maxDuration, duration);
+  _fullScanSteps += execution.fullScanSteps;
+  _sorts += execution.sorts;
+  _autoIndexRows += execution.autoIndexRows;
+  _histogram[SQLHistogramBucket(duration)]++;
+}
+- (id) copyWithZone:(NSZone *)zone{
+  SQLStatementProfile *copy = [[SQLStatementProfile allocWithZone:zone] initWithSQL:_sql];
+  copy->_executionCount = _executionCount;
+  copy->_prepareCount = _prepareCount;
+  copy->_parameterCount = _parameterCount;
+  copy->_rowCount = _rowCount;
+  copy->_slowCount = _slowCount;
+  copy->_prepareDuration = _prepareDuration;
+  copy->_stepDuration = _stepDuration;
+  copy->_hydrationDuration = _hydrationDuration;
+  copy->_queueWait = _queueWait;
+  copy->_totalDuration = _totalDuration;
+  copy->_maxDuration = _maxDuration;
+  copy->_fullScanSteps = _fullScanSteps;
+  copy->_sorts = _sorts;
+  copy->_autoIndexRows = _autoIndexRows;
+  memcpy(copy->_histogram, _histogram, sizeof(_histogram));
+  return copy;
+}
+- (NSTimeInterval) averageDuration{
+  return _executionCount ? _totalDuration / _executionCount : 0;
+}
+- (NSArray *) durationHistogram{
+  return SQLHistogramArray(_histogram);
+}
+- (NSString *) description{
+  return $(@"<%@: %p> %lu executions, %.3fms total, %.3fms average, %.3fms max, %lu rows, %lu full scan steps, %lu sorts, %lu auto index rows: %@", NSStringFromClass([self class]), self, (unsigned long)_executionCount, _totalDuration * 1000, self.averageDuration * 1000, _maxDuration * 1000, (unsigned long)_rowCount, (unsigned long)_fullScanSteps, (unsigned long)_sorts, (unsigned long)_autoIndexRows, _sql);
+}
+@end
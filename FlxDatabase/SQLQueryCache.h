@@ -0,0 +1,115 @@
+//
+//  SQLQueryCache.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class SQLQueryCacheMetrics;
+
+/**
+ *  SQLQueryCache holds the results of recent queries, keyed by the query's sql, parameters and row class, so identical queries can be answered without going to the database. Results are tagged with the table they were queried from, so they can be invalidated when that table changes.
+ *
+ *  The cache is bounded by an (estimated) number of bytes. When it's full, the least recently used results are evicted.
+ *
+ *  Results are returned the way they were cached, except for NSMutableDictionary rows, which are copied so every caller gets their own rows to modify. Custom row objects that conform to NSCopying are copied as well; any other row objects are shared between callers, so don't modify them. SQLResultSets are immutable, so they're always shared.
+ *
+ *  *Generations*
+ *  A query can be reading an older commit while a table is being invalidated, in which case it's results shouldn't be cached. To prevent this, get the `generation` before the query's read transaction begins and pass it in when you cache the results. If the table was invalidated after that, the results aren't cached.
+ *
+ *  The cache is thread safe. Normally, you'd use this through SQLDatabaseManager's `enableQueryCacheWithByteLimit:`, which takes care of all this.
+ */
+@interface SQLQueryCache : NSObject
+/**
+ *  The maximum (estimated) number of bytes the cache will hold.
+ */
+@property (readonly) NSUInteger byteLimit;
+/**
+ *  The current generation. This changes every time the cache is invalidated.
+ */
+@property (readonly) NSUInteger generation;
+/**
+ *  Returns a snapshot of the cache metrics.
+ */
+@property (readonly) SQLQueryCacheMetrics *metrics;
+/**
+ *  Initializes a cache.
+ *
+ *  @param byteLimit The maximum (estimated) number of bytes to hold.
+ *
+ *  @return SQLQueryCache
+ */
+- (id) initWithByteLimit:(NSUInteger)byteLimit;
+/**
+ *  Returns the cached results (an NSArray of rows or a SQLResultSet) for the query, or `nil` if there are none. This counts as a hit or a miss.
+ *
+ *  @param sql        The query's sql.
+ *  @param parameters The query's parameters.
+ *  @param rowClass   The row class (NSMutableDictionary if nil). Use `[SQLResultSet class]` for result sets.
+ *
+ *  @return The cached results or `nil`.
+ */
+- (id) resultsForSQL:(NSString *)sql parameters:(NSArray *)parameters rowClass:(Class)rowClass;
+/**
+ *  Caches the results of a query.
+ *
+ *  @param results    The results: an NSArray of rows or a SQLResultSet.
+ *  @param sql        The query's sql.
+ *  @param parameters The query's parameters.
+ *  @param rowClass   The row class (NSMutableDictionary if nil). Use `[SQLResultSet class]` for result sets.
+ *  @param tableName  The table queried. Results without a table aren't cached, since they can't be invalidated.
+ *  @param generation The `generation` from before the query's read transaction began.
+ */
+- (void) cacheResults:(id)results forSQL:(NSString *)sql parameters:(NSArray *)parameters rowClass:(Class)rowClass tableName:(NSString *)tableName generation:(NSUInteger)generation;
+/**
+ *  Removes all the results queried from the tables.
+ *
+ *  @param tableNames The names of the tables that changed.
+ */
+- (void) invalidateTables:(NSSet *)tableNames;
+/**
+ *  Removes all results from the cache.
+ */
+- (void) removeAllResults;
+/**
+ *  Resets the metrics. The byte size & entry count aren't affected.
+ */
+- (void) resetMetrics;
+@end
+
+/**
+ *  Metrics for a SQLQueryCache.
+ */
+@interface SQLQueryCacheMetrics : NSObject
+/**
+ *  The number of lookups that found cached results.
+ */
+@property (readonly) NSUInteger hits;
+/**
+ *  The number of lookups that didn't find cached results.
+ */
+@property (readonly) NSUInteger misses;
+/**
+ *  The fraction of lookups that were hits (0 - 1).
+ */
+@property (readonly) double hitRate;
+/**
+ *  The number of results evicted to stay under the byte limit.
+ */
+@property (readonly) NSUInteger evictions;
+/**
+ *  The number of results removed because their table changed.
+ */
+@property (readonly) NSUInteger invalidations;
+/**
+ *  The (estimated) number of bytes currently cached.
+ */
+@property (readonly) NSUInteger byteSize;
+/**
+ *  The number of results currently cached.
+ */
+@property (readonly) NSUInteger entryCount;
+@end
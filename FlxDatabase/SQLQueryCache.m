@@ -0,0 +1,273 @@
+//
+//  SQLQueryCache.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLQueryCache.h"
+#import "SQLResultSet.h"
+#import <objc/runtime.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define ObjectOverhead 16
+
+@interface SQLQueryCacheEntry : NSObject
+@property (readonly) id results;
+@property (readonly) NSString *tableName;
+@property (readonly) NSUInteger byteSize;
+- (id) initWithResults:(id)results tableName:(NSString *)tableName byteSize:(NSUInteger)byteSize;
+@end
+
+@implementation SQLQueryCacheEntry
+- (id) initWithResults:(id)results tableName:(NSString *)tableName byteSize:(NSUInteger)byteSize{
+  if ((self = [super init])){
+    _results = results;
+    _tableName = tableName;
+    _byteSize = byteSize;
+  }
+  return self;
+}
+@end
+
+@interface SQLQueryCacheMetrics ()
+@property NSUInteger hits;
+@property NSUInteger misses;
+@property NSUInteger evictions;
+@property NSUInteger invalidations;
+@property NSUInteger byteSize;
+@property NSUInteger entryCount;
+@end
+
+@implementation SQLQueryCache {
+  //Keyed by query key, ordered from least to most recently used
+  NSMutableDictionary *_entries;
+  NSMutableOrderedSet *_entryOrder;
+  //Query keys by table name, for invalidation
+  NSMutableDictionary *_tableKeys;
+  //The generation each table was last invalidated in
+  NSMutableDictionary *_tableGenerations;
+  NSUInteger _clearedGeneration;
+  NSUInteger _byteSize;
+  SQLQueryCacheMetrics *_metrics;
+}
+#pragma mark - Init Methods
+- (id) initWithByteLimit:(NSUInteger)byteLimit{
+  if ((self = [super init])){
+    _byteLimit = byteLimit;
+    _entries = [NSMutableDictionary new];
+    _entryOrder = [NSMutableOrderedSet new];
+    _tableKeys = [NSMutableDictionary new];
+    _tableGenerations = [NSMutableDictionary new];
+    _generation = 0;
+    _clearedGeneration = 0;
+    _byteSize = 0;
+    _metrics = [SQLQueryCacheMetrics new];
+  }
+  return self;
+}
+#pragma mark - Private Methods
+static void SQLAppendHexBytes(NSMutableString *key, NSData *data){
+  //The data's description is truncated on newer systems & base64 needs iOS 7, so the bytes are hex encoded here
+  static const char digits[] = "0123456789abcdef";
+  const unsigned char *bytes = [data bytes];
+  NSUInteger length = [data length];
+  char *hex = malloc(length * 2);
+  if (!hex) return;
+  for (NSUInteger i = 0; i < length; i++){
+    hex[i * 2] = digits[bytes[i] >> 4];
+    hex[i * 2 + 1] = digits[bytes[i] & 0x0F];
+  }
+  NSString *encoded = [[NSString alloc] initWithBytesNoCopy:hex length:length * 2 encoding:NSASCIIStringEncoding freeWhenDone:YES];
+  if (encoded) [key appendString:encoded];
+  else free(hex);
+}
+static void SQLAppendParameterKey(NSMutableString *key, id parameter){
+  /* Parameters are keyed by the exact value that's bound, not their description: a date's description only has one second resolution and a double's drops digits, so different values could share results.
+   - The type is part of the key so @"1" and @1 don't share results
+   - Strings & data are prefixed by their length, so a value can't run into the next one
+   */
+  if ([parameter isKindOfClass:[NSString class]]){
+    [key appendFormat:@"\ns%lu:%@", (unsigned long)[parameter length], parameter];
+  } else if ([parameter isKindOfClass:[NSNumber class]]){
+    const char *type = [parameter objCType];
+    if (strcmp(type, @encode(double)) == 0 || strcmp(type, @encode(float)) == 0){
+      [key appendFormat:@"\nn%s:%a", type, [parameter doubleValue]];
+    } else if (strcmp(type, @encode(int)) == 0 || strcmp(type, @encode(long)) == 0 || strcmp(type, @encode(long long)) == 0){
+      [key appendFormat:@"\nn%s:%lld", type, [parameter longLongValue]];
+    } else {
+      //Bound as it's description (see SQLDatabase)
+      [key appendFormat:@"\nn%s:%@", type, parameter];
+    }
+  } else if ([parameter isKindOfClass:[NSData class]]){
+    [key appendFormat:@"\nb%lu:", (unsigned long)[parameter length]];
+    SQLAppendHexBytes(key, parameter);
+  } else if ([parameter isKindOfClass:[NSDate class]]){
+    [key appendFormat:@"\nd:%a", [parameter timeIntervalSinceReferenceDate]];
+  } else if (!parameter || parameter == [NSNull null]){
+    [key appendString:@"\n0"];
+  } else {
+    NSString *description = [parameter description];
+    [key appendFormat:@"\no%lu:%@", (unsigned long)description.length, description];
+  }
+}
+- (NSString *) keyForSQL:(NSString *)sql parameters:(NSArray *)parameters rowClass:(Class)rowClass{
+  NSMutableString *key = [NSMutableString stringWithFormat:@"%@\n%@", NSStringFromClass(rowClass ?: [NSMutableDictionary class]), sql];
+  for (id parameter in parameters){
+    SQLAppendParameterKey(key, parameter);
+  }
+  return key;
+}
+static NSUInteger SQLEstimatedValueSize(id value){
+  if ([value isKindOfClass:[NSString class]]) return ObjectOverhead + [value length] * sizeof(unichar);
+  if ([value isKindOfClass:[NSData class]]) return ObjectOverhead + [value length];
+  return ObjectOverhead;
+}
+static NSUInteger SQLEstimatedSize(id results){
+  /* Estimates how much memory the results take up
+   - Result sets know exactly how much they've allocated
+   - Dictionary rows are estimated from their keys & values
+   - Any other row is estimated from it's instance size (which doesn't include the objects it references)
+   */
+  if ([results isKindOfClass:[SQLResultSet class]]) return ObjectOverhead + [results byteSize];
+  NSUInteger size = ObjectOverhead + [results count] * sizeof(id);
+  for (id row in results){
+    if ([row isKindOfClass:[NSDictionary class]]){
+      size += ObjectOverhead;
+      for (id key in row){
+        size += sizeof(id) * 2 + SQLEstimatedValueSize(key) + SQLEstimatedValueSize(row[key]);
+      }
+    } else {
+      size += class_getInstanceSize([row class]);
+    }
+  }
+  return size;
+}
+static id SQLCopyResults(id results){
+  if (![results isKindOfClass:[NSArray class]]) return results;
+  NSMutableArray *rows = [NSMutableArray arrayWithCapacity:[results count]];
+  for (id row in results){
+    if ([row isKindOfClass:[NSMutableDictionary class]]){
+      [rows addObject:[row mutableCopy]];
+    } else if ([row conformsToProtocol:@protocol(NSCopying)]){
+      [rows addObject:[row copy]];
+    } else {
+      [rows addObject:row];
+    }
+  }
+  return rows;
+}
+- (void) removeEntryForKey:(NSString *)key{
+  SQLQueryCacheEntry *entry = _entries[key];
+  if (!entry) return;
+  _byteSize -= entry.byteSize;
+  [_entries removeObjectForKey:key];
+  [_entryOrder removeObject:key];
+  [_tableKeys[entry.tableName] removeObject:key];
+}
+#pragma mark - Property Methods
+- (NSUInteger) generation{
+  @synchronized(self){
+    return _generation;
+  }
+}
+- (SQLQueryCacheMetrics *) metrics{
+  SQLQueryCacheMetrics *metrics = [SQLQueryCacheMetrics new];
+  @synchronized(self){
+    metrics.hits = _metrics.hits;
+    metrics.misses = _metrics.misses;
+    metrics.evictions = _metrics.evictions;
+    metrics.invalidations = _metrics.invalidations;
+    metrics.byteSize = _byteSize;
+    metrics.entryCount = _entries.count;
+  }
+  return metrics;
+}
+#pragma mark - Standard Methods
+- (id) resultsForSQL:(NSString *)sql parameters:(NSArray *)parameters rowClass:(Class)rowClass{
+  if (!sql.length) return nil;
+  NSString *key = [self keyForSQL:sql parameters:parameters rowClass:rowClass];
+  id results = nil;
+  @synchronized(self){
+    SQLQueryCacheEntry *entry = _entries[key];
+    if (entry){
+      _metrics.hits++;
+      [_entryOrder removeObject:key];
+      [_entryOrder addObject:key];
+      results = entry.results;
+    } else {
+      _metrics.misses++;
+    }
+  }
+  //Copying happens outside the lock; the cached rows themselves are never modified
+  return SQLCopyResults(results);
+}
+- (void) cacheResults:(id)results forSQL:(NSString *)sql parameters:(NSArray *)parameters rowClass:(Class)rowClass tableName:(NSString *)tableName generation:(NSUInteger)generation{
+  if (!results || !sql.length || !tableName.length) return;
+  NSUInteger byteSize = SQLEstimatedSize(results);
+  if (byteSize > _byteLimit) return;
+  NSString *key = [self keyForSQL:sql parameters:parameters rowClass:rowClass];
+  //Cache a copy, so the caller can modify the rows they were given
+  SQLQueryCacheEntry *entry = [[SQLQueryCacheEntry alloc] initWithResults:SQLCopyResults(results) tableName:tableName byteSize:byteSize];
+  @synchronized(self){
+    //The table (or the whole cache) changed after the query started, so the results may be stale
+    if (_clearedGeneration > generation || [_tableGenerations[tableName] unsignedIntegerValue] > generation) return;
+    [self removeEntryForKey:key];
+    while (_byteSize + byteSize > _byteLimit && _entryOrder.count){
+      [self removeEntryForKey:_entryOrder.firstObject];
+      _metrics.evictions++;
+    }
+    _entries[key] = entry;
+    [_entryOrder addObject:key];
+    NSMutableSet *keys = _tableKeys[tableName];
+    if (!keys){
+      keys = [NSMutableSet new];
+      _tableKeys[tableName] = keys;
+    }
+    [keys addObject:key];
+    _byteSize += byteSize;
+  }
+}
+- (void) invalidateTables:(NSSet *)tableNames{
+  if (!tableNames.count) return;
+  @synchronized(self){
+    _generation++;
+    for (NSString *tableName in tableNames){
+      _tableGenerations[tableName] = @(_generation);
+      for (NSString *key in [_tableKeys[tableName] copy]){
+        [self removeEntryForKey:key];
+        _metrics.invalidations++;
+      }
+      [_tableKeys removeObjectForKey:tableName];
+    }
+  }
+}
+- (void) removeAllResults{
+  @synchronized(self){
+    _generation++;
+    _clearedGeneration = _generation;
+    _metrics.invalidations += _entries.count;
+    [_entries removeAllObjects];
+    [_entryOrder removeAllObjects];
+    [_tableKeys removeAllObjects];
+    [_tableGenerations removeAllObjects];
+    _byteSize = 0;
+  }
+}
+- (void) resetMetrics{
+  @synchronized(self){
+    _metrics = [SQLQueryCacheMetrics new];
+  }
+}
+@end
+
+@implementation SQLQueryCacheMetrics
+- (double) hitRate{
+  NSUInteger lookups = _hits + _misses;
+  return lookups ? (double)_hits / lookups : 0;
+}
+- (NSString *) description{
+  return $(@"<%@: %p> hits: %lu, misses: %lu, hit rate: %.2f, evictions: %lu, invalidations: %lu, %lu entries (%lu bytes)", NSStringFromClass([self class]), self, (unsigned long)_hits, (unsigned long)_misses, self.hitRate, (unsigned long)_evictions, (unsigned long)_invalidations, (unsigned long)_entryCount, (unsigned long)_byteSize);
+}
+@end
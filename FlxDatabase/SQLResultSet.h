@@ -0,0 +1,131 @@
+//
+//  SQLResultSet.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  The storage type of an individual value in a SQLResultSet. These match sqlite's fundamental data types.
+ */
+typedef NS_ENUM(uint8_t, SQLValueType){
+    SQLValueTypeNull = 0,
+    SQLValueTypeInteger,
+    SQLValueTypeReal,
+    SQLValueTypeText,
+    SQLValueTypeBlob
+};
+
+@class SQLResultRow;
+
+/**
+ *  SQLResultSet is a compact, read-only alternative to the NSArray of NSMutableDictionary rows normally returned from a query.
+ *
+ *  Column names are stored once and each column is stored in contiguous buffers: an 8 byte slot per row for integer/real values, an offsets array plus a byte arena for text & blob values, and a type byte per row (which doubles as the null map). Nothing is boxed into an NSNumber/NSString/NSData until you ask for it, so even very large results only cost a few allocations per column.
+ *
+ *  Since sqlite is dynamically typed, each value keeps it's own type. The typed accessors (`integerAtRow:column:`, `doubleAtRow:column:`, etc) will convert between types when they can.
+ *
+ *  A result set is immutable once it's returned, so it's safe to read from any thread.
+ */
+@interface SQLResultSet : NSObject
+/**
+ *  The column names, in the order they were returned by the query.
+ */
+@property (readonly) NSArray *columnNames;
+/**
+ *  The number of columns in each row.
+ */
+@property (readonly) NSUInteger columnCount;
+/**
+ *  The number of rows returned.
+ */
+@property (readonly) NSUInteger rowCount;
+/**
+ *  The number of bytes allocated to store the values.
+ */
+@property (readonly) NSUInteger byteSize;
+/**
+ *  Returns the index of the column with the given name, or NSNotFound.
+ */
+- (NSUInteger) indexOfColumnNamed:(NSString *)columnName;
+/**
+ *  @return The storage type of the value at the row & column.
+ */
+- (SQLValueType) typeAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  @return YES if the value at the row & column is NULL.
+ */
+- (BOOL) isNullAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  @return The value as a 64 bit integer. Reals are truncated, text is parsed and NULL/blobs return 0.
+ */
+- (int64_t) integerAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  @return The value as a double. Text is parsed and NULL/blobs return 0.
+ */
+- (double) doubleAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  Returns the raw bytes of a text or blob value without copying them. Text is UTF-8 and is *not* NULL terminated.
+ *  @warning The pointer is only valid as long as the result set is alive.
+ *
+ *  @param length On return, the number of bytes. Can be NULL.
+ *
+ *  @return A pointer into the result set's storage, or NULL if the value isn't text or a blob.
+ */
+- (const void *) bytesAtRow:(NSUInteger)row column:(NSUInteger)column length:(NSUInteger *)length;
+/**
+ *  @return The value as a string. Numbers are converted, a binary GUID is returned in it's string form and NULL returns nil.
+ */
+- (NSString *) stringAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  @return The value as data (copied). Text returns it's UTF-8 bytes; anything else returns nil.
+ */
+- (NSData *) dataAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  Boxes the value the same way SQLDatabase does for dictionary rows: NSNumber for integers & reals, NSString for text (and binary GUIDs), NSData for blobs and nil for NULL.
+ */
+- (id) objectAtRow:(NSUInteger)row column:(NSUInteger)column;
+/**
+ *  Returns a lightweight view onto a row. The view doesn't copy anything; values are boxed when you ask for them.
+ */
+- (SQLResultRow *) rowAtIndex:(NSUInteger)index;
+/**
+ *  Subscripting support: `resultSet[0]` returns a row view.
+ */
+- (SQLResultRow *) objectAtIndexedSubscript:(NSUInteger)index;
+/**
+ *  Iterates over each row without allocating a view per row.
+ *  @warning The same row view is reused for every row, so don't hold onto it outside of the block. Use `rowAtIndex:` if you need to keep a row.
+ */
+- (void) enumerateRowsUsingBlock:(void (^)(SQLResultRow *row, NSUInteger index, BOOL *stop))block;
+/**
+ *  Boxes the entire result into an array of NSMutableDictionary rows, the same as what `-[SQLDatabase executeQuery:withParameters:]` returns. This defeats the purpose of a result set, so only use it for small results or for compatibility.
+ */
+- (NSArray *) dictionaryRows;
+@end
+
+/**
+ *  A view onto a single row in a SQLResultSet. Values can be retrieved by column name or index using subscripts (`row[@"name"]`, `row[0]`) or `valueForKey:`.
+ */
+@interface SQLResultRow : NSObject
+/**
+ *  The result set this row belongs to.
+ */
+@property (readonly) SQLResultSet *resultSet;
+/**
+ *  The index of this row in the result set.
+ */
+@property (readonly) NSUInteger index;
+- (id) objectForKeyedSubscript:(NSString *)columnName;
+- (id) objectAtIndexedSubscript:(NSUInteger)column;
+- (int64_t) integerForColumn:(NSString *)columnName;
+- (double) doubleForColumn:(NSString *)columnName;
+- (NSString *) stringForColumn:(NSString *)columnName;
+/**
+ *  @return The row boxed into a dictionary keyed by column name. NULL values are left out.
+ */
+- (NSMutableDictionary *) dictionary;
+@end
@@ -0,0 +1,329 @@
+//
+//  SQLResultSet.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLResultSet.h"
+#import "SQLGUID.h"
+#import <sqlite3.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define InitialRowCapacity 64
+#define InitialBytesCapacity 256
+
+typedef union {
+    int64_t integer;
+    double real;
+} SQLNumericValue;
+
+/* Storage for a single column:
+ - types: one SQLValueType per row (also serves as the null map)
+ - numbers: one 8 byte slot per row for integer/real values
+ - offsets & bytes: text/blob values are appended to the bytes arena. The value for row i spans offsets[i]..offsets[i+1]. The offsets aren't allocated until the column contains text or a blob, so numeric columns don't pay for them.
+ */
+typedef struct {
+    uint8_t *types;
+    SQLNumericValue *numbers;
+    uint64_t *offsets;
+    uint8_t *bytes;
+    size_t bytesLength;
+    size_t bytesCapacity;
+} SQLResultColumn;
+
+static const char SQLEmptyBytes[1] = {0};
+
+@interface SQLResultRow ()
+@property (readwrite) NSUInteger index;
+- (id) initWithResultSet:(SQLResultSet *)resultSet index:(NSUInteger)index;
+@end
+
+@interface SQLResultSet ()
+- (id) initWithColumnNames:(NSArray *)columnNames;
+- (void) appendRowFromStatement:(sqlite3_stmt *)statement;
+- (void) finishLoading;
+@end
+
+@implementation SQLResultSet {
+    SQLResultColumn *_columns;
+    NSUInteger _rowCapacity;
+    NSDictionary *_columnIndexes;
+    NSUInteger _GUIDColumn;
+}
+#pragma mark - Init Methods
+- (id) initWithColumnNames:(NSArray *)columnNames{
+    if ((self = [super init])){
+        _columnNames = [columnNames copy];
+        _columnCount = _columnNames.count;
+        _columns = calloc(MAX(_columnCount, 1), sizeof(SQLResultColumn));
+        //If a query returns duplicate column names, the first one wins (same as dictionary rows)
+        NSMutableDictionary *columnIndexes = [NSMutableDictionary dictionaryWithCapacity:_columnCount];
+        for (NSUInteger i = 0; i < _columnCount; i++){
+            if (!columnIndexes[_columnNames[i]]) columnIndexes[_columnNames[i]] = @(i);
+        }
+        _columnIndexes = columnIndexes;
+        _GUIDColumn = columnIndexes[GUIDKey] ? [columnIndexes[GUIDKey] unsignedIntegerValue] : NSNotFound;
+    }
+    return self;
+}
+- (void) dealloc{
+    for (NSUInteger i = 0; i < _columnCount; i++){
+        free(_columns[i].types);
+        free(_columns[i].numbers);
+        free(_columns[i].offsets);
+        free(_columns[i].bytes);
+    }
+    free(_columns);
+}
+#pragma mark - Private Methods
+- (void) resizeRowsToCapacity:(NSUInteger)rowCapacity{
+    for (NSUInteger i = 0; i < _columnCount; i++){
+        SQLResultColumn *column = &_columns[i];
+        column->types = realloc(column->types, rowCapacity * sizeof(uint8_t));
+        column->numbers = realloc(column->numbers, rowCapacity * sizeof(SQLNumericValue));
+        if (column->offsets) column->offsets = realloc(column->offsets, (rowCapacity + 1) * sizeof(uint64_t));
+    }
+    _rowCapacity = rowCapacity;
+}
+- (void) appendBytes:(const void *)bytes length:(size_t)length toColumn:(SQLResultColumn *)column{
+    if (!column->offsets){
+        //Any rows before this one had no bytes, so their offsets are all zero
+        column->offsets = calloc(_rowCapacity + 1, sizeof(uint64_t));
+    }
+    if (!length) return;
+    if (column->bytesLength + length > column->bytesCapacity){
+        size_t capacity = MAX(column->bytesCapacity * 2, InitialBytesCapacity);
+        while (capacity < column->bytesLength + length) capacity *= 2;
+        column->bytes = realloc(column->bytes, capacity);
+        column->bytesCapacity = capacity;
+    }
+    memcpy(column->bytes + column->bytesLength, bytes, length);
+    column->bytesLength += length;
+}
+- (void) appendRowFromStatement:(sqlite3_stmt *)statement{
+    if (_rowCount == _rowCapacity) [self resizeRowsToCapacity:MAX(_rowCapacity * 2, InitialRowCapacity)];
+    NSUInteger row = _rowCount;
+    for (NSUInteger i = 0; i < _columnCount; i++){
+        SQLResultColumn *column = &_columns[i];
+        int index = (int)i;
+        switch (sqlite3_column_type(statement, index)) {
+            case SQLITE_INTEGER:
+                column->types[row] = SQLValueTypeInteger;
+                column->numbers[row].integer = sqlite3_column_int64(statement, index);
+                break;
+            case SQLITE_FLOAT:
+                column->types[row] = SQLValueTypeReal;
+                column->numbers[row].real = sqlite3_column_double(statement, index);
+                break;
+            case SQLITE_TEXT:{
+                //sqlite recommends retrieving the value before the length
+                const unsigned char *text = sqlite3_column_text(statement, index);
+                column->types[row] = SQLValueTypeText;
+                [self appendBytes:text length:sqlite3_column_bytes(statement, index) toColumn:column];
+                break;
+            }
+            case SQLITE_BLOB:{
+                const void *blob = sqlite3_column_blob(statement, index);
+                column->types[row] = SQLValueTypeBlob;
+                [self appendBytes:blob length:sqlite3_column_bytes(statement, index) toColumn:column];
+                break;
+            }
+            default:
+                column->types[row] = SQLValueTypeNull;
+                break;
+        }
+        if (column->offsets) column->offsets[row + 1] = column->bytesLength;
+    }
+    _rowCount++;
+}
+- (void) finishLoading{
+    //Give back the unused capacity
+    if (_rowCount && _rowCount < _rowCapacity) [self resizeRowsToCapacity:_rowCount];
+    for (NSUInteger i = 0; i < _columnCount; i++){
+        SQLResultColumn *column = &_columns[i];
+        if (column->bytesLength && column->bytesLength < column->bytesCapacity){
+            column->bytes = realloc(column->bytes, column->bytesLength);
+            column->bytesCapacity = column->bytesLength;
+        }
+    }
+}
+- (SQLResultColumn *) columnAtIndex:(NSUInteger)column row:(NSUInteger)row{
+    if (row >= _rowCount || column >= _columnCount){
+        [NSException raise:NSRangeException format:@"Row %lu, column %lu is beyond the bounds of the result set (%lu rows, %lu columns).", (unsigned long)row, (unsigned long)column, (unsigned long)_rowCount, (unsigned long)_columnCount];
+    }
+    return &_columns[column];
+}
+#pragma mark - Property Methods
+- (NSUInteger) byteSize{
+    NSUInteger byteSize = 0;
+    for (NSUInteger i = 0; i < _columnCount; i++){
+        SQLResultColumn *column = &_columns[i];
+        byteSize += _rowCapacity * (sizeof(uint8_t) + sizeof(SQLNumericValue));
+        if (column->offsets) byteSize += (_rowCapacity + 1) * sizeof(uint64_t);
+        byteSize += column->bytesCapacity;
+    }
+    return byteSize;
+}
+#pragma mark - Standard Methods
+- (NSUInteger) indexOfColumnNamed:(NSString *)columnName{
+    NSNumber *index = columnName ? _columnIndexes[columnName] : nil;
+    return index ? index.unsignedIntegerValue : NSNotFound;
+}
+- (SQLValueType) typeAtRow:(NSUInteger)row column:(NSUInteger)column{
+    return [self columnAtIndex:column row:row]->types[row];
+}
+- (BOOL) isNullAtRow:(NSUInteger)row column:(NSUInteger)column{
+    return [self typeAtRow:row column:column] == SQLValueTypeNull;
+}
+- (int64_t) integerAtRow:(NSUInteger)row column:(NSUInteger)column{
+    SQLResultColumn *values = [self columnAtIndex:column row:row];
+    switch (values->types[row]) {
+        case SQLValueTypeInteger: return values->numbers[row].integer;
+        case SQLValueTypeReal: return (int64_t)values->numbers[row].real;
+        case SQLValueTypeText: return [[self stringAtRow:row column:column] longLongValue];
+        default: return 0;
+    }
+}
+- (double) doubleAtRow:(NSUInteger)row column:(NSUInteger)column{
+    SQLResultColumn *values = [self columnAtIndex:column row:row];
+    switch (values->types[row]) {
+        case SQLValueTypeInteger: return (double)values->numbers[row].integer;
+        case SQLValueTypeReal: return values->numbers[row].real;
+        case SQLValueTypeText: return [[self stringAtRow:row column:column] doubleValue];
+        default: return 0;
+    }
+}
+- (const void *) bytesAtRow:(NSUInteger)row column:(NSUInteger)column length:(NSUInteger *)length{
+    SQLResultColumn *values = [self columnAtIndex:column row:row];
+    SQLValueType type = values->types[row];
+    if (type != SQLValueTypeText && type != SQLValueTypeBlob){
+        if (length) *length = 0;
+        return NULL;
+    }
+    uint64_t start = values->offsets[row];
+    if (length) *length = (NSUInteger)(values->offsets[row + 1] - start);
+    return values->bytes ? values->bytes + start : SQLEmptyBytes;
+}
+- (NSString *) stringAtRow:(NSUInteger)row column:(NSUInteger)column{
+    SQLResultColumn *values = [self columnAtIndex:column row:row];
+    switch (values->types[row]) {
+        case SQLValueTypeInteger: return $(@"%lld", values->numbers[row].integer);
+        case SQLValueTypeReal: return [@(values->numbers[row].real) stringValue];
+        case SQLValueTypeText:
+        case SQLValueTypeBlob:{
+            NSUInteger length = 0;
+            const void *bytes = [self bytesAtRow:row column:column length:&length];
+            if (column == _GUIDColumn && values->types[row] == SQLValueTypeBlob){
+                NSString *GUID = [SQLGUID GUIDFromBytes:bytes length:length];
+                if (GUID) return GUID;
+            }
+            return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        }
+        default: return nil;
+    }
+}
+- (NSData *) dataAtRow:(NSUInteger)row column:(NSUInteger)column{
+    NSUInteger length = 0;
+    const void *bytes = [self bytesAtRow:row column:column length:&length];
+    return bytes ? [NSData dataWithBytes:bytes length:length] : nil;
+}
+- (id) objectAtRow:(NSUInteger)row column:(NSUInteger)column{
+    SQLResultColumn *values = [self columnAtIndex:column row:row];
+    switch (values->types[row]) {
+        case SQLValueTypeInteger: return @(values->numbers[row].integer);
+        case SQLValueTypeReal: return @(values->numbers[row].real);
+        case SQLValueTypeText: return [self stringAtRow:row column:column];
+        case SQLValueTypeBlob:{
+            if (column == _GUIDColumn){
+                NSUInteger length = 0;
+                const void *bytes = [self bytesAtRow:row column:column length:&length];
+                NSString *GUID = [SQLGUID GUIDFromBytes:bytes length:length];
+                if (GUID) return GUID;
+            }
+            return [self dataAtRow:row column:column];
+        }
+        default: return nil;
+    }
+}
+- (SQLResultRow *) rowAtIndex:(NSUInteger)index{
+    if (index >= _rowCount){
+        [NSException raise:NSRangeException format:@"Row %lu is beyond the bounds of the result set (%lu rows).", (unsigned long)index, (unsigned long)_rowCount];
+    }
+    return [[SQLResultRow alloc] initWithResultSet:self index:index];
+}
+- (SQLResultRow *) objectAtIndexedSubscript:(NSUInteger)index{
+    return [self rowAtIndex:index];
+}
+- (void) enumerateRowsUsingBlock:(void (^)(SQLResultRow *, NSUInteger, BOOL *))block{
+    if (!block || !_rowCount) return;
+    SQLResultRow *row = [[SQLResultRow alloc] initWithResultSet:self index:0];
+    BOOL stop = NO;
+    for (NSUInteger i = 0; i < _rowCount && !stop; i++){
+        row.index = i;
+        block(row, i, &stop);
+    }
+}
+- (NSArray *) dictionaryRows{
+    NSMutableArray *rows = [NSMutableArray arrayWithCapacity:_rowCount];
+    for (NSUInteger i = 0; i < _rowCount; i++){
+        [rows addObject:[[SQLResultRow alloc] initWithResultSet:self index:i].dictionary];
+    }
+    return rows;
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+    return $(@"<%@: %p> %lu rows, columns: %@", NSStringFromClass([self class]), self, (unsigned long)_rowCount, [_columnNames componentsJoinedByString:@", "]);
+}
+@end
+
+@implementation SQLResultRow
+#pragma mark - Init Methods
+- (id) initWithResultSet:(SQLResultSet *)resultSet index:(NSUInteger)index{
+    if ((self = [super init])){
+        _resultSet = resultSet;
+        _index = index;
+    }
+    return self;
+}
+#pragma mark - Standard Methods
+- (id) objectForKeyedSubscript:(NSString *)columnName{
+    NSUInteger column = [_resultSet indexOfColumnNamed:columnName];
+    if (column == NSNotFound) return nil;
+    return [_resultSet objectAtRow:_index column:column];
+}
+- (id) objectAtIndexedSubscript:(NSUInteger)column{
+    return [_resultSet objectAtRow:_index column:column];
+}
+- (int64_t) integerForColumn:(NSString *)columnName{
+    NSUInteger column = [_resultSet indexOfColumnNamed:columnName];
+    return column == NSNotFound ? 0 : [_resultSet integerAtRow:_index column:column];
+}
+- (double) doubleForColumn:(NSString *)columnName{
+    NSUInteger column = [_resultSet indexOfColumnNamed:columnName];
+    return column == NSNotFound ? 0 : [_resultSet doubleAtRow:_index column:column];
+}
+- (NSString *) stringForColumn:(NSString *)columnName{
+    NSUInteger column = [_resultSet indexOfColumnNamed:columnName];
+    return column == NSNotFound ? nil : [_resultSet stringAtRow:_index column:column];
+}
+- (NSMutableDictionary *) dictionary{
+    NSArray *columnNames = _resultSet.columnNames;
+    NSMutableDictionary *dictionary = [NSMutableDictionary dictionaryWithCapacity:columnNames.count];
+    for (NSUInteger i = 0; i < columnNames.count; i++){
+        id value = [_resultSet objectAtRow:_index column:i];
+        if (value) dictionary[columnNames[i]] = value;
+    }
+    return dictionary;
+}
+#pragma mark - Overridden Methods
+- (id) valueForKey:(NSString *)key{
+    //Columns take precedence so rows can be used anywhere a dictionary row was used with KVC
+    if ([_resultSet indexOfColumnNamed:key] != NSNotFound) return self[key];
+    return [super valueForKey:key];
+}
+- (NSString *) description{
+    return [[self dictionary] description];
+}
+@end
@@ -0,0 +1,52 @@
+//
+//  SQLRowMapper.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ *  SQLRowMapper copies query rows into instances of a row class without going through `setValue:forKeyPath:` for every value.
+ *
+ *  The first time a class is used with a list of columns, the mapper inspects the class with the ObjC runtime and builds a plan: for each column it finds the setter (or, for readonly primitive properties, the ivar) and the native type it expects. Values are then copied straight from sqlite into the setter as int64/double/NSString/etc without boxing primitives into an NSNumber first. Plans are cached per (class, columns), so this only happens once.
+ *
+ *  Conversions:
+ *  - Integer & floating point properties (including BOOL) get the native value.
+ *  - NSString properties get text (numbers are converted to text).
+ *  - NSNumber properties get integers or reals.
+ *  - NSData properties get blobs (or the text's UTF-8 bytes).
+ *  - NSDate properties get the date stored as a time interval since the reference date (which is how dates are bound as parameters).
+ *  - Anything else (or columns that are key paths) falls back to `setValue:forKeyPath:` with the same value a dictionary row would have.
+ *
+ *  Classes that override `setValue:forKey:` (or `setValue:forKeyPath:`) have every column set through KVC, so the override is always called. Readonly properties of a class that returns NO from `+accessInstanceVariablesDirectly` aren't written to directly either; they go through KVC too.
+ *
+ *  NULL values are skipped, so the row keeps whatever value it was initialized with.
+ *
+ *  SQLDatabase uses this automatically for any row class that isn't an NSMutableDictionary.
+ */
+@interface SQLRowMapper : NSObject
+/**
+ *  The class instantiated for each row.
+ */
+@property (readonly) Class rowClass;
+/**
+ *  The column names (in query order) the mapper was built for.
+ */
+@property (readonly) NSArray *columnNames;
+/**
+ *  Returns the cached mapper for the class and columns, building one if needed. This is thread safe.
+ *
+ *  @param rowClass    The class you want created for each row.
+ *  @param columnNames The column names in the order they're returned from the query.
+ *
+ *  @return A SQLRowMapper.
+ */
++ (instancetype) mapperForClass:(Class)rowClass columnNames:(NSArray *)columnNames;
+/**
+ *  Removes all cached mappers.
+ */
++ (void) clearCache;
+@end
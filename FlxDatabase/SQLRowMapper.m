@@ -0,0 +1,310 @@
+//
+//  SQLRowMapper.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLRowMapper.h"
+#import "SQLGUID.h"
+#import <objc/runtime.h>
+#import <sqlite3.h>
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+
+typedef NS_ENUM(NSUInteger, SQLMapKind){
+  SQLMapKindKeyValue,
+  SQLMapKindObject,
+  SQLMapKindString,
+  SQLMapKindNumber,
+  SQLMapKindData,
+  SQLMapKindDate,
+  SQLMapKindInteger,
+  SQLMapKindReal
+};
+
+/* How a single column is copied into the row:
+ - imp/selector: the setter to call. If there's no imp, ivarOffset is used to write a primitive straight into the ivar.
+ - type: the ObjC type encoding of a primitive value (ex: 'q', 'd', 'B')
+ - GUID: the column is the GUID, so a binary GUID is converted to it's string form
+ */
+typedef struct {
+  SQLMapKind kind;
+  char type;
+  SEL selector;
+  IMP imp;
+  ptrdiff_t ivarOffset;
+  BOOL GUID;
+} SQLColumnSetter;
+
+#define SQLSetPrimitive(row, setter, valueType, value) \
+  if (setter->imp) ((void (*)(id, SEL, valueType))setter->imp)(row, setter->selector, (valueType)value); \
+  else *(valueType *)((uint8_t *)(__bridge void *)row + setter->ivarOffset) = (valueType)value;
+
+@interface SQLRowMapper ()
+- (id) rowFromStatement:(sqlite3_stmt *)statement;
+@end
+
+@implementation SQLRowMapper {
+  SQLColumnSetter *_setters;
+  NSUInteger _columnCount;
+  //The class has it's own KVC, so every column is set with setValue:forKeyPath:
+  BOOL _overridesKeyValueCoding;
+}
+#pragma mark - Cache
+static NSMutableDictionary *SQLRowMappers(){
+  static NSMutableDictionary *mappers = nil;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    mappers = [NSMutableDictionary new];
+  });
+  return mappers;
+}
++ (instancetype) mapperForClass:(Class)rowClass columnNames:(NSArray *)columnNames{
+  if (!rowClass) return nil;
+  NSString *key = $(@"%@|%@", NSStringFromClass(rowClass), [columnNames componentsJoinedByString:@","]);
+  NSMutableDictionary *mappers = SQLRowMappers();
+  SQLRowMapper *mapper = nil;
+  @synchronized(mappers){
+    mapper = mappers[key];
+    if (!mapper){
+      mapper = [[self alloc] initWithClass:rowClass columnNames:columnNames];
+      mappers[key] = mapper;
+    }
+  }
+  return mapper;
+}
++ (void) clearCache{
+  NSMutableDictionary *mappers = SQLRowMappers();
+  @synchronized(mappers){
+    [mappers removeAllObjects];
+  }
+}
+#pragma mark - Init Methods
+- (id) initWithClass:(Class)rowClass columnNames:(NSArray *)columnNames{
+  if ((self = [super init])){
+    _rowClass = rowClass;
+    _columnNames = [columnNames copy];
+    _columnCount = _columnNames.count;
+    _overridesKeyValueCoding = SQLOverridesKeyValueCoding(rowClass);
+    _setters = calloc(MAX(_columnCount, 1), sizeof(SQLColumnSetter));
+    for (NSUInteger i = 0; i < _columnCount; i++){
+      _setters[i] = [self setterForKey:_columnNames[i]];
+      _setters[i].GUID = [_columnNames[i] isEqualToString:GUIDKey];
+    }
+  }
+  return self;
+}
+- (void) dealloc{
+  free(_setters);
+}
+#pragma mark - Private Methods
+static BOOL SQLOverridesKeyValueCoding(Class rowClass){
+  //Bypassing setValue:forKey: would skip whatever the class does in it's override (validation, Core Data, etc)
+  Class baseClass = [NSObject class];
+  return class_getMethodImplementation(rowClass, @selector(setValue:forKey:)) != class_getMethodImplementation(baseClass, @selector(setValue:forKey:))
+      || class_getMethodImplementation(rowClass, @selector(setValue:forKeyPath:)) != class_getMethodImplementation(baseClass, @selector(setValue:forKeyPath:));
+}
+static char SQLTypeFromEncoding(const char *encoding){
+  //Skip any method type qualifiers (const, in, out, etc)
+  while (encoding && *encoding && strchr("rnNoORV", *encoding)) encoding++;
+  return encoding ? *encoding : 0;
+}
+static SQLMapKind SQLMapKindForType(char type){
+  switch (type) {
+    case 'c':
+    case 'C':
+    case 's':
+    case 'S':
+    case 'i':
+    case 'I':
+    case 'l':
+    case 'L':
+    case 'q':
+    case 'Q':
+    case 'B':
+      return SQLMapKindInteger;
+    case 'f':
+    case 'd':
+      return SQLMapKindReal;
+    case '@':
+      return SQLMapKindObject;
+    default:
+      return SQLMapKindKeyValue;
+  }
+}
+static SQLMapKind SQLMapKindForClass(Class propertyClass){
+  if ([propertyClass isSubclassOfClass:[NSString class]]) return SQLMapKindString;
+  if ([propertyClass isSubclassOfClass:[NSNumber class]]) return SQLMapKindNumber;
+  if ([propertyClass isSubclassOfClass:[NSData class]]) return SQLMapKindData;
+  if ([propertyClass isSubclassOfClass:[NSDate class]]) return SQLMapKindDate;
+  return SQLMapKindObject;
+}
+- (SQLColumnSetter) setterForKey:(NSString *)key{
+  /* Builds the setter for a column, mirroring the order KVC uses:
+   - A declared property: use it's setter. If it's readonly, write primitive values directly to it's ivar (unless the class returns NO from accessInstanceVariablesDirectly).
+   - An undeclared set<Key>: method: use it with the type from the method's signature.
+   - Anything else (key paths, unknown keys, readonly objects) falls back to KVC, as does every key of a class that overrides setValue:forKey: or setValue:forKeyPath:
+   */
+  SQLColumnSetter setter = { SQLMapKindKeyValue, 0, NULL, NULL, -1, NO };
+  if (!key.length || [key rangeOfString:@"."].location != NSNotFound || _overridesKeyValueCoding) return setter;
+
+  NSString *setterName = $(@"set%@%@:", [[key substringToIndex:1] uppercaseString], [key substringFromIndex:1]);
+  objc_property_t property = class_getProperty(_rowClass, [key UTF8String]);
+  if (property){
+    char *typeAttribute = property_copyAttributeValue(property, "T");
+    char *customSetter = property_copyAttributeValue(property, "S");
+    char *readonly = property_copyAttributeValue(property, "R");
+    char *ivarName = property_copyAttributeValue(property, "V");
+
+    setter.type = SQLTypeFromEncoding(typeAttribute);
+    setter.kind = SQLMapKindForType(setter.type);
+    if (setter.kind == SQLMapKindObject && typeAttribute && strlen(typeAttribute) > 3 && typeAttribute[1] == '"'){
+      NSString *className = [[NSString alloc] initWithBytes:&typeAttribute[2] length:strlen(typeAttribute) - 3 encoding:NSUTF8StringEncoding];
+      setter.kind = SQLMapKindForClass(NSClassFromString(className));
+    }
+    if (customSetter) setterName = [NSString stringWithUTF8String:customSetter];
+
+    SEL selector = NSSelectorFromString(setterName);
+    if (!readonly && [_rowClass instancesRespondToSelector:selector]){
+      setter.selector = selector;
+      setter.imp = [_rowClass instanceMethodForSelector:selector];
+    } else if (ivarName && setter.kind != SQLMapKindKeyValue && setter.type != '@' && [_rowClass accessInstanceVariablesDirectly]){
+      Ivar ivar = class_getInstanceVariable(_rowClass, ivarName);
+      if (ivar) {
+        setter.ivarOffset = ivar_getOffset(ivar);
+      } else {
+        setter.kind = SQLMapKindKeyValue;
+      }
+    } else {
+      setter.kind = SQLMapKindKeyValue;
+    }
+
+    free(typeAttribute);
+    free(customSetter);
+    free(readonly);
+    free(ivarName);
+    return setter;
+  }
+
+  SEL selector = NSSelectorFromString(setterName);
+  Method method = class_getInstanceMethod(_rowClass, selector);
+  if (method && method_getNumberOfArguments(method) == 3){
+    char *argumentType = method_copyArgumentType(method, 2);
+    setter.type = SQLTypeFromEncoding(argumentType);
+    setter.kind = SQLMapKindForType(setter.type);
+    if (setter.kind != SQLMapKindKeyValue){
+      setter.selector = selector;
+      setter.imp = method_getImplementation(method);
+    }
+    free(argumentType);
+  }
+  return setter;
+}
+static id SQLObjectFromStatement(sqlite3_stmt *statement, int column, int columnType){
+  //Same values a dictionary row would get
+  switch (columnType) {
+    case SQLITE_INTEGER:
+      return [NSNumber numberWithLongLong:sqlite3_column_int64(statement, column)];
+    case SQLITE_FLOAT:
+      return [NSNumber numberWithDouble:sqlite3_column_double(statement, column)];
+    case SQLITE_TEXT:{
+      const unsigned char *text = sqlite3_column_text(statement, column);
+      return text ? [[NSString alloc] initWithBytes:text length:sqlite3_column_bytes(statement, column) encoding:NSUTF8StringEncoding] : @"";
+    }
+    case SQLITE_BLOB:{
+      const void *blob = sqlite3_column_blob(statement, column);
+      return [NSData dataWithBytes:blob length:sqlite3_column_bytes(statement, column)];
+    }
+    default:
+      return nil;
+  }
+}
+- (id) objectForSetter:(SQLColumnSetter *)setter statement:(sqlite3_stmt *)statement column:(int)column columnType:(int)columnType{
+  switch (setter->kind) {
+    case SQLMapKindString:{
+      const unsigned char *text = sqlite3_column_text(statement, column);
+      return text ? [[NSString alloc] initWithBytes:text length:sqlite3_column_bytes(statement, column) encoding:NSUTF8StringEncoding] : nil;
+    }
+    case SQLMapKindData:{
+      if (columnType == SQLITE_TEXT){
+        const unsigned char *text = sqlite3_column_text(statement, column);
+        return [NSData dataWithBytes:text length:sqlite3_column_bytes(statement, column)];
+      }
+      return SQLObjectFromStatement(statement, column, columnType);
+    }
+    case SQLMapKindDate:{
+      if (columnType == SQLITE_INTEGER || columnType == SQLITE_FLOAT){
+        return [NSDate dateWithTimeIntervalSinceReferenceDate:sqlite3_column_double(statement, column)];
+      }
+      return SQLObjectFromStatement(statement, column, columnType);
+    }
+    default:
+      return SQLObjectFromStatement(statement, column, columnType);
+  }
+}
+- (void) setInteger:(int64_t)value onRow:(id)row setter:(SQLColumnSetter *)setter{
+  switch (setter->type) {
+    case 'c': SQLSetPrimitive(row, setter, char, value); break;
+    case 'C': SQLSetPrimitive(row, setter, unsigned char, value); break;
+    case 's': SQLSetPrimitive(row, setter, short, value); break;
+    case 'S': SQLSetPrimitive(row, setter, unsigned short, value); break;
+    case 'i': SQLSetPrimitive(row, setter, int, value); break;
+    case 'I': SQLSetPrimitive(row, setter, unsigned int, value); break;
+    case 'l': SQLSetPrimitive(row, setter, long, value); break;
+    case 'L': SQLSetPrimitive(row, setter, unsigned long, value); break;
+    case 'q': SQLSetPrimitive(row, setter, long long, value); break;
+    case 'Q': SQLSetPrimitive(row, setter, unsigned long long, value); break;
+    case 'B': SQLSetPrimitive(row, setter, bool, (value != 0)); break;
+    default: break;
+  }
+}
+- (void) setReal:(double)value onRow:(id)row setter:(SQLColumnSetter *)setter{
+  switch (setter->type) {
+    case 'f': SQLSetPrimitive(row, setter, float, value); break;
+    case 'd': SQLSetPrimitive(row, setter, double, value); break;
+    default: break;
+  }
+}
+#pragma mark - Standard Methods
+- (id) rowFromStatement:(sqlite3_stmt *)statement{
+  id row = [_rowClass new];
+  for (NSUInteger i = 0; i < _columnCount; i++){
+    int column = (int)i;
+    int columnType = sqlite3_column_type(statement, column);
+    if (columnType == SQLITE_NULL) continue;
+    SQLColumnSetter *setter = &_setters[i];
+    if (setter->GUID && columnType == SQLITE_BLOB && setter->kind != SQLMapKindData){
+      NSString *GUID = [SQLGUID GUIDFromBytes:sqlite3_column_blob(statement, column) length:sqlite3_column_bytes(statement, column)];
+      if (GUID){
+        if (setter->imp && setter->kind != SQLMapKindInteger && setter->kind != SQLMapKindReal){
+          ((void (*)(id, SEL, id))setter->imp)(row, setter->selector, GUID);
+        } else {
+          [row setValue:GUID forKeyPath:_columnNames[i]];
+        }
+        continue;
+      }
+    }
+    switch (setter->kind) {
+      case SQLMapKindInteger:
+        [self setInteger:sqlite3_column_int64(statement, column) onRow:row setter:setter];
+        break;
+      case SQLMapKindReal:
+        [self setReal:sqlite3_column_double(statement, column) onRow:row setter:setter];
+        break;
+      case SQLMapKindKeyValue:{
+        id value = SQLObjectFromStatement(statement, column, columnType);
+        if (value) [row setValue:value forKeyPath:_columnNames[i]];
+        break;
+      }
+      default:{
+        id value = [self objectForSetter:setter statement:statement column:column columnType:columnType];
+        if (value) ((void (*)(id, SEL, id))setter->imp)(row, setter->selector, value);
+        break;
+      }
+    }
+  }
+  return row;
+}
+@end
@@ -0,0 +1,114 @@
+//
+//  SQLSchema.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+@class SQLStatement;
+@class SQLDatabase;
+
+/**
+ *  The table the schema fingerprints are recorded in (see `recordFingerprint:inDatabase:`).
+ */
+extern NSString *const SQLSchemaFingerprintTable;
+
+/**
+ *  A snapshot of a database's schema: it's tables, their columns and the indexes on them. The whole snapshot is read in a single query (`sqlite_master` joined with `pragma_table_info`) instead of a `PRAGMA table_info` query per table.
+ *
+ *  The snapshot is used to diff statements against the database: `updatesForStatement:` returns the statements needed to bring a table up to the statement's columns & indexes. Columns and indexes are looked up by name in sets, so diffing is linear in the number of columns.
+ *
+ *  Schema fingerprints let a database that's already up to date skip the diff entirely. A fingerprint identifies a set of statements (their tables, columns & indexes). Once a database is synced to those statements, the fingerprint is recorded along with sqlite's `schema_version` (which sqlite changes on every schema change). If neither has changed since, the database doesn't need to be read.
+ *
+ *  SQLDatabaseManager's `syncSchemaToStatements:` uses all of this to sync a set of tables in one transaction.
+ */
+@interface SQLSchema : NSObject
+/**
+ *  Reads the schema of every table in the database.
+ *
+ *  @param database The database to read.
+ *
+ *  @return The database's schema.
+ */
++ (SQLSchema *) schemaFromDatabase:(SQLDatabase *)database;
+/**
+ *  Reads the schema of the tables provided (and the indexes on them). Tables that don't exist are ignored.
+ *
+ *  @param database   The database to read.
+ *  @param tableNames The tables to read. If `nil`, every table is read.
+ *
+ *  @return The schema of the tables.
+ */
++ (SQLSchema *) schemaFromDatabase:(SQLDatabase *)database forTables:(NSArray *)tableNames;
+/**
+ *  The names of the tables in the snapshot.
+ */
+@property (readonly) NSArray *tableNames;
+/**
+ *  The names of the indexes in the snapshot, including sqlite's automatic indexes (ex: for UNIQUE columns).
+ */
+@property (readonly) NSArray *indexNames;
+/**
+ *  @return YES if the table is in the snapshot.
+ */
+- (BOOL) hasTable:(NSString *)tableName;
+/**
+ *  @return YES if the index is in the snapshot.
+ */
+- (BOOL) hasIndex:(NSString *)indexName;
+/**
+ *  @return The names of the table's columns, or `nil` if the table isn't in the snapshot.
+ */
+- (NSSet *) columnNamesForTable:(NSString *)tableName;
+/**
+ *  Diffs a statement against the snapshot and returns the updates needed to bring the table up to date:
+ *  - If the table doesn't exist, a `SQLStatementCreate` statement for it.
+ *  - Otherwise, a `SQLStatementAddColumn` statement for each column in the statement that's missing from the table. Columns are never removed.
+ *  - A `SQLStatementCreateIndex` statement for each of the statement's `indexStatements` that doesn't exist.
+ *
+ *  The snapshot is updated as though the updates were applied, so several statements for the same table are merged instead of conflicting.
+ *
+ *  @param statement The statement with the table's columns.
+ *
+ *  @return An NSArray of SQLStatement updates, which is empty if the table is up to date.
+ */
+- (NSArray *) updatesForStatement:(SQLStatement *)statement;
+/**
+ *  Diffs a statement against the columns and indexes provided (ex: from a `PRAGMA table_info` query). The same as `updatesForStatement:`, except nothing is recorded.
+ *
+ *  @param statement   The statement with the table's columns.
+ *  @param columnNames The table's existing column names, or `nil` if the table doesn't exist.
+ *  @param indexNames  The existing index names. If `nil`, every index in the statement is returned (indexes are created `IF NOT EXISTS`).
+ *
+ *  @return An NSArray of SQLStatement updates.
+ */
++ (NSArray *) updatesForStatement:(SQLStatement *)statement existingColumnNames:(NSSet *)columnNames existingIndexNames:(NSSet *)indexNames;
+/**
+ *  Returns a fingerprint for a set of statements. It's generated from the table each statement creates (it's columns, types & constraints) and it's indexes, so it changes when any of those do. The order of the statements doesn't matter.
+ *
+ *  @param statements An NSArray of SQLStatements.
+ *
+ *  @return The fingerprint.
+ */
++ (NSString *) fingerprintForStatements:(NSArray *)statements;
+/**
+ *  Checks if the database was synced to the fingerprint and it's schema hasn't changed since. The fingerprint table is created if it doesn't exist.
+ *
+ *  This must be called on the database's queue and the database can't be read only.
+ *
+ *  @param database    The database to check.
+ *  @param fingerprint A fingerprint from `fingerprintForStatements:`.
+ *
+ *  @return YES if the database is already synced to the fingerprint.
+ */
++ (BOOL) database:(SQLDatabase *)database matchesFingerprint:(NSString *)fingerprint;
+/**
+ *  Records that the database is synced to the fingerprint, along with it's current `schema_version`. Call this after the schema changes are made, in the same transaction.
+ *
+ *  @param fingerprint A fingerprint from `fingerprintForStatements:`.
+ *  @param database    The database that was synced.
+ */
++ (void) recordFingerprint:(NSString *)fingerprint inDatabase:(SQLDatabase *)database;
+@end
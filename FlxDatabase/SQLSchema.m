@@ -0,0 +1,184 @@
+//
+//  SQLSchema.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLSchema.h"
+#import "SQLStatement.h"
+#import "SQLDatabase.h"
+
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+#define FNVOffsetBasis 14695981039346656037ULL
+#define FNVPrime 1099511628211ULL
+
+NSString *const SQLSchemaFingerprintTable = @"SQLSchemaFingerprints";
+
+//Index rows don't join any columns (the join is limited to tables), so they come back with a NULL column name
+#define SchemaSQL @"SELECT m.type AS type, m.name AS name, m.tbl_name AS tableName, p.name AS columnName FROM sqlite_master AS m LEFT JOIN pragma_table_info(m.name) AS p ON m.type = 'table' WHERE m.type IN ('table', 'index')"
+
+static uint64_t SQLFingerprintHash(uint64_t hash, NSString *string){
+  //64 bit FNV-1a
+  for (const char *bytes = string.UTF8String; bytes && *bytes; bytes++){
+    hash ^= (uint8_t)*bytes;
+    hash *= FNVPrime;
+  }
+  return hash;
+}
+
+@implementation SQLSchema {
+  //Table name : NSMutableSet of column names
+  NSMutableDictionary *_tables;
+  NSMutableSet *_indexes;
+}
+#pragma mark - Init Methods
+- (id) init{
+  if ((self = [super init])){
+    _tables = [NSMutableDictionary new];
+    _indexes = [NSMutableSet new];
+  }
+  return self;
+}
++ (SQLSchema *) schemaFromDatabase:(SQLDatabase *)database{
+  return [self schemaFromDatabase:database forTables:nil];
+}
++ (SQLSchema *) schemaFromDatabase:(SQLDatabase *)database forTables:(NSArray *)tableNames{
+  NSString *sql = SchemaSQL;
+  NSArray *parameters = nil;
+  //Too many tables to bind is the same as reading them all
+  if (tableNames.count && tableNames.count <= database.maximumParameterCount){
+    NSMutableArray *placeholders = [NSMutableArray arrayWithCapacity:tableNames.count];
+    for (NSUInteger i = 0; i < tableNames.count; i++){
+      [placeholders addObject:@"?"];
+    }
+    sql = $(@"%@ AND m.tbl_name IN (%@);", sql, [placeholders componentsJoinedByString:@", "]);
+    parameters = tableNames;
+  } else {
+    sql = [sql stringByAppendingString:@";"];
+  }
+
+  SQLSchema *schema = [self new];
+  for (NSDictionary *row in [database executeQuery:sql withParameters:parameters]){
+    NSString *name = row[@"name"];
+    if (!name) continue;
+    if ([row[@"type"] isEqualToString:@"index"]){
+      [schema->_indexes addObject:name];
+      continue;
+    }
+    NSMutableSet *columnNames = schema->_tables[name];
+    if (!columnNames){
+      columnNames = [NSMutableSet new];
+      schema->_tables[name] = columnNames;
+    }
+    if (row[@"columnName"]) [columnNames addObject:row[@"columnName"]];
+  }
+  return schema;
+}
+#pragma mark - Property Methods
+- (NSArray *) tableNames{
+  return [_tables.allKeys sortedArrayUsingSelector:@selector(compare:)];
+}
+- (NSArray *) indexNames{
+  return [_indexes.allObjects sortedArrayUsingSelector:@selector(compare:)];
+}
+#pragma mark - Standard Methods
+- (BOOL) hasTable:(NSString *)tableName{
+  return tableName && _tables[tableName] != nil;
+}
+- (BOOL) hasIndex:(NSString *)indexName{
+  return indexName && [_indexes containsObject:indexName];
+}
+- (NSSet *) columnNamesForTable:(NSString *)tableName{
+  if (!tableName) return nil;
+  return [_tables[tableName] copy];
+}
+- (NSArray *) updatesForStatement:(SQLStatement *)statement{
+  NSString *tableName = statement.tableName;
+  if (!tableName) return @[];
+  NSArray *updates = [SQLSchema updatesForStatement:statement existingColumnNames:_tables[tableName] existingIndexNames:_indexes];
+
+  //Record the updates, as if they were applied
+  NSMutableSet *columnNames = _tables[tableName];
+  if (!columnNames){
+    columnNames = [NSMutableSet new];
+    _tables[tableName] = columnNames;
+  }
+  for (SQLStatement *update in updates){
+    if (update.SQLType == SQLStatementCreateIndex){
+      [_indexes addObject:update.indexName];
+      continue;
+    }
+    if (update.SQLType == SQLStatementCreate) [columnNames addObjectsFromArray:@[GUIDKey, SQLCreatedDate, SQLModifiedDate]];
+    for (SQLColumn *column in update.orderedColumns){
+      if (column.name) [columnNames addObject:column.name];
+    }
+  }
+  return updates;
+}
++ (NSArray *) updatesForStatement:(SQLStatement *)statement existingColumnNames:(NSSet *)columnNames existingIndexNames:(NSSet *)indexNames{
+  NSString *tableName = statement.tableName;
+  if (!tableName) return @[];
+  NSMutableArray *updates = [NSMutableArray new];
+  if (!columnNames){
+    SQLStatement *create = [statement copy];
+    create.tableInfo = NO;
+    create.SQLType = SQLStatementCreate;
+    [updates addObject:create];
+  } else {
+    for (SQLColumn *column in statement.orderedColumns){
+      if (!column.name || [column.name isEqualToString:@"*"] || [columnNames containsObject:column.name]) continue;
+      SQLStatement *addColumn = [[SQLStatement alloc] initWithType:SQLStatementAddColumn forTable:tableName];
+      [addColumn addSQLColumn:column];
+      [updates addObject:addColumn];
+    }
+  }
+  for (SQLStatement *index in statement.indexStatements){
+    if (indexNames && [indexNames containsObject:index.indexName]) continue;
+    [updates addObject:index];
+  }
+  return updates;
+}
+#pragma mark Fingerprints
++ (NSString *) fingerprintForStatements:(NSArray *)statements{
+  /* Each statement is described by the sql that would create it's table and indexes
+   - the descriptions are sorted, so the order of the statements doesn't matter
+   - a separator is hashed after each description, so they can't run together
+   */
+  NSMutableArray *descriptions = [NSMutableArray arrayWithCapacity:statements.count];
+  for (SQLStatement *statement in statements){
+    if (!statement.tableName) continue;
+    SQLStatement *create = [statement copy];
+    create.tableInfo = NO;
+    create.SQLType = SQLStatementCreate;
+    NSMutableString *description = [NSMutableString stringWithString:create.newStatement ?: @""];
+    for (SQLStatement *index in statement.indexStatements){
+      [description appendString:index.newStatement ?: @""];
+    }
+    [descriptions addObject:description];
+  }
+  [descriptions sortUsingSelector:@selector(compare:)];
+  uint64_t hash = FNVOffsetBasis;
+  for (NSString *description in descriptions){
+    hash = SQLFingerprintHash(hash, description);
+    hash = SQLFingerprintHash(hash, @"\n");
+  }
+  return $(@"%016llx-%lu", hash, (unsigned long)descriptions.count);
+}
++ (BOOL) database:(SQLDatabase *)database matchesFingerprint:(NSString *)fingerprint{
+  if (!fingerprint) return NO;
+  //Creating the table changes the schema_version, so a new table never matches
+  [database executeUpdate:$(@"CREATE TABLE IF NOT EXISTS \"%@\" (\"fingerprint\" TEXT PRIMARY KEY, \"schemaVersion\" INTEGER);", SQLSchemaFingerprintTable)];
+  NSDictionary *row = [[database executeQuery:$(@"SELECT f.schemaVersion = v.schema_version AS current FROM \"%@\" AS f, pragma_schema_version AS v WHERE f.fingerprint = ?;", SQLSchemaFingerprintTable) withParameters:@[fingerprint]] firstObject];
+  return [row[@"current"] boolValue];
+}
++ (void) recordFingerprint:(NSString *)fingerprint inDatabase:(SQLDatabase *)database{
+  if (!fingerprint) return;
+  [database executeUpdate:$(@"INSERT OR REPLACE INTO \"%@\" (fingerprint, schemaVersion) SELECT ?, schema_version FROM pragma_schema_version;", SQLSchemaFingerprintTable) withParameters:@[fingerprint]];
+}
+#pragma mark - Overridden Methods
+- (NSString *) description{
+  return $(@"<%@: %p> %lu tables, %lu indexes", NSStringFromClass([self class]), self, (unsigned long)_tables.count, (unsigned long)_indexes.count);
+}
+@end
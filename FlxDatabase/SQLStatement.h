@@ -10,10 +10,11 @@
 #import "SQLPredicate.h"
 #import "SQLOrder.h"
 #import "SQLColumn.h"
+#import "SQLJoin.h"
 #import "SQLStatementProtocol.h"
+#import "SQLGUID.h"
 
-// Default Column Names
-#define GUIDKey @"GUID"
+// Default Column Names (GUIDKey is defined in SQLGUID.h)
 #define SQLCreatedDate @"SQLCreatedDateTime"
 #define SQLModifiedDate @"SQLModifiedDateTime"
 
@@ -26,6 +27,17 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
     SQLConflictRollback
 };
 
+/**
+ *  A position in a paginated query's results: the values of the last row of a page for each of the statement's orderings (including the GUID tiebreaker). Get one from SQLStatement's `pageTokenForRow:` and set it as the statement's `pageToken` to query the next page. A token only applies to a statement with the same orderings.
+ */
+@interface SQLPageToken : NSObject <NSCopying>
+/**
+ *  The row's value for each ordering, in order. NULL values are NSNull.
+ */
+@property (readonly) NSArray *values;
+- (id) initWithValues:(NSArray *)values;
+@end
+
 /**
  *  The SQLStatement takes a bunch of information (columns, predicates, orderings, groups, etc) and will construct an SQL statment (thus the name...).  Not all the properties available on this class will work for all situations. Specifically, some properties only apply to a query while others will only apply to an update. Each property will explain when and where it can be used.
  *  
@@ -34,7 +46,7 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  *  Generally, you construct a SQLStatement by adding columns, predicates, etc and then pass it to the SQLDatabaseManager for processing. Be careful about creating a SQLStatement, passing it to the manager for processing, and then immediately modifying it. The SQLDatabaseManager doesn't copy the statement, so you'll be modifying the original which could lead to undesirable results.  If you're going to reuse a statement, it's probably best to pass to the manager a copy of the statement instead.
  *
  *  There are quite a few auto-generated readonly properties. However, the order you access some of them is important. Normally, you won't need to access these, except perhaps, to debug a statement but when you do, this is important to know:
-    - The `NSString *newStatement` property is auto-generated and *is not cached*. Each time you access it, you're creating a new statement. So if you need to access this, it's recommended you store the string in a local variable.
+    - The `NSString *newStatement` property is auto-generated and *is not cached*. Each time you access it, you're creating a new statement. So if you need to access this, it's recommended you store the string in a local variable. The exception is a compiled statement (see `compile`), which returns the same frozen statement each time and only regenerates its parameters.
     - When a `statement` is generated, so also are the parameters: `NSArray *parameters`, and `parameters` *is* cached.  So if you attempt to access a statement's parameters before you access the statement, you'll either get `nil` or you'll get old parameters (if you've modified the statement).
     - Property `NSString *GUID` is auto-generated.  You *can* set your own GUID if you want, pass the statement to the database manager and it will be used (for insertion/updating).  However, this is not recommended. The GUID must be unique to that table.  If not, the statement will fail since the GUID is the primary key on the table. Instead, use the auto-generated GUID (by simply accessing the property one will be generated and cached) and pass the statement to the manager.  Just be aware that the manager will set the GUID to `nil` when it's done, but *after* the return block has been called.  This way, if you pass the statement to the manager again, a new GUID will be created.
     - NSNumber *modified & *created properties are automatically cached when an update/insertion statement is generated. You can set these beforehand by adding a column with one of the default colum names and setting it's value. However, you really shouldn't need to do this. The updated & created dates are automagically generated, which you can access after the SQLStatement has been run.
@@ -47,6 +59,11 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  */
 @property (readonly) NSDictionary *columns;
 
+/**
+ *  This will return a NSArray of the SQLColumn items currently in the statement, in the order they were added. Statements are always generated using this order, so two statements with the same columns added in the same order will always generate the same sql (which matters if you want the statement cache to work for you).
+ */
+@property (readonly) NSArray *orderedColumns;
+
 /**
  *  This will return a NSArray of SQLPredicate & SQLPredicateGroup items currently in the statement.
  */
@@ -102,6 +119,23 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  */
 @property NSInteger offset;
 
+/**
+ *  Only used for Queries. Turns on keyset (seek) pagination, used with `limit` as the page size instead of `offset`. The query is ordered by it's `orderings` followed by the GUID as a tiebreaker (unless the GUID is already ordered), so every row has a unique position. Instead of skipping rows with `OFFSET`, which makes sqlite walk every row before the page, the next page is found by comparing the ordered columns against the last row of the previous page (see `pageToken`). With an index on the ordered columns, the hundredth page costs the same as the first.
+ *
+ *  A few things to be aware of:
+ *  - `offset` is ignored.
+ *  - The ordered columns & the GUID must be in the results, so `pageTokenForRow:` can read them.
+ *  - Orders with a `customOrdering` and grouped queries can't be paged.
+ *  Default: NO
+ */
+@property bool paginated;
+
+/**
+ *  Only used by paginated Queries. The query returns the rows that come after this token (see `pageTokenForRow:`). Leave it `nil` for the first page. Setting the token discards a compiled statement.
+ *  @warning If the token can't be sought (a grouped query, an order with a `customOrdering`, or a token made for different orderings) an empty statement is generated rather than returning the first page again.
+ */
+@property (copy) SQLPageToken *pageToken;
+
 /**
  *  Only used for Queries. This will change a standard "SELECT" to "SELECT DISTINCT". Essentially, if there are duplicate rows in the returned results, this will remove them from the results.
  *  Default: NO
@@ -121,11 +155,62 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  */
 @property (readonly) NSString *tableName;
 
+/**
+ *  Only used by `SQLStatementQuery`. An alias for the statement's table (`FROM "<tableName>" AS "<tableAlias>"`). When set, the alias qualifies the statement's columns, predicates, orders & groups. This is needed to join a table to itself.
+ */
+@property (copy) NSString *tableAlias;
+
+/**
+ *  Only used by `SQLStatementQuery`. The SQLJoin items in the statement, in the order they were added.
+ */
+@property (readonly) NSArray *joins;
+
+/**
+ *  The tables the statement reads: the statement's table followed by each joined table (without duplicates).
+ */
+@property (readonly) NSArray *referencedTableNames;
+
 /**
  *  This is only used when you're altering a table's name. This value must be present if you use `SQLStatementAlterTable`.
  */
 @property (strong) NSString *alterTableName;
 
+/**
+ *  Used by `SQLStatementCreateIndex` & `SQLStatementDropIndex`: the name of the index. If one isn't set, the name is generated from the table & column names (`<tableName>_<columnName>_..._idx`), so an index created without a name can be dropped by a statement with the same columns.
+ *
+ *  A `SQLStatementCreateIndex` statement indexes it's columns, in the order they were added. An order (`addOrderForColumn:withDirection:`) on one of those columns sets the column's direction & collation in the index, which lets queries with the same ordering avoid a sort. Predicates make it a partial index: only the rows matching the predicates are indexed. sqlite doesn't allow parameters in an index, so predicate values are written into the statement as literals.
+ */
+@property (strong) NSString *indexName;
+
+/**
+ *  Only used by `SQLStatementCreateIndex`. This will create a UNIQUE index.
+ *  Default: NO
+ */
+@property bool uniqueIndex;
+
+/**
+ *  Only used by `SQLStatementCreateIndex`. These columns are appended to the index after the statement's columns so queries that only need the indexed & covering columns can be answered from the index without reading the table (a covering index). They don't help with lookups.
+ */
+@property (copy) NSArray *coveringColumnNames;
+
+/**
+ *  Only used by `SQLStatementUpsert`. The columns that identify an existing row (`ON CONFLICT(<columns>)`). These must be the primary key or have a unique index. If there are none, the GUID is used.
+ *
+ *  An upsert inserts the row if there isn't one. Otherwise, only the supplied columns (those with a value) and the modified date of the existing row are updated in place: the GUID, created date and the key columns are kept. Unlike `SQLConflictReplace`, which deletes the old row and inserts a new one, this doesn't rewrite every index entry, fire delete triggers or reset the created date. `conflict` isn't used. Requires sqlite 3.24 or later.
+ */
+@property (copy) NSArray *upsertKeyColumnNames;
+
+/**
+ *  Only used by `SQLStatementUpsert`. The existing row is only updated if the new modified date is later than it's own (`WHERE excluded.SQLModifiedDateTime > SQLModifiedDateTime`), which makes the upsert last-writer-wins. For sync merges, set the value of the statement's `SQLModifiedDate` column to the incoming row's modified date (otherwise the current date is used, which is always later).
+ *  Default: NO
+ */
+@property bool upsertOnlyIfNewer;
+
+/**
+ *  The indexes (`SQLStatementCreateIndex` statements) to create along with the table: one for each column that's `indexed` plus any added with `addIndexStatement:`. SQLDatabaseManager creates these whenever it creates or updates a table from the statement.
+ */
+@property (readonly) NSArray *indexStatements;
+
 /**
  *  The actual sql statement used on the databse. The statement is auto-generated each time you access this property, so it's recommended that you store the statement in a local variable. When you access this statement several other properties *can* update:
  *  - GUID (if it hasn't already been set)
@@ -140,11 +225,24 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  */
 @property (readonly) NSArray *parameters;
 
+/**
+ *  Returns YES if the statement has been compiled.
+ *  @see compile
+ */
+@property (readonly) BOOL compiled;
+
 /**
  *  This is the GUID. If you request the property and it's not been set, a new GUID will be automatically generated. If you set this property to `nil`, the next the GUID is accessed a new one will be generated.
  */
 @property (strong) NSString *GUID;
 
+/**
+ *  How the table stores it's GUID. When `SQLGUIDModeBinary`, the GUID is generated time-ordered, created as a BLOB column and bound (along with any predicate on the GUID column) as 16 bytes. The GUID property itself is always a string.
+ *  Default: The table's mode, read from the declared type of it's GUID column by the connection that runs the statement (SQLDatabaseManager does this each time it runs the statement, so a migrated table is picked up). Until then, or for a table that doesn't exist yet, it's the mode from `[SQLGUID modeForTable:]`. Setting this overrides both. If you run the statement's sql yourself on a binary table, set it from SQLDatabase's `GUIDModeForTable:`.
+ *  @see SQLGUID
+ */
+@property SQLGUIDMode GUIDMode;
+
 /**
  *  This defines what kind of SQL statement will be generated.
  *  @see SQLStatementType
@@ -168,6 +266,26 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  */
 + (SQLStatement *) renameTable:(NSString *)tableName to:(NSString *)newTableName;
 
+/**
+ *  This will return a SQLStatement of type `SQLStatementCreateIndex` that indexes the columns provided, in order.
+ *
+ *  @param columnNames The names of the columns to index.
+ *  @param tableName   The name of the table.
+ *
+ *  @return SQLStatement
+ */
++ (SQLStatement *) createIndexOnColumns:(NSArray *)columnNames forTable:(NSString *)tableName;
+
+/**
+ *  This will return a SQLStatement of type `SQLStatementDropIndex` that drops the index, if it exists.
+ *
+ *  @param indexName The name of the index.
+ *  @param tableName The name of the table the index is on.
+ *
+ *  @return SQLStatement
+ */
++ (SQLStatement *) dropIndexNamed:(NSString *)indexName forTable:(NSString *)tableName;
+
 /**
  *  Convenience constructor that returns a SQLStatement for the table you specify with the given type.
  *
@@ -190,13 +308,80 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  *  @return SQLStatement
  */
 - (id) initWithType:(SQLStatementType)sqlType forTable:(NSString *)tableName;
+#pragma mark Compiling
+/**
+ *  This will freeze the statement's shape: the sql statement is generated once and, along with it, a layout of where each parameter comes from (a column's value, a predicate's value, the GUID, a timestamp, etc). From then on, accessing `newStatement` returns the same statement string and simply regenerates `parameters` from the current column & predicate values. This is a lot cheaper than rebuilding the statement and, since the statement text never changes, the SQLDatabase statement cache will always find it.
+ *
+ *  Use this when you're keeping a statement around as a template and running it over and over with different values (ex: inserting thousands of objects).
+ *
+ *  A few things to be aware of:
+ *  - A compiled insert includes every column in the statement. Columns with a `nil` value are inserted as NULL (normally they're left out of the insert).
+ *  - Predicates that had a `nil` value when compiled will remain `IS NULL` / `IS NOT NULL`. Predicates that had a value will bind NULL if their value is later set to `nil`.
+ *  - `SQLIn` & `SQLNotIn` lists are always bound as a json array, so the list can change size. Lists that can't be represented in json (ex: NSData values) keep the values they were compiled with. A subquery's parameters are regenerated, but it's shape is frozen too.
+ *  - Adding or removing columns, predicates, orders, groups or joins (or changing the `pageToken`) will discard the compiled statement. So will changing a SQLPredicateGroup in the statement (or in one of it's joins): the statement is recompiled the next time it's run. Changing any other property (type, limit, offset, a predicate's column or operator, etc) will *not*, so call `compile` again if you change those.
+ *  - Copies of a statement are not compiled.
+ */
+- (void) compile;
+/**
+ *  Discards the compiled statement. The statement will be regenerated each time `newStatement` is accessed.
+ */
+- (void) decompile;
+#pragma mark Bulk Inserts
+/**
+ *  The column names (in order) a bulk insert expects a value for in each row: every column in the statement except `*` and the default columns. The GUID, created & modified dates are filled in automatically.
+ *  @see newBulkInsertStatementForRowCount:
+ */
+@property (readonly) NSArray *bulkInsertColumnNames;
+/**
+ *  Generates a multi-row insert (`INSERT OR <conflict> INTO ... VALUES (...), (...)`) for the number of rows provided, using the statement's table, columns and conflict. A `SQLStatementUpsert` statement generates a multi-row upsert instead (see `upsertKeyColumnNames`).
+ *
+ *  Each row has `bulkInsertColumnNames.count + 3` parameters, in this order: the GUID, each of the `bulkInsertColumnNames`, the created date and the modified date. Parameters aren't generated for you; SQLDatabaseManager's bulk insert methods do this.
+ *
+ *  @param rowCount The number of rows in the insert.
+ *
+ *  @return The sql statement.
+ */
+- (NSString *) newBulkInsertStatementForRowCount:(NSUInteger)rowCount;
+#pragma mark Index Methods
+/**
+ *  Adds an index to create along with the table (see `indexStatements`).
+ *
+ *  @param index A statement of type `SQLStatementCreateIndex`. Other statement types are ignored.
+ */
+- (void) addIndexStatement:(SQLStatement *)index;
+#pragma mark Join Methods
+/**
+ *  Joins a table into the query. Add the columns to read and the predicates to join on to the SQLJoin returned.
+ *
+ *  @param tableName The table to join.
+ *  @param joinType  How the table is joined.
+ *
+ *  @return The SQLJoin that was added, or `nil` if the tableName is empty.
+ */
+- (SQLJoin *) addJoinForTable:(NSString *)tableName withType:(SQLJoinType)joinType;
+/**
+ *  Adds the join to the query. Joins are added in the order provided.
+ *
+ *  @param join The SQLJoin to add.
+ */
+- (void) addJoin:(SQLJoin *)join;
+/**
+ *  Removes the join from the query.
+ *
+ *  @param join The SQLJoin to remove.
+ */
+- (void) removeJoin:(SQLJoin *)join;
+/**
+ *  Removes all joins from the query.
+ */
+- (void) removeAllJoins;
 #pragma mark Column Methods
 /**
- *  This will add the column to the table. If the column already exists in the table, the column won't be added, but instead the original column will be returned. 
+ *  This will add the column to the statement. If a column with the same nameString already exists in the statement, it will be replaced by this column (keeping the original column's position).
  *
  *  @param column The SQLColumn you wish to add
  *
- *  @return The SQLColumn that was added or found (could be different than the one you supplied)
+ *  @return The SQLColumn that was added.
  */
 - (SQLColumn *) addSQLColumn:(SQLColumn *)column;
 /**
@@ -293,6 +478,8 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
 /**
  *  Constructs a predicate from the variable provides, adds it to the statement and returns it.
  *
+ *  For `SQLIn` & `SQLNotIn`, the value is a collection or a SQLStatement query (see SQLPredicate's `value`). Lists of up to 32 values are bound a parameter per value. Longer lists are bound as a single json array, read with sqlite's `json_each`, so any number of values can be matched without reaching sqlite's parameter limit (binary GUIDs are always bound a parameter per value). A subquery's parameters are added to the statement's.
+ *
  *  @param predicate The predicate value
  *  @param column    The Name of the column you wish to use.
  *  @param op        The comparison operator.
@@ -300,6 +487,15 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  *  @return The SQLPredicate added to the statement.
  */
 - (SQLPredicate *) addPredicate:(id)predicate forColumn:(NSString *)columnName operator:(SQLOperator)op;
+/**
+ *  Adds an `EXISTS` or `NOT EXISTS` predicate for the subquery. To correlate the subquery with this statement, give the subquery a predicate with a `valueColumn` and set it's `valueTable` to this statement's table (or `tableAlias`).
+ *
+ *  @param subquery A `SQLStatementQuery` statement.
+ *  @param op       `SQLExists` or `SQLNotExists`.
+ *
+ *  @return The SQLPredicate added to the statement.
+ */
+- (SQLPredicate *) addPredicateForSubquery:(SQLStatement *)subquery operator:(SQLOperator)op;
 /**
  *  This will add the predicate to the statement.
  *
@@ -369,6 +565,23 @@ typedef NS_ENUM(NSUInteger, SQLConflict) {
  *  I'm pretty sure the method name says it all.
  */
 - (void) removeAllOrderParameters;
+#pragma mark Pagination Methods
+/**
+ *  Creates the token for the rows following `row`: pass it the last row of a page and set the token as the statement's `pageToken` to query the next page. The row can be a dictionary or a row class. The values are read by the key each ordered column is returned under (it's alias, or for a joined column the join's key path prefix).
+ *
+ *  @param row The last row of a page.
+ *
+ *  @return SQLPageToken, or `nil` if there's no row, an order has a `customOrdering`, an ordered column isn't selected by the statement or the row has no GUID. A selected column missing from a dictionary row is NULL (NULL values are left out of rows).
+ */
+- (SQLPageToken *) pageTokenForRow:(id)row;
+/**
+ *  The token for the page after `rows`, or `nil` if `rows` is the last page (it has fewer rows than the `limit`). This makes paging a simple loop: query, set `pageToken` to this, repeat until it's `nil`.
+ *
+ *  @param rows The rows of a page.
+ *
+ *  @return SQLPageToken
+ */
+- (SQLPageToken *) nextPageTokenForRows:(NSArray *)rows;
 #pragma mark Grouping Methods
 /**
  *  This will add the specified column as a group in the statement.
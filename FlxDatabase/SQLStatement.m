@@ -9,27 +9,102 @@
 #import "SQLStatement.h"
 
 #define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+//Lists longer than this are bound as a single json array instead of a parameter per value
+#define SQLInListBindingLimit 32
 
 @interface SQLStatement ()
 
 @property (strong) NSMutableDictionary *columns;
+@property (strong) NSMutableArray *orderedColumns;
 @property (strong) NSMutableArray *predicates;
 @property (strong) NSMutableArray *orderings;
 @property (strong) NSMutableArray *groups;
 @end
 
+typedef NS_ENUM(NSUInteger, SQLParameterSlotKind){
+  SQLParameterSlotValue,
+  SQLParameterSlotColumn,
+  SQLParameterSlotPredicate,
+  SQLParameterSlotGUID,
+  SQLParameterSlotTimestamp,
+  SQLParameterSlotPredicateList,
+  SQLParameterSlotSubquery
+};
+
+/**
+ *  Records where a parameter in a compiled statement comes from, so the parameters can be regenerated without rebuilding the statement. A subquery slot supplies all of the subquery's parameters.
+ */
+@interface SQLParameterSlot : NSObject
+@property (readonly) SQLParameterSlotKind kind;
+@property (readonly) id source;
+- (id) initWithKind:(SQLParameterSlotKind)kind source:(id)source;
+@end
+
+@implementation SQLParameterSlot
+- (id) initWithKind:(SQLParameterSlotKind)kind source:(id)source{
+  if ((self = [super init])){
+    _kind = kind;
+    _source = source;
+  }
+  return self;
+}
+@end
+
+@implementation SQLPageToken
+- (id) initWithValues:(NSArray *)values{
+  if ((self = [super init])){
+    _values = [values copy] ?: @[];
+  }
+  return self;
+}
+- (id) copyWithZone:(NSZone *)zone{
+  //Tokens are immutable
+  return self;
+}
+- (BOOL) isEqual:(id)object{
+  if (![object isKindOfClass:[SQLPageToken class]]) return NO;
+  return [_values isEqualToArray:[object values]];
+}
+- (NSUInteger) hash{
+  return _values.hash;
+}
+- (NSString *) description{
+  return $(@"<SQLPageToken after: %@>", [_values componentsJoinedByString:@", "]);
+}
+@end
+
 @implementation SQLStatement{
   //Object Values
   NSString *_tableName;
   SQLStatementType _SQLType;
   SQLConflict _conflict;
   NSMutableArray *_predicates;
-  NSMutableDictionary *_columns;
+  NSMutableDictionary *_columns; //Keyed by nameString, for lookup
+  NSMutableArray *_orderedColumns; //Insertion order, used to generate statements
   NSMutableArray *_orderings;
   NSMutableArray *_groups;
   //Result Values
   NSMutableArray *_parameters;
   NSString *_GUID;
+  //GUID Mode: a mode that's been set wins over the table's mode (read from the schema by the connection running the statement)
+  SQLGUIDMode _GUIDMode;
+  BOOL _GUIDModeSet;
+  SQLGUIDMode _tableGUIDMode;
+  BOOL _tableGUIDModeKnown;
+  //Compiled Values
+  NSMutableArray *_parameterSlots;
+  NSArray *_compiledSlots;
+  NSString *_compiledStatement;
+  int64_t _compiledGroupVersion; //The latest version of the predicate groups when compiled
+  //Index Values
+  NSMutableArray *_indexStatements;
+  //Join Values
+  NSMutableArray *_joins;
+  //Pagination Values
+  bool _paginated;
+  SQLPageToken *_pageToken;
+  //Set while generating an index, which can't use parameters
+  BOOL _inlineParameters;
 }
 static NSArray *defaultColumns(){
   static NSArray *defaultColumns = nil;
@@ -39,6 +114,61 @@ static NSArray *defaultColumns(){
   });
   return defaultColumns;
 }
+static NSString *SQLLiteralForValue(id value){
+  //Used where sqlite doesn't allow parameters (ex: a partial index)
+  if (!value || value == [NSNull null]) return @"NULL";
+  if ([value isKindOfClass:[NSNumber class]]) return [value stringValue];
+  if ([value isKindOfClass:[NSDate class]]) return $(@"%.17g", [value timeIntervalSinceReferenceDate]);
+  if ([value isKindOfClass:[NSData class]]){
+    const unsigned char *bytes = [value bytes];
+    NSMutableString *literal = [NSMutableString stringWithCapacity:[value length] * 2 + 3];
+    [literal appendString:@"X'"];
+    for (NSUInteger i = 0; i < [value length]; i++){
+      [literal appendFormat:@"%02X", bytes[i]];
+    }
+    [literal appendString:@"'"];
+    return literal;
+  }
+  return $(@"'%@'", [[value description] stringByReplacingOccurrencesOfString:@"'" withString:@"''"]);
+}
+static BOOL SQLOperatorTakesSet(SQLOperator op){
+  return op == SQLIn || op == SQLNotIn || op == SQLExists || op == SQLNotExists;
+}
+static NSArray *SQLListFromValue(id value){
+  //A single value is a list of one
+  if (!value || value == [NSNull null]) return @[];
+  if ([value isKindOfClass:[NSArray class]]) return value;
+  if ([value isKindOfClass:[NSSet class]]) return [value allObjects];
+  if ([value isKindOfClass:[NSOrderedSet class]]) return [value array];
+  return @[value];
+}
+static NSString *SQLJSONFromList(NSArray *list){
+  //Returns nil if a value can't be represented in json (ex: NSData)
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:list.count];
+  for (id value in list){
+    if ([value isKindOfClass:[NSDate class]]){
+      [values addObject:@([value timeIntervalSinceReferenceDate])];
+    } else if ([value isKindOfClass:[NSString class]] || [value isKindOfClass:[NSNumber class]] || value == [NSNull null]){
+      [values addObject:value];
+    } else {
+      return nil;
+    }
+  }
+  if (![NSJSONSerialization isValidJSONObject:values]) return nil;
+  NSData *data = [NSJSONSerialization dataWithJSONObject:values options:0 error:nil];
+  return data ? [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] : nil;
+}
+static NSString *SQLQualifiedColumn(NSString *table, NSString *column){
+  return $(@"\"%@\".\"%@\"", table, column);
+}
+static NSString *SQLColumnOperatorString(SQLPredicate *predicate){
+  //Columns are compared like a join: NULL doesn't match anything
+  switch (predicate.op) {
+    case SQLEquals: return @"=";
+    case SQLNotEqualTo: return @"!=";
+    default: return predicate.operatorString;
+  }
+}
 static NSArray *defaultColumnTypes(){
   static NSArray *types = nil;
   static dispatch_once_t onceToken;
@@ -53,6 +183,20 @@ static NSArray *defaultColumnTypes(){
   constructor.alterTableName = newTableName;
   return constructor;
 }
++ (SQLStatement *) createIndexOnColumns:(NSArray *)columnNames forTable:(NSString *)tableName{
+  if (!columnNames.count) return nil;
+  SQLStatement *constructor = [[SQLStatement alloc] initWithType:SQLStatementCreateIndex forTable:tableName];
+  for (NSString *columnName in columnNames){
+    [constructor addColumn:columnName];
+  }
+  return constructor;
+}
++ (SQLStatement *) dropIndexNamed:(NSString *)indexName forTable:(NSString *)tableName{
+  if (!indexName.length) return nil;
+  SQLStatement *constructor = [[SQLStatement alloc] initWithType:SQLStatementDropIndex forTable:tableName];
+  constructor.indexName = indexName;
+  return constructor;
+}
 + (SQLStatement *) getAllTables{
   SQLStatement *constructor = [[SQLStatement alloc] initWithType:SQLStatementQuery forTable:@"sqlite_master"];
   [constructor addColumn:@"*" ofColumnType:SQLColumnTypeNone];
@@ -78,6 +222,7 @@ static NSArray *defaultColumnTypes(){
     _tableName = tableName;
     self.SQLType = sqlType;
     _columns = [NSMutableDictionary new];
+    _orderedColumns = [NSMutableArray new];
     _predicates = [NSMutableArray new];
     _orderings = [NSMutableArray new];
     _groups = [NSMutableArray new];
@@ -88,50 +233,319 @@ static NSArray *defaultColumnTypes(){
     _tableInfo = NO;
     _limit = 0;
     _offset = -1;
+    _indexStatements = [NSMutableArray new];
+    _joins = [NSMutableArray new];
   }
   return self;
 }
 #pragma mark - 
 #pragma mark Private Methods
+- (id) GUIDParameter{
+  if (self.GUIDMode == SQLGUIDModeBinary) return [SQLGUID dataFromGUID:self.GUID] ?: self.GUID;
+  return self.GUID;
+}
+- (NSString *) qualifier{
+  //Only queries can alias their table
+  return (_SQLType == SQLStatementQuery && _tableAlias.length) ? _tableAlias : _tableName;
+}
+- (BOOL) predicateComparesBinaryGUIDs:(SQLPredicate *)predicate{
+  if (self.GUIDMode != SQLGUIDModeBinary || ![predicate.column isEqualToString:GUIDKey]) return NO;
+  return !predicate.table || [predicate.table isEqualToString:_tableName] || [predicate.table isEqualToString:_tableAlias];
+}
+- (id) parameterForPredicate:(SQLPredicate *)predicate{
+  return [self parameterForValue:predicate.value predicate:predicate];
+}
+- (id) parameterForValue:(id)value predicate:(SQLPredicate *)predicate{
+  if (!value) return [NSNull null];
+  //Binary GUIDs are compared as blobs, so the GUID string must be converted
+  if ([value isKindOfClass:[NSString class]] && [self predicateComparesBinaryGUIDs:predicate]){
+    return [SQLGUID dataFromGUID:value] ?: value;
+  }
+  return value;
+}
+- (NSString *) listParameterForPredicate:(SQLPredicate *)predicate{
+  return SQLJSONFromList(SQLListFromValue(predicate.value)) ?: @"[]";
+}
+- (NSArray *) parametersForSubquery:(id)subquery{
+  if (![subquery isKindOfClass:[SQLStatement class]]) return @[];
+  [subquery newStatement];
+  return [subquery parameters] ?: @[];
+}
+- (void) addParameter:(id)parameter kind:(SQLParameterSlotKind)kind source:(id)source{
+  [_parameters addObject:parameter];
+  //Slots are only recorded while compiling
+  if (_parameterSlots){
+    [_parameterSlots addObject:[[SQLParameterSlot alloc] initWithKind:kind source:source]];
+  }
+}
+- (void) bindCompiledParameters{
+  [_parameters removeAllObjects];
+  NSDate *now = nil;
+  for (SQLParameterSlot *slot in _compiledSlots){
+    switch (slot.kind) {
+      case SQLParameterSlotValue:
+        [_parameters addObject:slot.source];
+        break;
+      case SQLParameterSlotColumn:
+        [_parameters addObject:[(SQLColumn *)slot.source value] ?: [NSNull null]];
+        break;
+      case SQLParameterSlotPredicate:
+        [_parameters addObject:[self parameterForPredicate:slot.source]];
+        break;
+      case SQLParameterSlotGUID:
+        [_parameters addObject:[self GUIDParameter]];
+        break;
+      case SQLParameterSlotTimestamp:
+        if (!now){
+          now = [NSDate date];
+          _modified = @([now timeIntervalSinceReferenceDate]);
+          if (_SQLType == SQLStatementInsert || _SQLType == SQLStatementUpsert) _created = _modified;
+        }
+        [_parameters addObject:now];
+        break;
+      case SQLParameterSlotPredicateList:
+        [_parameters addObject:[self listParameterForPredicate:slot.source]];
+        break;
+      case SQLParameterSlotSubquery:
+        [_parameters addObjectsFromArray:[self parametersForSubquery:[(SQLPredicate *)slot.source value]]];
+        break;
+    }
+  }
+}
+- (BOOL) orderIsGUID:(SQLOrder *)order{
+  if (![order.column isEqualToString:GUIDKey]) return NO;
+  return !order.table || [order.table isEqualToString:_tableName] || [order.table isEqualToString:_tableAlias];
+}
+- (NSArray *) pageOrderings{
+  //A page is ordered by the statement's orderings with the GUID as the final tiebreaker, so every row has a unique position
+  for (SQLOrder *order in _orderings){
+    if ([self orderIsGUID:order]) return [_orderings copy];
+  }
+  SQLOrder *GUIDOrder = [[SQLOrder alloc] initWithColumn:GUIDKey orderDirection:SQLOrderAscending];
+  GUIDOrder.caseSensitive = YES;
+  return [_orderings arrayByAddingObject:GUIDOrder];
+}
+- (BOOL) canSeekOrderings:(NSArray *)orderings{
+  if (_groups.count || _pageToken.values.count != orderings.count) return NO;
+  for (SQLOrder *order in orderings){
+    if (order.customOrdering.count) return NO;
+  }
+  return YES;
+}
+- (NSString *) resultKeyForOrder:(SQLOrder *)order{
+  //The key an ordered column is returned under: it's alias or, for a joined column, the join's key path prefix. nil if the column isn't selected.
+  NSString *table = order.table;
+  if (!table || [table isEqualToString:_tableName] || [table isEqualToString:_tableAlias]){
+    for (SQLColumn *column in _orderedColumns){
+      if (column.table && ![column.table isEqualToString:_tableName] && ![column.table isEqualToString:_tableAlias]) continue;
+      if ([column.name isEqualToString:@"*"]) return order.column;
+    }
+    for (SQLColumn *column in _orderedColumns){
+      if (column.aggregate != SQLAggregateNone || ![column.name isEqualToString:order.column]) continue;
+      if (column.table && ![column.table isEqualToString:_tableName] && ![column.table isEqualToString:_tableAlias]) continue;
+      return column.alias ?: column.name;
+    }
+    return nil;
+  }
+  for (SQLJoin *join in _joins){
+    if (![join.qualifier isEqualToString:table]) continue;
+    for (SQLColumn *column in join.columns){
+      if ([column.name isEqualToString:@"*"]) return order.column;
+      if (column.aggregate != SQLAggregateNone || ![column.name isEqualToString:order.column]) continue;
+      if (column.alias) return column.alias;
+      if (join.keyPathPrefix.length) return $(@"%@.%@", join.keyPathPrefix, column.name);
+      return column.name;
+    }
+  }
+  return nil;
+}
+- (void) appendSeekParameter:(id)value order:(SQLOrder *)order to:(NSMutableString *)statement{
+  //Binary GUIDs are compared as blobs
+  if (self.GUIDMode == SQLGUIDModeBinary && [value isKindOfClass:[NSString class]] && [self orderIsGUID:order]){
+    value = [SQLGUID dataFromGUID:value] ?: value;
+  }
+  [statement appendString:@" ?"];
+  [self addParameter:value kind:SQLParameterSlotValue source:value];
+}
+- (void) appendSeekComparison:(SQLOrder *)order value:(id)value after:(BOOL)after to:(NSMutableString *)statement{
+  NSString *column = SQLQualifiedColumn(order.table ?: self.qualifier, order.column);
+  BOOL ascending = order.orderDirection == SQLOrderAscending;
+  if (value == [NSNull null]){
+    //NULLs sort first: after a NULL come the values when ascending, and nothing when descending
+    if (!after) [statement appendFormat:@" %@ IS NULL", column];
+    else if (ascending) [statement appendFormat:@" %@ IS NOT NULL", column];
+    else [statement appendString:@" 0"];
+    return;
+  }
+  //Compared with the same collation it's ordered by. Descending, the NULLs come after every value.
+  BOOL includeNulls = after && !ascending;
+  [statement appendFormat:@" %@%@%@ %@", includeNulls ? @"( " : @"", column, order.caseSensitive ? @"" : @" COLLATE NOCASE", !after ? @"=" : ascending ? @">" : @"<"];
+  [self appendSeekParameter:value order:order to:statement];
+  if (includeNulls) [statement appendFormat:@" OR %@ IS NULL)", column];
+}
+- (void) appendSeekPredicateForOrderings:(NSArray *)orderings to:(NSMutableString *)statement{
+  /* The rows after the page token, compared as a tuple in the order of the orderings:
+   - if every order is ascending (and the token has no NULLs) it's a single row value comparison, which sqlite seeks an index with: ("a", "b", "GUID") > (?, ?, ?)
+   - otherwise it's expanded so each column is compared in it's own direction: ( ("a" > ?) OR ("a" = ? AND "b" < ?) OR ...). An ascending first column also bounds the whole comparison ("a" >= ? AND (...)) so an index range can still be used.
+   */
+  NSArray *values = _pageToken.values;
+  BOOL rowValue = YES;
+  for (NSUInteger i = 0; i < orderings.count; i++){
+    if ([orderings[i] orderDirection] != SQLOrderAscending || values[i] == [NSNull null]) rowValue = NO;
+  }
+  if (rowValue){
+    [statement appendString:@" ("];
+    for (NSUInteger i = 0; i < orderings.count; i++){
+      SQLOrder *order = orderings[i];
+      if (i > 0) [statement appendString:@","];
+      [statement appendFormat:@" %@%@", SQLQualifiedColumn(order.table ?: self.qualifier, order.column), order.caseSensitive ? @"" : @" COLLATE NOCASE"];
+    }
+    [statement appendString:@") > ("];
+    for (NSUInteger i = 0; i < orderings.count; i++){
+      if (i > 0) [statement appendString:@","];
+      [self appendSeekParameter:values[i] order:orderings[i] to:statement];
+    }
+    [statement appendString:@")"];
+    return;
+  }
+  SQLOrder *firstOrder = orderings[0];
+  if (firstOrder.orderDirection == SQLOrderAscending && values[0] != [NSNull null]){
+    [statement appendFormat:@" %@%@ >=", SQLQualifiedColumn(firstOrder.table ?: self.qualifier, firstOrder.column), firstOrder.caseSensitive ? @"" : @" COLLATE NOCASE"];
+    [self appendSeekParameter:values[0] order:firstOrder to:statement];
+    [statement appendString:@" AND"];
+  }
+  [statement appendString:@" ("];
+  for (NSUInteger i = 0; i < orderings.count; i++){
+    if (i > 0) [statement appendString:@" OR"];
+    [statement appendString:@" ("];
+    for (NSUInteger j = 0; j < i; j++){
+      [self appendSeekComparison:orderings[j] value:values[j] after:NO to:statement];
+      [statement appendString:@" AND"];
+    }
+    [self appendSeekComparison:orderings[i] value:values[i] after:YES to:statement];
+    [statement appendString:@")"];
+  }
+  [statement appendString:@")"];
+}
+- (void) appendPredicateParameter:(SQLPredicate *)predicate to:(NSMutableString *)statement{
+  if (_inlineParameters){
+    [statement appendFormat:@" %@", SQLLiteralForValue([self parameterForPredicate:predicate])];
+  } else {
+    [statement appendString:@" ?"];
+    [self addParameter:[self parameterForPredicate:predicate] kind:SQLParameterSlotPredicate source:predicate];
+  }
+}
+- (void) appendSetPredicate:(SQLPredicate *)predicate column:(NSString *)column to:(NSMutableString *)statement{
+  /* IN, NOT IN, EXISTS & NOT EXISTS
+   - a subquery is generated in place and it's parameters are added to the statement's
+   - a short list is bound a parameter per value
+   - a long list (or a compiled one) is bound as a single json array and read with json_each, so it stays under sqlite's parameter limit and the statement stays the same size. Binary GUIDs are carried as text & converted back with guid_blob().
+   */
+  id value = predicate.value;
+  BOOL exists = predicate.op == SQLExists || predicate.op == SQLNotExists;
+  if ([value isKindOfClass:[SQLStatement class]]){
+    SQLStatement *subquery = value;
+    NSString *sql = subquery.newStatement;
+    if ([sql hasSuffix:@";"]) sql = [sql substringToIndex:sql.length - 1];
+    if (exists){
+      [statement appendFormat:@" %@ (%@)", predicate.operatorString, sql];
+    } else {
+      [statement appendFormat:@" %@ %@ (%@)", column, predicate.operatorString, sql];
+    }
+    [_parameters addObjectsFromArray:subquery.parameters ?: @[]];
+    if (_parameterSlots){
+      [_parameterSlots addObject:[[SQLParameterSlot alloc] initWithKind:SQLParameterSlotSubquery source:predicate]];
+    }
+    return;
+  }
+  if (exists){
+    //Without a subquery, nothing exists
+    [statement appendString:predicate.op == SQLExists ? @" 0" : @" 1"];
+    return;
+  }
+  
+  NSArray *list = SQLListFromValue(value);
+  [statement appendFormat:@" %@ %@", column, predicate.operatorString];
+  BOOL binaryGUIDs = [self predicateComparesBinaryGUIDs:predicate];
+  NSString *json = nil;
+  if (!_inlineParameters && (list.count > SQLInListBindingLimit || _parameterSlots)){
+    json = SQLJSONFromList(list);
+  }
+  if (json){
+    [statement appendString:binaryGUIDs ? @" (SELECT guid_blob(value) FROM json_each(?))" : @" (SELECT value FROM json_each(?))"];
+    [self addParameter:json kind:SQLParameterSlotPredicateList source:predicate];
+    return;
+  }
+  [statement appendString:@" ("];
+  for (NSUInteger i = 0; i < list.count; i++){
+    if (i > 0) [statement appendString:@", "];
+    id parameter = [self parameterForValue:list[i] predicate:predicate];
+    if (_inlineParameters){
+      [statement appendString:SQLLiteralForValue(parameter)];
+    } else {
+      [statement appendString:@"?"];
+      [self addParameter:parameter kind:SQLParameterSlotValue source:parameter];
+    }
+  }
+  [statement appendString:@")"];
+}
+- (void) invalidateCompiledStatement{
+  _compiledStatement = nil;
+  _compiledSlots = nil;
+}
 - (void) appendPredicateTo:(NSMutableString *)statement{
   if (_predicates.count > 0) {
     [statement appendString:@" WHERE"];
-    NSUInteger count = 0;
-    for (id predicateItem in _predicates) {
-      if ([predicateItem isKindOfClass:[SQLPredicate class]]){
-        SQLPredicate *predicate = predicateItem;
-        if (count > 0) {
-          [statement appendFormat:@" %@", predicate.connectString];
-        }
-        if (predicate.value && predicate.op == SQLLessThan){
-          [statement appendString:@" ("];
-        }
-        [statement appendFormat:@" \"%@\".\"%@\"", _tableName, predicate.column];
-        
-        if (!predicate.value || predicate.value == [NSNull null]){
-          if (predicate.op == SQLEquals || predicate.op == SQLLessThan || predicate.op == SQLLessThanOrEqualTo){
-            [statement appendString:@" IS NULL"];
-          } else {
-            [statement appendString:@" IS NOT NULL"];
-          }
+    [self appendPredicates:_predicates table:self.qualifier to:statement];
+  }
+}
+- (void) appendPredicates:(NSArray *)predicates table:(NSString *)table to:(NSMutableString *)statement{
+  //Predicates without a table belong to the table provided: the statement's, or the joined table's in a join
+  NSUInteger count = 0;
+  for (id predicateItem in predicates) {
+    if ([predicateItem isKindOfClass:[SQLPredicate class]]){
+      SQLPredicate *predicate = predicateItem;
+      NSString *column = SQLQualifiedColumn(predicate.table ?: table, predicate.column);
+      if (count > 0) {
+        [statement appendFormat:@" %@", predicate.connectString];
+      }
+      if (predicate.valueColumn){
+        [statement appendFormat:@" %@ %@ %@", column, SQLColumnOperatorString(predicate), SQLQualifiedColumn(predicate.valueTable ?: self.qualifier, predicate.valueColumn)];
+        count ++;
+        continue;
+      }
+      if (SQLOperatorTakesSet(predicate.op)){
+        [self appendSetPredicate:predicate column:column to:statement];
+        count ++;
+        continue;
+      }
+      if (predicate.value && predicate.op == SQLLessThan){
+        [statement appendString:@" ("];
+      }
+      [statement appendFormat:@" %@", column];
+      
+      if (!predicate.value || predicate.value == [NSNull null]){
+        if (predicate.op == SQLEquals || predicate.op == SQLLessThan || predicate.op == SQLLessThanOrEqualTo){
+          [statement appendString:@" IS NULL"];
         } else {
-          [statement appendFormat:@" %@", predicate.operatorString];
-          [statement appendString:@" ?"];
-          [_parameters addObject:predicate.value ? predicate.value : [NSNull null]];
-          if (predicate.op == SQLLessThan){
-            [statement appendFormat:@" OR \"%@\".\"%@\" IS NULL)", _tableName, predicate.column];
-          }
+          [statement appendString:@" IS NOT NULL"];
         }
-        count ++;
-      } else if ([predicateItem isKindOfClass:[SQLPredicateGroup class]]){
-        if ([predicateItem predicates].count){
-          if (count){
-            [statement appendString:[predicateItem connectString]];
-          }
-          [statement appendString:[self stringFromPredicateGroup:predicateItem]];
-          count++;
+      } else {
+        [statement appendFormat:@" %@", predicate.operatorString];
+        [self appendPredicateParameter:predicate to:statement];
+        if (predicate.op == SQLLessThan){
+          [statement appendFormat:@" OR %@ IS NULL)", column];
         }
       }
+      count ++;
+    } else if ([predicateItem isKindOfClass:[SQLPredicateGroup class]]){
+      if ([predicateItem predicates].count){
+        if (count){
+          [statement appendString:[predicateItem connectString]];
+        }
+        [statement appendString:[self stringFromPredicateGroup:predicateItem table:table]];
+        count++;
+      }
     }
   }
 }
@@ -142,11 +556,11 @@ static NSArray *defaultColumnTypes(){
   NSMutableString *statement = [NSMutableString stringWithFormat: @"CREATE TABLE IF NOT EXISTS \"%@\" (", _tableName];
   
   //Append the default columns
-  [statement appendFormat:@"\"%@\" VARCHAR(36) PRIMARY KEY", GUIDKey];
+  [statement appendFormat:@"\"%@\" %@ PRIMARY KEY", GUIDKey, self.GUIDMode == SQLGUIDModeBinary ? @"BLOB" : @"VARCHAR(36)"];
   [statement appendFormat:@", \"%@\" REAL", SQLCreatedDate];
   [statement appendFormat:@", \"%@\" REAL", SQLModifiedDate];
   
-  for (SQLColumn *currentColumn in _columns.allValues) {
+  for (SQLColumn *currentColumn in _orderedColumns) {
     if (currentColumn.name && ![currentColumn.name isEqual: @""] && ![currentColumn.name isEqual:@"*"] && ![defaultColumns() containsObject:currentColumn.name]){
       [statement appendFormat:@", \"%@\" %@", currentColumn.name, currentColumn.columnTypeString];
       if (currentColumn.primaryKey) [statement appendString:@" PRIMARY KEY"];
@@ -166,19 +580,19 @@ static NSArray *defaultColumnTypes(){
   int count = 0;
   NSDate *now = [NSDate date];
   [statement appendFormat:@" \"%@\" = ?,", [defaultColumns() objectAtIndex:2]];
-  [_parameters addObject:now];
+  [self addParameter:now kind:SQLParameterSlotTimestamp source:nil];
   _modified = [NSNumber numberWithDouble:[now timeIntervalSinceReferenceDate]];
   
   NSArray *disallowedUpdates = @[@"*", GUIDKey, SQLCreatedDate, SQLModifiedDate];
   
-  for (SQLColumn *currentColumn in _columns.allValues) {
+  for (SQLColumn *currentColumn in _orderedColumns) {
     updateValue = currentColumn.value ? currentColumn.value : [NSNull null];
     
     if ([disallowedUpdates containsObject:currentColumn.name]) continue;
     
     if (count > 0 ) [statement appendString:@","];
     [statement appendFormat:@" \"%@\" = ?", currentColumn.name];
-    [_parameters addObject:updateValue];
+    [self addParameter:updateValue kind:SQLParameterSlotColumn source:currentColumn];
     count++;
   }
   
@@ -191,25 +605,29 @@ static NSArray *defaultColumnTypes(){
 - (NSString *) constructInsertStatement{
   NSUInteger count = _columns.count;
   if (count < 1) return @"";
-  NSMutableString *statement = [NSMutableString stringWithFormat:@"INSERT OR %@ INTO \"%@\" (",[self sqlConflictString], _tableName];
+  BOOL upsert = (_SQLType == SQLStatementUpsert);
+  NSMutableString *statement = upsert ? [NSMutableString stringWithFormat:@"INSERT INTO \"%@\" (", _tableName] : [NSMutableString stringWithFormat:@"INSERT OR %@ INTO \"%@\" (",[self sqlConflictString], _tableName];
   NSMutableString *valueStatement = [NSMutableString stringWithString:@" VALUES ("];
+  NSMutableArray *columnNames = [NSMutableArray arrayWithCapacity:_orderedColumns.count];
   
   NSDate *now = [NSDate date];
-  NSMutableSet *defaults = [NSMutableSet setWithObjects:defaultColumns()[1], defaultColumns()[2], nil];
+  NSMutableArray *defaults = [NSMutableArray arrayWithObjects:defaultColumns()[1], defaultColumns()[2], nil];
   
   [statement appendFormat:@"\"%@\"", defaultColumns()[0]];
   [valueStatement appendString:@"?"];
   _created = _modified = @([now timeIntervalSinceReferenceDate]);
-  [_parameters addObject:self.GUID];
-  for (SQLColumn *currentColumn in _columns.allValues){
+  [self addParameter:[self GUIDParameter] kind:SQLParameterSlotGUID source:nil];
+  for (SQLColumn *currentColumn in _orderedColumns){
     id currentValue = currentColumn.value;
-    if (currentValue && ![currentColumn.name isEqual: @"*"] && ![currentColumn.name isEqualToString:GUIDKey]){
+    //A compiled insert includes every column so its shape doesn't depend on which values happen to be set
+    if ((currentValue || _parameterSlots) && ![currentColumn.name isEqual: @"*"] && ![currentColumn.name isEqualToString:GUIDKey]){
       [statement appendString:@","];
       [valueStatement appendString:@","];
       [statement appendFormat:@" \"%@\"", currentColumn.name];
       [valueStatement appendString:@" ?"];
-      [_parameters addObject:currentValue];
+      [self addParameter:currentValue ? currentValue : [NSNull null] kind:SQLParameterSlotColumn source:currentColumn];
       [defaults removeObject:currentColumn.name];
+      [columnNames addObject:currentColumn.name];
     }
   }
   for (NSString *column in defaults){
@@ -217,26 +635,88 @@ static NSArray *defaultColumnTypes(){
     [valueStatement appendString:@","];
     [statement appendFormat:@" \"%@\"", column];
     [valueStatement appendString:@" ?"];
-    [_parameters addObject:_created];
+    [self addParameter:_created kind:SQLParameterSlotTimestamp source:nil];
   }
   [statement appendString:@")"];
   [valueStatement appendString:@")"];
   [statement appendString:valueStatement];
+  if (upsert) [self appendUpsertClauseForColumnNames:columnNames to:statement];
+  [statement appendString:@";"];
+  return statement;
+}
+- (void) appendUpsertClauseForColumnNames:(NSArray *)columnNames to:(NSMutableString *)statement{
+  /* ON CONFLICT(<key>) DO UPDATE SET only the supplied columns (from the `excluded` row that failed to insert) plus the modified date. The row is updated in place: the created date is kept and nothing is deleted, so unchanged index entries & delete triggers are left alone.
+   The newer-only guard makes this last-writer-wins: the existing row is only updated if the incoming modified date is later.
+   */
+  NSArray *keyColumnNames = _upsertKeyColumnNames.count ? _upsertKeyColumnNames : @[GUIDKey];
+  [statement appendString:@" ON CONFLICT("];
+  for (NSUInteger i = 0; i < keyColumnNames.count; i++){
+    if (i > 0) [statement appendString:@", "];
+    [statement appendFormat:@"\"%@\"", keyColumnNames[i]];
+  }
+  [statement appendString:@") DO UPDATE SET"];
+  NSUInteger count = 0;
+  for (NSString *columnName in columnNames){
+    if ([keyColumnNames containsObject:columnName] || [defaultColumns() containsObject:columnName]) continue;
+    [statement appendFormat:@"%@ \"%@\" = excluded.\"%@\"", count > 0 ? @"," : @"", columnName, columnName];
+    count ++;
+  }
+  [statement appendFormat:@"%@ \"%@\" = excluded.\"%@\"", count > 0 ? @"," : @"", SQLModifiedDate, SQLModifiedDate];
+  if (_upsertOnlyIfNewer){
+    NSString *modified = SQLQualifiedColumn(_tableName, SQLModifiedDate);
+    [statement appendFormat:@" WHERE excluded.\"%@\" > %@ OR %@ IS NULL", SQLModifiedDate, modified, modified];
+  }
+}
+- (NSString *) newBulkInsertStatementForRowCount:(NSUInteger)rowCount{
+  if (rowCount < 1) return @"";
+  NSArray *columnNames = self.bulkInsertColumnNames;
+  BOOL upsert = (_SQLType == SQLStatementUpsert);
+  NSMutableString *statement = upsert ? [NSMutableString stringWithFormat:@"INSERT INTO \"%@\" (\"%@\"", _tableName, GUIDKey] : [NSMutableString stringWithFormat:@"INSERT OR %@ INTO \"%@\" (\"%@\"", [self sqlConflictString], _tableName, GUIDKey];
+  NSMutableString *rowStatement = [NSMutableString stringWithString:@"(?"];
+  for (NSString *columnName in columnNames){
+    [statement appendFormat:@", \"%@\"", columnName];
+    [rowStatement appendString:@", ?"];
+  }
+  [statement appendFormat:@", \"%@\", \"%@\") VALUES ", SQLCreatedDate, SQLModifiedDate];
+  [rowStatement appendString:@", ?, ?)"];
+  for (NSUInteger i = 0; i < rowCount; i++){
+    if (i > 0) [statement appendString:@", "];
+    [statement appendString:rowStatement];
+  }
+  if (upsert) [self appendUpsertClauseForColumnNames:columnNames to:statement];
   [statement appendString:@";"];
   return statement;
 }
+- (void) appendColumn:(SQLColumn *)column table:(NSString *)table alias:(NSString *)alias to:(NSMutableString *)statement{
+  if ([column.name isEqualToString:@"*"]){
+    [statement appendFormat:@" \"%@\".*", table];
+    return;
+  }
+  if (column.aggregate == SQLAggregateNone){
+    [statement appendFormat:@" %@", SQLQualifiedColumn(table, column.name)];
+  } else {
+    [statement appendFormat:@" %@(%@)", column.columnAggregateString, SQLQualifiedColumn(table, column.name)];
+  }
+  if (alias){
+    [statement appendFormat:@" AS \"%@\"", alias];
+  }
+}
 - (NSString *) constructQueryStatement{
   NSUInteger count = _columns.count;
   if (count < 1) return @"";
+  //A token that can't be sought (a grouped query, a custom ordering or a token for other orderings) would return the first page again
+  NSArray *orderings = _paginated ? [self pageOrderings] : _orderings;
+  if (_paginated && _pageToken && ![self canSeekOrderings:orderings]) return @"";
+  NSString *qualifier = self.qualifier;
   NSMutableString *statement = [NSMutableString stringWithString:@"SELECT"];
   if (_selectDistinct) [statement appendString:@" DISTINCT"];
   
   //First check if we're grabbing all fields
   count = 0;
-  for (SQLColumn *currentColumn in _columns.allValues){
+  for (SQLColumn *currentColumn in _orderedColumns){
     if ([currentColumn.name isEqual: @"*"]) {
       if (count > 0) [statement appendString:@","];
-      [statement appendFormat:@" \"%@\".%@", _tableName, currentColumn.name];
+      [statement appendFormat:@" \"%@\".%@", currentColumn.table ?: qualifier, currentColumn.name];
       count ++;
       break;
     }
@@ -244,24 +724,51 @@ static NSArray *defaultColumnTypes(){
   
   //If we haven't grabbed all fields, add the fields we want
   if (count == 0){
-    for (SQLColumn *currentColumn in _columns.allValues) {
+    for (SQLColumn *currentColumn in _orderedColumns) {
       if (count > 0) [statement appendString:@","];
-      if (currentColumn.aggregate == SQLAggregateNone){
-        [statement appendFormat:@" \"%@\".\"%@\"", _tableName, currentColumn.name];
-      } else {
-        [statement appendFormat:@" %@(\"%@\".\"%@\")", currentColumn.columnAggregateString, _tableName, currentColumn.name];
-      }
-      
-      if (currentColumn.alias){
-        [statement appendString: [NSString stringWithFormat: @" AS \"%@\"", currentColumn.alias]];
+      [self appendColumn:currentColumn table:currentColumn.table ?: qualifier alias:currentColumn.alias to:statement];
+      count ++;
+    }
+  }
+  
+  //Joined columns follow the statement's columns
+  for (SQLJoin *join in _joins){
+    for (SQLColumn *currentColumn in join.columns){
+      if (count > 0) [statement appendString:@","];
+      NSString *alias = currentColumn.alias;
+      if (!alias && join.keyPathPrefix.length && currentColumn.aggregate == SQLAggregateNone && ![currentColumn.name isEqualToString:@"*"]){
+        alias = $(@"%@.%@", join.keyPathPrefix, currentColumn.name);
       }
+      [self appendColumn:currentColumn table:currentColumn.table ?: join.qualifier alias:alias to:statement];
       count ++;
     }
   }
   
   [statement appendFormat:@" FROM \"%@\"", _tableName];
+  if (_tableAlias.length) [statement appendFormat:@" AS \"%@\"", _tableAlias];
   
-  [self appendPredicateTo:statement];
+  for (SQLJoin *join in _joins){
+    [statement appendFormat:@" %@ \"%@\"", join.joinTypeString, join.tableName];
+    if (join.alias.length) [statement appendFormat:@" AS \"%@\"", join.alias];
+    if (join.predicates.count){
+      [statement appendString:@" ON"];
+      [self appendPredicates:join.predicates table:join.qualifier to:statement];
+    }
+  }
+  
+  if (_paginated && _pageToken){
+    //The seek predicate follows the statement's predicates, which are grouped so an OR in them can't swallow it
+    if (_predicates.count > 0){
+      [statement appendString:@" WHERE ("];
+      [self appendPredicates:_predicates table:qualifier to:statement];
+      [statement appendString:@") AND"];
+    } else {
+      [statement appendString:@" WHERE"];
+    }
+    [self appendSeekPredicateForOrderings:orderings to:statement];
+  } else {
+    [self appendPredicateTo:statement];
+  }
   
   //Construct the groups
   count = 0;
@@ -272,27 +779,27 @@ static NSArray *defaultColumnTypes(){
       if (column.alias){
         [statement appendFormat:@" \"%@\"", column.alias];
       } else {
-        [statement appendFormat:@" \"%@\".\"%@\"", _tableName, column.name];
+        [statement appendFormat:@" %@", SQLQualifiedColumn(column.table ?: qualifier, column.name)];
       }
       count ++;
     }
   }
   
   count = 0;
-  if (_orderings.count > 0){
+  if (orderings.count > 0){
     [statement appendString:@" ORDER BY"];
-    for (SQLOrder *order in _orderings){
+    for (SQLOrder *order in orderings){
       if (count > 0) [statement appendString:@","];
       if (order.customOrdering.count){
-        [statement appendFormat:@" CASE \"%@\".\"%@\"", _tableName, order.column];
+        [statement appendFormat:@" CASE %@", SQLQualifiedColumn(order.table ?: qualifier, order.column)];
         if (order.orderDirection == SQLOrderAscending){
           for (int i = 0; i < order.customOrdering.count; i++){
             [statement appendFormat:@" WHEN ? THEN %i", i];
             id pred = order.customOrdering[i];
             if ([pred isKindOfClass:[NSNumber class]] || [pred isKindOfClass:[NSString class]])
-              [_parameters addObject:pred];
+              [self addParameter:pred kind:SQLParameterSlotValue source:pred];
             else
-              [_parameters addObject:[pred description]];
+              [self addParameter:[pred description] kind:SQLParameterSlotValue source:[pred description]];
           }
           [statement appendFormat:@" ELSE %lu END", (unsigned long)order.customOrdering.count];
         } else {
@@ -300,43 +807,56 @@ static NSArray *defaultColumnTypes(){
             [statement appendFormat:@" WHEN ? THEN %lu", (unsigned long)order.customOrdering.count - i];
             id pred = order.customOrdering[i];
             if ([pred isKindOfClass:[NSNumber class]] || [pred isKindOfClass:[NSString class]])
-              [_parameters addObject:pred];
+              [self addParameter:pred kind:SQLParameterSlotValue source:pred];
             else
-              [_parameters addObject:[pred description]];
+              [self addParameter:[pred description] kind:SQLParameterSlotValue source:[pred description]];
           }
           [statement appendFormat:@" ELSE 0 END"];
         }
         count++;
       } else {
-        [statement appendFormat:@" \"%@\".\"%@\"", _tableName, order.column];
+        [statement appendFormat:@" %@", SQLQualifiedColumn(order.table ?: qualifier, order.column)];
         [statement appendFormat:@" %@", order.orderDirectionString];
         count ++;
       }
     }
   }
   
-  if (_limit > 0 || _offset > -1){
+  //Pages are sought, never skipped to
+  NSInteger offset = _paginated ? -1 : _offset;
+  if (_limit > 0 || offset > -1){
     [statement appendFormat:@" LIMIT %lu", (unsigned long)_limit];
-    if (_offset > -1) [statement appendFormat:@" OFFSET %ld",(long)_offset];
+    if (offset > -1) [statement appendFormat:@" OFFSET %ld",(long)offset];
   }
   
   [statement appendString:@";"];
   return statement;
 }
-- (NSString *) stringFromPredicateGroup:(SQLPredicateGroup *)group{
+- (NSString *) stringFromPredicateGroup:(SQLPredicateGroup *)group table:(NSString *)table{
   if (!group.predicates.count) return @"";
   NSUInteger count = 0;
   NSMutableString *statement = [NSMutableString stringWithString:@"("];
   for (id predicateItem in group.predicates) {
     if ([predicateItem isKindOfClass:[SQLPredicate class]]){
       SQLPredicate *predicate = predicateItem;
+      NSString *column = SQLQualifiedColumn(predicate.table ?: table, predicate.column);
       if (count > 0) {
         [statement appendFormat:@" %@", predicate.connectString];
       }
+      if (predicate.valueColumn){
+        [statement appendFormat:@" %@ %@ %@", column, SQLColumnOperatorString(predicate), SQLQualifiedColumn(predicate.valueTable ?: self.qualifier, predicate.valueColumn)];
+        count ++;
+        continue;
+      }
+      if (SQLOperatorTakesSet(predicate.op)){
+        [self appendSetPredicate:predicate column:column to:statement];
+        count ++;
+        continue;
+      }
       if (predicate.value && predicate.op == SQLLessThan && group.predicates.count > 1){
         [statement appendString:@" ("];
       }
-      [statement appendFormat:@" \"%@\".\"%@\"", _tableName, predicate.column];
+      [statement appendFormat:@" %@", column];
       if (!predicate.value || predicate.value == [NSNull null]){
         if (predicate.op == SQLEquals || predicate.op == SQLLessThan || predicate.op == SQLLessThanOrEqualTo){
           [statement appendString:@" IS NULL"];
@@ -345,10 +865,9 @@ static NSArray *defaultColumnTypes(){
         }
       } else {
         [statement appendFormat:@" %@", predicate.operatorString];
-        [statement appendString:@" ?"];
-        [_parameters addObject:predicate.value ? predicate.value : [NSNull null]];
+        [self appendPredicateParameter:predicate to:statement];
         if (predicate.op == SQLLessThan){
-          [statement appendFormat:@" OR \"%@\".\"%@\" IS NULL%@", _tableName, predicate.column, group.predicates.count > 1 ? @")" : @" "];
+          [statement appendFormat:@" OR %@ IS NULL%@", column, group.predicates.count > 1 ? @")" : @" "];
         }
       }
       count ++;
@@ -357,7 +876,7 @@ static NSArray *defaultColumnTypes(){
         if (count){
           [statement appendString:[predicateItem connectString]];
         }
-        [statement appendString:[self stringFromPredicateGroup:predicateItem]];
+        [statement appendString:[self stringFromPredicateGroup:predicateItem table:table]];
         count++;
       }
     }
@@ -380,7 +899,7 @@ static NSArray *defaultColumnTypes(){
     if (predicate.value){
       if (count > 0) [statement appendFormat:@" %@", predicate.connectString];
       [statement appendFormat:@" \"%@\" %@ ?", predicate.column, predicate.operatorString];
-      [_parameters addObject:(predicate.value) ? : [NSNull null]];
+      [self addParameter:[self parameterForPredicate:predicate] kind:SQLParameterSlotPredicate source:predicate];
       count ++;
     }
   }
@@ -398,7 +917,7 @@ static NSArray *defaultColumnTypes(){
 }
 - (NSString *) constructAddColumn{
   if (_columns.count < 1) return @"";
-  SQLColumn *currentColumn = _columns.allValues.firstObject;
+  SQLColumn *currentColumn = _orderedColumns.firstObject;
   NSMutableString *statement = [NSMutableString stringWithFormat: @"ALTER TABLE \"%@\" ADD COLUMN", _tableName];
   if (currentColumn.name && ![currentColumn.name isEqualToString:@""] && ![currentColumn.name isEqual:@"*"]){
     [statement appendFormat:@" \"%@\" %@", currentColumn.name, currentColumn.columnTypeString];
@@ -408,6 +927,41 @@ static NSArray *defaultColumnTypes(){
   [statement appendString:@";"];
   return statement;
 }
+- (NSArray *) indexColumnNames{
+  NSMutableArray *columnNames = [NSMutableArray arrayWithCapacity:_orderedColumns.count];
+  for (SQLColumn *column in _orderedColumns){
+    if (column.name.length && ![column.name isEqualToString:@"*"] && ![columnNames containsObject:column.name]) [columnNames addObject:column.name];
+  }
+  return columnNames;
+}
+- (NSString *) constructCreateIndex{
+  NSArray *columnNames = [self indexColumnNames];
+  if (!columnNames.count) return @"";
+  NSMutableString *statement = [NSMutableString stringWithFormat:@"CREATE %@INDEX IF NOT EXISTS \"%@\" ON \"%@\" (", _uniqueIndex ? @"UNIQUE " : @"", self.indexName, _tableName];
+  NSUInteger count = 0;
+  for (NSString *columnName in columnNames){
+    [statement appendFormat:@"%@\"%@\"", count > 0 ? @", " : @"", columnName];
+    //An order sets the column's collation & direction, so queries with the same order can use the index to sort
+    NSUInteger orderIndex = [_orderings indexOfObject:[[SQLOrder alloc] initWithColumn:columnName orderDirection:SQLOrderAscending]];
+    if (orderIndex != NSNotFound) [statement appendFormat:@" %@", [_orderings[orderIndex] orderDirectionString]];
+    count++;
+  }
+  for (NSString *columnName in _coveringColumnNames){
+    if ([columnNames containsObject:columnName]) continue;
+    [statement appendFormat:@", \"%@\"", columnName];
+  }
+  [statement appendString:@")"];
+  _inlineParameters = YES;
+  [self appendPredicateTo:statement];
+  _inlineParameters = NO;
+  [statement appendString:@";"];
+  return statement;
+}
+- (NSString *) constructDropIndex{
+  NSString *indexName = self.indexName;
+  if (!indexName.length) return @"";
+  return $(@"DROP INDEX IF EXISTS \"%@\";", indexName);
+}
 - (NSString *) sqlConflictString{
   switch (_conflict) {
     case SQLConflictReplace:
@@ -429,14 +983,32 @@ static NSArray *defaultColumnTypes(){
 - (id) copyWithZone:(NSZone *)zone{
   SQLStatement *returnConstructor = [[[self class] alloc] initWithType:_SQLType forTable:_tableName];
   returnConstructor.conflict = self.conflict;
-  returnConstructor.columns =[[NSMutableDictionary alloc] initWithDictionary:_columns copyItems:YES];
+  if (_GUIDModeSet) returnConstructor.GUIDMode = _GUIDMode;
+  if (_tableGUIDModeKnown) [returnConstructor setTableGUIDMode:_tableGUIDMode];
+  for (SQLColumn *column in _orderedColumns){
+    [returnConstructor addSQLColumn:[column copy]];
+  }
   returnConstructor.predicates = [[NSMutableArray alloc] initWithArray:_predicates copyItems:YES];
   returnConstructor.orderings = [[NSMutableArray alloc] initWithArray:_orderings copyItems:YES];
   returnConstructor.groups = [[NSMutableArray alloc] initWithArray:_groups copyItems:YES];
   returnConstructor.limit = self.limit;
   returnConstructor.offset = self.offset;
+  returnConstructor.paginated = _paginated;
+  returnConstructor.pageToken = _pageToken;
   returnConstructor.selectDistinct = self.selectDistinct;
   returnConstructor.tableInfo = self.tableInfo;
+  returnConstructor.indexName = _indexName;
+  returnConstructor.uniqueIndex = self.uniqueIndex;
+  returnConstructor.coveringColumnNames = self.coveringColumnNames;
+  returnConstructor.upsertKeyColumnNames = self.upsertKeyColumnNames;
+  returnConstructor.upsertOnlyIfNewer = self.upsertOnlyIfNewer;
+  returnConstructor.tableAlias = _tableAlias;
+  for (SQLJoin *join in _joins){
+    [returnConstructor addJoin:[join copy]];
+  }
+  for (SQLStatement *index in _indexStatements){
+    [returnConstructor addIndexStatement:[index copy]];
+  }
   
   return returnConstructor;
 }
@@ -446,6 +1018,7 @@ static NSArray *defaultColumnTypes(){
 #pragma mark - 
 #pragma mark Properties
 - (void) setTableName:(NSString *)tableName{
+  [self invalidateCompiledStatement];
   if (tableName.length){
     _tableName = tableName;
   }
@@ -456,26 +1029,78 @@ static NSArray *defaultColumnTypes(){
 - (NSArray *) defaultColumnNames{
   return defaultColumns();
 }
+- (NSArray *) joins{
+  return [_joins copy];
+}
+static void SQLAddSubqueryTableNames(NSArray *predicates, NSMutableArray *tableNames){
+  for (id predicateItem in predicates){
+    if ([predicateItem isKindOfClass:[SQLPredicate class]]){
+      id value = [predicateItem value];
+      if (![value isKindOfClass:[SQLStatement class]]) continue;
+      for (NSString *tableName in [value referencedTableNames]){
+        if (![tableNames containsObject:tableName]) [tableNames addObject:tableName];
+      }
+    } else if ([predicateItem isKindOfClass:[SQLPredicateGroup class]]){
+      SQLAddSubqueryTableNames([predicateItem predicates], tableNames);
+    }
+  }
+}
+static int64_t SQLLatestGroupVersion(NSArray *predicates){
+  int64_t latest = 0;
+  for (id predicateItem in predicates){
+    if (![predicateItem isKindOfClass:[SQLPredicateGroup class]]) continue;
+    latest = MAX(latest, MAX([(SQLPredicateGroup *)predicateItem version], SQLLatestGroupVersion([predicateItem predicates])));
+  }
+  return latest;
+}
+- (int64_t) latestGroupVersion{
+  int64_t latest = SQLLatestGroupVersion(_predicates);
+  for (SQLJoin *join in _joins){
+    latest = MAX(latest, SQLLatestGroupVersion(join.predicates));
+  }
+  return latest;
+}
+- (NSArray *) referencedTableNames{
+  NSMutableArray *tableNames = [NSMutableArray arrayWithObject:_tableName];
+  for (SQLJoin *join in _joins){
+    if (![tableNames containsObject:join.tableName]) [tableNames addObject:join.tableName];
+    SQLAddSubqueryTableNames(join.predicates, tableNames);
+  }
+  SQLAddSubqueryTableNames(_predicates, tableNames);
+  return tableNames;
+}
 - (NSString *) newStatement{
+  //Groups are changed without the statement knowing, so a compiled statement checks if any changed since it was compiled
+  if (_compiledStatement && [self latestGroupVersion] > _compiledGroupVersion) [self compile];
+  if (_compiledStatement){
+    [self bindCompiledParameters];
+    return _compiledStatement;
+  }
   if (_tableInfo == YES){
     return [NSString stringWithFormat:@"PRAGMA table_info(\"%@\");", _tableName];
   }
   [_parameters removeAllObjects];
   switch (_SQLType) {
     case SQLStatementCreate: return [self constructCreateStatement];
-    case SQLStatementInsert: return [self constructInsertStatement];
+    case SQLStatementInsert:
+    case SQLStatementUpsert: return [self constructInsertStatement];
     case SQLStatementUpdate: return [self constructUpdateStatement];
     case SQLStatementQuery: return [self constructQueryStatement];
     case SQLStatementDelete: return [self constructDelete];
     case SQLStatementAddColumn: return [self constructAddColumn];
     case SQLStatementDropTable: return [self constructDropTable];
     case SQLStatementAlterTable: return [self constructAlterTable];
+    case SQLStatementCreateIndex: return [self constructCreateIndex];
+    case SQLStatementDropIndex: return [self constructDropIndex];
   }
   return @"";
 }
 - (NSArray *) parameters{
   return _parameters;
 }
+- (BOOL) compiled{
+  return _compiledStatement != nil;
+}
 - (NSArray *) defaultColumns{
   return ({
     NSMutableArray *columns = [NSMutableArray new];
@@ -487,16 +1112,113 @@ static NSArray *defaultColumnTypes(){
     columns;
   });
 }
+- (NSArray *) bulkInsertColumnNames{
+  NSMutableArray *columnNames = [NSMutableArray arrayWithCapacity:_orderedColumns.count];
+  for (SQLColumn *column in _orderedColumns){
+    if (column.name.length && ![column.name isEqualToString:@"*"] && ![defaultColumns() containsObject:column.name]){
+      [columnNames addObject:column.name];
+    }
+  }
+  return columnNames;
+}
+- (NSString *) indexName{
+  if (_indexName) return _indexName;
+  NSArray *columnNames = [self indexColumnNames];
+  if (!columnNames.count) return nil;
+  return $(@"%@_%@_idx", _tableName, [columnNames componentsJoinedByString:@"_"]);
+}
+- (NSArray *) indexStatements{
+  NSMutableArray *indexes = [NSMutableArray arrayWithArray:_indexStatements];
+  for (SQLColumn *column in _orderedColumns){
+    //Primary keys & unique columns are already indexed by sqlite
+    if (!column.indexed || column.primaryKey || column.unique || !column.name.length || [column.name isEqualToString:@"*"]) continue;
+    [indexes addObject:[SQLStatement createIndexOnColumns:@[column.name] forTable:_tableName]];
+  }
+  return indexes;
+}
+- (void) setGUIDMode:(SQLGUIDMode)GUIDMode{
+  [self invalidateCompiledStatement];
+  _GUIDMode = GUIDMode;
+  _GUIDModeSet = YES;
+}
+- (SQLGUIDMode) GUIDMode{
+  if (_GUIDModeSet) return _GUIDMode;
+  if (_tableGUIDModeKnown) return _tableGUIDMode;
+  return [SQLGUID modeForTable:_tableName];
+}
+- (void) setTableGUIDMode:(SQLGUIDMode)mode{
+  //Set by the connection about to run the statement, from the table's schema. The compiled sql depends on the mode, so it's recompiled if the mode changed (ex: the table was migrated).
+  if (_tableGUIDModeKnown && _tableGUIDMode == mode) return;
+  if (!_GUIDModeSet) [self invalidateCompiledStatement];
+  _tableGUIDMode = mode;
+  _tableGUIDModeKnown = YES;
+}
 - (void) setGUID:(NSString *)GUID{
   _GUID = GUID;
 }
 - (NSString *) GUID{
   if (!_GUID){
-    _GUID = [SQLStatement newGUID];
+    _GUID = self.GUIDMode == SQLGUIDModeBinary ? [SQLGUID newTimeOrderedGUID] : [SQLStatement newGUID];
   }
   return _GUID;
 }
+- (void) setPaginated:(bool)paginated{
+  [self invalidateCompiledStatement];
+  _paginated = paginated;
+}
+- (bool) paginated{
+  return _paginated;
+}
+- (void) setPageToken:(SQLPageToken *)pageToken{
+  [self invalidateCompiledStatement];
+  _pageToken = [pageToken copy];
+}
+- (SQLPageToken *) pageToken{
+  return _pageToken;
+}
 #pragma mark - Standard Methods
+#pragma mark Compiling
+- (void) compile{
+  [self invalidateCompiledStatement];
+  _parameterSlots = [NSMutableArray new];
+  _compiledGroupVersion = [self latestGroupVersion];
+  NSString *statement = [self.newStatement copy];
+  _compiledSlots = [_parameterSlots copy];
+  _parameterSlots = nil;
+  if (statement.length){
+    _compiledStatement = statement;
+  } else {
+    _compiledSlots = nil;
+  }
+}
+- (void) decompile{
+  [self invalidateCompiledStatement];
+}
+#pragma mark Index Methods
+- (void) addIndexStatement:(SQLStatement *)index{
+  if (index.SQLType != SQLStatementCreateIndex) return;
+  [_indexStatements addObject:index];
+}
+#pragma mark Join Methods
+- (SQLJoin *) addJoinForTable:(NSString *)tableName withType:(SQLJoinType)joinType{
+  SQLJoin *join = [[SQLJoin alloc] initWithTable:tableName joinType:joinType];
+  [self addJoin:join];
+  return join;
+}
+- (void) addJoin:(SQLJoin *)join{
+  if (!join) return;
+  [self invalidateCompiledStatement];
+  [_joins addObject:join];
+}
+- (void) removeJoin:(SQLJoin *)join{
+  if (!join) return;
+  [self invalidateCompiledStatement];
+  [_joins removeObject:join];
+}
+- (void) removeAllJoins{
+  [self invalidateCompiledStatement];
+  [_joins removeAllObjects];
+}
 #pragma mark Column Methods
 - (SQLColumn *) addColumn:(NSString *)column{
   return [self addSQLColumn:[[SQLColumn alloc] initWithColumn:column]];
@@ -511,28 +1233,48 @@ static NSArray *defaultColumnTypes(){
   return [self addSQLColumn:[[SQLColumn alloc] initWithColumn:column ofColumnType:newColumnType usingAlias:newAlias aggregate:aggregate]];
 }
 - (SQLColumn *) addSQLColumn:(SQLColumn *)column{
+  [self invalidateCompiledStatement];
   if (!column.name) return nil;
-  _columns[column.nameString] = column;
+  NSString *key = column.nameString;
+  SQLColumn *existing = _columns[key];
+  if (existing){
+    //Replace the existing column in place so the column order doesn't change
+    NSUInteger index = [_orderedColumns indexOfObjectIdenticalTo:existing];
+    if (index != NSNotFound) _orderedColumns[index] = column;
+  } else {
+    [_orderedColumns addObject:column];
+  }
+  _columns[key] = column;
   return column;
 }
 - (SQLColumn *) getColumnNamed:(NSString *)columnName{
-  for (SQLColumn *column in _columns) if ([column.name isEqualToString:columnName] || [column.alias isEqualToString:columnName]) return column;
+  if (!columnName) return nil;
+  SQLColumn *column = _columns[columnName];
+  if ([column.name isEqualToString:columnName] || [column.alias isEqualToString:columnName]) return column;
+  //The name index is keyed by nameString (the alias, if there is one), so fall back to the column names
+  for (column in _orderedColumns) if ([column.name isEqualToString:columnName] || [column.alias isEqualToString:columnName]) return column;
   return nil;
 }
 - (SQLColumn *) removeColumnNamed:(NSString *)columnName{
-  if (!columnName) return nil;
-  SQLColumn *column = _columns[columnName];
+  [self invalidateCompiledStatement];
+  SQLColumn *column = [self getColumnNamed:columnName];
   if (column){
-    [_columns removeObjectForKey:column.nameString];
+    [self removeColumn:column];
   }
   return column;
 }
 - (void) removeColumn:(SQLColumn *)column{
+  [self invalidateCompiledStatement];
   if (!column.nameString) return;
+  SQLColumn *existing = _columns[column.nameString];
+  if (!existing) return;
+  [_orderedColumns removeObjectIdenticalTo:existing];
   [_columns removeObjectForKey:column.nameString];
 }
 - (void) removeAllColumns{
+  [self invalidateCompiledStatement];
   [_columns removeAllObjects];
+  [_orderedColumns removeAllObjects];
 }
 - (void) addDefaultColumns{
   for (int i = 0; i < defaultColumns().count; i++){
@@ -541,6 +1283,7 @@ static NSArray *defaultColumnTypes(){
 }
 #pragma mark Predicate Methods
 - (SQLPredicate *) addPredicate:(id)predicate forSQLColumn:(SQLColumn *)column operator:(SQLOperator)op{
+  [self invalidateCompiledStatement];
   if (column.name){
     SQLPredicate *pred = [[SQLPredicate alloc] initWithColumn:column.name value:predicate operator:op connection:SQLConnectAnd];
     [_predicates addObject:pred];
@@ -552,6 +1295,7 @@ static NSArray *defaultColumnTypes(){
   return [self addPredicate:predicate forColumn:columnName operator:SQLEquals];
 }
 - (SQLPredicate *) addPredicate:(id)predicate forColumn:(NSString *)columnName operator:(SQLOperator)op{
+  [self invalidateCompiledStatement];
   if (columnName && ![columnName isEqualToString:@"*"]){
     SQLPredicate *pred = [[SQLPredicate alloc] initWithColumn:columnName value:predicate operator:op connection:SQLConnectAnd];
     [_predicates addObject:pred];
@@ -560,23 +1304,35 @@ static NSArray *defaultColumnTypes(){
   assert(NO);
   return nil;
 }
+- (SQLPredicate *) addPredicateForSubquery:(SQLStatement *)subquery operator:(SQLOperator)op{
+  [self invalidateCompiledStatement];
+  if (!subquery || (op != SQLExists && op != SQLNotExists)) return nil;
+  SQLPredicate *pred = [[SQLPredicate alloc] initWithColumn:nil value:subquery operator:op connection:SQLConnectAnd];
+  [_predicates addObject:pred];
+  return pred;
+}
 - (void) addPredicate:(SQLPredicate *)predicate{
+  [self invalidateCompiledStatement];
   if (predicate.column){
     [_predicates addObject:predicate];
   }
 }
 - (void) removePredicate:(SQLPredicate *)predicate{
+  [self invalidateCompiledStatement];
   [_predicates removeObject:predicate];
 }
 - (void) removeAllPredicates{
+  [self invalidateCompiledStatement];
   [_predicates removeAllObjects];
 }
 - (void) addPredicateGroup:(SQLPredicateGroup *)group{
+  [self invalidateCompiledStatement];
   if (group){
     [_predicates addObject:group];
   }
 }
 - (void) removePredicateGroup:(SQLPredicateGroup *)group{
+  [self invalidateCompiledStatement];
   if (group){
     [_predicates removeObject:group];
   }
@@ -586,6 +1342,7 @@ static NSArray *defaultColumnTypes(){
   return [self addOrderForColumn:column.name withDirection:direction];
 }
 - (SQLOrder *) addOrderForColumn:(NSString *)columnName withDirection:(SQLOrderDirection)direction{
+  [self invalidateCompiledStatement];
   if (columnName){
     SQLOrder *order = [[SQLOrder alloc] initWithColumn:columnName orderDirection:direction];
     NSUInteger index = [_orderings indexOfObject:order];
@@ -599,6 +1356,7 @@ static NSArray *defaultColumnTypes(){
   return nil;
 }
 - (void) addOrderParameter:(SQLOrder *)order{
+  [self invalidateCompiledStatement];
   if (order.column) {
     NSUInteger index = [_orderings indexOfObject:order];
     if (index == NSNotFound){
@@ -609,20 +1367,47 @@ static NSArray *defaultColumnTypes(){
   }
 }
 - (void) removeOrderParameter:(SQLOrder *)order{
+  [self invalidateCompiledStatement];
   [_orderings removeObject:order];
 }
 - (void) removeOrderWithColumName:(NSString *)column{
+  [self invalidateCompiledStatement];
   if (!column.length) return;
   [_orderings removeObject:[[SQLOrder alloc] initWithColumn:column orderDirection:SQLOrderAscending]];
 }
 - (void) removeAllOrderParameters{
+  [self invalidateCompiledStatement];
   [_orderings removeAllObjects];
 }
+#pragma mark Pagination Methods
+- (SQLPageToken *) pageTokenForRow:(id)row{
+  if (!row) return nil;
+  NSArray *orderings = [self pageOrderings];
+  NSMutableArray *values = [NSMutableArray arrayWithCapacity:orderings.count];
+  for (SQLOrder *order in orderings){
+    if (order.customOrdering.count) return nil;
+    //A column that isn't selected can't be read, and a NULL in it's place would seek from the wrong row
+    NSString *key = [self resultKeyForOrder:order];
+    if (!key) return nil;
+    id value = [row isKindOfClass:[NSDictionary class]] ? row[key] : [row valueForKeyPath:key];
+    //Rows leave out NULL values, but the GUID is never NULL
+    if (!value && [self orderIsGUID:order]) return nil;
+    [values addObject:value ?: [NSNull null]];
+  }
+  return [[SQLPageToken alloc] initWithValues:values];
+}
+- (SQLPageToken *) nextPageTokenForRows:(NSArray *)rows{
+  //A short page is the last one
+  if (_limit == 0 || rows.count < _limit) return nil;
+  return [self pageTokenForRow:rows.lastObject];
+}
 #pragma mark Grouping Methods
 - (void) addGroupColumn:(SQLColumn *)groupColumn{
+  [self invalidateCompiledStatement];
   [_groups addObject:groupColumn];
 }
 - (void) removeGroupColumn:(SQLColumn *)groupColumn{
+  [self invalidateCompiledStatement];
   [_groups removeObject:groupColumn];
 }
 @end
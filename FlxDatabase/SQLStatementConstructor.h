@@ -22,7 +22,15 @@
 + (SQLStatement *) constructUpdateStatementFromObject:(id)object usingProtocol:(Protocol *)proto onKey:(NSString *)key tableName:(NSString *)tableName;
 + (SQLStatement *) constructInsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto;
 + (SQLStatement *) constructInsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto tableName:(NSString *)tableName;
+/* Upserts insert the object or update only it's columns in an existing row with the same key (GUID by default), keeping the created date. See SQLStatement's `upsertKeyColumnNames`. */
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto;
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto tableName:(NSString *)tableName;
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto onKey:(NSString *)key tableName:(NSString *)tableName;
 + (SQLStatement *) constructDeleteStatementFromObject:(id)object usingProtocol:(Protocol *)proto;
 + (SQLStatement *) constructDeleteStatementFromObject:(id)object usingProtocol:(Protocol *)proto onKey:(NSString *)key;
 + (SQLStatement *) constructDeleteStatementFromObject:(id)object onKey:(NSString *)key usingProtocol:(Protocol *)proto tableName:(NSString *)tableName;
+
+/* ***** Index Constructors ****** */
+/* Returns a SQLStatementCreateIndex statement for each index protocol (SQLStatementIndex) the protocol adopts. Constructing a SQLStatementCreateIndex statement from an index protocol directly indexes it's properties. */
++ (NSArray *) constructIndexStatementsFromProtocol:(Protocol *)proto usingTableName:(NSString *)tableName;
 @end
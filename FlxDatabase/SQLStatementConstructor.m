@@ -10,6 +10,8 @@
 #import "SQLStatement.h"
 #import <objc/runtime.h>
 
+#define $(...)        [NSString  stringWithFormat:__VA_ARGS__,nil]
+
 @interface SQLPropertyObject : NSObject
 @property (nonatomic) SQLColumnType propertyColumn;
 @property (nonatomic) NSString *propertyName;
@@ -84,6 +86,42 @@
   
   return propertyObj;
 }
++ (NSArray *) propertyObjectsFromProtocol:(Protocol *)proto{
+  unsigned int propertyCount;
+  objc_property_t *properties = protocol_copyPropertyList(proto, &propertyCount);
+  NSMutableArray *propertyObjects = [NSMutableArray new];
+  for (unsigned int i = 0; i < propertyCount; i++){
+    SQLPropertyObject *propertyObject = [self propertyObjectFromProperty:properties[i]];
+    if (propertyObject){
+      [propertyObjects addObject:propertyObject];
+    }
+  }
+  
+  free(properties);
+  return propertyObjects;
+}
++ (NSArray *) indexProtocolsAdoptedByProtocol:(Protocol *)proto{
+  unsigned int protocolCount;
+  Protocol * __unsafe_unretained *protocols = protocol_copyProtocolList(proto, &protocolCount);
+  NSMutableArray *indexProtocols = [NSMutableArray new];
+  for (unsigned int i = 0; i < protocolCount; i++){
+    if (protocol_conformsToProtocol(protocols[i], @protocol(SQLStatementIndex))){
+      [indexProtocols addObject:protocols[i]];
+    }
+  }
+  free(protocols);
+  return indexProtocols;
+}
++ (SQLStatement *) constructIndexStatementFromIndexProtocol:(Protocol *)indexProto usingTableName:(NSString *)tableName{
+  NSMutableArray *columnNames = [NSMutableArray new];
+  for (SQLPropertyObject *prop in [self propertyObjectsFromProtocol:indexProto]){
+    [columnNames addObject:prop.propertyName];
+  }
+  SQLStatement *index = [SQLStatement createIndexOnColumns:columnNames forTable:tableName];
+  index.indexName = $(@"%@_%@", tableName, NSStringFromProtocol(indexProto));
+  index.uniqueIndex = protocol_conformsToProtocol(indexProto, @protocol(SQLStatementUniqueIndex));
+  return index;
+}
 + (NSString *) tableNameFromProtocol:(Protocol *)proto{
   if (!proto) return nil;
   return NSStringFromProtocol(proto);
@@ -95,35 +133,49 @@
     tableName = [self tableNameFromProtocol:proto];
   }
   
+  BOOL indexStatement = (statementType == SQLStatementCreateIndex || statementType == SQLStatementDropIndex);
   //Construct the properties
+  NSArray *indexProtocols = indexStatement ? @[] : [self indexProtocolsAdoptedByProtocol:proto];
   NSArray *protocolProperties = ({
-    unsigned int propertyCount;
-    objc_property_t *properties = protocol_copyPropertyList(proto, &propertyCount);
-    NSMutableArray *propertyObjects = [NSMutableArray new];
-    for (unsigned int i = 0; i < propertyCount; i++){
-      SQLPropertyObject *propertyObject = [self propertyObjectFromProperty:properties[i]];
-      if (propertyObject){
-        [propertyObjects addObject:propertyObject];
+    NSMutableArray *propertyObjects = [NSMutableArray arrayWithArray:[self propertyObjectsFromProtocol:proto]];
+    //The columns of adopted indexes are also columns of the table
+    NSMutableSet *propertyNames = [NSMutableSet setWithArray:[propertyObjects valueForKey:@"propertyName"]];
+    for (Protocol *indexProto in indexProtocols){
+      for (SQLPropertyObject *prop in [self propertyObjectsFromProtocol:indexProto]){
+        if ([propertyNames containsObject:prop.propertyName]) continue;
+        [propertyNames addObject:prop.propertyName];
+        [propertyObjects addObject:prop];
       }
     }
-    
-    free(properties);
     propertyObjects;
   });
   
   return ({
-    BOOL appendValues = (valueObject != nil && (statementType == SQLStatementInsert || statementType == SQLStatementUpdate));
+    BOOL appendValues = (valueObject != nil && (statementType == SQLStatementInsert || statementType == SQLStatementUpdate || statementType == SQLStatementUpsert));
     SQLStatement *statement = [SQLStatement statementType:statementType forTable:tableName];
-    if (protocol_conformsToProtocol(proto, @protocol(SQLStatementObject))){
+    if (!indexStatement && protocol_conformsToProtocol(proto, @protocol(SQLStatementObject))){
       [statement addDefaultColumns];
     }
     for (SQLPropertyObject *prop in protocolProperties){
         [statement addColumn:prop.propertyName ofColumnType:prop.propertyColumn].value = (appendValues) ? [valueObject valueForKey:prop.propertyName] : nil;
     }
+    for (Protocol *indexProto in indexProtocols){
+      [statement addIndexStatement:[self constructIndexStatementFromIndexProtocol:indexProto usingTableName:tableName]];
+    }
     statement;
   });
   
 }
+#pragma mark - Index Constructors
++ (NSArray *) constructIndexStatementsFromProtocol:(Protocol *)proto usingTableName:(NSString *)tableName{
+  if (!proto) return nil;
+  if (!tableName) tableName = [self tableNameFromProtocol:proto];
+  NSMutableArray *indexes = [NSMutableArray new];
+  for (Protocol *indexProto in [self indexProtocolsAdoptedByProtocol:proto]){
+    [indexes addObject:[self constructIndexStatementFromIndexProtocol:indexProto usingTableName:tableName]];
+  }
+  return indexes;
+}
 #pragma mark - Convenience Constructors
 + (SQLStatement *) constructStatement:(SQLStatementType)statementType fromProtocol:(Protocol *)proto{
   return [SQLStatementConstructor constructStatement:statementType fromProtocol:proto usingTableName:[SQLStatementConstructor tableNameFromProtocol:proto]];
@@ -165,6 +217,30 @@
   }
   return statement;
 }
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto{
+  return [self constructUpsertStatementFromObject:object usingProtocol:proto onKey:GUIDKey tableName:nil];
+}
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto tableName:(NSString *)tableName{
+  return [self constructUpsertStatementFromObject:object usingProtocol:proto onKey:GUIDKey tableName:tableName];
+}
++ (SQLStatement *) constructUpsertStatementFromObject:(id)object usingProtocol:(Protocol *)proto onKey:(NSString *)key tableName:(NSString *)tableName{
+  if (!object) return nil;
+  SQLStatement *statement = [self constructStatement:SQLStatementUpsert fromProtocol:proto usingTableName:tableName usingValuesFromObject:object];
+  if (key && ![key isEqualToString:GUIDKey]){
+    statement.upsertKeyColumnNames = @[key];
+  }
+  //The GUID is only inserted, so a new object gets one the same way an insert does
+  NSString *GUID = nil;
+  if ([object respondsToSelector:@selector(GUID)]){
+    if ((GUID = [object GUID])){
+      statement.GUID = GUID;
+    } else {
+      GUID = statement.GUID;
+      [object setGUID:GUID];
+    }
+  }
+  return statement;
+}
 + (SQLStatement *) constructDeleteStatementFromObject:(id)object usingProtocol:(Protocol *)proto{
   return [self constructDeleteStatementFromObject:object onKey:GUIDKey usingProtocol:proto tableName:nil];
 }
@@ -43,7 +43,19 @@ typedef NS_ENUM(NSUInteger, SQLStatementType){
     /**
      *  This will add one or more columns to the table.
      */
-    SQLStatementAddColumn
+    SQLStatementAddColumn,
+    /**
+     *  This will create an index on the table's columns (see SQLStatement's `indexName`).
+     */
+    SQLStatementCreateIndex,
+    /**
+     *  This will drop an index (see SQLStatement's `indexName`).
+     */
+    SQLStatementDropIndex,
+    /**
+     *  This will insert a new row or, if one with the same key already exists, update only the supplied columns of the existing row (`INSERT ... ON CONFLICT DO UPDATE`). See SQLStatement's `upsertKeyColumnNames`.
+     */
+    SQLStatementUpsert
 };
 
 /**
@@ -78,4 +90,18 @@ typedef NS_ENUM(NSUInteger, SQLStatementType){
 @property (nonatomic) NSString *GUID;
 @property (nonatomic) NSNumber *SQLCreatedDateTime;
 @property (nonatomic) NSNumber *SQLModifiedDateTime;
-@end
\ No newline at end of file
+@end
+
+/**
+ *  Adopt this in a protocol to declare an index for SQLStatementConstructor: the protocol's properties (in the order they're declared) become the index's columns. When a table's protocol adopts an index protocol, statements constructed from the table's protocol include the index protocol's properties as columns and the index in `indexStatements`. The index is named after the index protocol.
+ *
+ *  Ex: `@protocol PersonByName <SQLStatementIndex>` with `lastName` & `firstName` properties, adopted by `@protocol Person <SQLStatementObject, PersonByName>`.
+ */
+@protocol SQLStatementIndex <NSObject>
+@end
+
+/**
+ *  Adopt this instead of SQLStatementIndex to declare a unique index.
+ */
+@protocol SQLStatementUniqueIndex <SQLStatementIndex>
+@end
@@ -0,0 +1,53 @@
+//
+//  SQLChangeSetTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLChangeSetTests : SQLTestCase
+
+@end
+
+@implementation SQLChangeSetTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE ChangeTest (name TEXT);"];
+  _database.tracksChanges = YES;
+}
+
+- (void) testCommittedChangesAreRecordedByRow{
+  [_database beginImmediateTransaction];
+  [_database executeUpdate:@"INSERT INTO ChangeTest (name) VALUES ('first');"];
+  [_database executeUpdate:@"INSERT INTO ChangeTest (name) VALUES ('second');"];
+  [_database executeUpdate:@"UPDATE ChangeTest SET name = 'changed' WHERE rowid = 1;"];
+  XCTAssertNil([_database takeCommittedChanges], @"Changes shouldn't be available until they're committed.");
+  [_database commit];
+
+  SQLChangeSet *changes = [_database takeCommittedChanges];
+  XCTAssertEqualObjects(changes.tableNames, [NSSet setWithObject:@"ChangeTest"], @"Only the changed table should be included.");
+  XCTAssertEqualObjects([changes insertedRowIDsForTable:@"ChangeTest"], ([NSSet setWithObjects:@1, @2, nil]), @"Both inserts should be recorded.");
+  XCTAssertEqualObjects([changes updatedRowIDsForTable:@"ChangeTest"], [NSSet setWithObject:@1], @"The update should be recorded.");
+  XCTAssertNil([changes updatedColumnsForTable:@"ChangeTest"], @"The columns updated by raw sql aren't known.");
+  XCTAssertNil([_database takeCommittedChanges], @"Taking the changes should clear them.");
+
+  [_database executeUpdate:@"DELETE FROM ChangeTest WHERE rowid = 2;"];
+  XCTAssertEqualObjects([[_database takeCommittedChanges] deletedRowIDsForTable:@"ChangeTest"], [NSSet setWithObject:@2], @"A statement outside a transaction should commit on it's own.");
+}
+
+- (void) testRolledBackChangesAreDiscarded{
+  [_database beginImmediateTransaction];
+  [_database executeUpdate:@"INSERT INTO ChangeTest (name) VALUES ('first');"];
+  [_database rollback];
+  XCTAssertNil([_database takeCommittedChanges], @"Rolled back changes shouldn't be reported.");
+
+  _database.tracksChanges = NO;
+  [_database executeUpdate:@"INSERT INTO ChangeTest (name) VALUES ('first');"];
+  XCTAssertNil([_database takeCommittedChanges], @"Changes shouldn't be recorded when tracking is off.");
+}
+
+@end
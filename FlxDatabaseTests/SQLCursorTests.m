@@ -0,0 +1,83 @@
+//
+//  SQLCursorTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLCursorTests : SQLTestCase
+
+@end
+
+@implementation SQLCursorTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+  NSMutableArray *rows = [NSMutableArray new];
+  for (NSInteger i = 0; i < 25; i++){
+    [rows addObject:@[@(i)]];
+  }
+  [self insertRows:rows intoTable:@"Test"];
+}
+
+- (void) testBatches{
+  SQLCursor *cursor = [_database cursorForQuery:@"SELECT id FROM Test ORDER BY id;" withParameters:nil rowClass:nil];
+  XCTAssertEqualObjects(cursor.columnNames, @[@"id"], @"Column names should be available before stepping.");
+
+  NSUInteger total = 0;
+  NSArray *batch = nil;
+  while ((batch = [cursor nextBatch:10]).count){
+    XCTAssertEqualObjects(batch.firstObject[@"id"], @(total), @"Batches should continue where the last one left off.");
+    total += batch.count;
+  }
+  XCTAssertEqual(total, (NSUInteger)25, @"All rows should be read.");
+  XCTAssertTrue(cursor.finished, @"The cursor should finish after the last row.");
+  XCTAssertNil([cursor nextRow], @"A finished cursor shouldn't return rows.");
+}
+
+- (void) testFastEnumerationAndClose{
+  SQLCursor *cursor = [_database cursorForQuery:@"SELECT id FROM Test WHERE id >= ? ORDER BY id;" withParameters:@[@20] rowClass:nil];
+  NSUInteger count = 0;
+  for (NSDictionary *row in cursor){
+    XCTAssertEqualObjects(row[@"id"], @(20 + count), @"Rows should be enumerated in order.");
+    count++;
+  }
+  XCTAssertEqual(count, (NSUInteger)5, @"All rows should be enumerated.");
+
+  cursor = [_database cursorForQuery:@"SELECT id FROM Test;" withParameters:nil rowClass:nil];
+  XCTAssertNotNil([cursor nextRow], @"The cursor should return a row.");
+  [cursor close];
+  XCTAssertTrue(cursor.finished, @"Closing should finish the cursor.");
+  XCTAssertEqual(cursor.rowsRead, (NSUInteger)1, @"Only one row should have been read.");
+
+  //The statement should have been released, so the same sql can be run again
+  XCTAssertEqual([_database executeQuery:@"SELECT id FROM Test;"].count, (NSUInteger)25, @"The statement should be reusable after closing.");
+}
+
+- (void) testClosingTheDatabaseClosesCursors{
+  SQLCursor *cursor = [_database cursorForQuery:@"SELECT id FROM Test ORDER BY id;" withParameters:nil rowClass:nil];
+  XCTAssertNotNil([cursor nextRow], @"The cursor should return a row.");
+  [_database close];
+  XCTAssertTrue(cursor.finished, @"Closing the database should close the cursor.");
+  XCTAssertNil([cursor nextRow], @"A closed cursor shouldn't return rows.");
+  XCTAssertEqual([_database executeQuery:@"SELECT 1 AS one;"].count, (NSUInteger)0, @"The database should be closed, not left open by the cursor's statement.");
+  [_database open];
+  XCTAssertEqual([_database executeQuery:@"SELECT 1 AS one;"].count, (NSUInteger)1, @"The database should reopen.");
+}
+
+- (void) testMismatchedParametersReleaseTheStatement{
+  NSString *sql = @"SELECT id FROM Test WHERE id >= ?;";
+  SQLCursor *cursor = [_database cursorForQuery:sql withParameters:@[@20] rowClass:nil];
+  [cursor close];
+  XCTAssertThrows([_database cursorForQuery:sql withParameters:@[@20, @21] rowClass:nil], @"Mismatched parameters should raise.");
+  NSUInteger hits = _database.statementCacheHits;
+  cursor = [_database cursorForQuery:sql withParameters:@[@20] rowClass:nil];
+  XCTAssertEqual(_database.statementCacheHits, hits + 1, @"The cached statement shouldn't be left in use.");
+  XCTAssertEqual([cursor nextBatch:10].count, (NSUInteger)5, @"The statement should be bound with the new parameters.");
+}
+
+@end
@@ -0,0 +1,723 @@
+//
+//  SQLDatabaseManagerTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <libkern/OSAtomic.h>
+#import "SQLDatabaseManager.h"
+#import "SQLStatement.h"
+
+#define ManagerTestTimeout 10
+
+static char ManagerTestQueueKey;
+
+//Raw sql. The block is run (on the database or reader's queue) each time the sql is generated, which shows when & where statements are run.
+@interface ManagerTestSQL : NSObject <SQLStatementProtocol>
+@property (readonly) NSString *sql;
+@property (copy) void (^onRun)(void);
++ (instancetype) sql:(NSString *)sql type:(SQLStatementType)type parameters:(NSArray *)parameters;
+@end
+
+@implementation ManagerTestSQL
+@synthesize GUID, SQLType, parameters = _parameters;
++ (instancetype) sql:(NSString *)sql type:(SQLStatementType)type parameters:(NSArray *)parameters{
+  ManagerTestSQL *statement = [self new];
+  statement->_sql = [sql copy];
+  statement->_parameters = [parameters copy];
+  statement.SQLType = type;
+  return statement;
+}
+- (NSString *) newStatement{
+  if (self.onRun) self.onRun();
+  return _sql;
+}
+@end
+
+@interface SQLDatabaseManagerTests : XCTestCase
+
+@end
+
+@implementation SQLDatabaseManagerTests{
+  NSString *_path;
+  SQLDatabaseManager *_manager;
+  dispatch_queue_t _callbackQueue;
+}
+
+- (void) setUp{
+  [super setUp];
+  _path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID].UUIDString stringByAppendingPathExtension:@"sqlite"]];
+  _manager = [[SQLDatabaseManager alloc] initWithFilePath:_path];
+  _callbackQueue = dispatch_queue_create("SQLDatabaseManagerTests", DISPATCH_QUEUE_SERIAL);
+  _manager.callbackQueue = _callbackQueue;
+  [_manager runSynchronousUpdate:[self update:@"CREATE TABLE Item (id INTEGER PRIMARY KEY, name TEXT);"]];
+}
+
+- (void) tearDown{
+  [_manager closeDatabase];
+  _manager = nil;
+  for (NSString *suffix in @[@"", @"-wal", @"-shm"]){
+    [[NSFileManager defaultManager] removeItemAtPath:[_path stringByAppendingString:suffix] error:nil];
+  }
+  [super tearDown];
+}
+
+- (ManagerTestSQL *) update:(NSString *)sql{
+  return [ManagerTestSQL sql:sql type:SQLStatementInsert parameters:nil];
+}
+
+- (ManagerTestSQL *) query:(NSString *)sql{
+  return [ManagerTestSQL sql:sql type:SQLStatementQuery parameters:nil];
+}
+
+- (ManagerTestSQL *) insertItemNamed:(NSString *)name{
+  return [ManagerTestSQL sql:@"INSERT INTO Item (name) VALUES (?);" type:SQLStatementInsert parameters:@[name]];
+}
+
+- (void) insertItems:(NSUInteger)count{
+  [_manager runSynchronousUpdate:[self update:[NSString stringWithFormat:@"INSERT INTO Item (name) SELECT 'item' || n FROM (WITH RECURSIVE counter(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM counter LIMIT %lu) SELECT n FROM counter);", (unsigned long)count]]];
+}
+
+- (NSNumber *) itemCount{
+  return [_manager runSynchronousQuery:[self query:@"SELECT count(*) AS total FROM Item;"]].firstObject[@"total"];
+}
+
+- (dispatch_queue_t) newQueueNamed:(const char *)name{
+  //The queue can be recognized with isOnQueueNamed:
+  dispatch_queue_t queue = dispatch_queue_create(name, DISPATCH_QUEUE_SERIAL);
+  dispatch_queue_set_specific(queue, &ManagerTestQueueKey, (void *)name, NULL);
+  return queue;
+}
+
+- (BOOL) isOnQueueNamed:(const char *)name{
+  const char *current = dispatch_get_specific(&ManagerTestQueueKey);
+  return current && strcmp(current, name) == 0;
+}
+
+- (BOOL) waitForSemaphore:(dispatch_semaphore_t)semaphore{
+  //Blocks the main thread (and it's run loop) while waiting
+  return dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(ManagerTestTimeout * NSEC_PER_SEC))) == 0;
+}
+
+- (NSArray *) itemNames{
+  return [[_manager runSynchronousQuery:[self query:@"SELECT name FROM Item ORDER BY id;"]] valueForKey:@"name"];
+}
+
+#pragma mark - Write Batching
+
+- (void) testQueuedUpdatesAreMergedIntoOneBatch{
+  _manager.writeLatency = 0.05;
+  [_manager resetWriteMetrics];
+  XCTestExpectation *written = [self expectationWithDescription:@"last update"];
+  [_manager queueUpdate:[self insertItemNamed:@"apple"] withBlock:nil];
+  [_manager queueUpdate:[self insertItemNamed:@"banana"] withBlock:nil];
+  [_manager queueUpdate:[self insertItemNamed:@"cherry"] withBlock:^(NSInteger result) {
+    [written fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  SQLWriteMetrics *metrics = _manager.writeMetrics;
+  XCTAssertEqual(metrics.batchCount, (NSUInteger)1, @"Updates queued within the latency should be committed together.");
+  XCTAssertEqual(metrics.requestCount, (NSUInteger)1, @"Single updates should be merged into one request.");
+  XCTAssertEqual(metrics.statementCount, (NSUInteger)3, @"Every update should be run.");
+  XCTAssertEqualObjects([self itemNames], (@[@"apple", @"banana", @"cherry"]), @"The updates should be run in order.");
+}
+
+- (void) testRollbackOnFailOnlyRollsBackItsQueue{
+  _manager.writeLatency = 0.05;
+  [_manager resetWriteMetrics];
+  XCTestExpectation *kept = [self expectationWithDescription:@"kept update"];
+  __block NSInteger keptResult = SQLUpdateResultFailed;
+  [_manager queueUpdate:[self insertItemNamed:@"kept"] withBlock:^(NSInteger result) {
+    keptResult = result;
+    [kept fulfill];
+  }];
+  SQLUpdateQueue *failing = [SQLUpdateQueue new];
+  failing.rollbackOnFail = YES;
+  __block BOOL rolledBackBlockCalled = NO;
+  [failing addSQLUpdate:[self insertItemNamed:@"rolled back"] withBlock:^(NSInteger result) {
+    rolledBackBlockCalled = YES;
+  }];
+  [failing addSQLUpdate:[self update:@"INSERT INTO Missing VALUES (1);"] withBlock:nil];
+  XCTestExpectation *completed = [self expectationWithDescription:@"completion"];
+  __block BOOL succeeded = YES;
+  //Running the queue immediately flushes the pending update into the same batch
+  XCTAssertNoThrow([_manager runUpdateQueue:failing withCompletionBlock:^(BOOL success) {
+    succeeded = success;
+    [completed fulfill];
+  }], @"A failed update shouldn't raise.");
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertFalse(succeeded, @"The failing queue should report it failed.");
+  XCTAssertFalse(rolledBackBlockCalled, @"Blocks of a rolled back queue shouldn't be called.");
+  XCTAssertGreaterThan(keptResult, (NSInteger)0, @"The other update should report it's row id.");
+  XCTAssertEqual(_manager.writeMetrics.batchCount, (NSUInteger)1, @"Both requests should be in one batch.");
+  XCTAssertEqualObjects([self itemNames], (@[@"kept"]), @"Only the failing queue should be rolled back.");
+}
+
+- (void) testFailedUpdateDoesntStopTheBatch{
+  _manager.writeLatency = 0.05;
+  XCTestExpectation *failed = [self expectationWithDescription:@"failed update"];
+  XCTestExpectation *written = [self expectationWithDescription:@"next update"];
+  __block NSInteger failedResult = 0;
+  [_manager queueUpdate:[self update:@"INSERT INTO Missing VALUES (1);"] withBlock:^(NSInteger result) {
+    failedResult = result;
+    [failed fulfill];
+  }];
+  [_manager queueUpdate:[self insertItemNamed:@"apple"] withBlock:^(NSInteger result) {
+    [written fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqual(failedResult, (NSInteger)SQLUpdateResultFailed, @"The update should fail.");
+  XCTAssertEqual([_manager runSynchronousUpdate:[self insertItemNamed:@"banana"]], (NSUInteger)2, @"The transaction should be committed, so later updates still run.");
+  XCTAssertEqualObjects([self itemNames], (@[@"apple", @"banana"]), @"The other updates should be committed.");
+}
+
+- (void) testUpdateThatRollsBackTheTransactionIsSkipped{
+  [_manager runSynchronousUpdate:[self update:@"CREATE TABLE Tag (name TEXT UNIQUE ON CONFLICT ROLLBACK);"]];
+  [_manager runSynchronousUpdate:[self update:@"INSERT INTO Tag VALUES ('taken');"]];
+  _manager.writeLatency = 0.05;
+  XCTestExpectation *failed = [self expectationWithDescription:@"failed update"];
+  XCTestExpectation *written = [self expectationWithDescription:@"other update"];
+  __block NSInteger failedResult = 0;
+  [_manager queueUpdate:[self insertItemNamed:@"apple"] withBlock:^(NSInteger result) {
+    [written fulfill];
+  }];
+  [_manager queueUpdate:[self update:@"INSERT INTO Tag VALUES ('taken');"] withBlock:^(NSInteger result) {
+    failedResult = result;
+    [failed fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqual(failedResult, (NSInteger)SQLUpdateResultFailed, @"The conflicting update should fail.");
+  XCTAssertEqualObjects([self itemNames], (@[@"apple"]), @"The batch should be started over without the failed update.");
+}
+
+#pragma mark - Reader Pool
+
+- (void) testConcurrentReadsSwitchToWAL{
+  XCTAssertFalse(_manager.concurrentReadsEnabled, @"Concurrent reads should be off by default.");
+  XCTAssertEqual(_manager.readerCount, (NSUInteger)0, @"There shouldn't be any readers by default.");
+  XCTAssertEqualObjects([_manager runSynchronousQuery:[self query:@"PRAGMA journal_mode;"]].firstObject[@"journal_mode"], @"delete", @"The database should start in rollback journal mode.");
+
+  XCTAssertFalse([_manager enableConcurrentReadsWithReaderCount:0], @"A pool needs at least one reader.");
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:3], @"WAL should be enabled for a file.");
+  XCTAssertTrue(_manager.concurrentReadsEnabled, @"Concurrent reads should be enabled.");
+  XCTAssertEqual(_manager.readerCount, (NSUInteger)3, @"The pool should have the readers requested.");
+  XCTAssertEqualObjects([_manager runSynchronousQuery:[self query:@"PRAGMA journal_mode;"]].firstObject[@"journal_mode"], @"wal", @"The database should be switched to WAL.");
+  XCTAssertFalse([_manager enableConcurrentReadsWithReaderCount:2], @"The pool can only be created once.");
+}
+
+- (void) testConcurrentReadsNeedAFile{
+  SQLDatabaseManager *memory = [[SQLDatabaseManager alloc] initWithFilePath:@":memory:"];
+  XCTAssertFalse([memory enableConcurrentReadsWithReaderCount:2], @"An in-memory database can't use WAL.");
+  XCTAssertFalse(memory.concurrentReadsEnabled, @"Queries should still be run on the database.");
+  [memory closeDatabase];
+}
+
+- (void) testReadsDontWaitForWrites{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:2], @"WAL should be enabled for a file.");
+  dispatch_semaphore_t writing = dispatch_semaphore_create(0);
+  dispatch_semaphore_t finishWrite = dispatch_semaphore_create(0);
+  ManagerTestSQL *update = [self insertItemNamed:@"slow"];
+  update.onRun = ^{
+    //Holds the writer in the middle of it's transaction
+    dispatch_semaphore_signal(writing);
+    dispatch_semaphore_wait(finishWrite, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(ManagerTestTimeout * NSEC_PER_SEC)));
+  };
+  XCTestExpectation *written = [self expectationWithDescription:@"update"];
+  [_manager queueUpdate:update withBlock:^(NSInteger result) {
+    [written fulfill];
+  }];
+  XCTAssertTrue([self waitForSemaphore:writing], @"The update should start.");
+  XCTAssertEqualObjects([self itemCount], @0, @"A read shouldn't wait for the write in progress or see it.");
+  dispatch_semaphore_signal(finishWrite);
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqualObjects([self itemCount], @1, @"The write should be read once it's committed.");
+}
+
+- (void) testQueuedReadsRunConcurrentlyUpToThePoolSize{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:2], @"WAL should be enabled for a file.");
+  [self insertItems:10];
+  dispatch_semaphore_t started = dispatch_semaphore_create(0);
+  dispatch_semaphore_t proceed = dispatch_semaphore_create(0);
+  __block int32_t running = 0;
+  __block int32_t maxRunning = 0;
+  NSMutableArray *counts = [NSMutableArray new];
+  XCTestExpectation *finished = [self expectationWithDescription:@"queries"];
+  for (NSUInteger i = 0; i < 4; i++){
+    ManagerTestSQL *query = [self query:@"SELECT count(*) AS total FROM Item;"];
+    query.onRun = ^{
+      int32_t now = OSAtomicIncrement32(&running);
+      @synchronized(counts){
+        maxRunning = MAX(maxRunning, now);
+      }
+      dispatch_semaphore_signal(started);
+      dispatch_semaphore_wait(proceed, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(ManagerTestTimeout * NSEC_PER_SEC)));
+      OSAtomicDecrement32(&running);
+    };
+    [_manager queueQuery:query withBlock:^(NSArray *rows) {
+      @synchronized(counts){
+        [counts addObject:rows.firstObject[@"total"] ?: [NSNull null]];
+        if (counts.count == 4) [finished fulfill];
+      }
+    }];
+  }
+  //Both readers have to be running a query at once for the second to start before the first is released
+  XCTAssertTrue([self waitForSemaphore:started], @"The first query should start.");
+  XCTAssertTrue([self waitForSemaphore:started], @"A second query should run on the other reader.");
+  for (NSUInteger i = 0; i < 4; i++){
+    dispatch_semaphore_signal(proceed);
+  }
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqual(maxRunning, (int32_t)2, @"No more queries than there are readers should run at once.");
+  XCTAssertEqualObjects(counts, (@[@10, @10, @10, @10]), @"Every query should read the committed rows.");
+}
+
+#pragma mark - Parallel Queries
+
+- (void) testParallelQueriesAreLimitedToTheirWidth{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:4], @"WAL should be enabled for a file.");
+  __block int32_t running = 0;
+  __block int32_t maxRunning = 0;
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.execution = SQLQueryExecutionParallel;
+  queue.maxConcurrentQueries = 2;
+  NSMutableArray *results = [NSMutableArray new];
+  for (NSUInteger i = 0; i < 8; i++){
+    ManagerTestSQL *query = [self query:@"SELECT count(*) AS total FROM Item;"];
+    query.onRun = ^{
+      int32_t now = OSAtomicIncrement32(&running);
+      @synchronized(results){
+        maxRunning = MAX(maxRunning, now);
+      }
+      [NSThread sleepForTimeInterval:0.02];
+      OSAtomicDecrement32(&running);
+    };
+    [queue addSQLQuery:query withBlock:^(NSArray *rows) {
+      [results addObject:rows];
+    }];
+  }
+  XCTestExpectation *finished = [self expectationWithDescription:@"completion"];
+  __block NSUInteger resultsAtCompletion = 0;
+  [_manager runQueryQueue:queue withCompletionBlock:^{
+    resultsAtCompletion = results.count;
+    [finished fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqual(resultsAtCompletion, (NSUInteger)8, @"The completion should run after every result is delivered.");
+  XCTAssertEqual(maxRunning, (int32_t)2, @"No more queries than the queue's width should run at once.");
+}
+
+- (void) testSnapshotQueriesReadOneCommit{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:2], @"WAL should be enabled for a file.");
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.execution = SQLQueryExecutionSnapshot;
+  queue.maxConcurrentQueries = 1;
+  dispatch_semaphore_t started = dispatch_semaphore_create(0);
+  NSMutableArray *counts = [NSMutableArray new];
+  for (NSUInteger i = 0; i < 3; i++){
+    ManagerTestSQL *query = [self query:@"SELECT count(*) AS total FROM Item;"];
+    query.onRun = ^{
+      if (i == 0) dispatch_semaphore_signal(started);
+      [NSThread sleepForTimeInterval:0.05];
+    };
+    [queue addSQLQuery:query withBlock:^(NSArray *rows) {
+      [counts addObject:rows.firstObject[@"total"]];
+    }];
+  }
+  XCTestExpectation *finished = [self expectationWithDescription:@"completion"];
+  [_manager runQueryQueue:queue withCompletionBlock:^{
+    [finished fulfill];
+  }];
+  //Committed while the snapshot is being read
+  dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+  [_manager runSynchronousUpdate:[self insertItemNamed:@"apple"]];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqualObjects(counts, (@[@0, @0, @0]), @"Every query of a snapshot should read the same commit.");
+  XCTAssertEqualObjects([self itemCount], @1, @"The update should be committed.");
+}
+
+- (void) testSnapshotsDontDeadlockWithSchemaChanges{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:2], @"WAL should be enabled for a file.");
+  NSUInteger rounds = 20;
+  for (NSUInteger i = 0; i < rounds; i++){
+    SQLQueryQueue *queue = [SQLQueryQueue new];
+    queue.execution = SQLQueryExecutionSnapshot;
+    [queue addSQLQuery:[self query:@"SELECT * FROM Item;"] withBlock:^(NSArray *results) {}];
+    [queue addSQLQuery:[self query:@"SELECT count(*) AS total FROM Item;"] withBlock:^(NSArray *results) {}];
+    XCTestExpectation *snapshot = [self expectationWithDescription:@"snapshot"];
+    [_manager runQueryQueue:queue withCompletionBlock:^{
+      [snapshot fulfill];
+    }];
+    SQLStatement *table = [SQLStatement statementType:SQLStatementCreate forTable:[NSString stringWithFormat:@"Table%lu", (unsigned long)i]];
+    [table addColumn:@"name" ofColumnType:SQLColumnTypeText];
+    XCTestExpectation *sync = [self expectationWithDescription:@"sync"];
+    [_manager syncSchemaToStatements:@[table] onCompletion:^(BOOL success) {
+      [sync fulfill];
+    }];
+  }
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+}
+
+#pragma mark - Streaming
+
+- (void) testStreamDoesntBlockTheDatabaseQueueOnTheConsumer{
+  [self insertItems:100];
+  __block NSUInteger rowCount = 0;
+  __block NSUInteger batchCount = 0;
+  XCTestExpectation *finished = [self expectationWithDescription:@"completion"];
+  [_manager streamQuery:[self query:@"SELECT * FROM Item;"] usingRowClass:nil batchSize:10 withBatchBlock:^BOOL(NSArray *rows) {
+    //Without a reader pool, the stream is read on the database queue. This would deadlock if it waited there on this block.
+    if (batchCount++ == 0) [_manager runSynchronousUpdate:[self insertItemNamed:@"late"]];
+    rowCount += rows.count;
+    return YES;
+  } completion:^(BOOL streamFinished) {
+    XCTAssertTrue(streamFinished, @"The stream wasn't stopped.");
+    [finished fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertGreaterThanOrEqual(rowCount, (NSUInteger)100, @"Every row should be streamed.");
+  XCTAssertEqualObjects([self itemCount], @101, @"The update should be committed during the stream.");
+}
+
+- (void) testStreamStopsWhenTheBlockReturnsNO{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:1], @"WAL should be enabled for a file.");
+  [self insertItems:100];
+  __block NSUInteger batchCount = 0;
+  XCTestExpectation *finished = [self expectationWithDescription:@"completion"];
+  [_manager streamQuery:[self query:@"SELECT * FROM Item;"] usingRowClass:nil batchSize:10 withBatchBlock:^BOOL(NSArray *rows) {
+    return ++batchCount < 2;
+  } completion:^(BOOL streamFinished) {
+    XCTAssertFalse(streamFinished, @"The stream was stopped.");
+    [finished fulfill];
+  }];
+  [self waitForExpectationsWithTimeout:ManagerTestTimeout handler:nil];
+  XCTAssertEqual(batchCount, (NSUInteger)2, @"No batches should be delivered after the block returns NO.");
+  XCTAssertEqualObjects([self itemCount], @100, @"The reader should be returned once the stream stops.");
+}
+
+#pragma mark - Callbacks
+
+- (void) testBatchesDontNeedTheMainRunLoop{
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  __block NSInteger updateResult = 0;
+  __block NSArray *queryResults = nil;
+  [_manager queueUpdate:[self insertItemNamed:@"apple"] withBlock:^(NSInteger result) {
+    updateResult = result;
+  }];
+  [_manager queueQuery:[self query:@"SELECT name FROM Item;"] withBlock:^(NSArray *results) {
+    queryResults = results;
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"Queued work should be triggered while the main thread is blocked.");
+  XCTAssertEqual(updateResult, (NSInteger)1, @"The update should be run first.");
+  XCTAssertEqualObjects([queryResults valueForKey:@"name"], @[@"apple"], @"The query should see the update.");
+}
+
+- (void) testQueuedQueriesAreDeliveredInOrder{
+  [self insertItems:3];
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  NSMutableArray *order = [NSMutableArray new];
+  for (NSUInteger i = 1; i <= 3; i++){
+    [_manager queueQuery:[self query:[NSString stringWithFormat:@"SELECT id FROM Item WHERE id = %lu;", (unsigned long)i]] withBlock:^(NSArray *results) {
+      [order addObject:[results.firstObject objectForKey:@"id"]];
+      if (order.count == 3) dispatch_semaphore_signal(done);
+    }];
+  }
+  XCTAssertTrue([self waitForSemaphore:done], @"Every queued query should be run.");
+  XCTAssertEqualObjects(order, (@[@1, @2, @3]), @"Queued queries should be delivered in order.");
+}
+
+- (void) testResultsDeliveredTogetherWithTheCompletion{
+  [self insertItems:3];
+  dispatch_queue_t queueCallbacks = [self newQueueNamed:"QueueCallbacks"];
+  SQLQueryQueue *queue = [SQLQueryQueue new];
+  queue.callbackQueue = queueCallbacks;
+  queue.deliversResultsTogether = YES;
+  NSMutableArray *delivered = [NSMutableArray new];
+  __block BOOL lastQueryRun = NO;
+  __block BOOL deliveredAfterLastQuery = YES;
+  __block BOOL onQueue = YES;
+  for (NSUInteger i = 1; i <= 3; i++){
+    ManagerTestSQL *query = [self query:[NSString stringWithFormat:@"SELECT id FROM Item WHERE id = %lu;", (unsigned long)i]];
+    if (i == 3) query.onRun = ^{
+      [NSThread sleepForTimeInterval:0.05];
+      lastQueryRun = YES;
+    };
+    [queue addSQLQuery:query withBlock:^(NSArray *results) {
+      onQueue = onQueue && [self isOnQueueNamed:"QueueCallbacks"];
+      deliveredAfterLastQuery = deliveredAfterLastQuery && lastQueryRun;
+      [delivered addObject:[results.firstObject objectForKey:@"id"]];
+    }];
+  }
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  __block NSArray *deliveredAtCompletion = nil;
+  [_manager runQueryQueue:queue withCompletionBlock:^{
+    deliveredAtCompletion = [delivered copy];
+    onQueue = onQueue && [self isOnQueueNamed:"QueueCallbacks"];
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The completion should be called.");
+  XCTAssertEqualObjects(deliveredAtCompletion, (@[@1, @2, @3]), @"Every result should be delivered, in order, before the completion.");
+  XCTAssertTrue(deliveredAfterLastQuery, @"No result should be delivered until every query has run.");
+  XCTAssertTrue(onQueue, @"Results & the completion should be delivered on the queue's callback queue.");
+}
+
+- (void) testUpdateQueueCompletionRunsAfterItsBlocks{
+  dispatch_queue_t queueCallbacks = [self newQueueNamed:"QueueCallbacks"];
+  SQLUpdateQueue *queue = [SQLUpdateQueue new];
+  queue.callbackQueue = queueCallbacks;
+  __block BOOL blocksFinished = NO;
+  [queue addSQLUpdate:[self insertItemNamed:@"apple"] withBlock:^(NSInteger result) {
+    [NSThread sleepForTimeInterval:0.05];
+    blocksFinished = YES;
+  }];
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  __block BOOL finishedFirst = NO;
+  __block BOOL onQueue = NO;
+  [_manager runUpdateQueue:queue withCompletionBlock:^(BOOL success) {
+    finishedFirst = blocksFinished;
+    onQueue = [self isOnQueueNamed:"QueueCallbacks"];
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The completion should be called.");
+  XCTAssertTrue(finishedFirst, @"The completion should run after the update blocks.");
+  XCTAssertTrue(onQueue, @"The completion should run on the queue's callback queue, not the database queue.");
+}
+
+- (void) testChunkedUpdateQueueCompletionRunsAfterTheLastChunk{
+  _manager.backgroundChunkSize = 2;
+  [_manager resetWriteMetrics];
+  SQLUpdateQueue *queue = [SQLUpdateQueue new];
+  queue.priority = SQLPriorityBackground;
+  __block NSUInteger blocksRun = 0;
+  for (NSString *name in @[@"apple", @"banana", @"cherry", @"date", @"elderberry"]){
+    [queue addSQLUpdate:[self insertItemNamed:name] withBlock:^(NSInteger result) {
+      blocksRun++;
+    }];
+  }
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  __block NSUInteger blocksRunAtCompletion = 0;
+  __block NSUInteger completionCount = 0;
+  [_manager runUpdateQueue:queue withCompletionBlock:^(BOOL success) {
+    blocksRunAtCompletion = blocksRun;
+    completionCount++;
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The completion should be called.");
+  XCTAssertEqual(_manager.writeMetrics.batchCount, (NSUInteger)3, @"The queue should be committed in chunks.");
+  XCTAssertEqual(blocksRunAtCompletion, (NSUInteger)5, @"The completion should run after every chunk's blocks.");
+  XCTAssertEqualObjects([self itemNames], (@[@"apple", @"banana", @"cherry", @"date", @"elderberry"]), @"Every chunk should be committed, in order.");
+  XCTAssertEqual(completionCount, (NSUInteger)1, @"The completion should only be called once.");
+}
+
+- (void) testSubmissionQueuesAreHonored{
+  dispatch_queue_t submissionQueue = [self newQueueNamed:"Submission"];
+  dispatch_semaphore_t done = dispatch_semaphore_create(0);
+  __block BOOL syncOnQueue = NO;
+  __block BOOL bulkOnQueue = NO;
+  __block BOOL subscriptionOnQueue = NO;
+  SQLStatement *table = [SQLStatement statementType:SQLStatementCreate forTable:@"Tag"];
+  [table addColumn:@"name" ofColumnType:SQLColumnTypeText];
+  [_manager syncSchemaToStatements:@[table] onQueue:submissionQueue onCompletion:^(BOOL success) {
+    syncOnQueue = [self isOnQueueNamed:"Submission"];
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The sync should finish.");
+  SQLStatement *insert = [SQLStatement statementType:SQLStatementInsert forTable:@"Tag"];
+  [insert addColumn:@"name"];
+  [_manager bulkInsertRows:@[@[@"red"], @[@"blue"]] usingStatement:insert onQueue:submissionQueue withBlock:^(SQLBulkResult *result) {
+    bulkOnQueue = [self isOnQueueNamed:"Submission"];
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The insert should finish.");
+  SQLStatement *tags = [SQLStatement statementType:SQLStatementQuery forTable:@"Tag"];
+  [tags addColumn:@"*"];
+  SQLSubscription *subscription = [_manager subscribeToQuery:tags usingRowClass:nil onQueue:submissionQueue withBlock:^(NSArray *results) {
+    subscriptionOnQueue = [self isOnQueueNamed:"Submission"];
+    dispatch_semaphore_signal(done);
+  }];
+  XCTAssertTrue([self waitForSemaphore:done], @"The subscription should deliver it's initial results.");
+  [subscription cancel];
+  XCTAssertTrue(syncOnQueue, @"The sync's block should run on it's queue.");
+  XCTAssertTrue(bulkOnQueue, @"The insert's block should run on it's queue.");
+  XCTAssertTrue(subscriptionOnQueue, @"The subscription's block should run on it's queue.");
+}
+
+#pragma mark - Statement Cache
+
+- (void) testSchemaChangesClearTheStatementCache{
+  //The database is only handed out to migrations
+  __block SQLDatabase *database = nil;
+  XCTAssertTrue([_manager runMigrations:@{ @1 : ^BOOL(SQLDatabase *migrating) {
+    database = migrating;
+    return YES;
+  }}], @"The migration should run.");
+  [_manager runSynchronousUpdate:[self update:@"CREATE TABLE Other (name TEXT);"]];
+  NSArray *changes = @[[ManagerTestSQL sql:@"ALTER TABLE Item ADD COLUMN note TEXT;" type:SQLStatementAddColumn parameters:nil],
+                       [ManagerTestSQL sql:@"ALTER TABLE Item RENAME TO Thing;" type:SQLStatementAlterTable parameters:nil],
+                       [ManagerTestSQL sql:@"DROP TABLE Other;" type:SQLStatementDropTable parameters:nil]];
+  for (ManagerTestSQL *change in changes){
+    [_manager runSynchronousQuery:[self query:@"SELECT count(*) AS total FROM sqlite_master;"]];
+    NSUInteger misses = database.statementCacheMisses;
+    [_manager runSynchronousQuery:[self query:@"SELECT count(*) AS total FROM sqlite_master;"]];
+    XCTAssertEqual(database.statementCacheMisses, misses, @"The query should be cached before the change.");
+    [_manager runSynchronousUpdate:change];
+    [_manager runSynchronousQuery:[self query:@"SELECT count(*) AS total FROM sqlite_master;"]];
+    XCTAssertEqual(database.statementCacheMisses, misses + 1, @"The query should be prepared again after: %@", change.sql);
+  }
+}
+
+#pragma mark - Bulk Inserts
+
+- (SQLDatabase *) migrationDatabase{
+  //The database is only handed out to migrations
+  __block SQLDatabase *database = nil;
+  [_manager runMigrations:@{ @1 : ^BOOL(SQLDatabase *migrating) {
+    database = migrating;
+    return YES;
+  }}];
+  return database;
+}
+
+- (SQLStatement *) bulkTemplateForTable:(NSString *)tableName columnCount:(NSUInteger)count{
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:tableName];
+  SQLStatement *insert = [SQLStatement statementType:SQLStatementInsert forTable:tableName];
+  for (NSUInteger i = 0; i < count; i++){
+    NSString *columnName = [NSString stringWithFormat:@"c%lu", (unsigned long)i];
+    [create addColumn:columnName ofColumnType:SQLColumnTypeInt];
+    [insert addColumn:columnName];
+  }
+  [_manager runSynchronousUpdate:create];
+  return insert;
+}
+
+- (NSArray *) bulkRows:(NSUInteger)rowCount columnCount:(NSUInteger)columnCount{
+  NSMutableArray *rows = [NSMutableArray arrayWithCapacity:rowCount];
+  for (NSUInteger i = 0; i < rowCount; i++){
+    NSMutableArray *row = [NSMutableArray arrayWithCapacity:columnCount];
+    for (NSUInteger c = 0; c < columnCount; c++){
+      [row addObject:@(i)];
+    }
+    [rows addObject:row];
+  }
+  return rows;
+}
+
+- (NSNumber *) rowCountOfTable:(NSString *)tableName{
+  return [_manager runSynchronousQuery:[self query:[NSString stringWithFormat:@"SELECT count(*) AS total FROM \"%@\";", tableName]]].firstObject[@"total"];
+}
+
+- (void) testBulkInsertsAreChunked{
+  NSUInteger parameterLimit = [[self migrationDatabase] maximumParameterCount];
+  XCTAssertGreaterThan(parameterLimit, (NSUInteger)0, @"The parameter limit should be read from sqlite.");
+
+  //4 parameters a row (GUID, c0 & the dates), so chunks are capped at 500 rows unless sqlite's limit is lower
+  SQLStatement *narrow = [self bulkTemplateForTable:@"Narrow" columnCount:1];
+  NSUInteger rowsPerStatement = MIN((NSUInteger)500, parameterLimit / 4);
+  SQLBulkResult *result = [_manager runSynchronousBulkInsertRows:[self bulkRows:1201 columnCount:1] usingStatement:narrow];
+  XCTAssertTrue(result.success, @"The insert should succeed.");
+  XCTAssertEqual(result.rowCount, (NSUInteger)1201, @"Every row should be counted.");
+  XCTAssertEqual(result.insertedCount, (NSUInteger)1201, @"Every row should be inserted.");
+  XCTAssertEqual(result.failedIndexes.count, (NSUInteger)0, @"No rows should fail.");
+  XCTAssertEqual(result.statementCount, (1201 + rowsPerStatement - 1) / rowsPerStatement, @"Rows should be inserted in chunks of %lu.", (unsigned long)rowsPerStatement);
+  XCTAssertEqualObjects([self rowCountOfTable:@"Narrow"], @1201, @"The rows should be in the table.");
+
+  //73 parameters a row, which is more than the default limit (32766) allows for 500 rows
+  SQLStatement *wide = [self bulkTemplateForTable:@"Wide" columnCount:70];
+  rowsPerStatement = parameterLimit / 73;
+  XCTAssertLessThan(rowsPerStatement, (NSUInteger)500, @"The parameter limit should be what caps the chunks.");
+  result = [_manager runSynchronousBulkInsertRows:[self bulkRows:1000 columnCount:70] usingStatement:wide];
+  XCTAssertTrue(result.success, @"The insert should succeed.");
+  XCTAssertEqual(result.insertedCount, (NSUInteger)1000, @"Every row should be inserted.");
+  XCTAssertEqual(result.statementCount, (1000 + rowsPerStatement - 1) / rowsPerStatement, @"Chunks should fit within %lu parameters.", (unsigned long)parameterLimit);
+  XCTAssertEqualObjects([self rowCountOfTable:@"Wide"], @1000, @"The rows should be in the table.");
+}
+
+- (void) testBulkInsertResultsReportConflicts{
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:@"Tag"];
+  [create addColumn:@"name" ofColumnType:SQLColumnTypeText].unique = YES;
+  [_manager runSynchronousUpdate:create];
+  SQLStatement *insert = [SQLStatement statementType:SQLStatementInsert forTable:@"Tag"];
+  [insert addColumn:@"name"];
+  [_manager runSynchronousBulkInsertRows:@[@[@"red"]] usingStatement:insert];
+
+  insert.conflict = SQLConflictIgnore;
+  SQLBulkResult *result = [_manager runSynchronousBulkInsertRows:@[@[@"red"], @[@"blue"], @[@"green"], @[@"blue"]] usingStatement:insert];
+  XCTAssertTrue(result.success, @"Ignored rows aren't failures.");
+  XCTAssertEqual(result.rowCount, (NSUInteger)4, @"Every row should be counted.");
+  XCTAssertEqual(result.insertedCount, (NSUInteger)2, @"Only the new names should be inserted.");
+  XCTAssertEqual(result.statementCount, (NSUInteger)1, @"The rows should fit in one statement.");
+
+  //The chunk fails, so it's retried a row at a time to find the failed rows
+  insert.conflict = SQLConflictAbort;
+  result = [_manager runSynchronousBulkInsertRows:@[@[@"red"], @[@"pink"], @[@"pink"]] usingStatement:insert];
+  XCTAssertFalse(result.success, @"The duplicate rows should fail.");
+  NSMutableIndexSet *duplicates = [NSMutableIndexSet indexSetWithIndex:0];
+  [duplicates addIndex:2];
+  XCTAssertEqualObjects(result.failedIndexes, duplicates, @"Only the duplicate rows should fail.");
+  XCTAssertEqual(result.insertedCount, (NSUInteger)1, @"The other row should be inserted.");
+  XCTAssertEqual(result.statementCount, (NSUInteger)4, @"The chunk and each of it's rows should be run.");
+  XCTAssertFalse(result.rolledBack, @"An abort shouldn't roll back the insert.");
+
+  //Rollback rows are inserted one at a time, and a failure undoes the whole insert
+  insert.conflict = SQLConflictRollback;
+  result = [_manager runSynchronousBulkInsertRows:@[@[@"teal"], @[@"red"], @[@"gray"]] usingStatement:insert];
+  XCTAssertTrue(result.rolledBack, @"The duplicate should roll back the insert.");
+  XCTAssertEqual(result.insertedCount, (NSUInteger)0, @"Nothing should be inserted after a rollback.");
+  XCTAssertEqual(result.failedIndexes.count, (NSUInteger)3, @"Every row should fail after a rollback.");
+  XCTAssertEqual(result.statementCount, (NSUInteger)2, @"Rows after the rollback shouldn't be run.");
+  XCTAssertEqualObjects([self rowCountOfTable:@"Tag"], @4, @"The rolled back rows shouldn't be in the table.");
+}
+
+- (void) testRollbackInsertIsRefusedInsideATransaction{
+  SQLDatabase *database = [self migrationDatabase];
+  SQLStatement *insert = [self bulkTemplateForTable:@"Tag" columnCount:1];
+  insert.conflict = SQLConflictRollback;
+  [_manager runSynchronousBulkInsertRows:@[@[@1]] usingStatement:insert];
+
+  //A transaction the bulk insert doesn't own, which a rollback would end
+  [database beginImmediateTransaction];
+  [database executeUpdate:@"INSERT INTO Tag (GUID, c0) VALUES ('outer', 2);"];
+  SQLBulkResult *result = [_manager runSynchronousBulkInsertRows:@[@[@3], @[@4]] usingStatement:insert];
+  XCTAssertFalse(result.success, @"The insert should be refused.");
+  XCTAssertEqual(result.failedIndexes.count, (NSUInteger)2, @"Every row should be reported as failed.");
+  XCTAssertEqual(result.statementCount, (NSUInteger)0, @"Nothing should be run.");
+  XCTAssertFalse(result.rolledBack, @"Nothing should be rolled back.");
+  XCTAssertTrue([database inTransaction], @"The outer transaction should be left alone.");
+  [database commit];
+  XCTAssertEqualObjects([[_manager runSynchronousQuery:[self query:@"SELECT c0 FROM Tag ORDER BY c0;"]] valueForKey:@"c0"], (@[@1, @2]), @"The outer transaction's row should be kept.");
+}
+
+#pragma mark - GUID Modes
+
+- (void) testStatementsPickUpAMigratedGUIDMode{
+  XCTAssertTrue([_manager enableConcurrentReadsWithReaderCount:2], @"WAL should be enabled for a file.");
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:@"GUIDItem"];
+  [create addColumn:@"name" ofColumnType:SQLColumnTypeText];
+  [_manager runSynchronousUpdate:create];
+  SQLStatement *insert = [SQLStatement statementType:SQLStatementInsert forTable:@"GUIDItem"];
+  [insert addColumn:@"name" ofColumnType:SQLColumnTypeText].value = @"first";
+  [_manager runSynchronousUpdate:insert];
+
+  //Created before the migration, and already run in text mode
+  SQLStatement *query = [SQLStatement statementType:SQLStatementQuery forTable:@"GUIDItem"];
+  [query addColumn:@"name"];
+  [query addPredicate:insert.GUID forColumn:GUIDKey];
+  XCTAssertEqual([_manager runSynchronousQuery:query].count, (NSUInteger)1, @"The row should be found by it's text GUID.");
+  XCTAssertEqual(query.GUIDMode, SQLGUIDModeText, @"The mode should be read from the schema.");
+
+  XCTAssertTrue([_manager migrateTable:@"GUIDItem" toGUIDMode:SQLGUIDModeBinary], @"The table should be migrated.");
+  XCTAssertEqual([SQLGUID modeForTable:@"GUIDItem"], SQLGUIDModeText, @"The migration shouldn't depend on a process wide mode.");
+  XCTAssertEqualObjects([[_manager runSynchronousQuery:query] valueForKey:@"name"], @[@"first"], @"The statement should bind the GUID as a blob after the migration.");
+  XCTAssertEqual(query.GUIDMode, SQLGUIDModeBinary, @"The statement should pick up the migrated mode.");
+
+  SQLStatement *second = [SQLStatement statementType:SQLStatementInsert forTable:@"GUIDItem"];
+  [second addColumn:@"name" ofColumnType:SQLColumnTypeText].value = @"second";
+  [_manager runSynchronousUpdate:second];
+  NSDictionary *storage = [_manager runSynchronousQuery:[self query:@"SELECT typeof(GUID) AS type FROM GUIDItem WHERE name = 'second';"]].firstObject;
+  XCTAssertEqualObjects(storage[@"type"], @"blob", @"New rows should be inserted with binary GUIDs.");
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  SQLDatabaseOptionsTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SQLDatabase.h"
+#import "SQLDatabaseOptions.h"
+
+@interface SQLDatabaseOptionsTests : XCTestCase
+
+@end
+
+@implementation SQLDatabaseOptionsTests{
+  NSString *_path;
+  NSMutableArray *_databases;
+}
+
+- (void) setUp{
+  [super setUp];
+  //Most settings (journal mode, mmap, page size) only apply to files
+  _path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID].UUIDString stringByAppendingPathExtension:@"sqlite"]];
+  _databases = [NSMutableArray new];
+}
+
+- (void) tearDown{
+  for (SQLDatabase *database in _databases){
+    [database close];
+  }
+  _databases = nil;
+  for (NSString *suffix in @[@"", @"-wal", @"-shm"]){
+    [[NSFileManager defaultManager] removeItemAtPath:[_path stringByAppendingString:suffix] error:nil];
+  }
+  [super tearDown];
+}
+
+- (SQLDatabase *) openWithOptions:(SQLDatabaseOptions *)options readOnly:(BOOL)readOnly{
+  SQLDatabase *database = [[SQLDatabase alloc] initWithPath:_path readOnly:readOnly options:options];
+  [_databases addObject:database];
+  return database;
+}
+
+- (void) testPragmaOrder{
+  SQLDatabaseOptions *options = [SQLDatabaseOptions throughputOptions];
+  options.pageSize = @8192;
+  NSArray *expected = @[@"PRAGMA page_size = 8192;", @"PRAGMA journal_mode = WAL;", @"PRAGMA synchronous = NORMAL;", @"PRAGMA cache_size = -16384;", @"PRAGMA mmap_size = 268435456;", @"PRAGMA temp_store = MEMORY;"];
+  XCTAssertEqualObjects([options pragmaStatementsForReadOnlyConnection:NO], expected, @"The page size should be set before the journal mode.");
+  expected = @[@"PRAGMA synchronous = NORMAL;", @"PRAGMA cache_size = -16384;", @"PRAGMA mmap_size = 268435456;", @"PRAGMA temp_store = MEMORY;"];
+  XCTAssertEqualObjects([options pragmaStatementsForReadOnlyConnection:YES], expected, @"Read-only connections shouldn't set the page size or journal mode.");
+  XCTAssertEqualObjects([[SQLDatabaseOptions new] pragmaStatementsForReadOnlyConnection:NO], @[], @"Default values shouldn't be set.");
+}
+
+- (void) testNoOptionsUsesLowMemory{
+  NSDictionary *settings = [[self openWithOptions:nil readOnly:NO] effectiveSettings];
+  XCTAssertEqualObjects(settings[@"cache_size"], @0, @"The page cache should be disabled by default.");
+  XCTAssertEqualObjects(settings[@"mmap_size"], @0, @"Memory mapping should be disabled by default.");
+  XCTAssertEqualObjects(settings[@"temp_store"], @1, @"Temp storage should be on disk by default.");
+
+  SQLDatabase *database = [[SQLDatabase alloc] initWithPath:@":memory:"];
+  XCTAssertEqualObjects([database effectiveSettings][@"cache_size"], @0, @"initWithPath: should use the default options.");
+  [database close];
+}
+
+- (void) testThroughputOptions{
+  NSDictionary *settings = [[self openWithOptions:[SQLDatabaseOptions throughputOptions] readOnly:NO] effectiveSettings];
+  XCTAssertEqualObjects(settings[@"journal_mode"], @"wal", @"WAL should be enabled.");
+  XCTAssertEqualObjects(settings[@"synchronous"], @1, @"Synchronous should be NORMAL.");
+  XCTAssertEqualObjects(settings[@"cache_size"], @(-16384), @"The page cache should be 16MB.");
+  XCTAssertEqualObjects(settings[@"mmap_size"], @(256 * 1024 * 1024), @"256MB should be memory mapped.");
+  XCTAssertEqualObjects(settings[@"temp_store"], @2, @"Temp storage should be in memory.");
+  XCTAssertEqualObjects(settings[@"busy_timeout"], @5000, @"The busy timeout should be 5 seconds.");
+}
+
+- (void) testBulkLoadOptions{
+  NSDictionary *settings = [[self openWithOptions:[SQLDatabaseOptions bulkLoadOptions] readOnly:NO] effectiveSettings];
+  XCTAssertEqualObjects(settings[@"journal_mode"], @"wal", @"WAL should be enabled.");
+  XCTAssertEqualObjects(settings[@"synchronous"], @0, @"Synchronous should be OFF.");
+  XCTAssertEqualObjects(settings[@"cache_size"], @(-65536), @"The page cache should be 64MB.");
+  XCTAssertEqualObjects(settings[@"busy_timeout"], @5000, @"The busy timeout should be 5 seconds.");
+}
+
+- (void) testPageSizeIsSetBeforeWAL{
+  SQLDatabaseOptions *options = [SQLDatabaseOptions throughputOptions];
+  options.pageSize = @8192;
+  SQLDatabase *database = [self openWithOptions:options readOnly:NO];
+  [database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+  NSDictionary *settings = [database effectiveSettings];
+  XCTAssertEqualObjects(settings[@"page_size"], @8192, @"The page size should be applied to a new database.");
+  XCTAssertEqualObjects(settings[@"journal_mode"], @"wal", @"WAL should still be enabled.");
+}
+
+- (void) testReadOnlyConnectionsDontWriteSettings{
+  SQLDatabase *database = [self openWithOptions:[SQLDatabaseOptions throughputOptions] readOnly:NO];
+  [database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+
+  SQLDatabaseOptions *options = [SQLDatabaseOptions lowMemoryOptions];
+  options.journalMode = SQLJournalModeDelete;
+  options.pageSize = @16384;
+  options.busyTimeout = 1;
+  NSDictionary *settings = [[self openWithOptions:options readOnly:YES] effectiveSettings];
+  XCTAssertEqualObjects(settings[@"journal_mode"], @"wal", @"A read-only connection shouldn't change the journal mode.");
+  XCTAssertEqualObjects(settings[@"page_size"], @4096, @"A read-only connection shouldn't change the page size.");
+  XCTAssertEqualObjects(settings[@"cache_size"], @0, @"Other options should still be applied.");
+  XCTAssertEqualObjects(settings[@"busy_timeout"], @1000, @"The busy timeout should still be set.");
+}
+
+@end
@@ -0,0 +1,110 @@
+//
+//  SQLGUIDTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+#define GUIDTestTable @"GUIDTest"
+
+@interface SQLGUIDTests : SQLTestCase
+
+@end
+
+@implementation SQLGUIDTests
+
+- (void) tearDown{
+  [SQLGUID setMode:SQLGUIDModeText forTable:GUIDTestTable];
+  [super tearDown];
+}
+
+- (NSString *) insertRowNamed:(NSString *)name{
+  SQLStatement *insert = [SQLStatement statementType:SQLStatementInsert forTable:GUIDTestTable];
+  [insert addColumn:@"name" ofColumnType:SQLColumnTypeText].value = name;
+  [_database executeUpdate:insert.newStatement withParameters:insert.parameters];
+  return insert.GUID;
+}
+
+- (void) createTable{
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:GUIDTestTable];
+  [create addColumn:@"name" ofColumnType:SQLColumnTypeText];
+  [_database executeUpdate:create.newStatement];
+}
+
+- (void) testTimeOrderedGUIDs{
+  NSString *previous = [SQLGUID newTimeOrderedGUID];
+  for (NSUInteger i = 0; i < 100; i++){
+    NSString *GUID = [SQLGUID newTimeOrderedGUID];
+    XCTAssertEqual([GUID compare:previous], NSOrderedDescending, @"GUIDs should sort in the order they're created.");
+    previous = GUID;
+  }
+  XCTAssertEqual(previous.length, (NSUInteger)36, @"GUIDs should use the standard string form.");
+  XCTAssertEqual([previous characterAtIndex:14], (unichar)'7', @"GUIDs should be version 7.");
+
+  NSData *data = [SQLGUID dataFromGUID:previous];
+  XCTAssertEqual(data.length, (NSUInteger)16, @"GUIDs should convert to 16 bytes.");
+  XCTAssertEqualObjects([SQLGUID GUIDFromData:data], previous, @"GUIDs should convert back to the same string.");
+  XCTAssertNil([SQLGUID dataFromGUID:@"not a guid"], @"Invalid GUIDs shouldn't convert.");
+}
+
+- (void) testBinaryGUIDsAreStoredAsBlobsAndReturnedAsStrings{
+  [SQLGUID setMode:SQLGUIDModeBinary forTable:GUIDTestTable];
+  [self createTable];
+  NSString *GUID = [self insertRowNamed:@"first"];
+  [self insertRowNamed:@"second"];
+
+  NSDictionary *storage = [_database executeQuery:@"SELECT typeof(GUID) AS type, length(GUID) AS length FROM GUIDTest LIMIT 1;"].firstObject;
+  XCTAssertEqualObjects(storage[@"type"], @"blob", @"Binary GUIDs should be stored as blobs.");
+  XCTAssertEqualObjects(storage[@"length"], @16, @"Binary GUIDs should be 16 bytes.");
+
+  SQLStatement *query = [SQLStatement statementType:SQLStatementQuery forTable:GUIDTestTable];
+  [query addColumn:GUIDKey];
+  [query addColumn:@"name"];
+  [query addPredicate:GUID forColumn:GUIDKey];
+  NSArray *rows = [_database executeQuery:query.newStatement withParameters:query.parameters];
+  XCTAssertEqual(rows.count, (NSUInteger)1, @"GUID predicates should match binary GUIDs.");
+  XCTAssertEqualObjects(rows.firstObject[GUIDKey], GUID, @"Binary GUIDs should be returned as strings.");
+  XCTAssertEqualObjects(rows.firstObject[@"name"], @"first", @"The matching row should be returned.");
+
+  SQLResultSet *results = [_database executeResultSetQuery:query.newStatement withParameters:query.parameters];
+  XCTAssertEqualObjects(results[0][GUIDKey], GUID, @"Result sets should return binary GUIDs as strings.");
+}
+
+- (void) testLongBinaryGUIDListsAreBoundAsJSON{
+  [SQLGUID setMode:SQLGUIDModeBinary forTable:GUIDTestTable];
+  [self createTable];
+  NSMutableArray *GUIDs = [NSMutableArray new];
+  for (NSUInteger i = 0; i < 5000; i++){
+    [GUIDs addObject:[SQLGUID newTimeOrderedGUID]];
+  }
+  NSString *first = [self insertRowNamed:@"first"];
+  [self insertRowNamed:@"second"];
+  [GUIDs addObject:first];
+
+  SQLStatement *query = [SQLStatement statementType:SQLStatementQuery forTable:GUIDTestTable];
+  [query addColumn:@"name"];
+  [query addPredicate:GUIDs forColumn:GUIDKey operator:SQLIn];
+  XCTAssertEqualObjects(query.newStatement, @"SELECT \"GUIDTest\".\"name\" FROM \"GUIDTest\" WHERE \"GUIDTest\".\"GUID\" IN (SELECT guid_blob(value) FROM json_each(?));", @"A long GUID list should be read from json & converted to blobs.");
+  XCTAssertEqual(query.parameters.count, (NSUInteger)1, @"The list should be bound as one parameter.");
+  NSArray *rows = [_database executeQuery:query.newStatement withParameters:query.parameters];
+  XCTAssertEqualObjects([rows valueForKey:@"name"], @[@"first"], @"The list should match binary GUIDs.");
+}
+
+- (void) testMigrationConvertsExistingGUIDs{
+  [self createTable];
+  [_database executeUpdate:@"CREATE INDEX GUIDTestName ON GUIDTest (name);"];
+  NSString *GUID = [self insertRowNamed:@"first"];
+  [self insertRowNamed:@"second"];
+
+  XCTAssertTrue([_database migrateTable:GUIDTestTable toGUIDMode:SQLGUIDModeBinary], @"The table should be migrated.");
+  NSArray *rows = [_database executeQuery:@"SELECT typeof(GUID) AS type, guid_text(GUID) AS GUIDText FROM GUIDTest WHERE name = 'first';"];
+  XCTAssertEqualObjects(rows.firstObject[@"type"], @"blob", @"GUIDs should be converted to blobs.");
+  XCTAssertEqualObjects(rows.firstObject[@"GUIDText"], GUID, @"GUIDs should keep their value.");
+  XCTAssertEqual([_database executeQuery:@"SELECT * FROM GUIDTest;"].count, (NSUInteger)2, @"All rows should be copied.");
+  XCTAssertEqual([_database executeQuery:@"SELECT name FROM sqlite_master WHERE type = 'index' AND name = 'GUIDTestName';"].count, (NSUInteger)1, @"Indexes should be recreated.");
+}
+
+@end
@@ -0,0 +1,81 @@
+//
+//  SQLIndexAdvisorTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+#import "SQLIndexAdvisor.h"
+
+@interface SQLIndexAdvisorTests : SQLTestCase
+
+@end
+
+@implementation SQLIndexAdvisorTests
+
+- (void) setUp{
+  [super setUp];
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:@"Item"];
+  [create addColumn:@"list" ofColumnType:SQLColumnTypeText];
+  [create addColumn:@"name" ofColumnType:SQLColumnTypeText];
+  [create addColumn:@"price" ofColumnType:SQLColumnTypeReal];
+  [_database executeUpdate:create.newStatement];
+}
+
+- (SQLStatement *) listQuery{
+  SQLStatement *query = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [query addColumn:@"*"];
+  [query addPredicate:@"groceries" forColumn:@"list"];
+  [query addOrderForColumn:@"name" withDirection:SQLOrderAscending];
+  return query;
+}
+
+- (void) testScansAreFlaggedAndIndexesProposed{
+  SQLIndexAdvisor *advisor = [SQLIndexAdvisor new];
+  SQLIndexAdvice *advice = [advisor adviceForStatement:[self listQuery] database:_database];
+  XCTAssertTrue(advice.fullScan, @"An unindexed predicate should scan the table.");
+  XCTAssertTrue(advice.temporarySort, @"An unindexed order should sort in a temporary b-tree.");
+  XCTAssertEqualObjects([advice.proposedIndex.orderedColumns valueForKey:@"name"], (@[@"list", @"name"]), @"The equality column should be followed by the order column.");
+
+  [_database executeUpdate:advice.proposedIndex.newStatement];
+  advice = [advisor adviceForStatement:[self listQuery] database:_database];
+  XCTAssertFalse(advice.fullScan, @"The proposed index should be used for the predicate.");
+  XCTAssertFalse(advice.temporarySort, @"The proposed index should be used for the order.");
+  XCTAssertNil(advice.proposedIndex, @"Nothing should be proposed once the index exists.");
+}
+
+- (void) testRangePredicatesFollowEqualityPredicates{
+  SQLStatement *query = [self listQuery];
+  [query addPredicate:@5 forColumn:@"price" operator:SQLGreaterThan];
+  SQLIndexAdvice *advice = [[SQLIndexAdvisor new] adviceForStatement:query database:_database];
+  XCTAssertEqualObjects([advice.proposedIndex.orderedColumns valueForKey:@"name"], (@[@"list", @"price"]), @"A range column should follow the equality columns, without the order.");
+
+  SQLStatement *either = [self listQuery];
+  [either addPredicate:@"other" forColumn:@"name"].connect = SQLConnectOr;
+  XCTAssertNil([[SQLIndexAdvisor new] adviceForStatement:either database:_database].proposedIndex, @"OR predicates can't be matched by a single index.");
+}
+
+- (void) testObservedStatementsCanCreateIndexes{
+  SQLIndexAdvisor *advisor = [SQLIndexAdvisor new];
+  advisor.createsIndexes = YES;
+  for (NSUInteger i = 0; i < 3; i++){
+    SQLStatement *query = [self listQuery];
+    [advisor observeStatement:query sql:query.newStatement];
+  }
+  SQLStatement *lookup = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [lookup addColumn:@"*"];
+  [lookup addPredicate:@"id" forColumn:GUIDKey];
+  [advisor observeStatement:lookup sql:lookup.newStatement];
+  XCTAssertEqual(advisor.observedStatementCount, (NSUInteger)2, @"Each shape should be observed once.");
+
+  NSArray *adviceList = [advisor adviceUsingDatabase:_database];
+  XCTAssertEqual(adviceList.count, (NSUInteger)1, @"Only the scanning query should be advised.");
+  SQLIndexAdvice *advice = adviceList.firstObject;
+  XCTAssertEqual(advice.observationCount, (NSUInteger)3, @"Every observation should be counted.");
+  XCTAssertTrue(advice.created, @"The proposed index should be created.");
+  XCTAssertEqual([advisor adviceUsingDatabase:_database].count, (NSUInteger)0, @"Nothing should be advised once the index exists.");
+}
+
+@end
@@ -0,0 +1,73 @@
+//
+//  SQLInterruptTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+//Counts far enough that it won't finish before it's interrupted
+#define LongQuery @"WITH RECURSIVE counter(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM counter LIMIT 100000000) SELECT count(*) AS total FROM counter;"
+
+@interface SQLInterruptTests : SQLTestCase
+
+@end
+
+@implementation SQLInterruptTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (1);"];
+}
+
+- (void) testInterruptBlockStopsQuery{
+  __block NSUInteger checks = 0;
+  _database.interruptBlock = ^BOOL{
+    return ++checks > 10;
+  };
+  NSArray *rows = [_database executeQuery:LongQuery];
+  XCTAssertTrue(_database.interrupted, @"The query should be interrupted.");
+  XCTAssertEqual(rows.count, (NSUInteger)0, @"An interrupted aggregate shouldn't return a row.");
+  XCTAssertEqual(checks, (NSUInteger)11, @"The block should be checked until it asks for an interrupt.");
+  
+  _database.interruptBlock = nil;
+  rows = [_database executeQuery:@"SELECT id FROM Test;"];
+  XCTAssertFalse(_database.interrupted, @"The next query shouldn't be interrupted.");
+  XCTAssertEqual(rows.count, (NSUInteger)1, @"The next query should return it's rows.");
+}
+
+- (void) testInterruptBlockIsntCalledWhenCleared{
+  __block NSUInteger checks = 0;
+  _database.interruptBlock = ^BOOL{
+    checks++;
+    return NO;
+  };
+  _database.interruptBlock = nil;
+  [_database executeQuery:@"WITH RECURSIVE counter(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM counter LIMIT 10000) SELECT count(*) AS total FROM counter;"];
+  XCTAssertEqual(checks, (NSUInteger)0, @"The progress handler should be removed with the block.");
+}
+
+- (void) testInterruptedUpdateDoesntRaise{
+  _database.interruptBlock = ^BOOL{
+    return YES;
+  };
+  NSInteger result = -2;
+  XCTAssertNoThrow(result = [_database executeUpdate:@"INSERT INTO Test SELECT n FROM (WITH RECURSIVE counter(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM counter LIMIT 100000) SELECT n FROM counter);"], @"An interrupted update shouldn't raise.");
+  XCTAssertEqual(result, (NSInteger)-1, @"An interrupted update should fail.");
+  XCTAssertTrue(_database.interrupted, @"The update should be interrupted.");
+  _database.interruptBlock = nil;
+  XCTAssertEqualObjects([_database executeQuery:@"SELECT count(*) AS total FROM Test;"].firstObject[@"total"], @1, @"Nothing should be inserted.");
+}
+
+- (void) testInterruptFromAnotherThread{
+  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.05 * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+    [_database interrupt];
+  });
+  [_database executeQuery:LongQuery];
+  XCTAssertTrue(_database.interrupted, @"The query should be interrupted.");
+}
+
+@end
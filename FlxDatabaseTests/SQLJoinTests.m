@@ -0,0 +1,81 @@
+//
+//  SQLJoinTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLJoinTests : SQLTestCase
+
+@end
+
+@implementation SQLJoinTests
+
+- (void) setUp{
+  [super setUp];
+  [self createListTables];
+  [self insertRows:@[@[@"L1", @"Groceries"], @[@"L2", @"Hardware"]] intoTable:@"List"];
+  [self insertRows:@[@[@"I1", @"Milk", @"L1"], @[@"I2", @"Nails", @"L2"], @[@"I3", @"Loose", [NSNull null]]] intoTable:@"Item"];
+}
+
+- (SQLStatement *) itemQueryWithJoinType:(SQLJoinType)joinType{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:@"name"];
+  SQLJoin *join = [statement addJoinForTable:@"List" withType:joinType];
+  join.keyPathPrefix = @"list";
+  [join addColumn:@"name"];
+  [join addPredicateForColumn:GUIDKey matchingColumn:@"listGUID"];
+  [statement addOrderForColumn:@"name" withDirection:SQLOrderAscending];
+  return statement;
+}
+
+- (void) testJoinedQueryStatement{
+  SQLStatement *statement = [self itemQueryWithJoinType:SQLJoinInner];
+  NSString *expected = @"SELECT \"Item\".\"name\", \"List\".\"name\" AS \"list.name\" FROM \"Item\" INNER JOIN \"List\" ON \"List\".\"GUID\" = \"Item\".\"listGUID\" ORDER BY \"Item\".\"name\" COLLATE NOCASE ASC;";
+  XCTAssertEqualObjects(statement.newStatement, expected, @"Joined columns should be qualified by their table and prefixed.");
+  XCTAssertEqualObjects(statement.referencedTableNames, (@[@"Item", @"List"]), @"Both tables should be referenced.");
+
+  SQLStatement *copy = [statement copy];
+  XCTAssertEqualObjects(copy.newStatement, expected, @"A copy should keep the joins.");
+  [copy removeAllJoins];
+  XCTAssertEqual(statement.joins.count, (NSUInteger)1, @"Joins should be deep copied.");
+}
+
+- (void) testAliasesAndQualifiedColumns{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  statement.tableAlias = @"i";
+  [statement addColumn:@"name"];
+  SQLJoin *join = [statement addJoinForTable:@"Item" withType:SQLJoinLeft];
+  join.alias = @"other";
+  [join addColumn:@"name" usingAlias:@"otherName"];
+  [join addPredicateForColumn:@"listGUID" matchingColumn:@"listGUID"];
+  [join addPredicate:@"I1" forColumn:GUIDKey operator:SQLNotEqualTo];
+  SQLPredicate *predicate = [statement addPredicate:nil forColumn:@"name" operator:SQLNotEqualTo];
+  predicate.table = join.qualifier;
+  [statement addGroupColumn:[[SQLColumn alloc] initWithColumn:@"name"]];
+  [[statement addOrderForColumn:@"name" withDirection:SQLOrderDescending] setTable:join.qualifier];
+
+  NSString *expected = @"SELECT \"i\".\"name\", \"other\".\"name\" AS \"otherName\" FROM \"Item\" AS \"i\" LEFT JOIN \"Item\" AS \"other\" ON \"other\".\"listGUID\" = \"i\".\"listGUID\"  AND \"other\".\"GUID\" IS NOT ? WHERE \"other\".\"name\" IS NOT NULL GROUP BY \"i\".\"name\" ORDER BY \"other\".\"name\" COLLATE NOCASE DESC;";
+  XCTAssertEqualObjects(statement.newStatement, expected, @"Aliases should qualify the columns, predicates, groups & orders.");
+  XCTAssertEqualObjects(statement.parameters, (@[@"I1"]), @"Join predicates should be bound.");
+}
+
+- (void) testJoinedRows{
+  NSArray *rows = [_database executeQuery:[self itemQueryWithJoinType:SQLJoinInner].newStatement];
+  XCTAssertEqual(rows.count, (NSUInteger)2, @"An inner join should only return matched rows.");
+  XCTAssertEqualObjects(rows[0][@"name"], @"Milk", @"The statement's columns should be returned.");
+  XCTAssertEqualObjects(rows[0][@"list.name"], @"Groceries", @"Joined columns should be returned with their prefix.");
+
+  rows = [_database executeQuery:[self itemQueryWithJoinType:SQLJoinLeft].newStatement];
+  XCTAssertEqual(rows.count, (NSUInteger)3, @"A left join should return every row.");
+  XCTAssertEqualObjects(rows[0][@"name"], @"Loose", @"Unmatched rows should be returned.");
+  XCTAssertNil(rows[0][@"list.name"], @"Unmatched rows shouldn't have joined values.");
+
+  rows = [_database executeQuery:[self itemQueryWithJoinType:SQLJoinCross].newStatement];
+  XCTAssertEqual(rows.count, (NSUInteger)2, @"The join predicates should limit a cross join.");
+}
+
+@end
@@ -0,0 +1,140 @@
+//
+//  SQLPaginationTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLPaginationTests : SQLTestCase
+
+@end
+
+@implementation SQLPaginationTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Item (GUID TEXT PRIMARY KEY, name TEXT, price INTEGER);"];
+  NSArray *names = @[@"apple", @"Apple", @"banana", @"cherry", [NSNull null]];
+  NSMutableArray *rows = [NSMutableArray new];
+  for (NSUInteger i = 0; i < 100; i++){
+    id price = i % 10 ? @(i % 7) : [NSNull null];
+    [rows addObject:@[[NSString stringWithFormat:@"I%03lu", (unsigned long)i], names[i % names.count], price]];
+  }
+  [self insertRows:rows intoTable:@"Item"];
+}
+
+- (SQLStatement *) statementOrderedBy:(NSArray *)orders{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:@"*"];
+  for (SQLOrder *order in orders){
+    [statement addOrderParameter:order];
+  }
+  statement.paginated = YES;
+  return statement;
+}
+
+- (void) assertPagesOfStatement:(SQLStatement *)statement{
+  SQLStatement *full = [statement copy];
+  full.limit = 0;
+  NSArray *expected = [[self rowsForStatement:full] valueForKey:GUIDKey];
+
+  statement.limit = 7;
+  NSMutableArray *paged = [NSMutableArray new];
+  NSUInteger pages = 0;
+  do {
+    NSArray *rows = [self rowsForStatement:statement];
+    [paged addObjectsFromArray:[rows valueForKey:GUIDKey]];
+    statement.pageToken = [statement nextPageTokenForRows:rows];
+    pages++;
+  } while (statement.pageToken && pages < 100);
+  XCTAssertEqualObjects(paged, expected, @"Paging should return every row once, in order: %@", statement.orderings);
+}
+
+- (void) testAscendingOrdersSeekWithRowValues{
+  SQLOrder *name = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderAscending];
+  name.caseSensitive = YES;
+  SQLStatement *statement = [self statementOrderedBy:@[name]];
+  statement.limit = 10;
+  statement.offset = 20;
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".* FROM \"Item\" ORDER BY \"Item\".\"name\" ASC, \"Item\".\"GUID\" ASC LIMIT 10;", @"The GUID should break ties and the offset should be ignored.");
+
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[@"banana", @"I002"]];
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".* FROM \"Item\" WHERE ( \"Item\".\"name\", \"Item\".\"GUID\") > ( ?, ?) ORDER BY \"Item\".\"name\" ASC, \"Item\".\"GUID\" ASC LIMIT 10;", @"Ascending orders should seek with a row value.");
+  XCTAssertEqualObjects(statement.parameters, (@[@"banana", @"I002"]), @"The token's values should be bound.");
+}
+
+- (void) testMixedDirectionsSeekEachColumn{
+  SQLOrder *name = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderAscending];
+  SQLOrder *price = [[SQLOrder alloc] initWithColumn:@"price" orderDirection:SQLOrderDescending];
+  price.caseSensitive = YES;
+  SQLStatement *statement = [self statementOrderedBy:@[name, price]];
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[@"apple", @3, @"I005"]];
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".* FROM \"Item\" WHERE \"Item\".\"name\" COLLATE NOCASE >= ? AND ( ( \"Item\".\"name\" COLLATE NOCASE > ?) OR ( \"Item\".\"name\" COLLATE NOCASE = ? AND ( \"Item\".\"price\" < ? OR \"Item\".\"price\" IS NULL)) OR ( \"Item\".\"name\" COLLATE NOCASE = ? AND \"Item\".\"price\" = ? AND \"Item\".\"GUID\" > ?)) ORDER BY \"Item\".\"name\" COLLATE NOCASE ASC, \"Item\".\"price\" DESC, \"Item\".\"GUID\" ASC;", @"Each column should be compared in it's own direction.");
+}
+
+- (void) testPagesMatchTheFullQuery{
+  SQLOrder *name = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderAscending];
+  SQLOrder *price = [[SQLOrder alloc] initWithColumn:@"price" orderDirection:SQLOrderDescending];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[]]];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[name]]];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[price]]];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[name, price]]];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[[price copy], [name copy]]]];
+
+  SQLOrder *GUID = [[SQLOrder alloc] initWithColumn:GUIDKey orderDirection:SQLOrderDescending];
+  [self assertPagesOfStatement:[self statementOrderedBy:@[[price copy], GUID]]];
+}
+
+- (void) testPagesKeepThePredicates{
+  SQLOrder *name = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderDescending];
+  SQLStatement *statement = [self statementOrderedBy:@[name]];
+  [statement addPredicate:@1 forColumn:@"price" operator:SQLEquals];
+  [statement addPredicate:[[SQLPredicate alloc] initWithColumn:@"price" value:@2 operator:SQLEquals connection:SQLConnectOr]];
+  [self assertPagesOfStatement:statement];
+
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[[NSNull null], @"I999"]];
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)0, @"Nothing comes after the last NULL when descending.");
+}
+
+- (void) testTokensReadAliasedColumns{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:GUIDKey];
+  [statement addColumn:@"name" usingAlias:@"title"];
+  [statement addOrderForColumn:@"name" withDirection:SQLOrderAscending];
+  statement.paginated = YES;
+  SQLPageToken *token = [statement pageTokenForRow:@{GUIDKey: @"I001", @"title": @"Apple"}];
+  XCTAssertEqualObjects(token.values, (@[@"Apple", @"I001"]), @"The token should read the ordered column's alias.");
+  XCTAssertEqualObjects([statement pageTokenForRow:@{GUIDKey: @"I002"}].values, (@[[NSNull null], @"I002"]), @"A selected column missing from the row should be NULL.");
+  XCTAssertNil([statement pageTokenForRow:@{@"title": @"Apple"}], @"A row without a GUID can't be sought from.");
+
+  [statement removeColumnNamed:@"title"];
+  XCTAssertNil([statement pageTokenForRow:@{GUIDKey: @"I001", @"title": @"Apple"}], @"An ordered column that isn't selected can't be read.");
+
+  statement.limit = 2;
+  XCTAssertNil([statement nextPageTokenForRows:@[@{GUIDKey: @"I001"}]], @"A short page should be the last.");
+  XCTAssertNotNil([statement nextPageTokenForRows:@[@{GUIDKey: @"I001"}, @{GUIDKey: @"I002"}]], @"A full page should have a next page.");
+}
+
+- (void) testTokensThatCantBeSoughtDontReturnTheFirstPage{
+  SQLOrder *name = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderAscending];
+  SQLStatement *statement = [self statementOrderedBy:@[name]];
+  statement.limit = 7;
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[@"I002"]];
+  XCTAssertEqualObjects(statement.newStatement, @"", @"A token for other orderings shouldn't be ignored.");
+
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[@"banana", @"I002"]];
+  XCTAssertGreaterThan(statement.newStatement.length, (NSUInteger)0, @"A token for the statement's orderings should be sought.");
+  [statement addGroupColumn:[[SQLColumn alloc] initWithColumn:@"name"]];
+  XCTAssertEqualObjects(statement.newStatement, @"", @"A grouped query can't be sought.");
+
+  SQLOrder *custom = [[SQLOrder alloc] initWithColumn:@"name" orderDirection:SQLOrderAscending];
+  custom.customOrdering = @[@"cherry", @"apple"];
+  statement = [self statementOrderedBy:@[custom]];
+  statement.pageToken = [[SQLPageToken alloc] initWithValues:@[@"apple", @"I002"]];
+  XCTAssertEqualObjects(statement.newStatement, @"", @"A custom ordering can't be sought.");
+}
+
+@end
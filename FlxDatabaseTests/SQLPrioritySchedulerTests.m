@@ -0,0 +1,101 @@
+//
+//  SQLPrioritySchedulerTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SQLPriorityScheduler.h"
+
+#define SchedulerTestTimeout 10
+
+static char SchedulerTestQueueKey;
+
+@interface SQLPrioritySchedulerTests : XCTestCase
+
+@end
+
+@implementation SQLPrioritySchedulerTests{
+  dispatch_queue_t _queue;
+  SQLPriorityScheduler *_scheduler;
+  NSMutableArray *_ran;
+}
+
+- (void) setUp{
+  [super setUp];
+  _queue = dispatch_queue_create("SQLPrioritySchedulerTests", DISPATCH_QUEUE_SERIAL);
+  dispatch_queue_set_specific(_queue, &SchedulerTestQueueKey, &SchedulerTestQueueKey, NULL);
+  _scheduler = [[SQLPriorityScheduler alloc] initWithQueue:_queue];
+  _ran = [NSMutableArray new];
+}
+
+- (void) tearDown{
+  _scheduler = nil;
+  [super tearDown];
+}
+
+- (void) performNamed:(NSString *)name priority:(SQLPriority)priority{
+  //Work only runs on the scheduler's queue, so _ran doesn't need a lock
+  [_scheduler performWork:^{
+    [_ran addObject:name];
+  } priority:priority];
+}
+
+- (void) waitForQueue{
+  XCTestExpectation *drained = [self expectationWithDescription:@"queue drained"];
+  dispatch_async(_queue, ^{
+    [drained fulfill];
+  });
+  [self waitForExpectationsWithTimeout:SchedulerTestTimeout handler:nil];
+}
+
+- (void) testHigherLanesRunFirst{
+  _scheduler.agingInterval = 0;
+  dispatch_suspend(_queue);
+  [self performNamed:@"background 1" priority:SQLPriorityBackground];
+  [self performNamed:@"default 1" priority:SQLPriorityDefault];
+  [self performNamed:@"background 2" priority:SQLPriorityBackground];
+  [self performNamed:@"interactive 1" priority:SQLPriorityInteractive];
+  [self performNamed:@"default 2" priority:SQLPriorityDefault];
+  [self performNamed:@"interactive 2" priority:SQLPriorityInteractive];
+  dispatch_resume(_queue);
+  [self waitForQueue];
+  XCTAssertEqualObjects(_ran, (@[@"interactive 1", @"interactive 2", @"default 1", @"default 2", @"background 1", @"background 2"]), @"Work should run by lane, and in submission order within a lane.");
+}
+
+- (void) testWaitingWorkIsAged{
+  _scheduler.agingInterval = 0.05;
+  dispatch_suspend(_queue);
+  [self performNamed:@"background" priority:SQLPriorityBackground];
+  [NSThread sleepForTimeInterval:0.12];
+  [self performNamed:@"default" priority:SQLPriorityDefault];
+  dispatch_resume(_queue);
+  [self waitForQueue];
+  XCTAssertEqualObjects(_ran, (@[@"background", @"default"]), @"Work that's waited more than an aging interval should run before newer work in the next lane.");
+}
+
+- (void) testAgingCanBeDisabled{
+  _scheduler.agingInterval = 0;
+  dispatch_suspend(_queue);
+  [self performNamed:@"background" priority:SQLPriorityBackground];
+  [NSThread sleepForTimeInterval:0.12];
+  [self performNamed:@"default" priority:SQLPriorityDefault];
+  dispatch_resume(_queue);
+  [self waitForQueue];
+  XCTAssertEqualObjects(_ran, (@[@"default", @"background"]), @"Without aging, waiting work should stay in it's lane.");
+}
+
+- (void) testPerformWorkAndWait{
+  __block BOOL ran = NO;
+  __block BOOL onQueue = NO;
+  [_scheduler performWorkAndWait:^{
+    ran = YES;
+    onQueue = (dispatch_get_specific(&SchedulerTestQueueKey) != NULL);
+  } priority:SQLPriorityDefault];
+  XCTAssertTrue(ran, @"The work should have run before returning.");
+  XCTAssertTrue(onQueue, @"The work should run on the scheduler's queue.");
+}
+
+@end
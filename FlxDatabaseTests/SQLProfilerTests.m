@@ -0,0 +1,102 @@
+//
+//  SQLProfilerTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+#define ProfileQuerySQL @"SELECT * FROM Test WHERE name = ?;"
+
+@interface SQLProfilerTestSink : NSObject <SQLProfilerSink>
+@property NSUInteger executions;
+@property NSUInteger slowExecutions;
+@end
+
+@implementation SQLProfilerTestSink
+- (void) profiler:(SQLProfiler *)profiler didProfileExecution:(SQLExecutionProfile *)execution{
+  self.executions++;
+}
+- (void) profiler:(SQLProfiler *)profiler didLogSlowExecution:(SQLExecutionProfile *)execution{
+  self.slowExecutions++;
+}
+@end
+
+@interface SQLProfilerTests : SQLTestCase
+
+@end
+
+@implementation SQLProfilerTests{
+  SQLProfiler *_profiler;
+}
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (id INTEGER, name TEXT);"];
+  NSMutableArray *rows = [NSMutableArray new];
+  for (NSInteger i = 0; i < 50; i++){
+    [rows addObject:@[@(i), (i % 5) ? @"other" : @"match"]];
+  }
+  [self insertRows:rows intoTable:@"Test"];
+  _profiler = [SQLProfiler new];
+  _database.profiler = _profiler;
+}
+
+- (void) tearDown{
+  _profiler = nil;
+  [super tearDown];
+}
+
+- (void) testStatementsAreProfiledByShape{
+  [_database executeQuery:ProfileQuerySQL withParameters:@[@"match"]];
+  [_database executeQuery:ProfileQuerySQL withParameters:@[@"other"]];
+
+  XCTAssertEqual(_profiler.executionCount, (NSUInteger)2, @"Both executions should be recorded.");
+  SQLStatementProfile *profile = [_profiler profileForSQL:ProfileQuerySQL];
+  XCTAssertNotNil(profile, @"Executions with different values should share a profile.");
+  XCTAssertEqual(profile.executionCount, (NSUInteger)2, @"The profile should include both executions.");
+  XCTAssertEqual(profile.rowCount, (NSUInteger)50, @"The profile should count all the rows returned.");
+  XCTAssertEqual(profile.parameterCount, (NSUInteger)2, @"One parameter was bound per execution.");
+  XCTAssertEqual(profile.prepareCount, (NSUInteger)1, @"The second execution should reuse the cached statement.");
+  XCTAssertTrue(profile.fullScanSteps > 0, @"Without an index, each execution should scan the table.");
+  XCTAssertEqual([[profile.durationHistogram valueForKeyPath:@"@sum.self"] unsignedIntegerValue], (NSUInteger)2, @"Each execution should be in the histogram.");
+}
+
+- (void) testUpdatesRecordRowsChanged{
+  [_database executeUpdate:@"UPDATE Test SET name = ? WHERE name = ?;" withParameters:@[@"changed", @"match"]];
+  SQLStatementProfile *profile = [_profiler profileForSQL:@"UPDATE Test SET name = ? WHERE name = ?;"];
+  XCTAssertEqual(profile.rowCount, (NSUInteger)10, @"An update should record the rows it changed.");
+  XCTAssertEqual(profile.parameterCount, (NSUInteger)2, @"Both parameters should be counted.");
+}
+
+- (void) testSlowExecutionsAreLoggedAndSentToSinks{
+  SQLProfilerTestSink *sink = [SQLProfilerTestSink new];
+  [_profiler addSink:sink];
+  _profiler.slowExecutionThreshold = 0;
+  _profiler.slowExecutionLogLimit = 2;
+  for (NSUInteger i = 0; i < 3; i++){
+    [_database executeQuery:ProfileQuerySQL withParameters:@[@"match"]];
+  }
+  XCTAssertEqual(_profiler.slowExecutions.count, (NSUInteger)2, @"The slow execution log should be limited.");
+  XCTAssertEqual(sink.executions, (NSUInteger)3, @"The sink should receive every execution.");
+  XCTAssertEqual(sink.slowExecutions, (NSUInteger)3, @"The sink should receive every slow execution.");
+
+  [_profiler removeSink:sink];
+  [_database executeQuery:ProfileQuerySQL withParameters:@[@"match"]];
+  XCTAssertEqual(sink.executions, (NSUInteger)3, @"A removed sink shouldn't receive executions.");
+}
+
+- (void) testResetAndRemovingTheProfiler{
+  [_database executeQuery:ProfileQuerySQL withParameters:@[@"match"]];
+  [_profiler reset];
+  XCTAssertEqual(_profiler.executionCount, (NSUInteger)0, @"Reset should clear the totals.");
+  XCTAssertNil([_profiler profileForSQL:ProfileQuerySQL], @"Reset should clear the profiles.");
+
+  _database.profiler = nil;
+  [_database executeQuery:ProfileQuerySQL withParameters:@[@"match"]];
+  XCTAssertEqual(_profiler.executionCount, (NSUInteger)0, @"Nothing should be recorded without a profiler.");
+}
+
+@end
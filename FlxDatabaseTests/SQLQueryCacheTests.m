@@ -0,0 +1,105 @@
+//
+//  SQLQueryCacheTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SQLQueryCache.h"
+
+#define CacheTestSQL @"SELECT * FROM CacheTest WHERE name = ?;"
+
+@interface SQLQueryCacheTests : XCTestCase
+
+@end
+
+@implementation SQLQueryCacheTests
+
+- (NSArray *) rowsNamed:(NSString *)name count:(NSUInteger)count{
+  NSMutableArray *rows = [NSMutableArray new];
+  for (NSUInteger i = 0; i < count; i++){
+    [rows addObject:[NSMutableDictionary dictionaryWithDictionary:@{ @"name" : name, @"index" : @(i) }]];
+  }
+  return rows;
+}
+
+- (void) testCachedResultsAreReturnedAsCopies{
+  SQLQueryCache *cache = [[SQLQueryCache alloc] initWithByteLimit:1024 * 1024];
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil], @"Nothing should be cached yet.");
+  [cache cacheResults:[self rowsNamed:@"a" count:2] forSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+
+  NSArray *rows = [cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil];
+  XCTAssertEqual(rows.count, (NSUInteger)2, @"The cached rows should be returned.");
+  rows.firstObject[@"name"] = @"changed";
+  XCTAssertEqualObjects([cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil].firstObject[@"name"], @"a", @"Modifying returned rows shouldn't change the cache.");
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"b"] rowClass:nil], @"Different parameters shouldn't share results.");
+
+  SQLQueryCacheMetrics *metrics = cache.metrics;
+  XCTAssertEqual(metrics.hits, (NSUInteger)2, @"Both lookups of the cached query should be hits.");
+  XCTAssertEqual(metrics.misses, (NSUInteger)2, @"Both lookups of uncached queries should be misses.");
+  XCTAssertEqualWithAccuracy(metrics.hitRate, 0.5, 0.001, @"Half the lookups were hits.");
+}
+
+- (void) testParametersAreKeyedByTheirExactValue{
+  SQLQueryCache *cache = [[SQLQueryCache alloc] initWithByteLimit:1024 * 1024];
+  NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:1000.25];
+  NSNumber *number = @(0.1 + 0.2);
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:CacheTestSQL parameters:@[date] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:CacheTestSQL parameters:@[number] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  XCTAssertNotNil([cache resultsForSQL:CacheTestSQL parameters:@[[NSDate dateWithTimeIntervalSinceReferenceDate:1000.25]] rowClass:nil], @"An equal date should share results.");
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[[NSDate dateWithTimeIntervalSinceReferenceDate:1000.5]] rowClass:nil], @"Dates within the same second shouldn't share results.");
+  XCTAssertNotNil([cache resultsForSQL:CacheTestSQL parameters:@[@(0.1 + 0.2)] rowClass:nil], @"An equal double should share results.");
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@0.3] rowClass:nil], @"Doubles that only differ past their description shouldn't share results.");
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"0.30000000000000004"] rowClass:nil], @"A string shouldn't share a number's results.");
+  XCTAssertNil([cache resultsForSQL:@"SELECT * FROM CacheTest WHERE name = ? OR name = ?;" parameters:@[@"a\ns1:b", @"c"] rowClass:nil], @"Nothing should be cached for it.");
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:@"SELECT * FROM CacheTest WHERE name = ? OR name = ?;" parameters:@[@"a", @"b\ns1:c"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  XCTAssertNil([cache resultsForSQL:@"SELECT * FROM CacheTest WHERE name = ? OR name = ?;" parameters:@[@"a\ns1:b", @"c"] rowClass:nil], @"A string's contents shouldn't be confused with the next parameter.");
+
+  //Only differs in the middle, which a truncated description leaves out
+  NSMutableData *blob = [NSMutableData dataWithLength:256];
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:CacheTestSQL parameters:@[blob] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  XCTAssertNotNil([cache resultsForSQL:CacheTestSQL parameters:@[[NSData dataWithLength:256]] rowClass:nil], @"Equal data should share results.");
+  ((unsigned char *)blob.mutableBytes)[128] = 0xA5;
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[blob] rowClass:nil], @"Data with different bytes shouldn't share results.");
+}
+
+- (void) testInvalidationRemovesOnlyTheTablesResults{
+  SQLQueryCache *cache = [[SQLQueryCache alloc] initWithByteLimit:1024 * 1024];
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:@"SELECT * FROM Other;" parameters:nil rowClass:nil tableName:@"Other" generation:cache.generation];
+
+  [cache invalidateTables:[NSSet setWithObject:@"CacheTest"]];
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil], @"The invalidated table's results should be removed.");
+  XCTAssertNotNil([cache resultsForSQL:@"SELECT * FROM Other;" parameters:nil rowClass:nil], @"Other tables should keep their results.");
+  XCTAssertEqual(cache.metrics.invalidations, (NSUInteger)1, @"One result should have been invalidated.");
+}
+
+- (void) testResultsQueriedBeforeAnInvalidationAreNotCached{
+  SQLQueryCache *cache = [[SQLQueryCache alloc] initWithByteLimit:1024 * 1024];
+  NSUInteger generation = cache.generation;
+  [cache invalidateTables:[NSSet setWithObject:@"CacheTest"]];
+  [cache cacheResults:[self rowsNamed:@"a" count:1] forSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil tableName:@"CacheTest" generation:generation];
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil], @"Results that may be stale shouldn't be cached.");
+}
+
+- (void) testLeastRecentlyUsedResultsAreEvicted{
+  NSArray *rows = [self rowsNamed:@"a" count:10];
+  SQLQueryCache *cache = [[SQLQueryCache alloc] initWithByteLimit:1024 * 1024];
+  [cache cacheResults:rows forSQL:CacheTestSQL parameters:@[@"size"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  NSUInteger byteSize = cache.metrics.byteSize;
+
+  cache = [[SQLQueryCache alloc] initWithByteLimit:byteSize * 2];
+  [cache cacheResults:rows forSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  [cache cacheResults:rows forSQL:CacheTestSQL parameters:@[@"b"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+  [cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil];
+  [cache cacheResults:rows forSQL:CacheTestSQL parameters:@[@"c"] rowClass:nil tableName:@"CacheTest" generation:cache.generation];
+
+  XCTAssertNotNil([cache resultsForSQL:CacheTestSQL parameters:@[@"a"] rowClass:nil], @"Recently used results should be kept.");
+  XCTAssertNil([cache resultsForSQL:CacheTestSQL parameters:@[@"b"] rowClass:nil], @"The least recently used results should be evicted.");
+  XCTAssertEqual(cache.metrics.evictions, (NSUInteger)1, @"One result should have been evicted.");
+  XCTAssertTrue(cache.metrics.byteSize <= byteSize * 2, @"The cache should stay under it's byte limit.");
+}
+
+@end
@@ -0,0 +1,64 @@
+//
+//  SQLResultSetTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLResultSetTests : SQLTestCase
+
+@end
+
+@implementation SQLResultSetTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (id INTEGER, name TEXT, score REAL, data BLOB);"];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (?, ?, ?, ?);" withParameters:@[@1, @"one", @1.5, [@"abc" dataUsingEncoding:NSUTF8StringEncoding]]];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (?, NULL, NULL, NULL);" withParameters:@[@2]];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (?, ?, ?, ?);" withParameters:@[@3, @"", @3, @4]];
+}
+
+- (void) testTypedAccess{
+  SQLResultSet *results = [_database executeResultSetQuery:@"SELECT id, name, score, data FROM Test ORDER BY id;" withParameters:nil];
+  XCTAssertEqual(results.rowCount, (NSUInteger)3, @"All rows should be returned.");
+  XCTAssertEqualObjects(results.columnNames, (@[@"id", @"name", @"score", @"data"]), @"Column names should be in query order.");
+
+  NSUInteger name = [results indexOfColumnNamed:@"name"];
+  XCTAssertEqual([results integerAtRow:2 column:0], (int64_t)3, @"Integers should be stored unboxed.");
+  XCTAssertEqual([results doubleAtRow:0 column:2], 1.5, @"Reals should be stored unboxed.");
+  XCTAssertEqualObjects([results stringAtRow:0 column:name], @"one", @"Text should be read from the arena.");
+  XCTAssertEqualObjects([results stringAtRow:2 column:name], @"", @"Empty text isn't NULL.");
+  XCTAssertTrue([results isNullAtRow:1 column:name], @"NULL values should be tracked.");
+  XCTAssertEqual([results typeAtRow:2 column:3], SQLValueTypeInteger, @"Each value keeps it's own storage type.");
+  XCTAssertEqualObjects([results dataAtRow:0 column:3], [@"abc" dataUsingEncoding:NSUTF8StringEncoding], @"Blobs should be read from the arena.");
+}
+
+- (void) testRowViewsMatchDictionaryRows{
+  NSString *sql = @"SELECT id, name, score, data FROM Test ORDER BY id;";
+  SQLResultSet *results = [_database executeResultSetQuery:sql withParameters:nil];
+  NSArray *rows = [_database executeQuery:sql];
+
+  XCTAssertEqualObjects([results dictionaryRows], rows, @"Boxed rows should match dictionary rows.");
+  XCTAssertEqualObjects(results[0][@"name"], @"one", @"Row views should support keyed subscripts.");
+  XCTAssertEqualObjects([results[0] valueForKey:@"id"], @1, @"Row views should support KVC for columns.");
+  XCTAssertNil(results[1][@"name"], @"NULL values should box to nil.");
+
+  __block NSUInteger count = 0;
+  [results enumerateRowsUsingBlock:^(SQLResultRow *row, NSUInteger index, BOOL *stop) {
+    XCTAssertEqual([row integerForColumn:@"id"], (int64_t)(index + 1), @"Enumerated rows should be in order.");
+    count++;
+  }];
+  XCTAssertEqual(count, (NSUInteger)3, @"All rows should be enumerated.");
+}
+
+- (void) testEmptyResultKeepsColumnNames{
+  SQLResultSet *results = [_database executeResultSetQuery:@"SELECT id, name FROM Test WHERE id > ?;" withParameters:@[@10]];
+  XCTAssertEqual(results.rowCount, (NSUInteger)0, @"No rows should be returned.");
+  XCTAssertEqualObjects(results.columnNames, (@[@"id", @"name"]), @"Column names should be available for empty results.");
+}
+
+@end
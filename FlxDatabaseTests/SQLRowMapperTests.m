@@ -0,0 +1,102 @@
+//
+//  SQLRowMapperTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+#import "SQLRowMapper.h"
+
+@interface SQLMapperTestRow : NSObject
+@property (nonatomic) NSInteger count;
+@property (nonatomic) double score;
+@property (nonatomic) BOOL enabled;
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic, strong) NSDate *date;
+@property (nonatomic, readonly) int64_t identifier;
+@end
+@implementation SQLMapperTestRow
+@end
+
+//Records every key set through KVC
+@interface SQLMapperKVCTestRow : SQLMapperTestRow
+@property (nonatomic, strong) NSMutableArray *keys;
+@end
+@implementation SQLMapperKVCTestRow
+- (void) setValue:(id)value forKey:(NSString *)key{
+  if (!_keys) _keys = [NSMutableArray new];
+  [_keys addObject:key];
+  [super setValue:value forKey:key];
+}
+@end
+
+//Readonly values can only be set through KVC, which won't write to the ivar
+@interface SQLMapperNoIvarTestRow : SQLMapperTestRow
+@property (nonatomic, strong) NSString *undefinedKey;
+@end
+@implementation SQLMapperNoIvarTestRow
++ (BOOL) accessInstanceVariablesDirectly{
+  return NO;
+}
+- (void) setValue:(id)value forUndefinedKey:(NSString *)key{
+  _undefinedKey = key;
+}
+@end
+
+@interface SQLRowMapperTests : SQLTestCase
+
+@end
+
+@implementation SQLRowMapperTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (identifier INTEGER, count INTEGER, score REAL, enabled INTEGER, name TEXT, date REAL);"];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (?, ?, ?, ?, ?, ?);" withParameters:@[@(5000000000), @7, @2.5, @YES, @"row", [NSDate dateWithTimeIntervalSinceReferenceDate:100]]];
+  [_database executeUpdate:@"INSERT INTO Test VALUES (?, NULL, NULL, NULL, ?, NULL);" withParameters:@[@2, @42]];
+}
+
+- (void) testNativeValuesAreMapped{
+  NSArray *rows = [_database executeQuery:@"SELECT * FROM Test ORDER BY identifier DESC;" withParameters:nil withClassForRow:[SQLMapperTestRow class]];
+  XCTAssertEqual(rows.count, (NSUInteger)2, @"All rows should be mapped.");
+
+  SQLMapperTestRow *row = rows[0];
+  XCTAssertEqual(row.identifier, (int64_t)5000000000, @"Readonly primitives should be set through their ivar without truncation.");
+  XCTAssertEqual(row.count, (NSInteger)7, @"Integers should be mapped.");
+  XCTAssertEqual(row.score, 2.5, @"Reals should be mapped.");
+  XCTAssertTrue(row.enabled, @"BOOLs should be mapped.");
+  XCTAssertEqualObjects(row.name, @"row", @"Strings should be mapped.");
+  XCTAssertEqualObjects(row.date, [NSDate dateWithTimeIntervalSinceReferenceDate:100], @"Dates should be mapped from their time interval.");
+
+  row = rows[1];
+  XCTAssertEqual(row.count, (NSInteger)0, @"NULL values should be skipped.");
+  XCTAssertEqualObjects(row.name, @"42", @"Numbers should be converted to text for string properties.");
+}
+
+- (void) testOverriddenKeyValueCodingIsUsed{
+  NSArray *rows = [_database executeQuery:@"SELECT count, name, identifier FROM Test ORDER BY identifier DESC;" withParameters:nil withClassForRow:[SQLMapperKVCTestRow class]];
+  SQLMapperKVCTestRow *row = rows.firstObject;
+  XCTAssertEqualObjects(row.keys, (@[@"count", @"name", @"identifier"]), @"Every column should be set through the class's setValue:forKey:.");
+  XCTAssertEqual(row.count, (NSInteger)7, @"Values should still be set.");
+  XCTAssertEqualObjects(row.name, @"row", @"Values should still be set.");
+  XCTAssertEqual(row.identifier, (int64_t)5000000000, @"Readonly values should be set by KVC.");
+}
+
+- (void) testIvarsArentWrittenWithoutDirectAccess{
+  NSArray *rows = [_database executeQuery:@"SELECT count, identifier FROM Test ORDER BY identifier DESC;" withParameters:nil withClassForRow:[SQLMapperNoIvarTestRow class]];
+  SQLMapperNoIvarTestRow *row = rows.firstObject;
+  XCTAssertEqual(row.count, (NSInteger)7, @"Setters should still be used.");
+  XCTAssertEqual(row.identifier, (int64_t)0, @"The readonly ivar shouldn't be written.");
+  XCTAssertEqualObjects(row.undefinedKey, @"identifier", @"The readonly value should go through KVC.");
+}
+
+- (void) testMappersAreCached{
+  NSArray *columns = @[@"count", @"name"];
+  SQLRowMapper *mapper = [SQLRowMapper mapperForClass:[SQLMapperTestRow class] columnNames:columns];
+  XCTAssertEqual(mapper, [SQLRowMapper mapperForClass:[SQLMapperTestRow class] columnNames:[columns copy]], @"Mappers should be cached by class and columns.");
+  XCTAssertNotEqual(mapper, [SQLRowMapper mapperForClass:[SQLMapperTestRow class] columnNames:@[@"name", @"count"]], @"Different column orders should use different mappers.");
+}
+
+@end
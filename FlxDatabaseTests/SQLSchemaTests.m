@@ -0,0 +1,94 @@
+//
+//  SQLSchemaTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+#import "SQLSchema.h"
+
+@interface SQLSchemaTests : SQLTestCase
+
+@end
+
+@implementation SQLSchemaTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:[self itemStatement].newStatement];
+}
+
+- (SQLStatement *) itemStatement{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementCreate forTable:@"Item"];
+  [statement addColumn:@"name" ofColumnType:SQLColumnTypeText];
+  return statement;
+}
+
+- (void) testSchemaIsReadInOnePass{
+  SQLSchema *schema = [SQLSchema schemaFromDatabase:_database];
+  XCTAssertTrue([schema hasTable:@"Item"], @"The table should be in the schema.");
+  NSSet *expected = [NSSet setWithObjects:GUIDKey, SQLCreatedDate, SQLModifiedDate, @"name", nil];
+  XCTAssertEqualObjects([schema columnNamesForTable:@"Item"], expected, @"Every column should be read.");
+  XCTAssertNil([schema columnNamesForTable:@"Missing"], @"A missing table shouldn't have columns.");
+
+  schema = [SQLSchema schemaFromDatabase:_database forTables:@[@"Other"]];
+  XCTAssertFalse([schema hasTable:@"Item"], @"Only the tables asked for should be read.");
+}
+
+- (void) testUpdatesAreDiffedAndMerged{
+  SQLStatement *item = [self itemStatement];
+  [item addColumn:@"price" ofColumnType:SQLColumnTypeReal];
+  [item addColumn:@"list" ofColumnType:SQLColumnTypeText].indexed = YES;
+  SQLStatement *tag = [SQLStatement statementType:SQLStatementQuery forTable:@"Tag"];
+  [tag addColumn:@"label" ofColumnType:SQLColumnTypeText];
+
+  SQLSchema *schema = [SQLSchema schemaFromDatabase:_database forTables:@[@"Item", @"Tag"]];
+  NSArray *updates = [schema updatesForStatement:item];
+  XCTAssertEqual(updates.count, (NSUInteger)3, @"The two missing columns and the index should be added.");
+  XCTAssertEqual([updates[0] SQLType], SQLStatementAddColumn, @"Missing columns should be added.");
+  XCTAssertEqual([updates[2] SQLType], SQLStatementCreateIndex, @"The missing index should be created.");
+  XCTAssertEqual([schema updatesForStatement:item].count, (NSUInteger)0, @"The snapshot should record the updates.");
+
+  updates = [schema updatesForStatement:tag];
+  XCTAssertEqual(updates.count, (NSUInteger)1, @"A missing table should be created.");
+  XCTAssertEqual([updates[0] SQLType], SQLStatementCreate, @"A missing table should be created.");
+
+  for (SQLStatement *update in [[SQLSchema schemaFromDatabase:_database] updatesForStatement:item]){
+    [_database executeUpdate:update.newStatement];
+  }
+  schema = [SQLSchema schemaFromDatabase:_database];
+  XCTAssertEqual([schema updatesForStatement:item].count, (NSUInteger)0, @"The applied updates should be read back.");
+  XCTAssertTrue([schema hasIndex:[item.indexStatements.firstObject indexName]], @"The created index should be read.");
+}
+
+- (void) testFingerprints{
+  SQLStatement *item = [self itemStatement];
+  SQLStatement *tag = [SQLStatement statementType:SQLStatementCreate forTable:@"Tag"];
+  [tag addColumn:@"label" ofColumnType:SQLColumnTypeText];
+  NSString *fingerprint = [SQLSchema fingerprintForStatements:@[item, tag]];
+  XCTAssertEqualObjects(fingerprint, [SQLSchema fingerprintForStatements:@[tag, item]], @"The order of the statements shouldn't matter.");
+  [tag addColumn:@"color" ofColumnType:SQLColumnTypeText];
+  XCTAssertNotEqualObjects(fingerprint, [SQLSchema fingerprintForStatements:@[item, tag]], @"A new column should change the fingerprint.");
+
+  XCTAssertFalse([SQLSchema database:_database matchesFingerprint:fingerprint], @"An unrecorded fingerprint shouldn't match.");
+  [SQLSchema recordFingerprint:fingerprint inDatabase:_database];
+  XCTAssertTrue([SQLSchema database:_database matchesFingerprint:fingerprint], @"A recorded fingerprint should match.");
+  [_database executeUpdate:@"ALTER TABLE Item ADD COLUMN extra TEXT;"];
+  XCTAssertFalse([SQLSchema database:_database matchesFingerprint:fingerprint], @"A schema change should invalidate the fingerprint.");
+}
+
+- (void) testUserVersion{
+  XCTAssertEqual(_database.userVersion, (NSUInteger)0, @"A new database should be at version 0.");
+  NSUInteger schemaVersion = _database.schemaVersion;
+  _database.userVersion = 3;
+  XCTAssertEqual(_database.userVersion, (NSUInteger)3, @"The user version should be set.");
+  [_database beginImmediateTransaction];
+  _database.userVersion = 4;
+  [_database rollback];
+  XCTAssertEqual(_database.userVersion, (NSUInteger)3, @"Setting the user version should be rolled back with the transaction.");
+  XCTAssertEqual(_database.schemaVersion, schemaVersion, @"The user version isn't part of the schema.");
+}
+
+@end
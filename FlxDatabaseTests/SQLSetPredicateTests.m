@@ -0,0 +1,90 @@
+//
+//  SQLSetPredicateTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@interface SQLSetPredicateTests : SQLTestCase
+
+@end
+
+@implementation SQLSetPredicateTests
+
+- (void) setUp{
+  [super setUp];
+  [self createListTables];
+  [self insertRows:@[@[@"L1", @"Groceries"], @[@"L2", @"Hardware"], @[@"L3", @"Empty"]] intoTable:@"List"];
+  NSMutableArray *items = [NSMutableArray new];
+  for (NSUInteger i = 0; i < 100; i++){
+    [items addObject:@[[NSString stringWithFormat:@"I%lu", (unsigned long)i], @"item", i % 2 ? @"L1" : @"L2"]];
+  }
+  [self insertRows:items intoTable:@"Item"];
+}
+
+- (NSArray *) GUIDsFrom:(NSUInteger)start count:(NSUInteger)count{
+  NSMutableArray *GUIDs = [NSMutableArray arrayWithCapacity:count];
+  for (NSUInteger i = start; i < start + count; i++){
+    [GUIDs addObject:[NSString stringWithFormat:@"I%lu", (unsigned long)i]];
+  }
+  return GUIDs;
+}
+
+- (void) testShortListsBindEachValue{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:GUIDKey];
+  [statement addPredicate:[NSSet setWithArray:@[@"I1", @"I2", @"missing"]] forColumn:GUIDKey operator:SQLIn];
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".\"GUID\" FROM \"Item\" WHERE \"Item\".\"GUID\" IN (?, ?, ?);", @"Each value should have a parameter.");
+  XCTAssertEqual(statement.parameters.count, (NSUInteger)3, @"Each value should be bound.");
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)2, @"Only the matching rows should be returned.");
+
+  [statement removeAllPredicates];
+  [statement addPredicate:nil forColumn:GUIDKey operator:SQLNotIn];
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)100, @"Nothing is in an empty list.");
+}
+
+- (void) testLongListsBindJSON{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:GUIDKey];
+  [statement addPredicate:[self GUIDsFrom:10 count:5000] forColumn:GUIDKey operator:SQLIn];
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".\"GUID\" FROM \"Item\" WHERE \"Item\".\"GUID\" IN (SELECT value FROM json_each(?));", @"A long list should be read from json.");
+  XCTAssertEqual(statement.parameters.count, (NSUInteger)1, @"A long list should be a single parameter.");
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)90, @"Only the matching rows should be returned.");
+
+  [statement.predicates.firstObject setOp:SQLNotIn];
+  [statement compile];
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)10, @"The rows not in the list should be returned.");
+  [statement.predicates.firstObject setValue:[self GUIDsFrom:0 count:2]];
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)98, @"A compiled list should rebind, whatever it's size.");
+}
+
+- (void) testSubqueries{
+  SQLStatement *lists = [SQLStatement statementType:SQLStatementQuery forTable:@"List"];
+  [lists addColumn:GUIDKey];
+  [lists addPredicate:@"Groceries" forColumn:@"name"];
+
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [statement addColumn:GUIDKey];
+  [statement addPredicate:lists forColumn:@"listGUID" operator:SQLIn];
+  XCTAssertEqualObjects(statement.newStatement, @"SELECT \"Item\".\"GUID\" FROM \"Item\" WHERE \"Item\".\"listGUID\" IN (SELECT \"List\".\"GUID\" FROM \"List\" WHERE \"List\".\"name\" IS ?);", @"The subquery should be generated in place.");
+  XCTAssertEqualObjects(statement.parameters, (@[@"Groceries"]), @"The subquery's parameters should be added.");
+  XCTAssertEqual([self rowsForStatement:statement].count, (NSUInteger)50, @"Only the items in the subquery's lists should be returned.");
+  XCTAssertEqualObjects(statement.referencedTableNames, (@[@"Item", @"List"]), @"The subquery's table should be referenced.");
+
+  SQLStatement *items = [SQLStatement statementType:SQLStatementQuery forTable:@"Item"];
+  [items addColumn:GUIDKey];
+  [items addPredicate:nil forColumn:@"listGUID" operator:SQLEquals].valueColumn = GUIDKey;
+  [items.predicates.firstObject setValueTable:@"List"];
+  SQLStatement *emptyLists = [SQLStatement statementType:SQLStatementQuery forTable:@"List"];
+  [emptyLists addColumn:@"name"];
+  [emptyLists addPredicateForSubquery:items operator:SQLNotExists];
+  XCTAssertEqualObjects(emptyLists.newStatement, @"SELECT \"List\".\"name\" FROM \"List\" WHERE NOT EXISTS (SELECT \"Item\".\"GUID\" FROM \"Item\" WHERE \"Item\".\"listGUID\" = \"List\".\"GUID\");", @"A correlated subquery should refer to the outer table.");
+  NSArray *rows = [self rowsForStatement:emptyLists];
+  XCTAssertEqual(rows.count, (NSUInteger)1, @"Only the list without items should be returned.");
+  XCTAssertEqualObjects(rows.firstObject[@"name"], @"Empty", @"Only the list without items should be returned.");
+}
+
+@end
@@ -0,0 +1,78 @@
+//
+//  SQLStatementCacheTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+#define CacheTestA @"SELECT id FROM Test WHERE id = 1;"
+#define CacheTestB @"SELECT id FROM Test WHERE id = 2;"
+#define CacheTestC @"SELECT id FROM Test WHERE id = 3;"
+
+@interface SQLStatementCacheTests : SQLTestCase
+
+@end
+
+@implementation SQLStatementCacheTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+  [self insertRows:@[@[@1], @[@2], @[@3]] intoTable:@"Test"];
+}
+
+- (void) assertHits:(NSUInteger)hits misses:(NSUInteger)misses afterRunning:(NSString *)sql message:(NSString *)message{
+  NSUInteger startHits = _database.statementCacheHits;
+  NSUInteger startMisses = _database.statementCacheMisses;
+  XCTAssertEqual([_database executeQuery:sql].count, (NSUInteger)1, @"The query should return it's row.");
+  XCTAssertEqual(_database.statementCacheHits - startHits, hits, @"%@", message);
+  XCTAssertEqual(_database.statementCacheMisses - startMisses, misses, @"%@", message);
+}
+
+- (void) testRepeatedSQLIsAHit{
+  [self assertHits:0 misses:1 afterRunning:CacheTestA message:@"The first run should prepare the statement."];
+  [self assertHits:1 misses:0 afterRunning:CacheTestA message:@"The same sql should reuse the prepared statement."];
+  [self assertHits:0 misses:1 afterRunning:CacheTestB message:@"Different sql should be prepared."];
+  [self assertHits:1 misses:0 afterRunning:CacheTestB message:@"Each sql should be cached separately."];
+}
+
+- (void) testLeastRecentlyUsedStatementsAreEvicted{
+  [_database clearStatementCache];
+  _database.statementCacheSize = 2;
+  [self assertHits:0 misses:1 afterRunning:CacheTestA message:@"A should be prepared."];
+  [self assertHits:0 misses:1 afterRunning:CacheTestB message:@"B should be prepared."];
+  [self assertHits:1 misses:0 afterRunning:CacheTestA message:@"A should be cached (and now be the most recently used)."];
+  [self assertHits:0 misses:1 afterRunning:CacheTestC message:@"C should be prepared."];
+  XCTAssertEqual(_database.statementCacheCount, (NSUInteger)2, @"The cache shouldn't grow past it's size.");
+  [self assertHits:1 misses:0 afterRunning:CacheTestA message:@"A was used more recently than B, so it should be kept."];
+  [self assertHits:0 misses:1 afterRunning:CacheTestB message:@"B should have been evicted."];
+
+  _database.statementCacheSize = 0;
+  XCTAssertEqual(_database.statementCacheCount, (NSUInteger)0, @"Shrinking the cache should evict statements.");
+  [self assertHits:0 misses:1 afterRunning:CacheTestA message:@"Nothing should be cached with a size of 0."];
+  [self assertHits:0 misses:1 afterRunning:CacheTestA message:@"Nothing should be cached with a size of 0."];
+}
+
+- (void) testCloseAndOpenClearTheCache{
+  NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID].UUIDString stringByAppendingPathExtension:@"sqlite"]];
+  SQLDatabase *database = [[SQLDatabase alloc] initWithPath:path];
+  [database executeUpdate:@"CREATE TABLE Test (id INTEGER);"];
+  [database executeQuery:@"SELECT id FROM Test;"];
+  XCTAssertGreaterThan(database.statementCacheCount, (NSUInteger)0, @"Statements should be cached.");
+  [database close];
+  XCTAssertEqual(database.statementCacheCount, (NSUInteger)0, @"Closing should clear the cache.");
+
+  [database open];
+  NSUInteger misses = database.statementCacheMisses;
+  [database executeQuery:@"SELECT id FROM Test;"];
+  XCTAssertEqual(database.statementCacheMisses, misses + 1, @"Statements should be prepared again on the new connection.");
+  [database executeQuery:@"SELECT id FROM Test;"];
+  XCTAssertEqual(database.statementCacheMisses, misses + 1, @"Statements should be cached again after reopening.");
+  [database close];
+  [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+@end
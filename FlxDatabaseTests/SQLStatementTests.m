@@ -0,0 +1,149 @@
+//
+//  SQLStatementTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SQLStatement.h"
+
+@interface SQLStatementTests : XCTestCase
+
+@end
+
+@implementation SQLStatementTests
+
+- (SQLStatement *) insertStatement{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementInsert forTable:@"TestTable"];
+  [statement addColumn:@"zeta" ofColumnType:SQLColumnTypeText].value = @"z";
+  [statement addColumn:@"alpha" ofColumnType:SQLColumnTypeInt].value = @1;
+  [statement addColumn:@"mid" ofColumnType:SQLColumnTypeReal].value = @2.5;
+  return statement;
+}
+
+- (void) testColumnOrderIsInsertionOrder{
+  SQLStatement *statement = [self insertStatement];
+  NSArray *names = [statement.orderedColumns valueForKey:@"name"];
+  XCTAssertEqualObjects(names, (@[@"zeta", @"alpha", @"mid"]), @"Columns should be kept in insertion order.");
+
+  [statement addColumn:@"alpha" ofColumnType:SQLColumnTypeText];
+  names = [statement.orderedColumns valueForKey:@"name"];
+  XCTAssertEqualObjects(names, (@[@"zeta", @"alpha", @"mid"]), @"Replacing a column should keep its position.");
+  XCTAssertEqual([statement getColumnNamed:@"alpha"].type, SQLColumnTypeText, @"The replaced column should be returned.");
+}
+
+- (void) testEqualStatementsGenerateIdenticalSQL{
+  SQLStatement *first = [self insertStatement];
+  SQLStatement *second = [self insertStatement];
+  second.GUID = first.GUID;
+
+  XCTAssertEqualObjects(first.newStatement, second.newStatement, @"Equal statements should generate identical sql.");
+  XCTAssertEqual(first.parameters.count, second.parameters.count, @"Equal statements should generate the same number of parameters.");
+
+  SQLStatement *copy = [first copy];
+  copy.GUID = first.GUID;
+  [copy getColumnNamed:@"zeta"].value = @"z";
+  [copy getColumnNamed:@"alpha"].value = @1;
+  [copy getColumnNamed:@"mid"].value = @2.5;
+  XCTAssertEqualObjects(first.newStatement, copy.newStatement, @"A copy should generate identical sql.");
+}
+
+- (void) testGetColumnNamedUsesNameOrAlias{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"TestTable"];
+  SQLColumn *column = [statement addColumn:@"value" ofColumnType:SQLColumnTypeInt usingAlias:@"total" withAggregate:SQLAggregateTotal];
+
+  XCTAssertEqual([statement getColumnNamed:@"total"], column, @"Column should be found by alias.");
+  XCTAssertEqual([statement getColumnNamed:@"value"], column, @"Column should be found by name.");
+  XCTAssertNil([statement getColumnNamed:@"missing"], @"Missing columns should return nil.");
+
+  XCTAssertEqual([statement removeColumnNamed:@"value"], column, @"Column should be removed by name.");
+  XCTAssertEqual(statement.orderedColumns.count, (NSUInteger)0, @"Column should be removed from the ordered columns.");
+  XCTAssertEqual(statement.columns.count, (NSUInteger)0, @"Column should be removed from the columns.");
+}
+
+- (void) testCompiledStatementRebindsValues{
+  SQLStatement *statement = [self insertStatement];
+  [statement compile];
+  XCTAssertTrue(statement.compiled, @"Statement should be compiled.");
+
+  NSString *sql = statement.newStatement;
+  NSArray *parameters = [statement.parameters copy];
+
+  [statement getColumnNamed:@"zeta"].value = @"y";
+  statement.GUID = nil;
+  NSString *recompiledSQL = statement.newStatement;
+
+  XCTAssertTrue(sql == recompiledSQL, @"A compiled statement should return the same sql string.");
+  XCTAssertEqual(parameters.count, statement.parameters.count, @"Parameter count shouldn't change.");
+  XCTAssertTrue([statement.parameters containsObject:@"y"], @"New column values should be bound.");
+  XCTAssertFalse([statement.parameters containsObject:@"z"], @"Old column values shouldn't be bound.");
+
+  [statement addColumn:@"other"];
+  XCTAssertFalse(statement.compiled, @"Changing the columns should discard the compiled statement.");
+}
+
+- (void) testCompiledQueryRebindsPredicatesAndFollowsGroups{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementQuery forTable:@"TestTable"];
+  [statement addColumn:@"zeta"];
+  SQLPredicate *alpha = [statement addPredicate:@1 forColumn:@"alpha" operator:SQLEquals];
+  SQLPredicateGroup *inner = [[SQLPredicateGroup alloc] initWithConnection:SQLConnectAnd predicates:@[[[SQLPredicate alloc] initWithColumn:@"mid" value:@2.5 operator:SQLGreaterThan connection:SQLConnectAnd]]];
+  SQLPredicateGroup *outer = [[SQLPredicateGroup alloc] initWithConnection:SQLConnectAnd predicates:@[inner]];
+  [statement addPredicateGroup:outer];
+  [statement compile];
+  NSString *sql = statement.newStatement;
+  XCTAssertEqualObjects(statement.parameters, (@[@1, @2.5]), @"The predicates should be bound in order.");
+
+  alpha.value = @2;
+  XCTAssertTrue(statement.newStatement == sql, @"Changing a predicate's value shouldn't regenerate the sql.");
+  XCTAssertEqualObjects(statement.parameters, (@[@2, @2.5]), @"The new value should be bound.");
+
+  [inner addPredicate:[[SQLPredicate alloc] initWithColumn:@"zeta" value:@"z" operator:SQLEquals connection:SQLConnectOr]];
+  NSString *regrouped = statement.newStatement;
+  XCTAssertFalse([regrouped isEqualToString:sql], @"Changing a nested group should recompile the statement.");
+  XCTAssertTrue([regrouped rangeOfString:@"\"TestTable\".\"zeta\" IS ?"].location != NSNotFound, @"The group's new predicate should be included.");
+  XCTAssertTrue(statement.compiled, @"The statement should stay compiled.");
+  XCTAssertEqualObjects(statement.parameters, (@[@2, @2.5, @"z"]), @"The group's new predicate should be bound.");
+  XCTAssertTrue(statement.newStatement == regrouped, @"The recompiled sql should be reused.");
+
+  outer.connect = SQLConnectOr;
+  XCTAssertTrue(statement.newStatement != regrouped, @"Changing a group's connect should recompile the statement.");
+}
+
+- (void) testBulkInsertStatement{
+  SQLStatement *statement = [self insertStatement];
+  [statement addDefaultColumns];
+  statement.conflict = SQLConflictIgnore;
+  XCTAssertEqualObjects(statement.bulkInsertColumnNames, (@[@"zeta", @"alpha", @"mid"]), @"Default columns shouldn't be bulk insert columns.");
+
+  NSString *sql = [statement newBulkInsertStatementForRowCount:2];
+  NSString *expected = @"INSERT OR IGNORE INTO \"TestTable\" (\"GUID\", \"zeta\", \"alpha\", \"mid\", \"SQLCreatedDateTime\", \"SQLModifiedDateTime\") VALUES (?, ?, ?, ?, ?, ?), (?, ?, ?, ?, ?, ?);";
+  XCTAssertEqualObjects(sql, expected, @"Bulk inserts should have a group of parameters per row.");
+}
+
+- (void) testIndexStatements{
+  SQLStatement *index = [SQLStatement createIndexOnColumns:@[@"zeta", @"alpha"] forTable:@"TestTable"];
+  XCTAssertEqualObjects(index.newStatement, @"CREATE INDEX IF NOT EXISTS \"TestTable_zeta_alpha_idx\" ON \"TestTable\" (\"zeta\", \"alpha\");", @"A composite index should index the columns in order.");
+
+  index.uniqueIndex = YES;
+  index.coveringColumnNames = @[@"mid", @"alpha"];
+  [index addOrderForColumn:@"alpha" withDirection:SQLOrderDescending];
+  [index addPredicate:@"it's" forColumn:@"zeta" operator:SQLNotEqualTo];
+  NSString *expected = @"CREATE UNIQUE INDEX IF NOT EXISTS \"TestTable_zeta_alpha_idx\" ON \"TestTable\" (\"zeta\", \"alpha\" COLLATE NOCASE DESC, \"mid\") WHERE \"TestTable\".\"zeta\" IS NOT 'it''s';";
+  XCTAssertEqualObjects(index.newStatement, expected, @"Orders, covering columns and predicates should be included.");
+  XCTAssertEqual(index.parameters.count, (NSUInteger)0, @"Index predicates can't use parameters.");
+
+  SQLStatement *drop = [SQLStatement dropIndexNamed:index.indexName forTable:@"TestTable"];
+  XCTAssertEqualObjects(drop.newStatement, @"DROP INDEX IF EXISTS \"TestTable_zeta_alpha_idx\";", @"The index should be dropped by name.");
+
+  SQLStatement *create = [SQLStatement statementType:SQLStatementCreate forTable:@"TestTable"];
+  [create addColumn:@"zeta" ofColumnType:SQLColumnTypeText].indexed = YES;
+  [create addColumn:@"alpha" ofColumnType:SQLColumnTypeInt];
+  [create addIndexStatement:[SQLStatement createIndexOnColumns:@[@"alpha", @"zeta"] forTable:@"TestTable"]];
+  NSArray *names = [create.indexStatements valueForKey:@"indexName"];
+  XCTAssertEqualObjects(names, (@[@"TestTable_alpha_zeta_idx", @"TestTable_zeta_idx"]), @"Added indexes and indexed columns should both be included.");
+  XCTAssertEqual([[create copy] indexStatements].count, (NSUInteger)2, @"Copies should keep the indexes.");
+}
+
+@end
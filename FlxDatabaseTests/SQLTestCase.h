@@ -0,0 +1,40 @@
+//
+//  SQLTestCase.h
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "SQLDatabase.h"
+#import "SQLStatement.h"
+
+/**
+ A test case that opens a fresh in-memory database before each test & closes it after.
+ 
+ Subclasses should call super from setUp (before adding their own tables) & from tearDown.
+ */
+@interface SQLTestCase : XCTestCase{
+  SQLDatabase *_database;
+}
+/**
+ Creates the List & Item tables shared by the statement tests:
+ 
+ - List (GUID TEXT PRIMARY KEY, name TEXT)
+ - Item (GUID TEXT PRIMARY KEY, name TEXT, listGUID TEXT)
+ */
+- (void) createListTables;
+/**
+ Inserts each row (an array of values, in column order) into the table inside a single transaction.
+ */
+- (void) insertRows:(NSArray *)rows intoTable:(NSString *)table;
+/**
+ Runs the statement's query with it's parameters & returns the rows.
+ */
+- (NSArray *) rowsForStatement:(SQLStatement *)statement;
+/**
+ Runs the statement as an update with it's parameters.
+ */
+- (void) runStatement:(SQLStatement *)statement;
+@end
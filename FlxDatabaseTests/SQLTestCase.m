@@ -0,0 +1,53 @@
+//
+//  SQLTestCase.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+
+@implementation SQLTestCase
+
+- (void) setUp{
+  [super setUp];
+  _database = [[SQLDatabase alloc] initWithPath:@":memory:"];
+}
+
+- (void) tearDown{
+  [_database close];
+  _database = nil;
+  [super tearDown];
+}
+
+- (void) createListTables{
+  [_database executeUpdate:@"CREATE TABLE List (GUID TEXT PRIMARY KEY, name TEXT);"];
+  [_database executeUpdate:@"CREATE TABLE Item (GUID TEXT PRIMARY KEY, name TEXT, listGUID TEXT);"];
+}
+
+- (void) insertRows:(NSArray *)rows intoTable:(NSString *)table{
+  if (!rows.count) return;
+  NSMutableArray *placeholders = [NSMutableArray new];
+  for (NSUInteger i = 0; i < [rows.firstObject count]; i++){
+    [placeholders addObject:@"?"];
+  }
+  NSString *sql = [NSString stringWithFormat:@"INSERT INTO \"%@\" VALUES (%@);", table, [placeholders componentsJoinedByString:@", "]];
+  [_database beginImmediateTransaction];
+  for (NSArray *row in rows){
+    [_database executeUpdate:sql withParameters:row];
+  }
+  [_database commit];
+}
+
+- (NSArray *) rowsForStatement:(SQLStatement *)statement{
+  NSString *sql = statement.newStatement;
+  return [_database executeQuery:sql withParameters:statement.parameters];
+}
+
+- (void) runStatement:(SQLStatement *)statement{
+  NSString *sql = statement.newStatement;
+  [_database executeUpdate:sql withParameters:statement.parameters];
+}
+
+@end
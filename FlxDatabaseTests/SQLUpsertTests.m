@@ -0,0 +1,114 @@
+//
+//  SQLUpsertTests.m
+//  FlxDatabase
+//
+//  Created by Aaron Hayman on 10/16/14.
+//  Copyright (c) 2014 Aaron Hayman. All rights reserved.
+//
+
+#import "SQLTestCase.h"
+#import "SQLStatementConstructor.h"
+
+@protocol UpsertItem <NSObject, SQLStatementObject>
+@property (nonatomic) NSString *name;
+@property (nonatomic) NSString *email;
+@end
+
+@interface UpsertItemClass : NSObject <UpsertItem>
+@end
+@implementation UpsertItemClass
+@synthesize GUID, SQLCreatedDateTime, SQLModifiedDateTime;
+@synthesize name, email;
+@end
+
+@interface SQLUpsertTests : SQLTestCase
+
+@end
+
+@implementation SQLUpsertTests
+
+- (void) setUp{
+  [super setUp];
+  [_database executeUpdate:@"CREATE TABLE Item (GUID TEXT PRIMARY KEY, name TEXT, price INTEGER, SQLCreatedDateTime REAL, SQLModifiedDateTime REAL);"];
+  [_database executeUpdate:@"CREATE TABLE UpsertItem (GUID TEXT PRIMARY KEY, name TEXT, email TEXT UNIQUE, SQLCreatedDateTime REAL, SQLModifiedDateTime REAL);"];
+  [_database executeUpdate:@"CREATE TABLE DeleteLog (GUID TEXT);"];
+  [_database executeUpdate:@"CREATE TRIGGER ItemDeleted AFTER DELETE ON Item BEGIN INSERT INTO DeleteLog VALUES (old.GUID); END;"];
+}
+
+- (NSDictionary *) rowForGUID:(NSString *)GUID table:(NSString *)table{
+  return [[_database executeQuery:[NSString stringWithFormat:@"SELECT * FROM \"%@\" WHERE GUID = ?;", table] withParameters:@[GUID]] firstObject];
+}
+
+- (SQLStatement *) upsertForGUID:(NSString *)GUID values:(NSDictionary *)values{
+  SQLStatement *statement = [SQLStatement statementType:SQLStatementUpsert forTable:@"Item"];
+  statement.GUID = GUID;
+  [values enumerateKeysAndObjectsUsingBlock:^(NSString *column, id value, BOOL *stop) {
+    [statement addColumn:column].value = value;
+  }];
+  return statement;
+}
+
+- (void) testUpsertStatement{
+  SQLStatement *statement = [self upsertForGUID:@"A" values:@{@"name": @"apple"}];
+  XCTAssertEqualObjects(statement.newStatement, @"INSERT INTO \"Item\" (\"GUID\", \"name\", \"SQLCreatedDateTime\", \"SQLModifiedDateTime\") VALUES (?, ?, ?, ?) ON CONFLICT(\"GUID\") DO UPDATE SET \"name\" = excluded.\"name\", \"SQLModifiedDateTime\" = excluded.\"SQLModifiedDateTime\";", @"Only the supplied columns & the modified date should be updated.");
+
+  statement.upsertKeyColumnNames = @[@"name"];
+  statement.upsertOnlyIfNewer = YES;
+  XCTAssertEqualObjects(statement.newStatement, @"INSERT INTO \"Item\" (\"GUID\", \"name\", \"SQLCreatedDateTime\", \"SQLModifiedDateTime\") VALUES (?, ?, ?, ?) ON CONFLICT(\"name\") DO UPDATE SET \"SQLModifiedDateTime\" = excluded.\"SQLModifiedDateTime\" WHERE excluded.\"SQLModifiedDateTime\" > \"Item\".\"SQLModifiedDateTime\" OR \"Item\".\"SQLModifiedDateTime\" IS NULL;", @"The key shouldn't be updated and the guard should compare modified dates.");
+}
+
+- (void) testUpsertUpdatesInPlace{
+  [self runStatement:[self upsertForGUID:@"A" values:@{@"name": @"apple", @"price": @3}]];
+  NSDictionary *inserted = [self rowForGUID:@"A" table:@"Item"];
+  XCTAssertEqualObjects(inserted[@"name"], @"apple", @"The row should be inserted.");
+
+  SQLStatement *update = [self upsertForGUID:@"A" values:@{@"name": @"Apple"}];
+  [self runStatement:update];
+  NSDictionary *updated = [self rowForGUID:@"A" table:@"Item"];
+  XCTAssertEqualObjects(updated[@"name"], @"Apple", @"The supplied column should be updated.");
+  XCTAssertEqualObjects(updated[@"price"], @3, @"Columns that weren't supplied should be kept.");
+  XCTAssertEqualObjects(updated[SQLCreatedDate], inserted[SQLCreatedDate], @"The created date should be kept.");
+  XCTAssertEqualObjects(updated[SQLModifiedDate], update.modified, @"The modified date should be bumped.");
+  XCTAssertEqual([[_database executeQuery:@"SELECT * FROM DeleteLog;"] count], (NSUInteger)0, @"An upsert shouldn't delete the row.");
+}
+
+- (void) testUpsertOnlyIfNewer{
+  SQLStatement *insert = [self upsertForGUID:@"A" values:@{@"name": @"apple", SQLModifiedDate: @100}];
+  [self runStatement:insert];
+
+  SQLStatement *older = [self upsertForGUID:@"A" values:@{@"name": @"older", SQLModifiedDate: @50}];
+  older.upsertOnlyIfNewer = YES;
+  [self runStatement:older];
+  XCTAssertEqualObjects([self rowForGUID:@"A" table:@"Item"][@"name"], @"apple", @"An older write should lose.");
+
+  SQLStatement *newer = [self upsertForGUID:@"A" values:@{@"name": @"newer", SQLModifiedDate: @150}];
+  newer.upsertOnlyIfNewer = YES;
+  [self runStatement:newer];
+  NSDictionary *row = [self rowForGUID:@"A" table:@"Item"];
+  XCTAssertEqualObjects(row[@"name"], @"newer", @"A newer write should win.");
+  XCTAssertEqualObjects(row[SQLModifiedDate], @150, @"The incoming modified date should be kept.");
+}
+
+- (void) testConstructedUpsertOnKey{
+  UpsertItemClass *item = [UpsertItemClass new];
+  item.name = @"Aaron";
+  item.email = @"aaron@example.com";
+  SQLStatement *insert = [SQLStatementConstructor constructUpsertStatementFromObject:item usingProtocol:@protocol(UpsertItem)];
+  XCTAssertEqual(insert.SQLType, SQLStatementUpsert, @"Check the Statement type is correct.");
+  XCTAssertNotNil(item.GUID, @"A new object should be given a GUID.");
+  [self runStatement:insert];
+
+  UpsertItemClass *duplicate = [UpsertItemClass new];
+  duplicate.name = @"Aaron Hayman";
+  duplicate.email = @"aaron@example.com";
+  SQLStatement *update = [SQLStatementConstructor constructUpsertStatementFromObject:duplicate usingProtocol:@protocol(UpsertItem) onKey:@"email" tableName:nil];
+  XCTAssertEqualObjects(update.upsertKeyColumnNames, @[@"email"], @"The key should be the conflict target.");
+  [self runStatement:update];
+
+  NSArray *rows = [_database executeQuery:@"SELECT * FROM UpsertItem;"];
+  XCTAssertEqual(rows.count, (NSUInteger)1, @"The existing row should be updated.");
+  XCTAssertEqualObjects(rows.firstObject[GUIDKey], item.GUID, @"The existing row's GUID should be kept.");
+  XCTAssertEqualObjects(rows.firstObject[@"name"], @"Aaron Hayman", @"The existing row should be updated.");
+}
+
+@end